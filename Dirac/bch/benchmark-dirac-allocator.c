@@ -0,0 +1,298 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a benchmark and stress test of the Dirac allocator.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a benchmark and stress test of the Dirac allocator under
+ * concurrent churn. Each of a number of threads keeps a set of live
+ * matrices and repeatedly replaces a random one with a new matrix of a
+ * random shape, drawn from a mix like that of a simulation: many small
+ * gates, fewer state vectors, and a few larger operators. Each matrix is
+ * stamped with its owner and checked when it is deleted, so that a matrix
+ * handed to two threads at once is caught. For each thread count it
+ * reports the throughput in replacements per second, the median and tail
+ * latency of a replacement, and how often and for how long the allocator
+ * waited for its lock; afterwards it audits the cache. It exits non-zero
+ * if any check fails.
+ *
+ * usage: benchmark-dirac-allocator [ -t THREADS,... ] [ -n REPLACEMENTS ]
+ *        [ -k LIVE ]
+ */
+
+#include "com/diag/dirac/dirac.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+enum {
+    LIMIT = 16, /* Most thread counts in a sweep. */
+};
+
+/*
+ * The shapes and how often each is drawn, out of the sum of the weights.
+ */
+static const struct {
+    size_t rows;
+    size_t columns;
+    unsigned int weight;
+} SHAPES[] = {
+    { 2, 2, 30, },      /* One qubit gates. */
+    { 4, 4, 20, },      /* Two qubit gates. */
+    { 8, 8, 8, },       /* Three qubit gates. */
+    { 2, 1, 10, },      /* State vectors. */
+    { 16, 1, 10, },
+    { 256, 1, 6, },
+    { 4096, 1, 2, },
+    { 16, 16, 8, },     /* Operators. */
+    { 64, 64, 4, },
+    { 256, 256, 2, },
+};
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+typedef struct Worker {
+    pthread_t thread;
+    size_t index;
+    size_t replacements;
+    size_t live;
+    double * latencies;
+    size_t failures;
+} worker_t;
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+static int ascending(const void * ap, const void * bp)
+{
+    double aa = *(const double *)ap;
+    double bb = *(const double *)bp;
+    return (aa < bb) ? -1 : (aa > bb) ? 1 : 0;
+}
+
+static double percentile(const double * sorted, size_t count, double percent)
+{
+    return sorted[(size_t)(((count - 1) * percent) / 100.0)];
+}
+
+static size_t list(const char * string, size_t * values)
+{
+    char * copy = strdup(string);
+    char * save = (char *)0;
+    char * token;
+    size_t count = 0;
+    for (token = strtok_r(copy, ",", &save); (token != (char *)0) && (count < LIMIT); token = strtok_r((char *)0, ",", &save)) {
+        values[count++] = strtoul(token, (char **)0, 0);
+    }
+    free(copy);
+    return count;
+}
+
+/*
+ * The first and last elements carry the owner and the replacement that
+ * made the matrix, so a matrix another thread has written is caught.
+ */
+static void stamp(dirac_matrix_t * matrix, size_t owner, size_t serial)
+{
+    dirac_complex_t * mm = (dirac_complex_t *)matrix;
+    size_t last = (dirac_rows_get(matrix) * dirac_cols_get(matrix)) - 1;
+    mm[0] = CMPLX((double)owner, (double)serial);
+    mm[last] = CMPLX((double)serial, (double)owner);
+}
+
+static int check(const dirac_matrix_t * matrix, size_t owner, size_t serial)
+{
+    const dirac_complex_t * mm = (const dirac_complex_t *)matrix;
+    size_t last = (dirac_rows_get(matrix) * dirac_cols_get(matrix)) - 1;
+    return (mm[0] == CMPLX((double)owner, (double)serial)) && (mm[last] == CMPLX((double)serial, (double)owner));
+}
+
+static void * churn(void * arg)
+{
+    worker_t * wp = (worker_t *)arg;
+    dirac_matrix_t ** matrices = (dirac_matrix_t **)calloc(wp->live, sizeof(dirac_matrix_t *));
+    size_t * serials = (size_t *)calloc(wp->live, sizeof(size_t));
+    unsigned int seed = 0x5eed + wp->index;
+    unsigned int total = 0;
+    unsigned int pick;
+    double start;
+    size_t ii;
+    size_t ss;
+    size_t slot;
+
+    for (ss = 0; ss < (sizeof(SHAPES) / sizeof(SHAPES[0])); ++ss) {
+        total += SHAPES[ss].weight;
+    }
+
+    for (ii = 0; ii < wp->replacements; ++ii) {
+        slot = rand_r(&seed) % wp->live;
+        pick = rand_r(&seed) % total;
+        for (ss = 0; pick >= SHAPES[ss].weight; ++ss) {
+            pick -= SHAPES[ss].weight;
+        }
+
+        if ((matrices[slot] != (dirac_matrix_t *)0) && !check(matrices[slot], wp->index, serials[slot])) {
+            wp->failures += 1;
+        }
+
+        start = now();
+        dirac_delete(matrices[slot]);
+        matrices[slot] = dirac_new_base(SHAPES[ss].rows, SHAPES[ss].columns);
+        wp->latencies[ii] = now() - start;
+
+        if (matrices[slot] == (dirac_matrix_t *)0) {
+            wp->failures += 1;
+            break;
+        }
+        serials[slot] = ii;
+        stamp(matrices[slot], wp->index, ii);
+    }
+
+    for (slot = 0; slot < wp->live; ++slot) {
+        if ((matrices[slot] != (dirac_matrix_t *)0) && !check(matrices[slot], wp->index, serials[slot])) {
+            wp->failures += 1;
+        }
+        dirac_delete(matrices[slot]);
+    }
+
+    free(serials);
+    free(matrices);
+
+    return (void *)0;
+}
+
+/*******************************************************************************
+ * MAIN
+ ******************************************************************************/
+
+int main(int argc, char * argv[])
+{
+    static const char * SELF = "benchmark-dirac-allocator";
+    size_t threads[LIMIT] = { 1, 2, 4, 8, };
+    size_t nthreads = 4;
+    size_t replacements = 200000;
+    size_t live = 64;
+    worker_t * workers;
+    double * latencies;
+    double start;
+    double elapsed;
+    uint64_t waited;
+    size_t waits;
+    size_t samples;
+    size_t failures;
+    size_t tt;
+    size_t ww;
+    int opt;
+    int rc = 0;
+
+    while ((opt = getopt(argc, argv, "t:n:k:")) >= 0) {
+        switch (opt) {
+        case 't':
+            nthreads = list(optarg, threads);
+            break;
+        case 'n':
+            replacements = strtoul(optarg, (char **)0, 0);
+            break;
+        case 'k':
+            live = strtoul(optarg, (char **)0, 0);
+            break;
+        default:
+            rc = 1;
+            break;
+        }
+    }
+    if ((nthreads == 0) || (replacements == 0) || (live == 0)) {
+        rc = 1;
+    }
+    if (rc != 0) {
+        fprintf(stderr, "usage: %s [ -t THREADS,... ] [ -n REPLACEMENTS ] [ -k LIVE ]\n", SELF);
+        return rc;
+    }
+
+    printf("# %s processors=%ld replacements=%zu live=%zu\n", SELF, sysconf(_SC_NPROCESSORS_ONLN), replacements, live);
+    printf("%7s %12s %10s %10s %10s %10s %10s %10s %8s\n", "threads", "ops/s", "p50ns", "p99ns", "p99.9ns", "maxns", "waits", "waitms", "wait%");
+
+    for (tt = 0; tt < nthreads; ++tt) {
+
+        if ((threads[tt] == 0) || ((workers = (worker_t *)calloc(threads[tt], sizeof(worker_t))) == (worker_t *)0)) {
+            return 2;
+        }
+        samples = threads[tt] * replacements;
+        if ((latencies = (double *)malloc(samples * sizeof(double))) == (double *)0) {
+            return 2;
+        }
+
+        dirac_contention_reset();
+        start = now();
+        for (ww = 0; ww < threads[tt]; ++ww) {
+            workers[ww].index = ww;
+            workers[ww].replacements = replacements;
+            workers[ww].live = live;
+            workers[ww].latencies = &(latencies[ww * replacements]);
+            if (pthread_create(&(workers[ww].thread), (pthread_attr_t *)0, churn, &(workers[ww])) != 0) {
+                perror("pthread_create");
+                return 2;
+            }
+        }
+        failures = 0;
+        for (ww = 0; ww < threads[tt]; ++ww) {
+            (void)pthread_join(workers[ww].thread, (void **)0);
+            failures += workers[ww].failures;
+        }
+        elapsed = now() - start;
+        waits = dirac_contention_get(&waited);
+
+        qsort(latencies, samples, sizeof(latencies[0]), ascending);
+        printf("%7zu %12.0f %10.0f %10.0f %10.0f %10.0f %10zu %10.3f %8.3f\n",
+            threads[tt], (samples * 1e9) / elapsed,
+            percentile(latencies, samples, 50.0), percentile(latencies, samples, 99.0), percentile(latencies, samples, 99.9), latencies[samples - 1],
+            waits, waited / 1e6, (100.0 * waited) / (elapsed * threads[tt]));
+        fflush(stdout);
+
+        if (failures > 0) {
+            fprintf(stderr, "%s: threads=%zu failures=%zu FAILED!\n", SELF, threads[tt], failures);
+            rc = 3;
+        }
+        if (dirac_audit() != (dirac_t *)0) {
+            fprintf(stderr, "%s: threads=%zu audit FAILED!\n", SELF, threads[tt]);
+            rc = 3;
+        }
+        if (dirac_dump((FILE *)0) < 0) {
+            fprintf(stderr, "%s: threads=%zu dump FAILED!\n", SELF, threads[tt]);
+            rc = 3;
+        }
+
+        free(latencies);
+        free(workers);
+
+        if (rc != 0) { break; }
+    }
+
+    dirac_free();
+    if (dirac_dump((FILE *)0) != 0) {
+        fprintf(stderr, "%s: free FAILED!\n", SELF);
+        rc = 3;
+    }
+
+    return rc;
+}
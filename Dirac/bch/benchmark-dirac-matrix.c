@@ -0,0 +1,284 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a benchmark of the Dirac matrix operations.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a benchmark of the Dirac matrix operations and the allocator
+ * across a sweep of orders and thread counts. Each measurement is a number
+ * of samples after a number of warmup samples; each sample times a batch of
+ * operations long enough to swamp the clock, and the median and the tenth
+ * and ninetieth percentiles of the samples are reported as nanoseconds per
+ * operation, along with GFLOPS and GB/s computed from the median. The
+ * FLOPS count a complex multiply as six real operations and a complex add
+ * as two; the bytes are the fewest the operation must read and write, so
+ * GB/s is a lower bound on the memory traffic.
+ *
+ * usage: benchmark-dirac-matrix [ -o OPERATION ] [ -s ORDER,... ]
+ *        [ -t THREADS,... ] [ -w WARMUPS ] [ -r SAMPLES ] [ -m MILLISECONDS ]
+ *
+ * OPERATION is one of mul, kro, had, add, trn or new, and may be repeated;
+ * all of them are run if none is given.
+ */
+
+#include "com/diag/dirac/dirac.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+enum {
+    LIMIT = 16, /* Most orders or thread counts in a sweep. */
+    MOST = 1001, /* Most samples per measurement. */
+};
+
+/*******************************************************************************
+ * OPERATIONS
+ ******************************************************************************/
+
+typedef struct Operands {
+    dirac_matrix_t * a;
+    dirac_matrix_t * b;
+    dirac_matrix_t * small;
+    size_t order;
+} operands_t;
+
+typedef dirac_matrix_t * (operation_t)(const operands_t * op);
+
+static dirac_matrix_t * mul(const operands_t * op) { return dirac_matrix_mul(op->a, op->b); }
+
+static dirac_matrix_t * kro(const operands_t * op) { return dirac_matrix_kro(op->small, op->b); }
+
+static dirac_matrix_t * had(const operands_t * op) { return dirac_matrix_had(op->a, op->b); }
+
+static dirac_matrix_t * add(const operands_t * op) { return dirac_matrix_add(op->a, op->b); }
+
+static dirac_matrix_t * trn(const operands_t * op) { return dirac_matrix_trn(op->a); }
+
+static dirac_matrix_t * new(const operands_t * op) { return dirac_new_base(op->order, op->order); }
+
+/*
+ * The Kronecker product is of a 2x2 matrix and an ORDER/2 square one, so
+ * that its result is the same order as the others.
+ */
+static const struct {
+    const char * name;
+    operation_t * operation;
+    double flops;       /* Per order cubed. */
+    double flops2;      /* Per order squared. */
+    double bytes2;      /* Complex elements moved per order squared. */
+} OPERATIONS[] = {
+    { "mul", mul, 8.0, 0.0, 3.0, },
+    { "kro", kro, 0.0, 6.0, 1.25, },
+    { "had", had, 0.0, 6.0, 3.0, },
+    { "add", add, 0.0, 2.0, 3.0, },
+    { "trn", trn, 0.0, 0.0, 2.0, },
+    { "new", new, 0.0, 0.0, 0.0, },
+};
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+static int ascending(const void * ap, const void * bp)
+{
+    double aa = *(const double *)ap;
+    double bb = *(const double *)bp;
+    return (aa < bb) ? -1 : (aa > bb) ? 1 : 0;
+}
+
+static double percentile(const double * sorted, size_t count, int percent)
+{
+    return sorted[((count - 1) * percent) / 100];
+}
+
+static dirac_matrix_t * fill(size_t order, unsigned int seed)
+{
+    dirac_matrix_t * matrix = dirac_new_base(order, order);
+    dirac_complex_t * mm = (dirac_complex_t *)matrix;
+    size_t ii;
+    if (matrix != (dirac_matrix_t *)0) {
+        for (ii = 0; ii < (order * order); ++ii) {
+            mm[ii] = CMPLX((double)rand_r(&seed) / RAND_MAX, (double)rand_r(&seed) / RAND_MAX);
+        }
+    }
+    return matrix;
+}
+
+static size_t list(const char * string, size_t * values)
+{
+    char * copy = strdup(string);
+    char * save = (char *)0;
+    char * token;
+    size_t count = 0;
+    for (token = strtok_r(copy, ",", &save); (token != (char *)0) && (count < LIMIT); token = strtok_r((char *)0, ",", &save)) {
+        values[count++] = strtoul(token, (char **)0, 0);
+    }
+    free(copy);
+    return count;
+}
+
+/*
+ * Returns the batch time in nanoseconds divided by the batch size, or a
+ * negative number if the operation failed.
+ */
+static double batch(operation_t * operation, const operands_t * op, size_t size)
+{
+    dirac_matrix_t * result;
+    double start;
+    size_t ii;
+    start = now();
+    for (ii = 0; ii < size; ++ii) {
+        if ((result = (*operation)(op)) == (dirac_matrix_t *)0) {
+            return -1.0;
+        }
+        dirac_delete(result);
+    }
+    return (now() - start) / size;
+}
+
+/*******************************************************************************
+ * MAIN
+ ******************************************************************************/
+
+int main(int argc, char * argv[])
+{
+    static const char * SELF = "benchmark-dirac-matrix";
+    size_t orders[LIMIT] = { 16, 64, 256, };
+    size_t norders = 3;
+    size_t threads[LIMIT];
+    size_t nthreads = 0;
+    int selected[sizeof(OPERATIONS) / sizeof(OPERATIONS[0])] = { 0, };
+    int any = 0;
+    size_t warmups = 3;
+    size_t samples = 15;
+    double target = 10e6;
+    double times[MOST];
+    operands_t op;
+    double elapsed;
+    double median;
+    size_t size;
+    size_t oo;
+    size_t ss;
+    size_t tt;
+    size_t ii;
+    int opt;
+    int rc = 0;
+
+    while ((opt = getopt(argc, argv, "o:s:t:w:r:m:")) >= 0) {
+        switch (opt) {
+        case 'o':
+            for (oo = 0; oo < (sizeof(OPERATIONS) / sizeof(OPERATIONS[0])); ++oo) {
+                if (strcmp(optarg, OPERATIONS[oo].name) == 0) { selected[oo] = any = !0; break; }
+            }
+            if (oo >= (sizeof(OPERATIONS) / sizeof(OPERATIONS[0]))) { rc = 1; }
+            break;
+        case 's':
+            norders = list(optarg, orders);
+            break;
+        case 't':
+            nthreads = list(optarg, threads);
+            break;
+        case 'w':
+            warmups = strtoul(optarg, (char **)0, 0);
+            break;
+        case 'r':
+            samples = strtoul(optarg, (char **)0, 0);
+            break;
+        case 'm':
+            target = strtod(optarg, (char **)0) * 1e6;
+            break;
+        default:
+            rc = 1;
+            break;
+        }
+    }
+    if ((samples == 0) || (samples > MOST) || (norders == 0)) {
+        rc = 1;
+    }
+    if (rc != 0) {
+        fprintf(stderr, "usage: %s [ -o mul|kro|had|add|trn|new ] [ -s ORDER,... ] [ -t THREADS,... ] [ -w WARMUPS ] [ -r SAMPLES ] [ -m MILLISECONDS ]\n", SELF);
+        return rc;
+    }
+
+    /* One thread and all of them, unless told otherwise. */
+    if (nthreads == 0) {
+        threads[nthreads++] = 1;
+        if (sysconf(_SC_NPROCESSORS_ONLN) > 1) {
+            threads[nthreads++] = sysconf(_SC_NPROCESSORS_ONLN);
+        }
+    }
+
+    printf("# %s processors=%ld warmups=%zu samples=%zu batch=%.0fms\n", SELF, sysconf(_SC_NPROCESSORS_ONLN), warmups, samples, target / 1e6);
+    printf("%-4s %6s %7s %14s %14s %14s %10s %10s\n", "op", "order", "threads", "ns/op", "p10", "p90", "GFLOPS", "GB/s");
+
+    for (oo = 0; oo < (sizeof(OPERATIONS) / sizeof(OPERATIONS[0])); ++oo) {
+        if (any && !selected[oo]) { continue; }
+        for (ss = 0; ss < norders; ++ss) {
+
+            op.order = (orders[ss] < 2) ? 2 : (orders[ss] & ~(size_t)1);
+            op.a = fill(op.order, 1);
+            op.b = fill(op.order, 2);
+            op.small = fill(2, 3);
+            if ((op.a == (dirac_matrix_t *)0) || (op.b == (dirac_matrix_t *)0) || (op.small == (dirac_matrix_t *)0)) {
+                return 2;
+            }
+            if (OPERATIONS[oo].operation == kro) {
+                dirac_delete(op.b);
+                op.b = fill(op.order / 2, 2);
+            }
+
+            for (tt = 0; tt < nthreads; ++tt) {
+                dirac_threads_set(threads[tt]);
+
+                /* The batch grows until it takes long enough to time. */
+                for (size = 1; ; size *= 2) {
+                    if ((elapsed = batch(OPERATIONS[oo].operation, &op, size)) < 0) {
+                        perror(OPERATIONS[oo].name);
+                        return 2;
+                    }
+                    if (((elapsed * size) >= target) || (size >= (1UL << 30))) { break; }
+                }
+                for (ii = 0; ii < warmups; ++ii) {
+                    (void)batch(OPERATIONS[oo].operation, &op, size);
+                }
+                for (ii = 0; ii < samples; ++ii) {
+                    times[ii] = batch(OPERATIONS[oo].operation, &op, size);
+                }
+                qsort(times, samples, sizeof(times[0]), ascending);
+
+                median = percentile(times, samples, 50);
+                printf("%-4s %6zu %7zu %14.1f %14.1f %14.1f %10.3f %10.3f\n",
+                    OPERATIONS[oo].name, op.order, threads[tt],
+                    median, percentile(times, samples, 10), percentile(times, samples, 90),
+                    ((OPERATIONS[oo].flops * op.order * op.order * op.order) + (OPERATIONS[oo].flops2 * op.order * op.order)) / median,
+                    (OPERATIONS[oo].bytes2 * op.order * op.order * sizeof(dirac_complex_t)) / median);
+                fflush(stdout);
+            }
+
+            dirac_delete(op.small);
+            dirac_delete(op.b);
+            dirac_delete(op.a);
+        }
+    }
+
+    dirac_threads_set(0);
+    dirac_free();
+
+    return 0;
+}
@@ -103,6 +103,23 @@ typedef complex double dirac_complex_t;
 
 typedef void dirac_matrix_t;
 
+typedef enum DiracKind {
+    DIRAC_KIND_DENSE    = 0,
+    DIRAC_KIND_SPARSE   = 1,
+    DIRAC_KIND_DIAGONAL = 2,
+    DIRAC_KIND_PERMUTATION = 3,
+    DIRAC_KIND_HERMITIAN = 4,
+    DIRAC_KIND_TRIANGULAR = 5,
+    DIRAC_KIND_STRIDED = 6,
+} dirac_kind_t;
+
+typedef enum DiracFlag {
+    DIRAC_FLAG_MAPPED    = (1 << 0), /* View of a mapped file or segment. */
+    DIRAC_FLAG_SHARED    = (1 << 1), /* View of a shared memory segment. */
+    DIRAC_FLAG_VIEW      = (1 << 2), /* View of the body of another matrix. */
+    DIRAC_FLAG_CONJUGATE = (1 << 3), /* View reads the conjugate elements. */
+} dirac_flag_t;
+
 typedef struct DiracNode {
     diminuto_tree_t tree;
     size_t size;
@@ -111,6 +128,10 @@ typedef struct DiracNode {
 typedef struct DiracData {
     size_t rows;
     size_t columns;
+    size_t count;       /* Stored elements if not dense. */
+    dirac_kind_t kind;
+    unsigned int flags; /* Bit mask of dirac_flag_t. */
+    unsigned int references; /* Holders if from the cache, else zero. */
 } dirac_data_t;
 
 typedef DIRAC_OBJECT_DECL(0, 0) dirac_t;
@@ -123,6 +144,23 @@ extern size_t dirac_rows_get(const dirac_matrix_t * them);
 
 extern size_t dirac_cols_get(const dirac_matrix_t * them);
 
+extern dirac_kind_t dirac_kind_get(const dirac_matrix_t * them);
+
+extern size_t dirac_references_get(const dirac_matrix_t * them);
+
+/*******************************************************************************
+ * PARALLELISM
+ ******************************************************************************/
+
+/*
+ * Sets the maximum number of threads a single operation may use, returning
+ * the prior value. Zero (the default) means the number of online
+ * processors. Large kernels split their rows across this many threads.
+ */
+extern size_t dirac_threads_set(size_t threads);
+
+extern size_t dirac_threads_get(void);
+
 /*******************************************************************************
  * MEMORY MANAGEMENT
  ******************************************************************************/
@@ -144,14 +182,66 @@ extern dirac_t * dirac_audit(void);
 
 extern ssize_t dirac_dump(FILE * fp);
 
+/*
+ * dirac_contention_get returns how many times an allocation or a free has
+ * found the cache locked by another thread, and if NANOSECONDSP is not null
+ * stores the total time they waited for it; dirac_contention_reset zeroes
+ * both.
+ */
+extern size_t dirac_contention_get(uint64_t * nanosecondsp);
+
+extern void dirac_contention_reset(void);
+
 extern const dirac_matrix_t * dirac_print(FILE * fp, const dirac_matrix_t * them);
 
+/*******************************************************************************
+ * FORMATTING
+ ******************************************************************************/
+
+/*
+ * DIRAC_FORMAT_TEXT writes each element as (real+imaginaryi) with each
+ * part in "%7.*e" format with PRECISION digits; at DIRAC_PRECISION the
+ * output is byte for byte what dirac_print writes. DIRAC_FORMAT_HEX writes
+ * the exact bits of each part instead, e.g. (0x3ff0000000000000,0x0...).
+ * DIRAC_FORMAT_BINARY writes the same bytes as dirac_store. PRECISION may
+ * be from 0 to 40. Large matrices are formatted a block of rows at a time
+ * using multiple threads. Returns the number of bytes written, or -1 with
+ * errno set.
+ */
+
+typedef enum DiracFormat {
+    DIRAC_FORMAT_TEXT   = 0,
+    DIRAC_FORMAT_HEX    = 1,
+    DIRAC_FORMAT_BINARY = 2,
+} dirac_format_t;
+
+#define DIRAC_PRECISION (4)
+
+extern ssize_t dirac_write(FILE * fp, const dirac_matrix_t * them, dirac_format_t format, int precision);
+
 /*******************************************************************************
  * OPERATIONS
  ******************************************************************************/
 
 extern dirac_matrix_t * dirac_matrix_dup(const dirac_matrix_t * thema);
 
+/*
+ * Matrices from the cache are reference counted, atomically, so that one
+ * may be held by many threads at once. dirac_matrix_cow is a copy-on-write
+ * dirac_matrix_dup: it returns A itself with one more holder, in O(1).
+ * Holders treat a counted matrix as read only, and call dirac_matrix_own
+ * before their first write to it; that returns A itself if the caller is
+ * its only holder, and otherwise a private copy, giving up the caller's
+ * hold on A. dirac_delete gives up one hold, returning the matrix to the
+ * cache with the last. dirac_references_get returns the number of holders.
+ * Mapped matrices from dirac_load and dirac_shared_new are not counted and
+ * dirac_matrix_cow refuses them, as it must statically allocated matrices.
+ */
+
+extern dirac_matrix_t * dirac_matrix_cow(const dirac_matrix_t * thema);
+
+extern dirac_matrix_t * dirac_matrix_own(dirac_matrix_t * them);
+
 extern dirac_matrix_t * dirac_matrix_trn(const dirac_matrix_t * thema);
 
 extern dirac_matrix_t * dirac_matrix_add(const dirac_matrix_t * thema, const dirac_matrix_t * themb);
@@ -164,6 +254,770 @@ extern dirac_matrix_t * dirac_matrix_had(const dirac_matrix_t * thema, const dir
 
 extern dirac_matrix_t * dirac_matrix_kro(const dirac_matrix_t * thema, const dirac_matrix_t * themb);
 
+/*
+ * Multiplies COUNT conformable matrices in the order that minimizes the
+ * number of complex multiply-accumulates. If FP is not null, the chosen
+ * plan, e.g. "((0*1)*2) cost 4500", is printed to it.
+ */
+extern dirac_matrix_t * dirac_matrix_mul_chain(const dirac_matrix_t * const thems[], size_t count, FILE * fp);
+
+/*
+ * dirac_matrix_pow returns the dense A^K for a square A of any kind (the
+ * identity for K zero) by repeated squaring, in O(log K) products using
+ * just the result and one work buffer from the cache.
+ *
+ * dirac_matrix_pow_apply returns the column vector A^K * V. It applies A
+ * to V K times, alternating between the result and one work vector, unless
+ * forming A^K by repeated squaring and applying it once would cost fewer
+ * multiply-accumulates, as it may for a large K and a small dense A.
+ */
+
+extern dirac_matrix_t * dirac_matrix_pow(const dirac_matrix_t * thema, size_t exponent);
+
+extern dirac_matrix_t * dirac_matrix_pow_apply(const dirac_matrix_t * thema, size_t exponent, const dirac_matrix_t * themv);
+
+/*******************************************************************************
+ * FIXED SIZE OPERATIONS
+ ******************************************************************************/
+
+/*
+ * Fully unrolled products for the operators of one, two and three qubit
+ * gates: an NxN operator times an NxN matrix (_2x2, _4x4, _8x8) or times
+ * an Nx1 column vector (_2x1, _4x1, _8x1). Each checks the operands at run
+ * time and falls back to dirac_matrix_mul if they are not what it expects.
+ * dirac_matrix_mul itself also uses these kernels when the shapes fit.
+ */
+
+extern dirac_matrix_t * dirac_matrix_mul_2x2(const dirac_matrix_t * thema, const dirac_matrix_t * themb);
+
+extern dirac_matrix_t * dirac_matrix_mul_4x4(const dirac_matrix_t * thema, const dirac_matrix_t * themb);
+
+extern dirac_matrix_t * dirac_matrix_mul_8x8(const dirac_matrix_t * thema, const dirac_matrix_t * themb);
+
+extern dirac_matrix_t * dirac_matrix_mul_2x1(const dirac_matrix_t * thema, const dirac_matrix_t * themb);
+
+extern dirac_matrix_t * dirac_matrix_mul_4x1(const dirac_matrix_t * thema, const dirac_matrix_t * themb);
+
+extern dirac_matrix_t * dirac_matrix_mul_8x1(const dirac_matrix_t * thema, const dirac_matrix_t * themb);
+
+/*
+ * When ROWS, MULS and COLS are constants the compiler reduces this to a
+ * direct call to the matching fixed size product (or to dirac_matrix_mul).
+ */
+static inline dirac_matrix_t * dirac_matrix_mul_sized(size_t rows, size_t muls, size_t cols, const dirac_matrix_t * thema, const dirac_matrix_t * themb)
+{
+    dirac_matrix_t * them = (dirac_matrix_t *)0;
+    if ((rows == 2) && (muls == 2) && (cols == 2)) {
+        them = dirac_matrix_mul_2x2(thema, themb);
+    } else if ((rows == 4) && (muls == 4) && (cols == 4)) {
+        them = dirac_matrix_mul_4x4(thema, themb);
+    } else if ((rows == 8) && (muls == 8) && (cols == 8)) {
+        them = dirac_matrix_mul_8x8(thema, themb);
+    } else if ((rows == 2) && (muls == 2) && (cols == 1)) {
+        them = dirac_matrix_mul_2x1(thema, themb);
+    } else if ((rows == 4) && (muls == 4) && (cols == 1)) {
+        them = dirac_matrix_mul_4x1(thema, themb);
+    } else if ((rows == 8) && (muls == 8) && (cols == 1)) {
+        them = dirac_matrix_mul_8x1(thema, themb);
+    } else {
+        them = dirac_matrix_mul(thema, themb);
+    }
+    return them;
+}
+
+#define dirac_mul(_ROWS_, _MULS_, _COLS_, _THEMA_, _THEMB_) \
+    (DIRAC_MATRIX_CAST(_ROWS_, _COLS_)dirac_matrix_mul_sized(_ROWS_, _MULS_, _COLS_, _THEMA_, _THEMB_))
+
+/*******************************************************************************
+ * SPARSE
+ ******************************************************************************/
+
+/*
+ * Sparse matrices are stored in compressed sparse row (CSR) form in the
+ * body of an object from the same cache as dense matrices: COUNT values,
+ * then COUNT column indices, then ROWS+1 row offsets. The handle points at
+ * the values and cannot be indexed as a two dimensional array. A new
+ * sparse matrix is zeroed; the caller fills in all three arrays.
+ *
+ * dirac_matrix_mul and dirac_matrix_kro dispatch on the kind of their
+ * operands: sparse times dense (including a column vector) and dense times
+ * sparse produce a dense result, sparse times sparse and any Kronecker
+ * product with a sparse operand produce a sparse result. The element-wise
+ * operations, dirac_matrix_add, dirac_matrix_sub and dirac_matrix_had,
+ * accept dense matrices and strided views; dirac_matrix_trn accepts those
+ * and the diagonal and permutation kinds. All of them refuse a sparse
+ * operand with EINVAL, so convert it with dirac_sparse_to_dense first.
+ */
+
+extern dirac_matrix_t * dirac_sparse_new(size_t rows, size_t columns, size_t count);
+
+extern size_t dirac_sparse_count_get(const dirac_matrix_t * them);
+
+extern const size_t * dirac_sparse_columns_get(const dirac_matrix_t * them);
+
+extern size_t * dirac_sparse_columns_mut(dirac_matrix_t * them);
+
+extern const size_t * dirac_sparse_offsets_get(const dirac_matrix_t * them);
+
+extern size_t * dirac_sparse_offsets_mut(dirac_matrix_t * them);
+
+extern dirac_matrix_t * dirac_sparse_from_dense(const dirac_matrix_t * thema);
+
+extern dirac_matrix_t * dirac_sparse_to_dense(const dirac_matrix_t * thema);
+
+/*******************************************************************************
+ * STRUCTURED
+ ******************************************************************************/
+
+/*
+ * Diagonal and phased permutation matrices are square and store only
+ * ORDER elements. A diagonal body is the ORDER diagonal values. A
+ * permutation body is ORDER phases followed by ORDER column indices: row R
+ * has the single nonzero phases[R] in column columns[R]. X, CNOT, SWAP and
+ * Toffoli are permutations with unit phases; adding phases gives e.g. Y.
+ * A new diagonal is zeroed; a new permutation is the identity.
+ *
+ * dirac_matrix_mul, dirac_matrix_kro and dirac_matrix_trn dispatch to
+ * O(N) kernels when an operand is diagonal or a permutation: products
+ * and Kronecker products among them stay structured, products with a
+ * dense matrix are dense, and Kronecker products with a dense or sparse
+ * matrix are sparse.
+ */
+
+extern dirac_matrix_t * dirac_diagonal_new(size_t order);
+
+extern dirac_matrix_t * dirac_permutation_new(size_t order);
+
+extern const size_t * dirac_permutation_columns_get(const dirac_matrix_t * them);
+
+extern size_t * dirac_permutation_columns_mut(dirac_matrix_t * them);
+
+extern dirac_matrix_t * dirac_structured_to_dense(const dirac_matrix_t * thema);
+
+/*******************************************************************************
+ * PACKED
+ ******************************************************************************/
+
+/*
+ * Hermitian and upper triangular matrices are square and store only the
+ * ORDER*(ORDER+1)/2 elements of the upper triangle, row by row: row R
+ * holds columns R through ORDER-1, and element (R, C) for C >= R is at
+ * DIRAC_PACKED_INDEX(ORDER, R, C). Below the diagonal a Hermitian matrix
+ * is the conjugate of its mirror image and a triangular one is zero. The
+ * diagonal of a Hermitian matrix should be real. A new packed matrix is
+ * zeroed.
+ *
+ * dirac_matrix_mul dispatches to packed kernels when one operand is packed
+ * and the other dense (including a column vector), which read each stored
+ * element once and produce a dense result. Any other product with a packed
+ * operand expands it first. dirac_matrix_kro with a packed operand produces
+ * a sparse result. The element-wise operations and transpose require dense
+ * operands.
+ *
+ * dirac_packed_from_dense packs the upper triangle of a square dense matrix
+ * as KIND (DIRAC_KIND_HERMITIAN or DIRAC_KIND_TRIANGULAR); the lower
+ * triangle is not read. dirac_packed_to_dense expands a packed matrix.
+ *
+ * dirac_hermitian_update is the Hermitian rank-K update C = ALPHA * A * A'
+ * + BETA * C in place, for a packed Hermitian NxN C and a dense NxK A;
+ * with a column vector A and BETA one it accumulates a pure state into a
+ * density matrix. It returns C, or null with errno set.
+ */
+
+#define DIRAC_PACKED_INDEX(_ORDER_, _ROW_, _COL_) \
+    ((((_ROW_) * ((2 * (_ORDER_)) - (_ROW_) + 1)) / 2) + ((_COL_) - (_ROW_)))
+
+extern dirac_matrix_t * dirac_hermitian_new(size_t order);
+
+extern dirac_matrix_t * dirac_triangular_new(size_t order);
+
+extern dirac_matrix_t * dirac_packed_from_dense(const dirac_matrix_t * thema, dirac_kind_t kind);
+
+extern dirac_matrix_t * dirac_packed_to_dense(const dirac_matrix_t * thema);
+
+extern dirac_matrix_t * dirac_hermitian_update(dirac_matrix_t * themc, double alpha, const dirac_matrix_t * thema, double beta);
+
+/*******************************************************************************
+ * VIEWS
+ ******************************************************************************/
+
+/*
+ * A view is a matrix whose elements are those of a dense matrix (or of
+ * another view) in place: element (R, C) of the view is element OFFSET +
+ * (R * ROWSTRIDE) + (C * COLSTRIDE) of the body of the matrix it views,
+ * counting its elements in row major order. A view owns nothing; reading
+ * or writing through it reads or writes the matrix it views, which must
+ * outlive it. dirac_delete releases only the view.
+ *
+ * A view whose elements are in row major order with no gaps, such as a
+ * row, a block of whole rows, or a reshape, is of kind DIRAC_KIND_DENSE
+ * and is used by every operation exactly as a dense matrix is. Any other
+ * view, such as a column or a general block, is of kind
+ * DIRAC_KIND_STRIDED; the element-wise operations, transpose, products,
+ * Kronecker products and the kernels that apply a matrix to a vector read
+ * it through its strides, and every other operation accepts it by first
+ * gathering just its elements. Either way the handle of a view is not its
+ * elements; use dirac_view_point to address them. dirac_view_is returns
+ * true for a view of either kind, so that a caller can tell a view from a
+ * dense matrix whose handle it may index directly.
+ *
+ * dirac_view_new returns the general view, or null with errno set if THEMA
+ * is not dense or the view would reach outside it. dirac_view_block
+ * returns the ROWS x COLUMNS block of A whose first element is (ROW,
+ * COLUMN), dirac_view_row returns row ROW as a 1xN matrix and dirac_view_col
+ * column COLUMN as an Nx1 matrix, and dirac_view_reshape returns the same
+ * elements in the same order as a ROWS x COLUMNS matrix, e.g. a 2^N state
+ * as a 2^K x 2^(N-K) matrix; A may itself be a view, but a reshape needs one
+ * in row major order with no gaps.
+ *
+ * dirac_view_trn returns the transpose of a dense matrix or a view, and
+ * dirac_view_adj its adjoint (conjugate transpose), in O(1): the transpose
+ * swaps the strides and the adjoint is a conjugate view, which reads the
+ * conjugate of every element it addresses. Products read a transposed or
+ * adjoint operand down its columns, so e.g. U * RHO * U^H takes one view
+ * and no copies; dirac_matrix_trn still returns a new dense transpose.
+ *
+ * dirac_view_point returns the address of element (ROW, COLUMN) of a dense
+ * matrix or a view, or null if it is out of range; for a conjugate view
+ * the element stored there is the conjugate of the element of the view.
+ * dirac_view_assign copies A of any kind into the dense matrix or view V of
+ * the same shape, so that the result of an operation can be written into a
+ * block of a larger matrix; it returns V, or null with errno set.
+ */
+
+extern dirac_matrix_t * dirac_view_new(const dirac_matrix_t * thema, size_t offset, size_t rows, size_t columns, size_t rowstride, size_t colstride);
+
+extern dirac_matrix_t * dirac_view_block(const dirac_matrix_t * thema, size_t row, size_t column, size_t rows, size_t columns);
+
+extern dirac_matrix_t * dirac_view_row(const dirac_matrix_t * thema, size_t row);
+
+extern dirac_matrix_t * dirac_view_col(const dirac_matrix_t * thema, size_t column);
+
+extern dirac_matrix_t * dirac_view_reshape(const dirac_matrix_t * thema, size_t rows, size_t columns);
+
+extern dirac_matrix_t * dirac_view_trn(const dirac_matrix_t * thema);
+
+extern dirac_matrix_t * dirac_view_adj(const dirac_matrix_t * thema);
+
+extern int dirac_view_is(const dirac_matrix_t * them);
+
+extern dirac_complex_t * dirac_view_point(dirac_matrix_t * them, size_t row, size_t column);
+
+extern dirac_matrix_t * dirac_view_assign(dirac_matrix_t * themv, const dirac_matrix_t * thema);
+
+/*******************************************************************************
+ * REDUCTIONS
+ ******************************************************************************/
+
+/*
+ * dirac_matrix_trace returns the trace of a square A of any kind.
+ * dirac_matrix_norm returns the Frobenius norm of A of any kind, which for
+ * a column vector is its 2-norm. dirac_matrix_inner returns the inner
+ * product <A|B>, the sum of conj(a) * b over all elements of two dense
+ * matrices of the same shape, e.g. <psi|phi> for column vectors.
+ * dirac_matrix_expectation returns <v|A|v> for a square A of any kind and
+ * a dense column vector V in one pass, without forming A|v>; for a packed
+ * Hermitian A it reads only the stored triangle and the result is real.
+ *
+ * The sums are computed pairwise in parallel blocks, so the rounding error
+ * grows only with the logarithm of the number of terms, and the result is
+ * the same whatever the number of threads. Each returns NaN with errno set
+ * if the operands are not conformable.
+ */
+
+extern dirac_complex_t dirac_matrix_trace(const dirac_matrix_t * thema);
+
+extern double dirac_matrix_norm(const dirac_matrix_t * thema);
+
+extern dirac_complex_t dirac_matrix_inner(const dirac_matrix_t * thema, const dirac_matrix_t * themb);
+
+extern dirac_complex_t dirac_matrix_expectation(const dirac_matrix_t * thema, const dirac_matrix_t * themv);
+
+/*
+ * dirac_matrix_ptrace returns the reduced density matrix of RHO, an NxN
+ * matrix of any kind over a system of COUNT (at most 64) subsystems in
+ * Kronecker order, subsystem I having DIMS[I] states (two for a qubit) and
+ * N being the product of the DIMS. Bit I of KEEP is set for each subsystem
+ * to keep; the rest are traced out. The result is dense and KxK for K the
+ * product of the kept DIMS: the whole trace as a 1x1 for a KEEP of zero.
+ * Each element is summed directly from RHO, in parallel over the rows of
+ * the result, in O(N^2) in all. Returns null with errno set if the
+ * dimensions do not match.
+ */
+
+extern dirac_matrix_t * dirac_matrix_ptrace(const dirac_matrix_t * thema, const size_t dims[], size_t count, uint64_t keep);
+
+/*******************************************************************************
+ * SAMPLING
+ ******************************************************************************/
+
+/*
+ * dirac_sampler_new prepares to sample measurements of the dense column
+ * vector V. With KEEP DIRAC_SAMPLE_ALL, V may have any length N and the
+ * outcomes are its indices, drawn with probability |v[i]|^2 (normalized).
+ * Otherwise V is the 2^Q amplitudes of Q qubits in Kronecker order (qubit
+ * 0 is the most significant bit of an index) and the outcomes are those of
+ * measuring only the qubits whose bits are set in KEEP, packed in the same
+ * order, drawn from the marginal distribution. The probabilities are
+ * computed once in parallel and made into an alias table, so each shot
+ * costs O(1). Returns null with errno set if V is not such a vector
+ * (EINVAL) or is zero (EDOM). dirac_sampler_delete frees the sampler.
+ *
+ * dirac_sampler_outcomes_get returns the number of distinct outcomes.
+ *
+ * dirac_sampler_draw fills SHOTS with COUNT outcomes drawn in parallel.
+ * Each fixed chunk of shots comes from its own random stream derived from
+ * SEED, so the same SEED gives the same shots whatever the number of
+ * threads. Returns COUNT, or -1 with errno set.
+ */
+
+#define DIRAC_SAMPLE_ALL (~(uint64_t)0)
+
+typedef struct DiracSampler dirac_sampler_t;
+
+extern dirac_sampler_t * dirac_sampler_new(const dirac_matrix_t * themv, uint64_t keep);
+
+extern void dirac_sampler_delete(dirac_sampler_t * sampler);
+
+extern size_t dirac_sampler_outcomes_get(const dirac_sampler_t * sampler);
+
+extern ssize_t dirac_sampler_draw(const dirac_sampler_t * sampler, uint64_t seed, uint64_t * shots, size_t count);
+
+/*******************************************************************************
+ * CIRCUITS
+ ******************************************************************************/
+
+/*
+ * dirac_circuit_new returns an empty circuit on QUBITS qubits, whose state
+ * is a column vector of 2^QUBITS amplitudes in Kronecker order (qubit 0 is
+ * the most significant bit of an index). dirac_circuit_delete frees it.
+ *
+ * dirac_circuit_gate appends the gate G, a 2^K x 2^K matrix of any kind
+ * (which is copied), acting on the K distinct qubits TARGETS[], the first
+ * being the most significant bit of a row or column of G. K may be at most
+ * DIRAC_CIRCUIT_MAXIMUM. Returns the number of the gate, or -1 with errno
+ * set.
+ *
+ * dirac_circuit_compile rewrites the circuit into fewer, larger gates that
+ * are equivalent. Each gate moves back past gates that commute with it
+ * (they share no qubit, or both are diagonal) and is multiplied into the
+ * first whose qubits together with its own number no more than WIDTH, or
+ * are the same as its own; a product within 1e-12 of the identity, such as
+ * that of a gate and its inverse, is dropped. Returns the number of gates
+ * left, or -1 with errno set. A gate on K qubits costs 2^K multiplies per
+ * amplitude per pass, so a WIDTH of three to five trades a little
+ * arithmetic for several times fewer passes over the state.
+ *
+ * dirac_circuit_gates_get returns the number of gates in the circuit.
+ *
+ * dirac_circuit_apply returns the dense state of the circuit applied to the
+ * column vector V of any kind, one parallel pass per gate, or null with
+ * errno set if V is not of the right length.
+ */
+
+#define DIRAC_CIRCUIT_MAXIMUM (8)
+
+typedef struct DiracCircuit dirac_circuit_t;
+
+extern dirac_circuit_t * dirac_circuit_new(size_t qubits);
+
+extern void dirac_circuit_delete(dirac_circuit_t * circuit);
+
+extern ssize_t dirac_circuit_gate(dirac_circuit_t * circuit, const dirac_matrix_t * themg, const size_t targets[], size_t count);
+
+extern ssize_t dirac_circuit_compile(dirac_circuit_t * circuit, size_t width);
+
+extern size_t dirac_circuit_gates_get(const dirac_circuit_t * circuit);
+
+extern dirac_matrix_t * dirac_circuit_apply(const dirac_circuit_t * circuit, const dirac_matrix_t * themv);
+
+/*******************************************************************************
+ * EXPONENTIAL
+ ******************************************************************************/
+
+/*
+ * dirac_matrix_expm returns the dense matrix exp(FACTOR * A) for a square
+ * A of any kind, e.g. the propagator U = exp(-iHt) with FACTOR -t*I. It
+ * uses scaling and squaring with a Pade approximant of degree 3 to 13
+ * chosen from the 1-norm, and allocates all of its workspace (eight NxN
+ * arrays) before it starts.
+ *
+ * dirac_matrix_expm_multiply returns the column vector exp(FACTOR * A) * V
+ * without forming exp(FACTOR * A), by projecting onto Krylov subspaces of
+ * dimension at most thirty. A is only ever applied to vectors, so a sparse
+ * A costs O(nonzeros) per Krylov step instead of O(N^3) for the whole.
+ *
+ * Both return null with errno set if the operands are not conformable or
+ * the result cannot be computed (EDOM).
+ */
+
+extern dirac_matrix_t * dirac_matrix_expm(const dirac_matrix_t * thema, dirac_complex_t factor);
+
+extern dirac_matrix_t * dirac_matrix_expm_multiply(const dirac_matrix_t * thema, dirac_complex_t factor, const dirac_matrix_t * themb);
+
+/*******************************************************************************
+ * MEMOIZATION
+ ******************************************************************************/
+
+/*
+ * The memo is an optional cache of results keyed on the operation and the
+ * contents of its operands, for programs that build the same operators
+ * over and over, e.g. I (x) I (x) H (x) I or a fixed Trotter step. It is
+ * off until dirac_memo_budget_set gives it a budget in bytes; it then keeps
+ * the most recently used results that fit, evicting the least recently used
+ * first, and a budget of zero turns it off again and empties it. Each
+ * returns the prior budget. dirac_memo_flush empties it, as dirac_free
+ * does; dirac_memo_bytes_get, dirac_memo_hits_get and dirac_memo_misses_get
+ * return how much it holds and how often it has been asked.
+ *
+ * dirac_memo_kro, dirac_memo_mul and dirac_memo_expm return the same
+ * results as dirac_matrix_kro, dirac_matrix_mul and dirac_matrix_expm. An
+ * operand is identified by a 128-bit hash of its shape, kind and stored
+ * elements, which costs one pass over it, far less than the operation for
+ * the products and the exponential. A result may be held by the memo and by
+ * other callers at once (see dirac_matrix_cow): the caller must treat it
+ * as read only, call dirac_matrix_own before writing to it, and
+ * dirac_delete it when done, whether or not it came from the memo.
+ */
+
+extern size_t dirac_memo_budget_set(size_t bytes);
+
+extern size_t dirac_memo_budget_get(void);
+
+extern void dirac_memo_flush(void);
+
+extern size_t dirac_memo_bytes_get(void);
+
+extern size_t dirac_memo_hits_get(void);
+
+extern size_t dirac_memo_misses_get(void);
+
+extern dirac_matrix_t * dirac_memo_kro(const dirac_matrix_t * thema, const dirac_matrix_t * themb);
+
+extern dirac_matrix_t * dirac_memo_mul(const dirac_matrix_t * thema, const dirac_matrix_t * themb);
+
+extern dirac_matrix_t * dirac_memo_expm(const dirac_matrix_t * thema, dirac_complex_t factor);
+
+/*******************************************************************************
+ * EIGENSYSTEMS
+ ******************************************************************************/
+
+/*
+ * dirac_matrix_eigh returns the eigenvalues of a Hermitian A of any kind
+ * as a dense Nx1 column in ascending order (the imaginary parts are zero).
+ * If VECTORSP is not null, it also returns in *VECTORSP the NxN dense
+ * matrix whose columns are the corresponding orthonormal eigenvectors.
+ * A is reduced to real tridiagonal form by Householder reflections; the
+ * eigenvalues alone are found by implicit QL, and the eigenvectors by
+ * divide and conquer.
+ *
+ * dirac_matrix_eigh_range returns only the eigenvalues FIRST through
+ * FIRST+COUNT-1 (counting from the smallest) as a COUNTx1 column, and if
+ * VECTORSP is not null their eigenvectors as an NxCOUNT matrix, by
+ * bisection and inverse iteration. This is much cheaper than the whole
+ * when only a ground state or a few low-lying states are needed.
+ *
+ * A is assumed to be Hermitian; that is not checked. Both
+ * return null with errno set if A is not square or the range is outside
+ * it (EINVAL), or if the iteration fails to converge (EDOM).
+ */
+
+extern dirac_matrix_t * dirac_matrix_eigh(const dirac_matrix_t * thema, dirac_matrix_t ** vectorsp);
+
+extern dirac_matrix_t * dirac_matrix_eigh_range(const dirac_matrix_t * thema, size_t first, size_t count, dirac_matrix_t ** vectorsp);
+
+/*******************************************************************************
+ * LINEAR SYSTEMS
+ ******************************************************************************/
+
+/*
+ * dirac_lu_new factors a square A of any kind into P * L * U by Gaussian
+ * elimination with partial pivoting, recursively halving the columns so
+ * that most of the work is in large threaded matrix products. The factors
+ * may be reused for any number of solves, and are freed by
+ * dirac_lu_delete. dirac_lu_factors_get returns the dense NxN factors, L
+ * (unit diagonal, not stored) below the diagonal and U on and above it;
+ * dirac_lu_pivots_get returns the N rows each row was swapped with in turn.
+ * A singular A still factors, but cannot be solved or inverted.
+ *
+ * dirac_lu_solve returns the dense X such that A * X = B for an NxM B of
+ * any kind, i.e. M right hand sides at once. dirac_lu_det returns det(A).
+ * dirac_lu_inverse returns the dense inverse of A.
+ *
+ * dirac_matrix_solve, dirac_matrix_det and dirac_matrix_inv do the same
+ * from A itself, factoring it and discarding the factors.
+ *
+ * dirac_triangular_solve returns the dense X such that T * X = B for a
+ * packed upper triangular T, by back substitution without factoring.
+ *
+ * All return null (NaN for a determinant) with errno set if the operands
+ * are not conformable (EINVAL) or the matrix is singular (EDOM).
+ */
+
+typedef struct DiracLu dirac_lu_t;
+
+extern dirac_lu_t * dirac_lu_new(const dirac_matrix_t * thema);
+
+extern void dirac_lu_delete(dirac_lu_t * lu);
+
+extern const dirac_matrix_t * dirac_lu_factors_get(const dirac_lu_t * lu);
+
+extern const size_t * dirac_lu_pivots_get(const dirac_lu_t * lu);
+
+extern dirac_matrix_t * dirac_lu_solve(const dirac_lu_t * lu, const dirac_matrix_t * themb);
+
+extern dirac_complex_t dirac_lu_det(const dirac_lu_t * lu);
+
+extern dirac_matrix_t * dirac_lu_inverse(const dirac_lu_t * lu);
+
+extern dirac_matrix_t * dirac_matrix_solve(const dirac_matrix_t * thema, const dirac_matrix_t * themb);
+
+extern dirac_complex_t dirac_matrix_det(const dirac_matrix_t * thema);
+
+extern dirac_matrix_t * dirac_matrix_inv(const dirac_matrix_t * thema);
+
+extern dirac_matrix_t * dirac_triangular_solve(const dirac_matrix_t * themt, const dirac_matrix_t * themb);
+
+/*******************************************************************************
+ * PERSISTENCE
+ ******************************************************************************/
+
+/*
+ * A matrix file is a native-endian image of the object: a file header
+ * (magic "DIRACMAT", version, byte order marker, element and index sizes,
+ * body offset and length), then the dirac_data_t of the object placed so
+ * that the body which follows it begins DIRAC_FILE_OFFSET bytes into the
+ * file, a multiple of DIRAC_FILE_ALIGNMENT. Any kind may be stored.
+ *
+ * dirac_store writes the header and the body with a single gathered
+ * write and returns the number of bytes written, or -1 with errno set.
+ *
+ * dirac_load maps the file read-only and returns a view of it directly;
+ * nothing is copied, and only the header and the indices of a sparse or
+ * permutation matrix are checked, so the elements are read only when
+ * touched. A file whose header or indices do not describe a matrix is
+ * refused with EINVAL. The view may be used as an operand anywhere but
+ * must not be modified. It is released with dirac_unload (dirac_delete
+ * does the same for a view).
+ */
+
+#define DIRAC_FILE_VERSION (2)
+
+#define DIRAC_FILE_ALIGNMENT (64)
+
+#define DIRAC_FILE_OFFSET (128)
+
+extern ssize_t dirac_store(const char * path, const dirac_matrix_t * them);
+
+extern const dirac_matrix_t * dirac_load(const char * path);
+
+extern void dirac_unload(const dirac_matrix_t * them);
+
+/*******************************************************************************
+ * SHARED MEMORY
+ ******************************************************************************/
+
+/*
+ * A shared matrix lives in a named POSIX shared memory segment laid out
+ * like a matrix file, so processes on the same host exchange it without
+ * copying or serializing anything.
+ *
+ * dirac_shared_new creates the segment NAME (e.g. "/pipeline-state"),
+ * which must not already exist, for a zeroed dense matrix and returns a
+ * writable view of it. dirac_shared_attach maps an existing segment
+ * read-only. Either view is released with dirac_delete; the segment
+ * itself lasts until dirac_shared_unlink and every view is gone.
+ *
+ * A generation counter in the segment tells consumers when the (single)
+ * producer has published a new version. The producer calls
+ * dirac_shared_begin before changing the body and dirac_shared_publish
+ * afterwards, which returns the new generation and wakes every waiter.
+ * dirac_shared_wait sleeps (on a futex) until a generation other than
+ * GENERATION is published, or MILLISECONDS (negative for ever) expire, and
+ * returns it, or -1 with errno set (ETIMEDOUT on timeout). A consumer that
+ * reads the body while the producer may be changing it uses
+ * dirac_shared_valid afterwards to check that the generation it read is
+ * still the current one; if not it read a torn matrix and should retry.
+ * Generation zero means nothing has been published yet.
+ */
+
+extern dirac_matrix_t * dirac_shared_new(const char * name, size_t rows, size_t columns);
+
+extern const dirac_matrix_t * dirac_shared_attach(const char * name);
+
+extern int dirac_shared_unlink(const char * name);
+
+extern int dirac_shared_begin(dirac_matrix_t * them);
+
+extern int64_t dirac_shared_publish(dirac_matrix_t * them);
+
+extern int64_t dirac_shared_generation_get(const dirac_matrix_t * them);
+
+extern int64_t dirac_shared_wait(const dirac_matrix_t * them, int64_t generation, int milliseconds);
+
+extern int dirac_shared_valid(const dirac_matrix_t * them, int64_t generation);
+
+/*******************************************************************************
+ * MATRIX MARKET
+ ******************************************************************************/
+
+/*
+ * dirac_market_read imports a Matrix Market file in coordinate or array
+ * format with a real, complex, integer or pattern field and general,
+ * symmetric, skew-symmetric or hermitian symmetry (the missing triangle is
+ * filled in). KIND is DIRAC_KIND_DENSE or DIRAC_KIND_SPARSE. The file is
+ * mapped and parsed by multiple threads. Returns null with errno set if
+ * the file cannot be read or is not valid.
+ *
+ * dirac_market_write exports a dense matrix as a complex general array,
+ * a packed Hermitian matrix as complex hermitian coordinates (its lower
+ * triangle), and any other kind as complex general coordinates, with
+ * enough digits to read back exactly. Returns the number of bytes written, or -1.
+ */
+
+extern dirac_matrix_t * dirac_market_read(const char * path, dirac_kind_t kind);
+
+extern ssize_t dirac_market_write(FILE * fp, const dirac_matrix_t * them);
+
+/*******************************************************************************
+ * STREAMING
+ ******************************************************************************/
+
+/*
+ * Streams move a dense matrix file (as written by dirac_store) through
+ * memory BLOCK rows at a time (zero picks about a megabyte's worth) so
+ * that matrices much larger than memory can be processed. Each stream
+ * holds two blocks: while the caller works on one, the next is read, or
+ * the last is written, asynchronously.
+ *
+ * dirac_stream_read returns the next block of a reader, a matrix of up
+ * to BLOCK rows that is valid until the following call, or null at the
+ * end (with errno zero) or on error. dirac_stream_row_get is the index
+ * of its first row in the whole matrix.
+ *
+ * dirac_stream_block returns the buffer for the next block of a writer,
+ * already shaped, or null once all rows have been written; the caller
+ * fills it and hands it back with dirac_stream_write. Blocks must be
+ * written in order. dirac_stream_close waits for outstanding I/O and
+ * fails if a writer was not given every row.
+ *
+ * dirac_stream_add, dirac_stream_had and dirac_stream_mul compute C = A+B,
+ * C = A.B (Hadamard) and C = A*B from and to files, where for the product
+ * only A is streamed and B (e.g. a state vector) is in memory. They
+ * return the number of rows written, or -1 with errno set.
+ */
+
+typedef struct DiracStream dirac_stream_t;
+
+extern dirac_stream_t * dirac_stream_reader(const char * path, size_t block);
+
+extern dirac_stream_t * dirac_stream_writer(const char * path, size_t rows, size_t columns, size_t block);
+
+extern size_t dirac_stream_rows_get(const dirac_stream_t * stream);
+
+extern size_t dirac_stream_cols_get(const dirac_stream_t * stream);
+
+extern size_t dirac_stream_block_get(const dirac_stream_t * stream);
+
+extern size_t dirac_stream_row_get(const dirac_stream_t * stream);
+
+extern const dirac_matrix_t * dirac_stream_read(dirac_stream_t * stream);
+
+extern dirac_matrix_t * dirac_stream_block(dirac_stream_t * stream);
+
+extern int dirac_stream_write(dirac_stream_t * stream);
+
+extern int dirac_stream_close(dirac_stream_t * stream);
+
+extern ssize_t dirac_stream_add(const char * pathc, const char * patha, const char * pathb, size_t block);
+
+extern ssize_t dirac_stream_had(const char * pathc, const char * patha, const char * pathb, size_t block);
+
+extern ssize_t dirac_stream_mul(const char * pathc, const char * patha, const dirac_matrix_t * themb, size_t block);
+
+/*******************************************************************************
+ * TRACING
+ ******************************************************************************/
+
+/*
+ * Tracing counts the calls to the dirac_matrix operations below, and the
+ * time and memory they take, to show which of them dominate a program and
+ * how their latency is distributed. It is off until dirac_trace_set turns
+ * it on, and then costs a read of the time stamp counter (or the clock
+ * where there is none) at either end of an operation, recorded without a
+ * lock in a buffer of the calling thread's own; while it is off it costs a
+ * load and a branch. If the library is built with DIRAC_TRACING defined
+ * as zero it costs nothing, and dirac_trace_set fails with ENOSYS.
+ *
+ * DIRAC_TRACE_COUNT keeps, for each operation, the calls, the cycles of
+ * the counter, the nanoseconds, the bytes of the operands and the result,
+ * and a histogram of latencies whose bucket N counts the calls that took
+ * from 2^N up to 2^(N+1) nanoseconds (the last takes all the longer ones).
+ * DIRAC_TRACE_EVENTS also keeps the first 65536 calls of each thread,
+ * which dirac_trace_export writes as a Chrome trace, JSON that Perfetto or
+ * chrome://tracing can display, returning the number of events written, or
+ * -1 with errno set.
+ *
+ * dirac_trace_set returns the prior mode. dirac_trace_snapshot sums the
+ * statistics of every thread into an array of DIRAC_TRACE_OPERATIONS,
+ * indexed by operation, and returns 0, or -1 with errno set.
+ * dirac_trace_reset zeroes the statistics and discards the events.
+ */
+
+typedef enum DiracTraceOperation {
+    DIRAC_TRACE_DUP             = 0,
+    DIRAC_TRACE_TRN             = 1,
+    DIRAC_TRACE_ADD             = 2,
+    DIRAC_TRACE_SUB             = 3,
+    DIRAC_TRACE_MUL             = 4,
+    DIRAC_TRACE_KRO             = 5,
+    DIRAC_TRACE_HAD             = 6,
+    DIRAC_TRACE_MUL_CHAIN       = 7,
+    DIRAC_TRACE_POW             = 8,
+    DIRAC_TRACE_POW_APPLY       = 9,
+    DIRAC_TRACE_EXPM            = 10,
+    DIRAC_TRACE_EXPM_MULTIPLY   = 11,
+    DIRAC_TRACE_EIGH            = 12,
+    DIRAC_TRACE_EIGH_RANGE      = 13,
+    DIRAC_TRACE_SOLVE           = 14,
+    DIRAC_TRACE_INV             = 15,
+    DIRAC_TRACE_DET             = 16,
+    DIRAC_TRACE_PTRACE          = 17,
+    DIRAC_TRACE_TRACE           = 18,
+    DIRAC_TRACE_NORM            = 19,
+    DIRAC_TRACE_INNER           = 20,
+    DIRAC_TRACE_EXPECTATION     = 21,
+    DIRAC_TRACE_OPERATIONS      = 22,
+} dirac_trace_operation_t;
+
+typedef enum DiracTraceMode {
+    DIRAC_TRACE_OFF     = 0,
+    DIRAC_TRACE_COUNT   = 1,
+    DIRAC_TRACE_EVENTS  = 2,
+} dirac_trace_mode_t;
+
+#define DIRAC_TRACE_BUCKETS (40)
+
+typedef struct DiracTraceStatistics {
+    uint64_t calls;
+    uint64_t cycles;
+    uint64_t nanoseconds;
+    uint64_t bytes;
+    uint64_t histogram[DIRAC_TRACE_BUCKETS];
+} dirac_trace_statistics_t;
+
+extern int dirac_trace_set(int mode);
+
+extern int dirac_trace_get(void);
+
+extern const char * dirac_trace_name(dirac_trace_operation_t operation);
+
+extern int dirac_trace_snapshot(dirac_trace_statistics_t statistics[]);
+
+extern void dirac_trace_reset(void);
+
+extern ssize_t dirac_trace_export(FILE * fp);
+
 /*******************************************************************************
  * END
  ******************************************************************************/
@@ -21,6 +21,8 @@
 
 extern dirac_t * dirac_core_init(dirac_t * that, size_t rows, size_t columns);
 
+extern dirac_t * dirac_core_init_kind(dirac_t * that, dirac_kind_t kind, size_t rows, size_t columns, size_t count);
+
 static inline dirac_t * dirac_core_fini(dirac_t * that) {
     return that;
 }
@@ -31,6 +33,8 @@ static inline dirac_t * dirac_core_fini(dirac_t * that) {
 
 extern dirac_t * dirac_core_allocate(size_t rows, size_t columns);
 
+extern dirac_t * dirac_core_allocate_kind(dirac_kind_t kind, size_t rows, size_t columns, size_t count);
+
 extern dirac_t * dirac_core_free(dirac_t * that);
 
 /*******************************************************************************
@@ -45,20 +49,62 @@ static inline size_t dirac_core_cols_get(const dirac_t * that) {
     return that->data.head.columns;
 }
 
+static inline dirac_kind_t dirac_core_kind_get(const dirac_t * that) {
+    return that->data.head.kind;
+}
+
+static inline int dirac_core_is_dense(const dirac_t * that) {
+    return (that->data.head.kind == DIRAC_KIND_DENSE);
+}
+
+/*
+ * Returns the number of elements actually stored in the body.
+ */
+static inline size_t dirac_core_count_get(const dirac_t * that) {
+    return dirac_core_is_dense(that) ? (that->data.head.rows * that->data.head.columns) : that->data.head.count;
+}
+
+/*
+ * Returns the number of bytes in the body, whatever its kind.
+ */
+extern size_t dirac_core_length_get(const dirac_t * that);
+
+extern size_t dirac_core_length_kind(dirac_kind_t kind, size_t rows, size_t columns, size_t count);
+
+/*
+ * A view is a head followed by where its elements are instead of the
+ * elements themselves: element (R, C) is origin[(R * rowstride) + (C *
+ * colstride)]. The body of a view is always that of some other matrix.
+ */
+
+typedef struct DiracView {
+    dirac_complex_t * origin;
+    size_t rowstride;
+    size_t colstride;
+} dirac_view_t;
+
+static inline int dirac_core_is_view(const dirac_t * that) {
+    return ((that->data.head.flags & DIRAC_FLAG_VIEW) != 0);
+}
+
+static inline const dirac_view_t * dirac_core_view_get(const dirac_t * that) {
+    return (const dirac_view_t *)(&(that->data.body[0][0]));
+}
+
 static inline const dirac_complex_t * dirac_core_body_get(const dirac_t * that) {
-    return &(that->data.body[0][0]);
+    return dirac_core_is_view(that) ? dirac_core_view_get(that)->origin : &(that->data.body[0][0]);
 }
 
 static inline dirac_complex_t * dirac_core_body_mut(dirac_t * that) {
-    return &(that->data.body[0][0]);
+    return dirac_core_is_view(that) ? dirac_core_view_get(that)->origin : &(that->data.body[0][0]);
 }
 
 static inline const dirac_matrix_t * dirac_core_matrix_get(const dirac_t * that) {
-    return (that != (const dirac_t *)0) ? (dirac_matrix_t *)dirac_core_body_get(that) : (const dirac_matrix_t *)0;
+    return (that != (const dirac_t *)0) ? (const dirac_matrix_t *)(&(that->data.body[0][0])) : (const dirac_matrix_t *)0;
 }
 
 static inline dirac_matrix_t * dirac_core_matrix_mut(dirac_t * that) {
-    return (that != (dirac_t *)0) ? (dirac_matrix_t *)dirac_core_body_mut(that) : (dirac_matrix_t *)0;
+    return (that != (dirac_t *)0) ? (dirac_matrix_t *)(&(that->data.body[0][0])) : (dirac_matrix_t *)0;
 }
 
 static inline const dirac_t * dirac_core_object_get(const dirac_matrix_t * them) {
@@ -69,6 +115,183 @@ static inline dirac_t * dirac_core_object_mut(dirac_matrix_t * them) {
     return (them != (dirac_matrix_t *)0) ? diminuto_containerof(dirac_t, data.body[0][0], them) : (dirac_t *)0;
 }
 
+/*******************************************************************************
+ * SPARSE
+ ******************************************************************************/
+
+/*
+ * A sparse body is COUNT values, COUNT column indices, and ROWS+1 row
+ * offsets such that the nonzeros of row R are [offsets[R]..offsets[R+1]).
+ */
+
+static inline const size_t * dirac_core_sparse_columns_get(const dirac_t * that) {
+    return (const size_t *)(&(dirac_core_body_get(that)[that->data.head.count]));
+}
+
+static inline size_t * dirac_core_sparse_columns_mut(dirac_t * that) {
+    return (size_t *)(&(dirac_core_body_mut(that)[that->data.head.count]));
+}
+
+static inline const size_t * dirac_core_sparse_offsets_get(const dirac_t * that) {
+    return &(dirac_core_sparse_columns_get(that)[that->data.head.count]);
+}
+
+static inline size_t * dirac_core_sparse_offsets_mut(dirac_t * that) {
+    return &(dirac_core_sparse_columns_mut(that)[that->data.head.count]);
+}
+
+/*
+ * Compresses a dense, diagonal, permutation or packed matrix into a new
+ * sparse one.
+ */
+extern dirac_t * dirac_core_to_sparse(const dirac_t * thata);
+
+extern dirac_t * dirac_core_mul_sparse(const dirac_t * thata, const dirac_t * thatb);
+
+extern dirac_t * dirac_core_kro_sparse(const dirac_t * thata, const dirac_t * thatb);
+
+/*******************************************************************************
+ * STRUCTURED
+ ******************************************************************************/
+
+static inline int dirac_core_is_structured(const dirac_t * that) {
+    return (that->data.head.kind == DIRAC_KIND_DIAGONAL) || (that->data.head.kind == DIRAC_KIND_PERMUTATION);
+}
+
+/*
+ * A permutation body is COUNT phases followed by COUNT column indices.
+ */
+
+static inline const size_t * dirac_core_permutation_columns_get(const dirac_t * that) {
+    return (const size_t *)(&(dirac_core_body_get(that)[that->data.head.count]));
+}
+
+static inline size_t * dirac_core_permutation_columns_mut(dirac_t * that) {
+    return (size_t *)(&(dirac_core_body_mut(that)[that->data.head.count]));
+}
+
+extern dirac_t * dirac_core_mul_structured(const dirac_t * thata, const dirac_t * thatb);
+
+extern dirac_t * dirac_core_kro_structured(const dirac_t * thata, const dirac_t * thatb);
+
+extern dirac_t * dirac_core_trn_structured(const dirac_t * thata);
+
+/*******************************************************************************
+ * PACKED
+ ******************************************************************************/
+
+static inline int dirac_core_is_packed(const dirac_t * that) {
+    return (that->data.head.kind == DIRAC_KIND_HERMITIAN) || (that->data.head.kind == DIRAC_KIND_TRIANGULAR);
+}
+
+static inline size_t dirac_core_packed_count(size_t order) {
+    return (order * (order + 1)) / 2;
+}
+
+/*
+ * Returns the offset of the first stored element, the diagonal, of row ROW.
+ */
+static inline size_t dirac_core_packed_offset(size_t order, size_t row) {
+    return DIRAC_PACKED_INDEX(order, row, row);
+}
+
+/*
+ * Computes rows [BEGIN..END) of YY = A * XX for a packed A, where XX and YY
+ * are dense arrays of ORDER rows and COLS columns.
+ */
+extern void dirac_core_packed_apply(dirac_complex_t * yy, const dirac_t * thata, const dirac_complex_t * xx, size_t cols, size_t begin, size_t end);
+
+extern dirac_t * dirac_core_mul_packed(const dirac_t * thata, const dirac_t * thatb);
+
+/*******************************************************************************
+ * STRIDED
+ ******************************************************************************/
+
+static inline int dirac_core_is_strided(const dirac_t * that) {
+    return (that->data.head.kind == DIRAC_KIND_STRIDED);
+}
+
+/*
+ * True for the kinds whose elements are all addressed by a row and a
+ * column stride: dense matrices (and dense views) and strided views.
+ */
+static inline int dirac_core_is_array(const dirac_t * that) {
+    return dirac_core_is_dense(that) || dirac_core_is_strided(that);
+}
+
+static inline size_t dirac_core_rowstride_get(const dirac_t * that) {
+    return dirac_core_is_view(that) ? dirac_core_view_get(that)->rowstride : that->data.head.columns;
+}
+
+static inline size_t dirac_core_colstride_get(const dirac_t * that) {
+    return dirac_core_is_view(that) ? dirac_core_view_get(that)->colstride : 1;
+}
+
+/*
+ * A conjugate view reads (and writes) the conjugate of every element it
+ * addresses. It is always of kind DIRAC_KIND_STRIDED, so that only the
+ * kernels that read through strides ever see one.
+ */
+static inline int dirac_core_is_conjugate(const dirac_t * that) {
+    return ((that->data.head.flags & DIRAC_FLAG_CONJUGATE) != 0);
+}
+
+/*
+ * Returns a new view of ROWS x COLUMNS elements of the array THATA whose
+ * first element is at ORIGIN, of kind DIRAC_KIND_DENSE if the strides put
+ * them in row major order with no gaps and it is not CONJUGATE, and of
+ * kind DIRAC_KIND_STRIDED otherwise.
+ */
+extern dirac_t * dirac_core_view(dirac_complex_t * origin, size_t rows, size_t columns, size_t rowstride, size_t colstride, int conjugate);
+
+/*
+ * Returns THATA itself unless it is a strided view, in which case it
+ * gathers its elements into a new dense matrix that it also stores in
+ * TEMPP for the caller to free. Returns null if there is no memory.
+ */
+extern const dirac_t * dirac_core_dense_get(const dirac_t * thata, dirac_t ** tempp);
+
+/*******************************************************************************
+ * LU
+ ******************************************************************************/
+
+/*
+ * Factors the dense ORDER x ORDER array AA in place into its unit lower and
+ * upper triangles, recording in PIVOTS the row each row was swapped with in
+ * turn. Returns the number of zero pivots, which is zero unless AA is
+ * singular.
+ */
+extern int dirac_core_lu_factor(dirac_complex_t * aa, size_t order, size_t * pivots);
+
+/*
+ * Overwrites the dense ORDER x COLS array BB with the solution X of
+ * A * X = BB given the factors and pivots of a nonsingular A.
+ */
+extern void dirac_core_lu_solve(const dirac_complex_t * lu, const size_t * pivots, size_t order, dirac_complex_t * bb, size_t cols);
+
+/*******************************************************************************
+ * PARALLELISM
+ ******************************************************************************/
+
+/*
+ * A body is handed a half open range [begin..end) of the COUNT items to
+ * process. Items are split evenly across at most dirac_threads_get()
+ * threads, but never so finely that a thread gets fewer than GRAIN items;
+ * the calling thread always processes the last range itself.
+ */
+
+typedef void (dirac_core_body_t)(void * context, size_t begin, size_t end);
+
+extern void dirac_core_parallel(size_t count, size_t grain, dirac_core_body_t * body, void * context);
+
+/*
+ * Returns the minimum number of items per thread worth parallelizing if
+ * each item costs about WORK complex multiply-accumulates.
+ */
+static inline size_t dirac_core_grain(size_t work) {
+    return (work >= (1 << 16)) ? 1 : ((1 << 16) / ((work > 0) ? work : 1));
+}
+
 /*******************************************************************************
  * ALLOCATORS
  ******************************************************************************/
@@ -85,12 +308,69 @@ extern dirac_t * dirac_core_kro(const dirac_t * thata, const dirac_t * thatb);
 
 extern dirac_t * dirac_core_had(const dirac_t * thata, const dirac_t * thatb);
 
+/*******************************************************************************
+ * KERNELS
+ ******************************************************************************/
+
+/*
+ * Kernels compute into a target that has already been allocated and shaped
+ * by the caller; they do no validation and no allocation.
+ */
+
+extern dirac_t * dirac_core_mul_into(dirac_t * that, const dirac_t * thata, const dirac_t * thatb);
+
+/*
+ * Returns null, having done nothing, if there is no unrolled kernel for
+ * the shapes of the operands.
+ */
+extern dirac_t * dirac_core_mul_fixed(dirac_t * that, const dirac_t * thata, const dirac_t * thatb);
+
+/*
+ * A dirac_core_parallel body that computes elements [BEGIN..END) of the raw
+ * vector YY = FACTOR * A * XX for an A of any kind without allocating.
+ * dirac_core_apply_grain returns the grain that suits the kind of A.
+ */
+
+typedef struct DiracApply {
+    const dirac_t * thata;
+    const dirac_complex_t * xx;
+    dirac_complex_t * yy;
+    dirac_complex_t factor;
+} dirac_core_apply_t;
+
+extern void dirac_core_apply(void * context, size_t begin, size_t end);
+
+extern size_t dirac_core_apply_grain(const dirac_t * thata);
+
+/*
+ * Fills TABLE with the offset into the index of a system of COUNT
+ * subsystems of DIMS[] states, in Kronecker order, of every combination
+ * of states of the subsystems whose bits are set in MASK, in the same
+ * order.
+ */
+extern void dirac_core_offsets(size_t * table, const size_t dims[], size_t count, uint64_t mask);
+
+/*
+ * Writes FACTOR times a matrix of any kind into TT as a dense array of its
+ * rows and columns.
+ */
+extern void dirac_core_expand(dirac_complex_t * tt, const dirac_t * thata, dirac_complex_t factor);
+
 /*******************************************************************************
  * INDEXING AND POINTING
  ******************************************************************************/
 
 static inline size_t dirac_core_index(const dirac_t * that, unsigned int row, unsigned int column) {
-    return (row * dirac_core_cols_get(that)) + column;
+    return (row * dirac_core_rowstride_get(that)) + (column * dirac_core_colstride_get(that));
+}
+
+/*
+ * Returns the value of element (ROW, COLUMN) of a dense matrix or a view,
+ * conjugated if the view is.
+ */
+static inline dirac_complex_t dirac_core_element(const dirac_t * that, unsigned int row, unsigned int column) {
+    dirac_complex_t value = (dirac_core_body_get(that))[dirac_core_index(that, row, column)];
+    return dirac_core_is_conjugate(that) ? conj(value) : value;
 }
 
 static inline dirac_complex_t * dirac_core_point_fast(dirac_t * that, unsigned int row, unsigned int column) {
@@ -107,12 +387,114 @@ static inline dirac_complex_t * dirac_core_point(dirac_t * that, unsigned int ro
 #endif
 }
 
+/*******************************************************************************
+ * PERSISTENCE
+ ******************************************************************************/
+
+static inline int dirac_core_is_mapped(const dirac_t * that) {
+    return ((that->data.head.flags & DIRAC_FLAG_MAPPED) != 0);
+}
+
+extern void dirac_core_unmap(const dirac_t * that);
+
+/*
+ * Fills in the DIRAC_FILE_OFFSET bytes of a file that precede the body of
+ * a matrix with the head HEAD.
+ */
+extern void dirac_core_file_header(void * header, const dirac_data_t * head);
+
+/*
+ * Returns the head in the HEADER of a file of SIZE bytes, or null if the
+ * file is not a valid matrix.
+ */
+extern const dirac_data_t * dirac_core_file_check(const void * header, size_t size);
+
+/*
+ * Returns true if the indices in the body of a mapped file at BASE, whose
+ * header has passed dirac_core_file_check, stay inside the matrix: the row
+ * offsets and columns of a sparse matrix, or the columns of a permutation.
+ */
+extern int dirac_core_file_valid(const void * base);
+
+/*
+ * Returns the generation counter in the header in front of a mapped
+ * object. It is only meaningful in a shared segment.
+ */
+extern uint32_t * dirac_core_file_generation(const dirac_t * that);
+
 /*******************************************************************************
  * DEBUGGING
  ******************************************************************************/
 
 extern const dirac_t * dirac_core_print(FILE * fp, const dirac_t * that);
 
+extern ssize_t dirac_core_format(FILE * fp, const dirac_t * that, dirac_format_t format, int precision);
+
+/*******************************************************************************
+ * TRACING
+ ******************************************************************************/
+
+/*
+ * Tracing is compiled in unless DIRAC_TRACING is defined as zero, e.g.
+ * make CDEFINES=-DDIRAC_TRACING=0.
+ */
+#if !defined(DIRAC_TRACING)
+#   define DIRAC_TRACING (1)
+#endif
+
+extern int dirac_core_trace_mode;
+
+#if DIRAC_TRACING
+
+#if defined(__x86_64__) || defined(__i386__)
+#   include <x86intrin.h>
+#endif
+#include <time.h>
+
+static inline uint64_t dirac_core_trace_clock(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+#endif
+}
+
+/*
+ * Returns the time at which an operation began, or zero if tracing is off.
+ */
+static inline uint64_t dirac_core_trace_begin(void) {
+    return (__atomic_load_n(&dirac_core_trace_mode, __ATOMIC_ACQUIRE) != DIRAC_TRACE_OFF) ? dirac_core_trace_clock() : 0;
+}
+
+extern size_t dirac_core_trace_bytes(const dirac_t * thata, const dirac_t * thatb, const dirac_t * that);
+
+extern void dirac_core_trace_record(dirac_trace_operation_t operation, uint64_t begin, size_t bytes);
+
+/*
+ * DIRAC_TRACE_BEGIN opens an operation, before its other declarations, and
+ * DIRAC_TRACE_END closes it, with its operands and result, before its return.
+ */
+#   define DIRAC_TRACE_BEGIN \
+    uint64_t dirac_trace_begin_ = dirac_core_trace_begin()
+
+#   define DIRAC_TRACE_END(_OPERATION_, _THATA_, _THATB_, _THAT_) \
+    do { \
+        if (dirac_trace_begin_ != 0) { \
+            dirac_core_trace_record((_OPERATION_), dirac_trace_begin_, dirac_core_trace_bytes((_THATA_), (_THATB_), (_THAT_))); \
+        } \
+    } while (0)
+
+#else
+
+#   define DIRAC_TRACE_BEGIN
+
+#   define DIRAC_TRACE_END(_OPERATION_, _THATA_, _THATB_, _THAT_) \
+    ((void)0)
+
+#endif
+
 /*******************************************************************************
  * END
  ******************************************************************************/
@@ -0,0 +1,527 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the circuit portions of Dirac. A circuit
+ * records small gates and the qubits they act on, and applies each one to
+ * the state in a single pass that gathers, transforms and scatters the
+ * amplitudes of every combination of the other qubits. Since every pass
+ * reads and writes the whole state, compiling a circuit first folds gates
+ * together: a gate moves back past the gates it commutes with (those on
+ * other qubits, or diagonal gates) and is multiplied into the first one
+ * it can join without exceeding the width, and a product that comes out
+ * as the identity is dropped.
+ *
+ * REFERENCES
+ *
+ * T. Haner, D. Steiger, "0.5 Petabyte Simulation of a 45-Qubit Quantum
+ * Circuit", SC17, 2017
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/*
+ * The largest number of amplitudes a gate transforms at once.
+ */
+#define SIZE ((size_t)1 << DIRAC_CIRCUIT_MAXIMUM)
+
+/*
+ * How far from the identity a product may be and still be dropped.
+ */
+static const double TOLERANCE = 1.0e-12;
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+typedef struct DiracGate {
+    dirac_t * that;
+    size_t targets[DIRAC_CIRCUIT_MAXIMUM];
+    size_t count;
+    int diagonal;
+} dirac_gate_t;
+
+struct DiracCircuit {
+    dirac_gate_t * gates;
+    size_t count;
+    size_t capacity;
+    size_t qubits;
+};
+
+typedef struct DiracPass {
+    dirac_complex_t * ss;
+    const dirac_complex_t * gg;
+    const size_t * offsets;
+    const size_t * positions;
+    size_t count;
+    int diagonal;
+} dirac_pass_t;
+
+/*******************************************************************************
+ * KERNELS
+ ******************************************************************************/
+
+/*
+ * Each item is one combination of the qubits the gate leaves alone. Its
+ * index into the state is the number of the item with a zero inserted at
+ * the bit of each target, in ascending order of bit.
+ */
+static void pass(void * context, size_t begin, size_t end)
+{
+    const dirac_pass_t * passp = (const dirac_pass_t *)context;
+    dirac_complex_t * restrict ss = passp->ss;
+    const dirac_complex_t * restrict gg = passp->gg;
+    const size_t * restrict offsets = passp->offsets;
+    const dirac_complex_t * restrict row;
+    dirac_complex_t in[SIZE];
+    dirac_complex_t * amplitudes;
+    dirac_complex_t sum;
+    size_t size = (size_t)1 << passp->count;
+    size_t base;
+    size_t bit;
+    size_t mm;
+    size_t ii;
+    size_t rr;
+    size_t cc;
+    for (mm = begin; mm < end; ++mm) {
+        base = mm;
+        for (ii = 0; ii < passp->count; ++ii) {
+            bit = passp->positions[ii];
+            base = ((base >> bit) << (bit + 1)) | (base & (((size_t)1 << bit) - 1));
+        }
+        amplitudes = &(ss[base]);
+        if (passp->diagonal) {
+            for (rr = 0; rr < size; ++rr) {
+                amplitudes[offsets[rr]] *= gg[(rr * size) + rr];
+            }
+        } else {
+            for (cc = 0; cc < size; ++cc) {
+                in[cc] = amplitudes[offsets[cc]];
+            }
+            for (rr = 0; rr < size; ++rr) {
+                row = &(gg[rr * size]);
+                sum = 0;
+                for (cc = 0; cc < size; ++cc) {
+                    sum += row[cc] * in[cc];
+                }
+                amplitudes[offsets[rr]] = sum;
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+static int is_diagonal(const dirac_complex_t * gg, size_t size)
+{
+    size_t rr;
+    size_t cc;
+    for (rr = 0; rr < size; ++rr) {
+        for (cc = 0; cc < size; ++cc) {
+            if ((rr != cc) && (gg[(rr * size) + cc] != 0)) {
+                return 0;
+            }
+        }
+    }
+    return !0;
+}
+
+static int is_identity(const dirac_complex_t * gg, size_t size)
+{
+    size_t rr;
+    size_t cc;
+    for (rr = 0; rr < size; ++rr) {
+        for (cc = 0; cc < size; ++cc) {
+            if (cabs(gg[(rr * size) + cc] - ((rr == cc) ? 1.0 : 0.0)) > TOLERANCE) {
+                return 0;
+            }
+        }
+    }
+    return !0;
+}
+
+/*
+ * Writes into UNION[] the qubits of EARLIER followed by those of LATER
+ * that EARLIER lacks, and returns how many there are.
+ */
+static size_t unite(size_t * unionp, const dirac_gate_t * earlier, const dirac_gate_t * later)
+{
+    size_t count = earlier->count;
+    size_t ii;
+    size_t jj;
+    memcpy(unionp, earlier->targets, count * sizeof(size_t));
+    for (ii = 0; ii < later->count; ++ii) {
+        for (jj = 0; jj < earlier->count; ++jj) {
+            if (later->targets[ii] == earlier->targets[jj]) {
+                break;
+            }
+        }
+        if (jj >= earlier->count) {
+            unionp[count++] = later->targets[ii];
+        }
+    }
+    return count;
+}
+
+/*
+ * Gates commute if they share no qubit or are both diagonal.
+ */
+static int commutes(const dirac_gate_t * one, const dirac_gate_t * two)
+{
+    size_t ii;
+    size_t jj;
+    if (one->diagonal && two->diagonal) {
+        return !0;
+    }
+    for (ii = 0; ii < one->count; ++ii) {
+        for (jj = 0; jj < two->count; ++jj) {
+            if (one->targets[ii] == two->targets[jj]) {
+                return 0;
+            }
+        }
+    }
+    return !0;
+}
+
+/*
+ * Writes into TT the operator on the WIDTH qubits UNION[] equivalent to
+ * the gate GATEP on a subset of them: an element is that of the gate for
+ * the bits of its qubits if the bits of all the other qubits agree, and
+ * zero if they do not.
+ */
+static void embed(dirac_complex_t * tt, const size_t * unionp, size_t width, const dirac_gate_t * gatep)
+{
+    const dirac_complex_t * gg = dirac_core_body_get(gatep->that);
+    size_t dimension = (size_t)1 << width;
+    size_t size = (size_t)1 << gatep->count;
+    size_t where[DIRAC_CIRCUIT_MAXIMUM];
+    size_t mask = 0;
+    size_t row;
+    size_t rr;
+    size_t cc;
+    size_t ii;
+    size_t jj;
+    for (ii = 0; ii < gatep->count; ++ii) {
+        for (jj = 0; unionp[jj] != gatep->targets[ii]; ++jj) {
+            /* Do nothing. */
+        }
+        where[ii] = width - 1 - jj;
+        mask |= (size_t)1 << where[ii];
+    }
+    for (rr = 0; rr < dimension; ++rr) {
+        row = 0;
+        for (ii = 0; ii < gatep->count; ++ii) {
+            row = (row << 1) | ((rr >> where[ii]) & 1);
+        }
+        for (cc = 0; cc < dimension; ++cc) {
+            if ((rr & ~mask) != (cc & ~mask)) {
+                tt[(rr * dimension) + cc] = 0;
+            } else {
+                jj = 0;
+                for (ii = 0; ii < gatep->count; ++ii) {
+                    jj = (jj << 1) | ((cc >> where[ii]) & 1);
+                }
+                tt[(rr * dimension) + cc] = gg[(row * size) + jj];
+            }
+        }
+    }
+}
+
+/*
+ * Replaces the gate EARLIERP with the product of the gate LATERP and it
+ * on the WIDTH qubits of UNION[]. Returns -1 if there is no memory.
+ */
+static int fuse(dirac_gate_t * earlierp, const dirac_gate_t * laterp, const size_t * unionp, size_t width)
+{
+    size_t dimension = (size_t)1 << width;
+    dirac_t * thata = dirac_core_allocate(dimension, dimension);
+    dirac_t * thatb = dirac_core_allocate(dimension, dimension);
+    dirac_t * that = dirac_core_allocate(dimension, dimension);
+    int rc = -1;
+    if ((thata != (dirac_t *)0) && (thatb != (dirac_t *)0) && (that != (dirac_t *)0)) {
+        embed(dirac_core_body_mut(thata), unionp, width, laterp);
+        embed(dirac_core_body_mut(thatb), unionp, width, earlierp);
+        (void)dirac_core_mul_into(that, thata, thatb);
+        dirac_core_free(earlierp->that);
+        earlierp->that = that;
+        that = (dirac_t *)0;
+        memcpy(earlierp->targets, unionp, width * sizeof(size_t));
+        earlierp->count = width;
+        earlierp->diagonal = is_diagonal(dirac_core_body_get(earlierp->that), dimension);
+        rc = 0;
+    }
+    dirac_core_free(that);
+    dirac_core_free(thatb);
+    dirac_core_free(thata);
+    return rc;
+}
+
+/*******************************************************************************
+ * PUBLIC OPERATIONS
+ ******************************************************************************/
+
+dirac_circuit_t * dirac_circuit_new(size_t qubits)
+{
+    dirac_circuit_t * circuit = (dirac_circuit_t *)0;
+    if ((qubits == 0) || (qubits >= (sizeof(size_t) * 8))) {
+        errno = EINVAL;
+        diminuto_perror("dirac_circuit_new");
+    } else if ((circuit = (dirac_circuit_t *)calloc(1, sizeof(dirac_circuit_t))) == (dirac_circuit_t *)0) {
+        diminuto_perror("dirac_circuit_new");
+    } else {
+        circuit->qubits = qubits;
+    }
+    return circuit;
+}
+
+void dirac_circuit_delete(dirac_circuit_t * circuit)
+{
+    size_t ii;
+    if (circuit != (dirac_circuit_t *)0) {
+        for (ii = 0; ii < circuit->count; ++ii) {
+            dirac_core_free(circuit->gates[ii].that);
+        }
+        free(circuit->gates);
+        free(circuit);
+    }
+}
+
+size_t dirac_circuit_gates_get(const dirac_circuit_t * circuit)
+{
+    return (circuit != (const dirac_circuit_t *)0) ? circuit->count : 0;
+}
+
+ssize_t dirac_circuit_gate(dirac_circuit_t * circuit, const dirac_matrix_t * themg, const size_t targets[], size_t count)
+{
+    const dirac_t * thatg = dirac_core_object_get(themg);
+    ssize_t result = -1;
+    dirac_gate_t * gatep;
+    void * pointer;
+    size_t capacity;
+    size_t size;
+    size_t ii;
+    size_t jj;
+
+    do {
+
+        if ((circuit == (dirac_circuit_t *)0) || (thatg == (const dirac_t *)0) || (targets == (const size_t *)0) || (count == 0) || (count > DIRAC_CIRCUIT_MAXIMUM)) {
+            errno = EINVAL;
+            break;
+        }
+
+        size = (size_t)1 << count;
+        if ((dirac_core_rows_get(thatg) != size) || (dirac_core_cols_get(thatg) != size)) {
+            errno = EINVAL;
+            break;
+        }
+
+        for (ii = 0; ii < count; ++ii) {
+            if (targets[ii] >= circuit->qubits) {
+                break;
+            }
+            for (jj = 0; jj < ii; ++jj) {
+                if (targets[jj] == targets[ii]) {
+                    break;
+                }
+            }
+            if (jj < ii) {
+                break;
+            }
+        }
+        if (ii < count) {
+            errno = EINVAL;
+            break;
+        }
+
+        if (circuit->count >= circuit->capacity) {
+            capacity = (circuit->capacity > 0) ? (2 * circuit->capacity) : 16;
+            if ((pointer = realloc(circuit->gates, capacity * sizeof(dirac_gate_t))) == (void *)0) {
+                break;
+            }
+            circuit->gates = (dirac_gate_t *)pointer;
+            circuit->capacity = capacity;
+        }
+
+        gatep = &(circuit->gates[circuit->count]);
+        if ((gatep->that = dirac_core_allocate(size, size)) == (dirac_t *)0) {
+            break;
+        }
+        dirac_core_expand(dirac_core_body_mut(gatep->that), thatg, 1.0);
+        memcpy(gatep->targets, targets, count * sizeof(size_t));
+        gatep->count = count;
+        gatep->diagonal = is_diagonal(dirac_core_body_get(gatep->that), size);
+
+        result = circuit->count++;
+
+    } while (0);
+
+    if (result < 0) {
+        diminuto_perror("dirac_circuit_gate");
+    }
+
+    return result;
+}
+
+ssize_t dirac_circuit_compile(dirac_circuit_t * circuit, size_t width)
+{
+    ssize_t result = -1;
+    dirac_gate_t * gatep;
+    dirac_gate_t * blockp;
+    size_t unionp[2 * DIRAC_CIRCUIT_MAXIMUM];
+    size_t united;
+    size_t blocks = 0;
+    size_t ii;
+    size_t jj;
+
+    do {
+
+        if ((circuit == (dirac_circuit_t *)0) || (width == 0) || (width > DIRAC_CIRCUIT_MAXIMUM)) {
+            errno = EINVAL;
+            break;
+        }
+
+        /*
+         * The compiled blocks are built at the front of the same array,
+         * which can never overtake the gate being placed.
+         */
+        for (ii = 0; ii < circuit->count; ++ii) {
+            gatep = &(circuit->gates[ii]);
+            for (jj = blocks; jj > 0; --jj) {
+                blockp = &(circuit->gates[jj - 1]);
+                united = unite(unionp, blockp, gatep);
+                if ((united <= width) || ((united == blockp->count) && (united == gatep->count))) {
+                    break;
+                }
+                if (!commutes(blockp, gatep)) {
+                    jj = 0;
+                    break;
+                }
+            }
+            if (jj == 0) {
+                circuit->gates[blocks++] = *gatep;
+            } else if (fuse(blockp, gatep, unionp, united) < 0) {
+                break;
+            } else {
+                dirac_core_free(gatep->that);
+                if (is_identity(dirac_core_body_get(blockp->that), (size_t)1 << blockp->count)) {
+                    dirac_core_free(blockp->that);
+                    memmove(blockp, &(blockp[1]), (blocks - jj) * sizeof(dirac_gate_t));
+                    --blocks;
+                }
+            }
+        }
+
+        if (ii < circuit->count) {
+            /* Keep the rest unfused; the circuit is still equivalent. */
+            memmove(&(circuit->gates[blocks]), &(circuit->gates[ii]), (circuit->count - ii) * sizeof(dirac_gate_t));
+            circuit->count = blocks + (circuit->count - ii);
+            break;
+        }
+
+        circuit->count = blocks;
+        result = blocks;
+
+    } while (0);
+
+    if (result < 0) {
+        diminuto_perror("dirac_circuit_compile");
+    }
+
+    return result;
+}
+
+dirac_matrix_t * dirac_circuit_apply(const dirac_circuit_t * circuit, const dirac_matrix_t * themv)
+{
+    const dirac_t * thatv = dirac_core_object_get(themv);
+    dirac_t * that = (dirac_t *)0;
+    const dirac_gate_t * gatep;
+    size_t offsets[SIZE];
+    size_t positions[DIRAC_CIRCUIT_MAXIMUM];
+    dirac_pass_t context;
+    size_t length;
+    size_t size;
+    size_t bit;
+    size_t gg;
+    size_t ii;
+    size_t jj;
+
+    do {
+
+        if ((circuit == (const dirac_circuit_t *)0) || (thatv == (const dirac_t *)0) || (dirac_core_cols_get(thatv) != 1)) {
+            errno = EINVAL;
+            break;
+        }
+
+        length = (size_t)1 << circuit->qubits;
+        if (dirac_core_rows_get(thatv) != length) {
+            errno = EINVAL;
+            break;
+        }
+
+        if ((that = dirac_core_allocate(length, 1)) == (dirac_t *)0) {
+            break;
+        }
+        dirac_core_expand(dirac_core_body_mut(that), thatv, 1.0);
+
+        context.ss = dirac_core_body_mut(that);
+        context.offsets = offsets;
+        context.positions = positions;
+
+        for (gg = 0; gg < circuit->count; ++gg) {
+            gatep = &(circuit->gates[gg]);
+            size = (size_t)1 << gatep->count;
+            for (jj = 0; jj < size; ++jj) {
+                offsets[jj] = 0;
+                for (ii = 0; ii < gatep->count; ++ii) {
+                    if ((jj & ((size_t)1 << (gatep->count - 1 - ii))) != 0) {
+                        offsets[jj] |= (size_t)1 << (circuit->qubits - 1 - gatep->targets[ii]);
+                    }
+                }
+            }
+            /* Insertion sort of the bits, smallest first. */
+            for (ii = 0; ii < gatep->count; ++ii) {
+                bit = circuit->qubits - 1 - gatep->targets[ii];
+                for (jj = ii; (jj > 0) && (positions[jj - 1] > bit); --jj) {
+                    positions[jj] = positions[jj - 1];
+                }
+                positions[jj] = bit;
+            }
+            context.gg = dirac_core_body_get(gatep->that);
+            context.count = gatep->count;
+            context.diagonal = gatep->diagonal;
+            dirac_core_parallel(length / size, dirac_core_grain(gatep->diagonal ? size : (size * size)), pass, &context);
+        }
+
+    } while (0);
+
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_circuit_apply");
+    }
+
+    return dirac_core_matrix_mut(that);
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
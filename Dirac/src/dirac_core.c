@@ -21,6 +21,7 @@
 #include <string.h>
 #include <errno.h>
 #include <math.h>
+#include <time.h>
 #include "dirac.h"
 
 /*******************************************************************************
@@ -31,6 +32,10 @@ static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static diminuto_tree_root_t cache = DIMINUTO_TREE_EMPTY;
 
+static size_t waits = 0;
+
+static uint64_t waited = 0;
+
 /*******************************************************************************
  * HELPERS
  ******************************************************************************/
@@ -43,12 +48,53 @@ static inline size_t length(size_t rows, size_t columns) {
     return count(rows, columns) * sizeof(dirac_complex_t);
 }
 
+static size_t length_kind(dirac_kind_t kind, size_t rows, size_t columns, size_t count)
+{
+    size_t bytes = 0;
+    switch (kind) {
+    case DIRAC_KIND_DENSE:
+        bytes = length(rows, columns);
+        break;
+    case DIRAC_KIND_SPARSE:
+        bytes = (count * (sizeof(dirac_complex_t) + sizeof(size_t))) + ((rows + 1) * sizeof(size_t));
+        break;
+    case DIRAC_KIND_DIAGONAL:
+        bytes = count * sizeof(dirac_complex_t);
+        break;
+    case DIRAC_KIND_PERMUTATION:
+        bytes = count * (sizeof(dirac_complex_t) + sizeof(size_t));
+        break;
+    case DIRAC_KIND_HERMITIAN:
+    case DIRAC_KIND_TRIANGULAR:
+        bytes = count * sizeof(dirac_complex_t);
+        break;
+    case DIRAC_KIND_STRIDED:
+        /* A strided view has no elements of its own. */
+        break;
+    }
+    return bytes;
+}
+
+static inline size_t size_kind(dirac_kind_t kind, size_t rows, size_t columns, size_t count) {
+    size_t bytes = length_kind(kind, rows, columns, count) + sizeof(dirac_data_t);
+    if (bytes < sizeof(dirac_node_t)) { bytes = sizeof(dirac_node_t); }
+    return bytes;
+}
+
 static inline size_t size(size_t rows, size_t columns) {
-    size_t bytes = length(rows, columns) + sizeof(dirac_data_t);
+    return size_kind(DIRAC_KIND_DENSE, rows, columns, 0);
+}
+
+static inline size_t size_view(void) {
+    size_t bytes = sizeof(dirac_data_t) + sizeof(dirac_view_t);
     if (bytes < sizeof(dirac_node_t)) { bytes = sizeof(dirac_node_t); }
     return bytes;
 }
 
+static inline size_t footprint(const dirac_t * that) {
+    return dirac_core_is_view(that) ? size_view() : size_kind(that->data.head.kind, that->data.head.rows, that->data.head.columns, that->data.head.count);
+}
+
 static int compare(const diminuto_tree_t * a, const diminuto_tree_t * b)
 {
     dirac_t * aa = (dirac_t *)a;
@@ -63,55 +109,141 @@ static int compare(const diminuto_tree_t * a, const diminuto_tree_t * b)
     }
 }
 
+/*******************************************************************************
+ * SIZING
+ ******************************************************************************/
+
+size_t dirac_core_length_kind(dirac_kind_t kind, size_t rows, size_t columns, size_t count)
+{
+    return length_kind(kind, rows, columns, count);
+}
+
+size_t dirac_core_length_get(const dirac_t * that)
+{
+    return length_kind(that->data.head.kind, that->data.head.rows, that->data.head.columns, that->data.head.count);
+}
+
 /*******************************************************************************
  * INITIALIZATION AND FINALIZATION
  ******************************************************************************/
 
-dirac_t * dirac_core_init(dirac_t * that, size_t rows, size_t columns)
+dirac_t * dirac_core_init_kind(dirac_t * that, dirac_kind_t kind, size_t rows, size_t columns, size_t count)
 {
     if (that != (dirac_t *)0) {
-        memset(dirac_core_body_mut(that), 0, length(rows, columns));
+        memset(&(that->data.body[0][0]), 0, length_kind(kind, rows, columns, count));
         that->data.head.rows = rows;
         that->data.head.columns = columns;
+        that->data.head.count = (kind == DIRAC_KIND_DENSE) ? 0 : count;
+        that->data.head.kind = kind;
+        that->data.head.flags = 0;
+        that->data.head.references = 1;
     }
     return that;
 }
 
+dirac_t * dirac_core_init(dirac_t * that, size_t rows, size_t columns)
+{
+    return dirac_core_init_kind(that, DIRAC_KIND_DENSE, rows, columns, 0);
+}
+
 /*******************************************************************************
  * PRIVATE MEMORY MANAGEMENT
  ******************************************************************************/
 
-dirac_t * dirac_core_allocate(size_t rows, size_t columns)
+/*
+ * Allocation and free lock the cache with these, which note how often the
+ * mutex was already held and for how long they waited for it; when it is
+ * not held this costs no more than the lock itself.
+ */
+static void enter(void)
+{
+    struct timespec before;
+    struct timespec after;
+    if (pthread_mutex_trylock(&mutex) != 0) {
+        clock_gettime(CLOCK_MONOTONIC, &before);
+        pthread_mutex_lock(&mutex);
+        clock_gettime(CLOCK_MONOTONIC, &after);
+        waits += 1;
+        waited += ((int64_t)(after.tv_sec - before.tv_sec) * 1000000000LL) + (after.tv_nsec - before.tv_nsec);
+    }
+}
+
+static inline void leave(void)
+{
+    pthread_mutex_unlock(&mutex);
+}
+
+static dirac_t * acquire(size_t bytes)
 {
     dirac_t target;
-    target.node.size = size(rows, columns);
+    target.node.size = bytes;
     diminuto_tree_t * me = diminuto_tree_init(&target.node.tree);
     dirac_t * that = (dirac_t *)0;
     int rc = 0;
-    DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+    enter();
+    {
         diminuto_tree_t * you = diminuto_tree_search(cache, me, compare, &rc);
         if (you == (diminuto_tree_t *)0) {
-            that = (dirac_t *)malloc(size(rows, columns));
+            that = (dirac_t *)malloc(target.node.size);
         } else if (rc != 0) {
-            that = (dirac_t *)malloc(size(rows, columns));
+            that = (dirac_t *)malloc(target.node.size);
         } else if (you->data == (void *)0) {
             that = (dirac_t *)diminuto_tree_remove(you);
         } else {
             that = (dirac_t *)(you->data);
             you->data = ((diminuto_tree_t *)(you->data))->data;
         }
-    DIMINUTO_CRITICAL_SECTION_END;
-    return dirac_core_init(that, rows, columns);
+    }
+    leave();
+    return that;
+}
+
+dirac_t * dirac_core_allocate_kind(dirac_kind_t kind, size_t rows, size_t columns, size_t count)
+{
+    return dirac_core_init_kind(acquire(size_kind(kind, rows, columns, count)), kind, rows, columns, count);
+}
+
+dirac_t * dirac_core_allocate(size_t rows, size_t columns)
+{
+    return dirac_core_allocate_kind(DIRAC_KIND_DENSE, rows, columns, 0);
+}
+
+dirac_t * dirac_core_view(dirac_complex_t * origin, size_t rows, size_t columns, size_t rowstride, size_t colstride, int conjugate)
+{
+    dirac_t * that = acquire(size_view());
+    dirac_view_t * viewp;
+    if (that != (dirac_t *)0) {
+        viewp = (dirac_view_t *)(&(that->data.body[0][0]));
+        viewp->origin = origin;
+        that->data.head.rows = rows;
+        that->data.head.columns = columns;
+        that->data.head.flags = DIRAC_FLAG_VIEW | (conjugate ? DIRAC_FLAG_CONJUGATE : 0);
+        that->data.head.references = 1;
+        if (!conjugate && ((columns == 1) || (colstride == 1)) && ((rows == 1) || (rowstride == columns))) {
+            /* In row major order with no gaps: the same as dense. */
+            that->data.head.count = 0;
+            that->data.head.kind = DIRAC_KIND_DENSE;
+            viewp->rowstride = columns;
+            viewp->colstride = 1;
+        } else {
+            that->data.head.count = rows * columns;
+            that->data.head.kind = DIRAC_KIND_STRIDED;
+            viewp->rowstride = rowstride;
+            viewp->colstride = colstride;
+        }
+    }
+    return that;
 }
 
 dirac_t * dirac_core_free(dirac_t * that)
 {
     if (that != (dirac_t *)0) {
-        size_t bytes = size(dirac_core_rows_get(that), dirac_core_cols_get(that));
+        size_t bytes = footprint(that);
         (void)dirac_core_fini(that);
         diminuto_tree_t * me = diminuto_tree_init(&(that->node.tree));
         that->node.size = bytes;
-        DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+        enter();
+        {
             diminuto_tree_t * you = diminuto_tree_search_insert_or_replace(&cache, me, compare, !0);
             if (you == (diminuto_tree_t *)0) {
                 /* Do  nothing. */
@@ -122,7 +254,8 @@ dirac_t * dirac_core_free(dirac_t * that)
                 me->data = (void *)you;
                 that = (dirac_t *)0;
             }
-        DIMINUTO_CRITICAL_SECTION_END;
+        }
+        leave();
     }
     return that;
 }
@@ -136,7 +269,16 @@ dirac_matrix_t * dirac_new_base(size_t rows, size_t columns) {
 }
 
 void dirac_delete(dirac_matrix_t * them) {
-    dirac_core_free(dirac_core_object_mut(them));
+    dirac_t * that = dirac_core_object_mut(them);
+    if (that == (dirac_t *)0) {
+        /* Do nothing. */
+    } else if (dirac_core_is_mapped(that)) {
+        dirac_core_unmap(that);
+    } else if (__atomic_sub_fetch(&(that->data.head.references), 1, __ATOMIC_ACQ_REL) > 0) {
+        /* Do nothing. */
+    } else {
+        dirac_core_free(that);
+    }
 }
 
 void dirac_free(void)
@@ -145,6 +287,8 @@ void dirac_free(void)
     diminuto_tree_t * nextp = (diminuto_tree_t *)0;
     diminuto_tree_t * peerp = (diminuto_tree_t *)0;
     diminuto_tree_t * linkp = (diminuto_tree_t *)0;
+    /* Memoized results go back to the cache before the cache is emptied. */
+    dirac_memo_flush();
     DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
         nodep = diminuto_tree_first(&cache);
         while (nodep != DIMINUTO_TREE_NULL) {
@@ -174,21 +318,43 @@ size_t dirac_cols_get(const dirac_matrix_t * them) {
     return dirac_core_object_get(them)->data.head.columns;
 }
 
+dirac_kind_t dirac_kind_get(const dirac_matrix_t * them) {
+    return dirac_core_object_get(them)->data.head.kind;
+}
+
+size_t dirac_references_get(const dirac_matrix_t * them) {
+    return __atomic_load_n(&(dirac_core_object_get(them)->data.head.references), __ATOMIC_ACQUIRE);
+}
+
 /*******************************************************************************
  * ALLOCATORS
  ******************************************************************************/
 
 dirac_t * dirac_core_dup(const dirac_t * thata) {
-    return dirac_core_allocate(dirac_core_rows_get(thata), dirac_core_cols_get(thata));
+    dirac_t * that;
+    if (dirac_core_is_strided(thata)) {
+        that = dirac_core_allocate(dirac_core_rows_get(thata), dirac_core_cols_get(thata));
+    } else {
+        that = dirac_core_allocate_kind(dirac_core_kind_get(thata), dirac_core_rows_get(thata), dirac_core_cols_get(thata), thata->data.head.count);
+    }
+    return that;
 }
 
 dirac_t * dirac_core_trn(const dirac_t * thata) {
-    return dirac_core_allocate(dirac_core_cols_get(thata), dirac_core_rows_get(thata));
+    dirac_t * that = (dirac_t *)0;
+    if (!dirac_core_is_array(thata)) {
+        errno = EINVAL;
+    } else {
+        that = dirac_core_allocate(dirac_core_cols_get(thata), dirac_core_rows_get(thata));
+    }
+    return that;
 }
 
 dirac_t * dirac_core_sum(const dirac_t * thata, const dirac_t * thatb) {
     dirac_t * that = (dirac_t *)0;
-    if (dirac_core_rows_get(thata) != dirac_core_rows_get(thatb)) {
+    if (!dirac_core_is_array(thata) || !dirac_core_is_array(thatb)) {
+        errno = EINVAL;
+    } else if (dirac_core_rows_get(thata) != dirac_core_rows_get(thatb)) {
         errno = EINVAL;
     } else if (dirac_core_cols_get(thata) != dirac_core_cols_get(thatb)) {
         errno = EINVAL;
@@ -203,7 +369,7 @@ dirac_t * dirac_core_pro(const dirac_t * thata, const dirac_t * thatb) {
     if (dirac_core_cols_get(thata) != dirac_core_rows_get(thatb)) {
         errno = EINVAL;
     } else {
-        that = dirac_core_allocate(dirac_core_cols_get(thata), dirac_core_rows_get(thatb));
+        that = dirac_core_allocate(dirac_core_rows_get(thata), dirac_core_cols_get(thatb));
     }
     return that;
 }
@@ -216,7 +382,9 @@ dirac_t * dirac_core_kro(const dirac_t * thata, const dirac_t * thatb) {
 /* Hadamard product */
 dirac_t * dirac_core_had(const dirac_t * thata, const dirac_t * thatb) {
     dirac_t * that = (dirac_t *)0;
-    if (dirac_core_rows_get(thata) != dirac_core_rows_get(thatb)) {
+    if (!dirac_core_is_array(thata) || !dirac_core_is_array(thatb)) {
+        errno = EINVAL;
+    } else if (dirac_core_rows_get(thata) != dirac_core_rows_get(thatb)) {
         errno = EINVAL;
     } else if (dirac_core_cols_get(thata) != dirac_core_cols_get(thatb)) {
         errno = EINVAL;
@@ -242,6 +410,104 @@ dirac_complex_t * dirac_core_point_safe(dirac_t * that, unsigned int row, unsign
     return here;
 }
 
+/*******************************************************************************
+ * CONVERSION
+ ******************************************************************************/
+
+void dirac_core_expand(dirac_complex_t * tt, const dirac_t * thata, dirac_complex_t factor)
+{
+    const dirac_complex_t * aa = dirac_core_body_get(thata);
+    size_t rows = dirac_core_rows_get(thata);
+    size_t cols = dirac_core_cols_get(thata);
+    const size_t * columns;
+    const size_t * offsets;
+    size_t rowstride;
+    size_t colstride;
+    size_t rr;
+    size_t cc;
+    size_t ii;
+
+    switch (dirac_core_kind_get(thata)) {
+
+    case DIRAC_KIND_DENSE:
+        for (ii = 0; ii < (rows * cols); ++ii) {
+            tt[ii] = factor * aa[ii];
+        }
+        break;
+
+    case DIRAC_KIND_SPARSE:
+        memset(tt, 0, rows * cols * sizeof(dirac_complex_t));
+        columns = dirac_core_sparse_columns_get(thata);
+        offsets = dirac_core_sparse_offsets_get(thata);
+        for (rr = 0; rr < rows; ++rr) {
+            for (ii = offsets[rr]; ii < offsets[rr + 1]; ++ii) {
+                tt[(rr * cols) + columns[ii]] += factor * aa[ii];
+            }
+        }
+        break;
+
+    case DIRAC_KIND_DIAGONAL:
+        memset(tt, 0, rows * cols * sizeof(dirac_complex_t));
+        for (rr = 0; rr < rows; ++rr) {
+            tt[(rr * cols) + rr] = factor * aa[rr];
+        }
+        break;
+
+    case DIRAC_KIND_PERMUTATION:
+        memset(tt, 0, rows * cols * sizeof(dirac_complex_t));
+        columns = dirac_core_permutation_columns_get(thata);
+        for (rr = 0; rr < rows; ++rr) {
+            tt[(rr * cols) + columns[rr]] = factor * aa[rr];
+        }
+        break;
+
+    case DIRAC_KIND_HERMITIAN:
+    case DIRAC_KIND_TRIANGULAR:
+        for (rr = 0, ii = 0; rr < rows; ++rr) {
+            for (cc = 0; cc < rr; ++cc) {
+                tt[(rr * cols) + cc] = (dirac_core_kind_get(thata) == DIRAC_KIND_HERMITIAN) ? (factor * conj(aa[DIRAC_PACKED_INDEX(rows, cc, rr)])) : 0;
+            }
+            for (cc = rr; cc < cols; ++cc, ++ii) {
+                tt[(rr * cols) + cc] = factor * aa[ii];
+            }
+        }
+        break;
+
+    case DIRAC_KIND_STRIDED:
+        rowstride = dirac_core_rowstride_get(thata);
+        colstride = dirac_core_colstride_get(thata);
+        if (dirac_core_is_conjugate(thata)) {
+            for (rr = 0; rr < rows; ++rr) {
+                for (cc = 0; cc < cols; ++cc) {
+                    tt[(rr * cols) + cc] = factor * conj(aa[(rr * rowstride) + (cc * colstride)]);
+                }
+            }
+        } else {
+            for (rr = 0; rr < rows; ++rr) {
+                for (cc = 0; cc < cols; ++cc) {
+                    tt[(rr * cols) + cc] = factor * aa[(rr * rowstride) + (cc * colstride)];
+                }
+            }
+        }
+        break;
+
+    }
+}
+
+const dirac_t * dirac_core_dense_get(const dirac_t * thata, dirac_t ** tempp)
+{
+    *tempp = (dirac_t *)0;
+    if ((thata == (const dirac_t *)0) || !dirac_core_is_strided(thata)) {
+        /* Do nothing. */
+    } else if ((*tempp = dirac_core_allocate(dirac_core_rows_get(thata), dirac_core_cols_get(thata))) == (dirac_t *)0) {
+        thata = (const dirac_t *)0;
+    } else {
+        dirac_core_expand(dirac_core_body_mut(*tempp), thata, 1.0);
+        thata = *tempp;
+    }
+    return thata;
+}
+
 /*******************************************************************************
  * PRIVATE DEBUGGING
  ******************************************************************************/
@@ -251,22 +517,7 @@ const dirac_t * dirac_core_print(FILE * fp, const dirac_t * that)
     if (that == (dirac_t *)0) {
         fprintf(fp, "dirac@%p\n", that);
     } else {
-        const dirac_matrix_t * them = dirac_core_matrix_get(that);
-        size_t rows = dirac_core_rows_get(that);
-        size_t cols = dirac_core_cols_get(that);
-        fprintf(fp, "dirac@%p: [%zu][%zu]\n", that, rows, cols);
-        const dirac_complex_t * tt = dirac_core_body_get(that);
-        int rr;
-        int cc;
-        int ii;
-        for (rr = 0; rr < rows; ++rr) {
-            fprintf(fp, " matrix@%p:", them);
-            for (cc = 0; cc < cols; ++cc) {
-                ii = dirac_core_index(that, rr, cc);
-                fprintf(fp, " (%7.4le%+7.4lei)", creal((tt)[ii]), cimag((tt)[ii]));
-            }
-            fputc('\n', fp);
-        }
+        (void)dirac_core_format(fp, that, DIRAC_FORMAT_TEXT, DIRAC_PRECISION);
     }
     fflush(fp);
     return that;
@@ -281,6 +532,24 @@ dirac_t * dirac_audit(void)
     return (dirac_t *)diminuto_tree_audit(&cache);
 }
 
+size_t dirac_contention_get(uint64_t * nanosecondsp)
+{
+    size_t result;
+    DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+        result = waits;
+        if (nanosecondsp != (uint64_t *)0) { *nanosecondsp = waited; }
+    DIMINUTO_CRITICAL_SECTION_END;
+    return result;
+}
+
+void dirac_contention_reset(void)
+{
+    DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+        waits = 0;
+        waited = 0;
+    DIMINUTO_CRITICAL_SECTION_END;
+}
+
 ssize_t dirac_dump(FILE * fp)
 {
     ssize_t total = 0;
@@ -0,0 +1,1243 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the Hermitian eigensolver portions of
+ * Dirac. A Hermitian matrix is reduced to a real symmetric tridiagonal one
+ * by Householder reflections, whose eigenproblem is solved by implicit QL
+ * (values only), bisection and inverse iteration (selected pairs) or
+ * divide and conquer (all pairs), and the eigenvectors are transformed
+ * back by the same reflections.
+ *
+ * REFERENCES
+ *
+ * G. Golub, C. Van Loan, MATRIX COMPUTATIONS, 4th ed., Johns Hopkins
+ * University Press, 2013, 8.3-8.5
+ *
+ * M. Gu, S. Eisenstat, "A Divide-and-Conquer Algorithm for the Symmetric
+ * Tridiagonal Eigenproblem", SIAM Journal on Matrix Analysis and
+ * Applications, 16.1, 1995
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <errno.h>
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/*
+ * Tridiagonal problems no larger than this are solved directly by QL.
+ */
+static const size_t LEAF = 24;
+
+/*
+ * Columns of eigenvectors the back transformation carries through every
+ * reflection at once, so that they stay in cache.
+ */
+static const size_t BLOCK = 32;
+
+static const int SWEEPS = 60;
+
+static const int ITERATIONS = 200;
+
+static const int REFINEMENTS = 4;
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+typedef struct DiracReduce {
+    dirac_complex_t * aa;
+    const dirac_complex_t * vv;
+    dirac_complex_t * pp;
+    const dirac_complex_t * ww;
+    dirac_complex_t tau;
+    size_t order;
+    size_t first;
+} dirac_reduce_t;
+
+typedef struct DiracBack {
+    const dirac_complex_t * aa;
+    const dirac_complex_t * taus;
+    dirac_complex_t * xx;
+    dirac_complex_t * dots;
+    size_t order;
+    size_t cols;
+} dirac_back_t;
+
+typedef struct DiracMerge {
+    const double * dk;
+    const double * zk;
+    const double * zhat;
+    double * taus;
+    size_t * origins;
+    double * uu;
+    const double * qk;
+    double * qnew;
+    double rho;
+    size_t kept;
+    size_t order;
+} dirac_merge_t;
+
+typedef struct DiracPair {
+    double value;
+    size_t index;
+} dirac_pair_t;
+
+typedef struct DiracConquer {
+    double * qk;
+    double * uu;
+    double * qnew;
+    double * zz;
+    double * ds;
+    double * zs;
+    double * dk;
+    double * zk;
+    double * zhat;
+    double * taus;
+    dirac_pair_t * pairs;
+    size_t * origins;
+    size_t * columns;
+    size_t * kept;
+    size_t * sources;
+} dirac_conquer_t;
+
+typedef struct DiracSelect {
+    const double * dd;
+    const double * ee;
+    const double * e2;
+    double * values;
+    double * zz;
+    const size_t * clusters;
+    double lower;
+    double upper;
+    double pivmin;
+    double norm;
+    size_t order;
+    size_t first;
+    size_t count;
+    int failures;
+} dirac_select_t;
+
+/*******************************************************************************
+ * TRIDIAGONALIZATION
+ ******************************************************************************/
+
+/*
+ * p = tau * A22 * v, where A22 is the trailing block from row and column
+ * FIRST.
+ */
+static void reduce_product(void * context, size_t begin, size_t end)
+{
+    const dirac_reduce_t * reducep = (const dirac_reduce_t *)context;
+    size_t order = reducep->order;
+    size_t first = reducep->first;
+    const dirac_complex_t * restrict vv = reducep->vv;
+    const dirac_complex_t * restrict arow;
+    dirac_complex_t sum;
+    size_t ii;
+    size_t jj;
+    for (ii = first + begin; ii < (first + end); ++ii) {
+        arow = &(reducep->aa[ii * order]);
+        sum = 0;
+        for (jj = first; jj < order; ++jj) {
+            sum += arow[jj] * vv[jj];
+        }
+        reducep->pp[ii] = reducep->tau * sum;
+    }
+}
+
+/*
+ * A22 -= v * w' + w * v'
+ */
+static void reduce_update(void * context, size_t begin, size_t end)
+{
+    const dirac_reduce_t * reducep = (const dirac_reduce_t *)context;
+    size_t order = reducep->order;
+    size_t first = reducep->first;
+    const dirac_complex_t * restrict vv = reducep->vv;
+    const dirac_complex_t * restrict ww = reducep->ww;
+    dirac_complex_t * restrict arow;
+    dirac_complex_t vi;
+    dirac_complex_t wi;
+    size_t ii;
+    size_t jj;
+    for (ii = first + begin; ii < (first + end); ++ii) {
+        arow = &(reducep->aa[ii * order]);
+        vi = vv[ii];
+        wi = ww[ii];
+        for (jj = first; jj < order; ++jj) {
+            arow[jj] -= (vi * conj(ww[jj])) + (wi * conj(vv[jj]));
+        }
+    }
+}
+
+/*
+ * Reduces the Hermitian A (AA) to the real tridiagonal T = Q' * A * Q with
+ * diagonal DD and subdiagonal EE, Q = H(0) * ... * H(N-2). Each reflection
+ * H(k) = I - tau * v * v' is left in row k of A (columns k+1 on, where
+ * nothing else is read any more) with its tau in TAUS. VV and PP are N
+ * elements of scratch.
+ */
+static void tridiagonalize(dirac_complex_t * aa, size_t order, double * dd, double * ee, dirac_complex_t * taus, dirac_complex_t * vv, dirac_complex_t * pp)
+{
+    dirac_reduce_t reduce = { aa, vv, pp, pp, 0, order, 0, };
+    dirac_complex_t alpha;
+    dirac_complex_t scale;
+    dirac_complex_t dot;
+    dirac_complex_t half;
+    double xnorm;
+    double beta;
+    size_t first;
+    size_t kk;
+    size_t ii;
+
+    for (kk = 0; (kk + 1) < order; ++kk) {
+
+        first = kk + 1;
+        alpha = aa[(first * order) + kk];
+        xnorm = 0.0;
+        for (ii = first + 1; ii < order; ++ii) {
+            xnorm = hypot(xnorm, cabs(aa[(ii * order) + kk]));
+        }
+
+        vv[first] = 1.0;
+        if ((xnorm == 0.0) && (cimag(alpha) == 0.0)) {
+            reduce.tau = 0;
+            beta = creal(alpha);
+            for (ii = first + 1; ii < order; ++ii) {
+                vv[ii] = 0;
+            }
+        } else {
+            beta = -copysign(hypot(cabs(alpha), xnorm), creal(alpha));
+            reduce.tau = CMPLX((beta - creal(alpha)) / beta, -cimag(alpha) / beta);
+            scale = 1.0 / (alpha - beta);
+            for (ii = first + 1; ii < order; ++ii) {
+                vv[ii] = scale * aa[(ii * order) + kk];
+            }
+        }
+
+        ee[kk] = beta;
+        taus[kk] = reduce.tau;
+
+        if (reduce.tau != 0) {
+            reduce.first = first;
+            dirac_core_parallel(order - first, dirac_core_grain(order - first), reduce_product, &reduce);
+            dot = 0;
+            for (ii = first; ii < order; ++ii) {
+                dot += conj(vv[ii]) * pp[ii];
+            }
+            half = 0.5 * conj(reduce.tau) * dot;
+            for (ii = first; ii < order; ++ii) {
+                pp[ii] -= half * vv[ii];
+            }
+            dirac_core_parallel(order - first, dirac_core_grain(2 * (order - first)), reduce_update, &reduce);
+        }
+
+        dd[kk] = creal(aa[(kk * order) + kk]);
+        for (ii = first; ii < order; ++ii) {
+            aa[(kk * order) + ii] = vv[ii];
+        }
+
+    }
+
+    if (order > 0) {
+        dd[order - 1] = creal(aa[((order - 1) * order) + (order - 1)]);
+        ee[order - 1] = 0.0;
+    }
+}
+
+/*
+ * X = Q * X for the N x COLS matrix X. Each range of columns is carried
+ * through every reflection a block at a time.
+ */
+static void back_transform(void * context, size_t begin, size_t end)
+{
+    const dirac_back_t * backp = (const dirac_back_t *)context;
+    size_t order = backp->order;
+    size_t cols = backp->cols;
+    dirac_complex_t * restrict dots = backp->dots;
+    const dirac_complex_t * restrict vv;
+    dirac_complex_t * restrict xrow;
+    dirac_complex_t tau;
+    dirac_complex_t factor;
+    size_t low;
+    size_t high;
+    size_t kk;
+    size_t rr;
+    size_t cc;
+
+    for (low = begin; low < end; low += BLOCK) {
+        high = ((low + BLOCK) < end) ? (low + BLOCK) : end;
+        for (kk = order - 1; kk > 0; --kk) {
+            tau = backp->taus[kk - 1];
+            if (tau == 0) {
+                continue;
+            }
+            vv = &(backp->aa[(kk - 1) * order]);
+            for (cc = low; cc < high; ++cc) {
+                dots[cc] = 0;
+            }
+            for (rr = kk; rr < order; ++rr) {
+                factor = conj(vv[rr]);
+                xrow = &(backp->xx[rr * cols]);
+                for (cc = low; cc < high; ++cc) {
+                    dots[cc] += factor * xrow[cc];
+                }
+            }
+            for (rr = kk; rr < order; ++rr) {
+                factor = tau * vv[rr];
+                xrow = &(backp->xx[rr * cols]);
+                for (cc = low; cc < high; ++cc) {
+                    xrow[cc] -= factor * dots[cc];
+                }
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * QL
+ ******************************************************************************/
+
+/*
+ * Diagonalizes the symmetric tridiagonal matrix with diagonal DD and
+ * subdiagonal EE (of N elements, the last ignored and destroyed) by
+ * implicit QL, accumulating the rotations in the N columns of ZZ (rows of
+ * stride LDZ) if it is not null. The eigenvalues are left in DD unsorted.
+ * Returns -1 if an eigenvalue fails to converge.
+ */
+static int implicit(double * dd, double * ee, double * zz, size_t ldz, size_t order)
+{
+    int rc = 0;
+    double bb;
+    double cc;
+    double ff;
+    double gg;
+    double pp;
+    double rr;
+    double ss;
+    double sum;
+    double swap;
+    int sweeps;
+    long ll;
+    long mm;
+    long ii;
+    size_t kk;
+
+    if (order > 0) {
+        ee[order - 1] = 0.0;
+    }
+
+    for (ll = 0; (rc == 0) && (ll < (long)order); ++ll) {
+        sweeps = 0;
+        do {
+            for (mm = ll; mm < ((long)order - 1); ++mm) {
+                sum = fabs(dd[mm]) + fabs(dd[mm + 1]);
+                if (fabs(ee[mm]) <= (DBL_EPSILON * sum)) {
+                    break;
+                }
+            }
+            if (mm == ll) {
+                break;
+            }
+            if (sweeps++ == SWEEPS) {
+                rc = -1;
+                break;
+            }
+            gg = (dd[ll + 1] - dd[ll]) / (2.0 * ee[ll]);
+            rr = hypot(gg, 1.0);
+            gg = dd[mm] - dd[ll] + (ee[ll] / (gg + copysign(rr, gg)));
+            ss = 1.0;
+            cc = 1.0;
+            pp = 0.0;
+            for (ii = mm - 1; ii >= ll; --ii) {
+                ff = ss * ee[ii];
+                bb = cc * ee[ii];
+                rr = hypot(ff, gg);
+                ee[ii + 1] = rr;
+                if (rr == 0.0) {
+                    dd[ii + 1] -= pp;
+                    ee[mm] = 0.0;
+                    break;
+                }
+                ss = ff / rr;
+                cc = gg / rr;
+                gg = dd[ii + 1] - pp;
+                rr = ((dd[ii] - gg) * ss) + (2.0 * cc * bb);
+                pp = ss * rr;
+                dd[ii + 1] = gg + pp;
+                gg = (cc * rr) - bb;
+                if (zz != (double *)0) {
+                    for (kk = 0; kk < order; ++kk) {
+                        swap = zz[(kk * ldz) + ii + 1];
+                        zz[(kk * ldz) + ii + 1] = (ss * zz[(kk * ldz) + ii]) + (cc * swap);
+                        zz[(kk * ldz) + ii] = (cc * zz[(kk * ldz) + ii]) - (ss * swap);
+                    }
+                }
+            }
+            if ((rr == 0.0) && (ii >= ll)) {
+                continue;
+            }
+            dd[ll] -= pp;
+            ee[ll] = gg;
+            ee[mm] = 0.0;
+        } while (!0);
+    }
+
+    return rc;
+}
+
+static int ascending(const void * a, const void * b)
+{
+    double aa = *(const double *)a;
+    double bb = *(const double *)b;
+    return (aa < bb) ? -1 : (aa > bb) ? 1 : 0;
+}
+
+/*******************************************************************************
+ * DIVIDE AND CONQUER
+ ******************************************************************************/
+
+/*
+ * Finds the root of 1 + rho * sum(z[i]^2 / (d[i] - lambda)) above d[j],
+ * returning it as an offset from d[ORIGIN] (whichever end of its interval
+ * is nearer) so that differences from the poles keep their precision.
+ */
+static double secular(const double * dk, const double * zk, size_t kept, double rho, size_t jj, size_t * originp)
+{
+    size_t origin = jj;
+    double low = 0.0;
+    double high = rho;
+    double tau;
+    double next;
+    double ff;
+    double fp;
+    double delta;
+    double tt;
+    double gap;
+    size_t ii;
+    int iterations;
+
+    if ((jj + 1) < kept) {
+        gap = (dk[jj + 1] - dk[jj]) / 2.0;
+        ff = 1.0;
+        for (ii = 0; ii < kept; ++ii) {
+            ff += (rho * zk[ii] * zk[ii]) / ((dk[ii] - dk[jj]) - gap);
+        }
+        if (ff >= 0.0) {
+            high = gap;
+        } else {
+            origin = jj + 1;
+            low = -gap;
+            high = 0.0;
+        }
+    }
+
+    tau = (low + high) / 2.0;
+    for (iterations = 0; iterations < ITERATIONS; ++iterations) {
+        ff = 1.0;
+        fp = 0.0;
+        for (ii = 0; ii < kept; ++ii) {
+            delta = (dk[ii] - dk[origin]) - tau;
+            tt = zk[ii] / delta;
+            ff += rho * zk[ii] * tt;
+            fp += rho * tt * tt;
+        }
+        if (ff == 0.0) {
+            break;
+        } else if (ff > 0.0) {
+            high = tau;
+        } else {
+            low = tau;
+        }
+        /* Newton, unless it leaves the bracket. */
+        next = tau - (ff / fp);
+        if (!((next > low) && (next < high))) {
+            next = (low + high) / 2.0;
+        }
+        if (fabs(next - tau) <= (2.0 * DBL_EPSILON * fabs(next))) {
+            tau = next;
+            break;
+        }
+        if ((high - low) <= (2.0 * DBL_EPSILON * fmax(fabs(low), fabs(high)))) {
+            break;
+        }
+        tau = next;
+    }
+
+    *originp = origin;
+    return tau;
+}
+
+static void merge_roots(void * context, size_t begin, size_t end)
+{
+    dirac_merge_t * mergep = (dirac_merge_t *)context;
+    size_t jj;
+    for (jj = begin; jj < end; ++jj) {
+        mergep->taus[jj] = secular(mergep->dk, mergep->zk, mergep->kept, mergep->rho, jj, &(mergep->origins[jj]));
+    }
+}
+
+/*
+ * Recomputes z from the roots (Lowner), so that the eigenvectors are
+ * orthogonal however close the roots are to the poles.
+ */
+static void merge_weights(void * context, size_t begin, size_t end)
+{
+    dirac_merge_t * mergep = (dirac_merge_t *)context;
+    const double * dk = mergep->dk;
+    const double * taus = mergep->taus;
+    const size_t * origins = mergep->origins;
+    size_t kept = mergep->kept;
+    double * zhat = (double *)mergep->zhat;
+    double product;
+    size_t ii;
+    size_t jj;
+    for (ii = begin; ii < end; ++ii) {
+        product = ((dk[origins[kept - 1]] - dk[ii]) + taus[kept - 1]) / mergep->rho;
+        for (jj = 0; jj < ii; ++jj) {
+            product *= ((dk[origins[jj]] - dk[ii]) + taus[jj]) / (dk[jj] - dk[ii]);
+        }
+        for (jj = ii; (jj + 1) < kept; ++jj) {
+            product *= ((dk[origins[jj]] - dk[ii]) + taus[jj]) / (dk[jj + 1] - dk[ii]);
+        }
+        zhat[ii] = copysign(sqrt(fabs(product)), mergep->zk[ii]);
+    }
+}
+
+static void merge_vectors(void * context, size_t begin, size_t end)
+{
+    dirac_merge_t * mergep = (dirac_merge_t *)context;
+    const double * dk = mergep->dk;
+    size_t kept = mergep->kept;
+    double * uu = mergep->uu;
+    double norm;
+    double delta;
+    size_t ii;
+    size_t jj;
+    for (jj = begin; jj < end; ++jj) {
+        norm = 0.0;
+        for (ii = 0; ii < kept; ++ii) {
+            delta = (dk[ii] - dk[mergep->origins[jj]]) - mergep->taus[jj];
+            uu[(ii * kept) + jj] = mergep->zhat[ii] / delta;
+            norm = hypot(norm, uu[(ii * kept) + jj]);
+        }
+        for (ii = 0; ii < kept; ++ii) {
+            uu[(ii * kept) + jj] /= norm;
+        }
+    }
+}
+
+/*
+ * QNEW = QK * U, N x K times K x K.
+ */
+static void merge_product(void * context, size_t begin, size_t end)
+{
+    dirac_merge_t * mergep = (dirac_merge_t *)context;
+    size_t kept = mergep->kept;
+    const double * restrict urow;
+    const double * restrict qrow;
+    double * restrict trow;
+    double factor;
+    size_t rr;
+    size_t ii;
+    size_t jj;
+    for (rr = begin; rr < end; ++rr) {
+        qrow = &(mergep->qk[rr * kept]);
+        trow = &(mergep->qnew[rr * kept]);
+        for (jj = 0; jj < kept; ++jj) {
+            trow[jj] = 0.0;
+        }
+        for (ii = 0; ii < kept; ++ii) {
+            factor = qrow[ii];
+            urow = &(mergep->uu[ii * kept]);
+            for (jj = 0; jj < kept; ++jj) {
+                trow[jj] += factor * urow[jj];
+            }
+        }
+    }
+}
+
+static int by_value(const void * a, const void * b)
+{
+    return ascending(&(((const dirac_pair_t *)a)->value), &(((const dirac_pair_t *)b)->value));
+}
+
+/*
+ * Given the eigenpairs of the two halves (first M and last N-M) in DD and
+ * the diagonal blocks of QQ, and the coupling RHO that was removed between
+ * them, computes the eigenpairs of the whole in ascending order.
+ */
+static void merge(double * dd, double * qq, size_t ldq, size_t order, size_t mm, double rho, dirac_conquer_t * ws)
+{
+    dirac_merge_t context;
+    double * zz = ws->zz;
+    double * ds = ws->ds;
+    double * zs = ws->zs;
+    dirac_pair_t * pairs = ws->pairs;
+    size_t * columns = ws->columns;
+    size_t * sources = ws->sources;
+    size_t * keep = ws->kept;
+    double sign = (rho < 0.0) ? -1.0 : 1.0;
+    double norm = 0.0;
+    double largest = 0.0;
+    double tolerance;
+    double cc;
+    double ss;
+    double rr;
+    double tt;
+    double xx;
+    double yy;
+    size_t kept = 0;
+    size_t deflated = 0;
+    size_t previous = order;
+    size_t ii;
+    size_t jj;
+    size_t kk;
+
+    rho = fabs(rho);
+
+    /* z is the last row of the first block and the first row of the second. */
+    for (ii = 0; ii < order; ++ii) {
+        zz[ii] = (ii < mm) ? qq[((mm - 1) * ldq) + ii] : (sign * qq[(mm * ldq) + ii]);
+        norm = hypot(norm, zz[ii]);
+    }
+    rho *= norm * norm;
+    for (ii = 0; ii < order; ++ii) {
+        zz[ii] /= norm;
+    }
+
+    /* Merge the two sorted halves. */
+    for (ii = 0, jj = mm, kk = 0; kk < order; ++kk) {
+        if ((jj >= order) || ((ii < mm) && (dd[ii] <= dd[jj]))) {
+            columns[kk] = ii++;
+        } else {
+            columns[kk] = jj++;
+        }
+        ds[kk] = dd[columns[kk]];
+        zs[kk] = zz[columns[kk]];
+        if (fabs(ds[kk]) > largest) {
+            largest = fabs(ds[kk]);
+        }
+    }
+
+    /*
+     * Deflate where z is negligible, or where two poles are so close that a
+     * rotation can zero one of their z with negligible error.
+     */
+    tolerance = 8.0 * DBL_EPSILON * fmax(largest, rho);
+    for (kk = 0; kk < order; ++kk) {
+        if ((rho * fabs(zs[kk])) <= tolerance) {
+            sources[deflated++] = kk;
+            continue;
+        }
+        if (previous == order) {
+            previous = kk;
+            continue;
+        }
+        ss = zs[previous];
+        cc = zs[kk];
+        rr = hypot(cc, ss);
+        tt = ds[kk] - ds[previous];
+        cc /= rr;
+        ss = -ss / rr;
+        if (fabs(tt * cc * ss) <= tolerance) {
+            zs[kk] = rr;
+            zs[previous] = 0.0;
+            for (ii = 0; ii < order; ++ii) {
+                xx = qq[(ii * ldq) + columns[previous]];
+                yy = qq[(ii * ldq) + columns[kk]];
+                qq[(ii * ldq) + columns[previous]] = (cc * xx) + (ss * yy);
+                qq[(ii * ldq) + columns[kk]] = (cc * yy) - (ss * xx);
+            }
+            tt = (ds[previous] * cc * cc) + (ds[kk] * ss * ss);
+            ds[kk] = (ds[previous] * ss * ss) + (ds[kk] * cc * cc);
+            ds[previous] = tt;
+            sources[deflated++] = previous;
+        } else {
+            keep[kept++] = previous;
+        }
+        previous = kk;
+    }
+    if (previous < order) {
+        keep[kept++] = previous;
+    }
+
+    context.dk = ws->dk;
+    context.zk = ws->zk;
+    context.zhat = ws->zhat;
+    context.taus = ws->taus;
+    context.origins = ws->origins;
+    context.uu = ws->uu;
+    context.qk = ws->qk;
+    context.qnew = ws->qnew;
+    context.rho = rho;
+    context.kept = kept;
+    context.order = order;
+
+    if (kept > 0) {
+
+        for (ii = 0; ii < kept; ++ii) {
+            ws->dk[ii] = ds[keep[ii]];
+            ws->zk[ii] = zs[keep[ii]];
+        }
+
+        dirac_core_parallel(kept, dirac_core_grain(16 * kept), merge_roots, &context);
+        dirac_core_parallel(kept, dirac_core_grain(kept), merge_weights, &context);
+        dirac_core_parallel(kept, dirac_core_grain(kept), merge_vectors, &context);
+
+        for (ii = 0; ii < order; ++ii) {
+            for (jj = 0; jj < kept; ++jj) {
+                ws->qk[(ii * kept) + jj] = qq[(ii * ldq) + columns[keep[jj]]];
+            }
+        }
+        dirac_core_parallel(order, dirac_core_grain(kept * kept), merge_product, &context);
+
+    }
+
+    /* Values: the roots first, then the deflated poles, then sort them. */
+    for (kk = 0; kk < order; ++kk) {
+        pairs[kk].value = (kk < kept) ? (ws->dk[ws->origins[kk]] + ws->taus[kk]) : ds[sources[kk - kept]];
+        pairs[kk].index = kk;
+    }
+    qsort(pairs, order, sizeof(pairs[0]), by_value);
+
+    /* The U workspace is free now, so stage the sorted vectors in it. */
+    for (ii = 0; ii < order; ++ii) {
+        for (kk = 0; kk < order; ++kk) {
+            jj = pairs[kk].index;
+            ws->uu[(ii * order) + kk] = (jj < kept) ? ws->qnew[(ii * kept) + jj] : qq[(ii * ldq) + columns[sources[jj - kept]]];
+        }
+    }
+    for (ii = 0; ii < order; ++ii) {
+        memcpy(&(qq[ii * ldq]), &(ws->uu[ii * order]), order * sizeof(double));
+    }
+    for (kk = 0; kk < order; ++kk) {
+        dd[kk] = pairs[kk].value;
+    }
+}
+
+/*
+ * Eigenpairs of the symmetric tridiagonal matrix DD, EE of order N into DD
+ * (ascending) and the columns of the N x N block QQ (row stride LDQ), which
+ * must be zero on entry.
+ */
+static int conquer(double * dd, double * ee, double * qq, size_t ldq, size_t order, dirac_conquer_t * ws)
+{
+    int rc = 0;
+    double rho;
+    double swap;
+    size_t mm;
+    size_t ii;
+    size_t jj;
+    size_t kk;
+    size_t best;
+
+    if (order <= LEAF) {
+        for (ii = 0; ii < order; ++ii) {
+            qq[(ii * ldq) + ii] = 1.0;
+        }
+        rc = implicit(dd, ee, qq, ldq, order);
+        for (ii = 0; (rc == 0) && (ii < order); ++ii) {
+            best = ii;
+            for (jj = ii + 1; jj < order; ++jj) {
+                if (dd[jj] < dd[best]) {
+                    best = jj;
+                }
+            }
+            if (best != ii) {
+                swap = dd[ii];
+                dd[ii] = dd[best];
+                dd[best] = swap;
+                for (kk = 0; kk < order; ++kk) {
+                    swap = qq[(kk * ldq) + ii];
+                    qq[(kk * ldq) + ii] = qq[(kk * ldq) + best];
+                    qq[(kk * ldq) + best] = swap;
+                }
+            }
+        }
+    } else {
+        mm = order / 2;
+        rho = ee[mm - 1];
+        dd[mm - 1] -= fabs(rho);
+        dd[mm] -= fabs(rho);
+        if ((rc = conquer(dd, ee, qq, ldq, mm, ws)) < 0) {
+            /* Do nothing. */
+        } else if ((rc = conquer(&(dd[mm]), &(ee[mm]), &(qq[(mm * ldq) + mm]), ldq, order - mm, ws)) < 0) {
+            /* Do nothing. */
+        } else {
+            merge(dd, qq, ldq, order, mm, rho, ws);
+        }
+    }
+
+    return rc;
+}
+
+/*******************************************************************************
+ * BISECTION AND INVERSE ITERATION
+ ******************************************************************************/
+
+/*
+ * Returns the number of eigenvalues less than X (Sturm sequence).
+ */
+static size_t sturm(const double * dd, const double * e2, size_t order, double pivmin, double xx)
+{
+    size_t count = 0;
+    double qq = dd[0] - xx;
+    size_t ii;
+    if (fabs(qq) < pivmin) {
+        qq = -pivmin;
+    }
+    if (qq < 0.0) {
+        ++count;
+    }
+    for (ii = 1; ii < order; ++ii) {
+        qq = dd[ii] - xx - (e2[ii - 1] / qq);
+        if (fabs(qq) < pivmin) {
+            qq = -pivmin;
+        }
+        if (qq < 0.0) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+static void select_values(void * context, size_t begin, size_t end)
+{
+    dirac_select_t * selectp = (dirac_select_t *)context;
+    double low;
+    double high;
+    double middle;
+    size_t jj;
+    for (jj = begin; jj < end; ++jj) {
+        low = selectp->lower;
+        high = selectp->upper;
+        while ((high - low) > ((2.0 * DBL_EPSILON * (fabs(low) + fabs(high))) + selectp->pivmin)) {
+            middle = (low + high) / 2.0;
+            if ((middle <= low) || (middle >= high)) {
+                break;
+            }
+            if (sturm(selectp->dd, selectp->e2, selectp->order, selectp->pivmin, middle) > (selectp->first + jj)) {
+                high = middle;
+            } else {
+                low = middle;
+            }
+        }
+        selectp->values[jj] = (low + high) / 2.0;
+    }
+}
+
+/*
+ * Solves (T - lambda * I) * x = b in place by Gaussian elimination with
+ * partial pivoting, in the scratch DL, DM, DU and D2 of N elements each.
+ */
+static void shifted(const double * dd, const double * ee, size_t order, double lambda, double tiny, double * dl, double * dm, double * du, double * d2, double * xx)
+{
+    double fact;
+    double temp;
+    size_t ii;
+
+    for (ii = 0; ii < order; ++ii) {
+        dm[ii] = dd[ii] - lambda;
+        if ((ii + 1) < order) {
+            dl[ii] = ee[ii];
+            du[ii] = ee[ii];
+        }
+        d2[ii] = 0.0;
+    }
+
+    for (ii = 0; (ii + 1) < order; ++ii) {
+        if (fabs(dm[ii]) >= fabs(dl[ii])) {
+            if (dm[ii] == 0.0) {
+                dm[ii] = tiny;
+            }
+            fact = dl[ii] / dm[ii];
+            dm[ii + 1] -= fact * du[ii];
+            xx[ii + 1] -= fact * xx[ii];
+        } else {
+            fact = dm[ii] / dl[ii];
+            dm[ii] = dl[ii];
+            temp = dm[ii + 1];
+            dm[ii + 1] = du[ii] - (fact * temp);
+            if ((ii + 2) < order) {
+                d2[ii] = du[ii + 1];
+                du[ii + 1] = -fact * d2[ii];
+            }
+            du[ii] = temp;
+            temp = xx[ii];
+            xx[ii] = xx[ii + 1];
+            xx[ii + 1] = temp - (fact * xx[ii + 1]);
+        }
+    }
+    if (dm[order - 1] == 0.0) {
+        dm[order - 1] = tiny;
+    }
+
+    xx[order - 1] /= dm[order - 1];
+    if (order > 1) {
+        xx[order - 2] = (xx[order - 2] - (du[order - 2] * xx[order - 1])) / dm[order - 2];
+    }
+    for (ii = order; ii > 2; --ii) {
+        xx[ii - 3] = (xx[ii - 3] - (du[ii - 3] * xx[ii - 2]) - (d2[ii - 3] * xx[ii - 1])) / dm[ii - 3];
+    }
+}
+
+/*
+ * Computes the eigenvectors of each cluster of close eigenvalues in turn,
+ * orthogonalizing each against the ones before it in the same cluster.
+ */
+static void select_vectors(void * context, size_t begin, size_t end)
+{
+    dirac_select_t * selectp = (dirac_select_t *)context;
+    size_t order = selectp->order;
+    size_t count = selectp->count;
+    double * zz = selectp->zz;
+    double * scratch;
+    double * dl;
+    double * dm;
+    double * du;
+    double * d2;
+    double * xx;
+    double separation = 10.0 * DBL_EPSILON * selectp->norm;
+    double tiny = DBL_EPSILON * selectp->norm;
+    double lambda = 0.0;
+    double norm;
+    double dot;
+    uint64_t seed;
+    size_t cluster;
+    size_t jj;
+    size_t ii;
+    size_t pp;
+    int refinement;
+
+    if (tiny == 0.0) {
+        tiny = DBL_MIN;
+    }
+
+    scratch = (double *)malloc(5 * order * sizeof(double));
+    if (scratch == (double *)0) {
+        __atomic_add_fetch(&(selectp->failures), 1, __ATOMIC_RELAXED);
+        end = begin;
+    }
+    dl = &(scratch[0 * order]);
+    dm = &(scratch[1 * order]);
+    du = &(scratch[2 * order]);
+    d2 = &(scratch[3 * order]);
+    xx = &(scratch[4 * order]);
+
+    for (cluster = begin; cluster < end; ++cluster) {
+        for (jj = selectp->clusters[cluster]; jj < selectp->clusters[cluster + 1]; ++jj) {
+
+            /* Coincident eigenvalues are pulled apart to get distinct vectors. */
+            if ((jj > selectp->clusters[cluster]) && ((selectp->values[jj] - lambda) < separation)) {
+                lambda += separation;
+            } else {
+                lambda = selectp->values[jj];
+            }
+
+            seed = 0x9e3779b97f4a7c15ULL ^ (selectp->first + jj);
+            for (ii = 0; ii < order; ++ii) {
+                seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+                xx[ii] = ((double)(seed >> 11) / (double)(1ULL << 53)) - 0.5;
+            }
+
+            for (refinement = 0; refinement < REFINEMENTS; ++refinement) {
+                shifted(selectp->dd, selectp->ee, order, lambda, tiny, dl, dm, du, d2, xx);
+                for (pp = selectp->clusters[cluster]; pp < jj; ++pp) {
+                    dot = 0.0;
+                    for (ii = 0; ii < order; ++ii) {
+                        dot += zz[(ii * count) + pp] * xx[ii];
+                    }
+                    for (ii = 0; ii < order; ++ii) {
+                        xx[ii] -= dot * zz[(ii * count) + pp];
+                    }
+                }
+                norm = 0.0;
+                for (ii = 0; ii < order; ++ii) {
+                    norm = hypot(norm, xx[ii]);
+                }
+                for (ii = 0; ii < order; ++ii) {
+                    xx[ii] /= norm;
+                }
+            }
+
+            for (ii = 0; ii < order; ++ii) {
+                zz[(ii * count) + jj] = xx[ii];
+            }
+
+        }
+    }
+
+    free(scratch);
+}
+
+/*******************************************************************************
+ * SOLVER
+ ******************************************************************************/
+
+/*
+ * Computes eigenvalues FIRST through FIRST+COUNT-1 (in ascending order) of
+ * the Hermitian THATA, and their eigenvectors if VECTORSP is not null. ALL
+ * says that every eigenpair was asked for.
+ */
+static dirac_t * eigensolve(const dirac_t * thata, size_t first, size_t count, int all, dirac_t ** vectorsp, const char * name)
+{
+    dirac_t * that = (dirac_t *)0;
+    dirac_t * work = (dirac_t *)0;
+    dirac_t * vectors = (dirac_t *)0;
+    dirac_complex_t * aa;
+    dirac_complex_t * xx;
+    double * reals = (double *)0;
+    size_t * indices = (size_t *)0;
+    double * dd;
+    double * ee;
+    double * zz = (double *)0;
+    dirac_complex_t * complexes = (dirac_complex_t *)0;
+    dirac_complex_t * taus;
+    dirac_complex_t * vv;
+    dirac_complex_t * pp;
+    dirac_conquer_t conquest;
+    dirac_select_t selection;
+    dirac_back_t back;
+    double radius;
+    double e2max;
+    size_t order = 0;
+    size_t ii;
+    size_t clusters;
+    int rc = 0;
+
+    do {
+
+        if (thata == (const dirac_t *)0) {
+            errno = EINVAL;
+            break;
+        }
+
+        order = dirac_core_rows_get(thata);
+        if ((order == 0) || (dirac_core_cols_get(thata) != order) || (count == 0) || ((first + count) > order) || (first > order)) {
+            errno = EINVAL;
+            break;
+        }
+
+        /* All of the workspace, up front. */
+        that = dirac_core_allocate(count, 1);
+        work = dirac_core_allocate(order, order);
+        reals = (double *)malloc((order * 4) * sizeof(double));
+        complexes = (dirac_complex_t *)malloc((order * 4) * sizeof(dirac_complex_t));
+        indices = (size_t *)malloc(((order * 4) + 1) * sizeof(size_t));
+        if (vectorsp != (dirac_t **)0) {
+            vectors = dirac_core_allocate(order, count);
+            zz = (double *)calloc(order * count, sizeof(double));
+        }
+        if ((that == (dirac_t *)0) || (work == (dirac_t *)0) || (vectorsp != (dirac_t **)0 && ((vectors == (dirac_t *)0) || (zz == (double *)0)))) {
+            rc = -1;
+            break;
+        }
+        if ((reals == (double *)0) || (complexes == (dirac_complex_t *)0) || (indices == (size_t *)0)) {
+            rc = -1;
+            break;
+        }
+
+        dd = &(reals[0 * order]);
+        ee = &(reals[1 * order]);
+        taus = &(complexes[0 * order]);
+        vv = &(complexes[1 * order]);
+        pp = &(complexes[2 * order]);
+
+        aa = dirac_core_body_mut(work);
+        dirac_core_expand(aa, thata, 1.0);
+        tridiagonalize(aa, order, dd, ee, taus, vv, pp);
+
+        if (all && (vectorsp != (dirac_t **)0)) {
+
+            memset(&conquest, 0, sizeof(conquest));
+            conquest.qk = (double *)malloc(3 * order * order * sizeof(double));
+            conquest.zz = (double *)malloc((7 * order * sizeof(double)) + (order * sizeof(dirac_pair_t)));
+            if ((conquest.qk == (double *)0) || (conquest.zz == (double *)0)) {
+                free(conquest.zz);
+                free(conquest.qk);
+                rc = -1;
+                break;
+            }
+            conquest.uu = &(conquest.qk[1 * order * order]);
+            conquest.qnew = &(conquest.qk[2 * order * order]);
+            conquest.ds = &(conquest.zz[1 * order]);
+            conquest.zs = &(conquest.zz[2 * order]);
+            conquest.dk = &(conquest.zz[3 * order]);
+            conquest.zk = &(conquest.zz[4 * order]);
+            conquest.zhat = &(conquest.zz[5 * order]);
+            conquest.taus = &(conquest.zz[6 * order]);
+            conquest.pairs = (dirac_pair_t *)&(conquest.zz[7 * order]);
+            conquest.origins = &(indices[0 * order]);
+            conquest.columns = &(indices[1 * order]);
+            conquest.kept = &(indices[2 * order]);
+            conquest.sources = &(indices[3 * order]);
+            rc = conquer(dd, ee, zz, order, order, &conquest);
+            free(conquest.zz);
+            free(conquest.qk);
+
+        } else if (all) {
+
+            rc = implicit(dd, ee, (double *)0, 0, order);
+            qsort(dd, order, sizeof(dd[0]), ascending);
+
+        } else {
+
+            /* Gershgorin bounds the spectrum, and scales the tolerances. */
+            memset(&selection, 0, sizeof(selection));
+            selection.e2 = &(reals[2 * order]);
+            e2max = 0.0;
+            for (ii = 0; ii < order; ++ii) {
+                radius = ((ii > 0) ? fabs(ee[ii - 1]) : 0.0) + (((ii + 1) < order) ? fabs(ee[ii]) : 0.0);
+                if ((ii == 0) || ((dd[ii] - radius) < selection.lower)) {
+                    selection.lower = dd[ii] - radius;
+                }
+                if ((ii == 0) || ((dd[ii] + radius) > selection.upper)) {
+                    selection.upper = dd[ii] + radius;
+                }
+                if ((ii + 1) < order) {
+                    reals[(2 * order) + ii] = ee[ii] * ee[ii];
+                    if (reals[(2 * order) + ii] > e2max) {
+                        e2max = reals[(2 * order) + ii];
+                    }
+                }
+            }
+            selection.norm = fmax(fabs(selection.lower), fabs(selection.upper));
+            selection.pivmin = DBL_MIN * fmax(1.0, e2max);
+            radius = (2.0 * DBL_EPSILON * selection.norm) + selection.pivmin;
+            selection.lower -= radius;
+            selection.upper += radius;
+            selection.dd = dd;
+            selection.ee = ee;
+            selection.values = &(reals[3 * order]);
+            selection.zz = zz;
+            selection.order = order;
+            selection.first = first;
+            selection.count = count;
+
+            dirac_core_parallel(count, dirac_core_grain(64 * order), select_values, &selection);
+
+            if (vectorsp != (dirac_t **)0) {
+                /* Clusters are runs of values closer than a thousandth of the norm. */
+                indices[0] = 0;
+                clusters = 0;
+                for (ii = 1; ii < count; ++ii) {
+                    if ((selection.values[ii] - selection.values[ii - 1]) > (1.0e-3 * selection.norm)) {
+                        indices[++clusters] = ii;
+                    }
+                }
+                indices[++clusters] = count;
+                selection.clusters = indices;
+                dirac_core_parallel(clusters, dirac_core_grain(REFINEMENTS * 8 * order), select_vectors, &selection);
+                if (selection.failures > 0) {
+                    rc = -1;
+                    break;
+                }
+            }
+
+            memcpy(&(dd[first]), selection.values, count * sizeof(double));
+
+        }
+
+        if (rc < 0) {
+            errno = EDOM;
+            break;
+        }
+
+        for (ii = 0; ii < count; ++ii) {
+            dirac_core_body_mut(that)[ii] = dd[first + ii];
+        }
+
+        if (vectorsp != (dirac_t **)0) {
+            /* All eigenvectors are columns FIRST on of the whole. */
+            xx = dirac_core_body_mut(vectors);
+            for (ii = 0; ii < (order * count); ++ii) {
+                xx[ii] = all ? zz[((ii / count) * order) + (ii % count) + first] : zz[ii];
+            }
+            back.aa = aa;
+            back.taus = taus;
+            back.xx = xx;
+            back.dots = pp;
+            back.order = order;
+            back.cols = count;
+            dirac_core_parallel(count, (BLOCK > dirac_core_grain(order * order)) ? BLOCK : dirac_core_grain(order * order), back_transform, &back);
+        }
+
+    } while (0);
+
+    if (rc < 0) {
+        that = dirac_core_free(that);
+        vectors = dirac_core_free(vectors);
+    }
+
+    if (that == (dirac_t *)0) {
+        vectors = dirac_core_free(vectors);
+        diminuto_perror(name);
+    } else if (vectorsp != (dirac_t **)0) {
+        *vectorsp = vectors;
+    } else {
+        /* Do nothing. */
+    }
+
+    free(zz);
+    free(indices);
+    free(complexes);
+    free(reals);
+    (void)dirac_core_free(work);
+
+    return that;
+}
+
+/*******************************************************************************
+ * OPERATIONS
+ ******************************************************************************/
+
+dirac_matrix_t * dirac_matrix_eigh(const dirac_matrix_t * thema, dirac_matrix_t ** vectorsp)
+{
+    DIRAC_TRACE_BEGIN;
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * vectors = (dirac_t *)0;
+    dirac_t * that;
+    that = eigensolve(thata, 0, (thata != (const dirac_t *)0) ? dirac_core_rows_get(thata) : 0, !0, (vectorsp != (dirac_matrix_t **)0) ? &vectors : (dirac_t **)0, "dirac_matrix_eigh");
+    if (vectorsp != (dirac_matrix_t **)0) {
+        *vectorsp = dirac_core_matrix_mut(vectors);
+    }
+    DIRAC_TRACE_END(DIRAC_TRACE_EIGH, dirac_core_object_get(thema), vectors, that);
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_matrix_eigh_range(const dirac_matrix_t * thema, size_t first, size_t count, dirac_matrix_t ** vectorsp)
+{
+    DIRAC_TRACE_BEGIN;
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * vectors = (dirac_t *)0;
+    dirac_t * that;
+    that = eigensolve(thata, first, count, 0, (vectorsp != (dirac_matrix_t **)0) ? &vectors : (dirac_t **)0, "dirac_matrix_eigh_range");
+    if (vectorsp != (dirac_matrix_t **)0) {
+        *vectorsp = dirac_core_matrix_mut(vectors);
+    }
+    DIRAC_TRACE_END(DIRAC_TRACE_EIGH_RANGE, dirac_core_object_get(thema), vectors, that);
+    return dirac_core_matrix_mut(that);
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
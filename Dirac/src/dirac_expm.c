@@ -0,0 +1,553 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the matrix exponential portions of Dirac.
+ *
+ * REFERENCES
+ *
+ * N. Higham, "The Scaling and Squaring Method for the Matrix Exponential
+ * Revisited", SIAM Journal on Matrix Analysis and Applications, 26.4,
+ * 2005
+ *
+ * R. Sidje, "Expokit: A Software Package for Computing Matrix
+ * Exponentials", ACM Transactions on Mathematical Software, 24.1, 1998
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <errno.h>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/*
+ * Pade degrees and the largest 1-norm for which each is accurate to double
+ * precision without scaling (Higham, Table 2.3).
+ */
+
+static const int DEGREES[] = { 3, 5, 7, 9, 13, };
+
+static const double THETAS[] = {
+    1.495585217958292e-2,
+    2.539398330063230e-1,
+    9.504178996162932e-1,
+    2.097847961257068e0,
+    5.371920351148152e0,
+};
+
+static const double B3[] = { 120.0, 60.0, 12.0, 1.0, };
+
+static const double B5[] = { 30240.0, 15120.0, 3360.0, 420.0, 30.0, 1.0, };
+
+static const double B7[] = { 17297280.0, 8648640.0, 1995840.0, 277200.0, 25200.0, 1512.0, 56.0, 1.0, };
+
+static const double B9[] = {
+    17643225600.0, 8821612800.0, 2075673600.0, 302702400.0, 30270240.0,
+    2162160.0, 110880.0, 3960.0, 90.0, 1.0,
+};
+
+static const double B13[] = {
+    64764752532480000.0, 32382376266240000.0, 7771770303897600.0,
+    1187353796428800.0, 129060195264000.0, 10559470521600.0,
+    670442572800.0, 33522128640.0, 1323241920.0, 40840800.0, 960960.0,
+    16380.0, 182.0, 1.0,
+};
+
+/*
+ * The number of NxN slots of workspace the Pade approximant uses.
+ */
+static const size_t SLOTS = 8;
+
+/*
+ * The largest Krylov subspace, and the accuracy asked of each step.
+ */
+static const size_t KRYLOV = 30;
+
+static const double TOLERANCE = 1.0e-12;
+
+/*
+ * Halvings of a step before the Krylov method gives up.
+ */
+static const int HALVINGS = 60;
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+typedef struct DiracDense {
+    dirac_complex_t * tt;
+    const dirac_complex_t * aa;
+    const dirac_complex_t * bb;
+    size_t order;
+} dirac_dense_t;
+
+/*******************************************************************************
+ * DENSE KERNELS
+ ******************************************************************************/
+
+/*
+ * The workspace is all raw NxN arrays, so these mirror dirac_core_mul_into
+ * without needing an object around each one.
+ */
+
+static void product(void * context, size_t begin, size_t end)
+{
+    const dirac_dense_t * densep = (const dirac_dense_t *)context;
+    size_t order = densep->order;
+    const dirac_complex_t * arow;
+    const dirac_complex_t * brow;
+    dirac_complex_t * trow;
+    dirac_complex_t factor;
+    size_t rr;
+    size_t mm;
+    size_t cc;
+    for (rr = begin; rr < end; ++rr) {
+        arow = &(densep->aa[rr * order]);
+        trow = &(densep->tt[rr * order]);
+        for (cc = 0; cc < order; ++cc) {
+            trow[cc] = 0;
+        }
+        for (mm = 0; mm < order; ++mm) {
+            factor = arow[mm];
+            brow = &(densep->bb[mm * order]);
+            for (cc = 0; cc < order; ++cc) {
+                trow[cc] += factor * brow[cc];
+            }
+        }
+    }
+}
+
+static void multiply(dirac_complex_t * tt, const dirac_complex_t * aa, const dirac_complex_t * bb, size_t order)
+{
+    dirac_dense_t dense = { tt, aa, bb, order, };
+    dirac_core_parallel(order, dirac_core_grain(order * order), product, &dense);
+}
+
+static double norm1(const dirac_complex_t * aa, size_t order)
+{
+    double largest = 0.0;
+    double sum;
+    size_t rr;
+    size_t cc;
+    for (cc = 0; cc < order; ++cc) {
+        sum = 0.0;
+        for (rr = 0; rr < order; ++rr) {
+            sum += cabs(aa[(rr * order) + cc]);
+        }
+        if (!(sum <= largest)) {
+            largest = sum;
+        }
+    }
+    return largest;
+}
+
+/*
+ * Computes TT = exp(A) where A is in the first of the SLOTS NxN slots of
+ * workspace WW, which it uses and overwrites. Returns -1 if A is not
+ * finite.
+ */
+static int exponentiate(dirac_complex_t * tt, dirac_complex_t * ww, size_t order)
+{
+    size_t area = order * order;
+    dirac_complex_t * aa = &(ww[0 * area]);
+    dirac_complex_t * a2 = &(ww[1 * area]);
+    dirac_complex_t * a4 = &(ww[2 * area]);
+    dirac_complex_t * a6 = &(ww[3 * area]);
+    dirac_complex_t * a8 = &(ww[4 * area]);
+    dirac_complex_t * xx = &(ww[5 * area]);
+    dirac_complex_t * uu = &(ww[6 * area]);
+    dirac_complex_t * vv = &(ww[7 * area]);
+    dirac_complex_t * source;
+    dirac_complex_t * target;
+    dirac_complex_t * spare;
+    dirac_complex_t pp;
+    dirac_complex_t qq;
+    const double * bb;
+    double norm;
+    double scale;
+    int degree = 0;
+    int squarings = 0;
+    int rc = 0;
+    int ii;
+    size_t jj;
+
+    do {
+
+        norm = norm1(aa, order);
+        if (!isfinite(norm)) {
+            rc = -1;
+            break;
+        }
+
+        for (ii = 0; ii < (int)(sizeof(DEGREES) / sizeof(DEGREES[0])); ++ii) {
+            degree = DEGREES[ii];
+            if (norm <= THETAS[ii]) {
+                break;
+            }
+        }
+
+        if (norm > THETAS[4]) {
+            squarings = (int)ceil(log2(norm / THETAS[4]));
+            scale = ldexp(1.0, -squarings);
+            for (jj = 0; jj < area; ++jj) {
+                aa[jj] *= scale;
+            }
+        }
+
+        multiply(a2, aa, aa, order);
+
+        switch (degree) {
+
+        case 13:
+            bb = B13;
+            multiply(a4, a2, a2, order);
+            multiply(a6, a4, a2, order);
+            for (jj = 0; jj < area; ++jj) {
+                xx[jj] = (bb[13] * a6[jj]) + (bb[11] * a4[jj]) + (bb[9] * a2[jj]);
+            }
+            multiply(uu, a6, xx, order);
+            for (jj = 0; jj < area; ++jj) {
+                uu[jj] += (bb[7] * a6[jj]) + (bb[5] * a4[jj]) + (bb[3] * a2[jj]);
+            }
+            for (jj = 0; jj < order; ++jj) {
+                uu[(jj * order) + jj] += bb[1];
+            }
+            multiply(xx, aa, uu, order);
+            for (jj = 0; jj < area; ++jj) {
+                uu[jj] = (bb[12] * a6[jj]) + (bb[10] * a4[jj]) + (bb[8] * a2[jj]);
+            }
+            multiply(vv, a6, uu, order);
+            for (jj = 0; jj < area; ++jj) {
+                vv[jj] += (bb[6] * a6[jj]) + (bb[4] * a4[jj]) + (bb[2] * a2[jj]);
+            }
+            break;
+
+        default:
+            bb = (degree == 3) ? B3 : (degree == 5) ? B5 : (degree == 7) ? B7 : B9;
+            if (degree >= 5) { multiply(a4, a2, a2, order); }
+            if (degree >= 7) { multiply(a6, a4, a2, order); }
+            if (degree >= 9) { multiply(a8, a6, a2, order); }
+            for (jj = 0; jj < area; ++jj) {
+                uu[jj] = bb[3] * a2[jj];
+                vv[jj] = bb[2] * a2[jj];
+                if (degree >= 5) { uu[jj] += bb[5] * a4[jj]; vv[jj] += bb[4] * a4[jj]; }
+                if (degree >= 7) { uu[jj] += bb[7] * a6[jj]; vv[jj] += bb[6] * a6[jj]; }
+                if (degree >= 9) { uu[jj] += bb[9] * a8[jj]; vv[jj] += bb[8] * a8[jj]; }
+            }
+            for (jj = 0; jj < order; ++jj) {
+                uu[(jj * order) + jj] += bb[1];
+            }
+            multiply(xx, aa, uu, order);
+            break;
+
+        }
+
+        /* U = A * (odd terms) is in X; V (even terms) lacks only b0*I. */
+        for (jj = 0; jj < order; ++jj) {
+            vv[(jj * order) + jj] += bb[0];
+        }
+
+        /* Solve (V - U) * R = (V + U), pivoting in the spent A^2 slot. */
+        for (jj = 0; jj < area; ++jj) {
+            pp = vv[jj] + xx[jj];
+            qq = vv[jj] - xx[jj];
+            vv[jj] = pp;
+            xx[jj] = qq;
+        }
+        if (dirac_core_lu_factor(xx, order, (size_t *)a2) != 0) {
+            rc = -1;
+            break;
+        }
+        dirac_core_lu_solve(xx, (size_t *)a2, order, vv, order);
+
+        /* Square back up, ending in the target. */
+        source = vv;
+        spare = uu;
+        for (ii = 0; ii < squarings; ++ii) {
+            target = (ii == (squarings - 1)) ? tt : spare;
+            multiply(target, source, source, order);
+            spare = source;
+            source = target;
+        }
+        if (squarings == 0) {
+            memcpy(tt, vv, area * sizeof(dirac_complex_t));
+        }
+
+    } while (0);
+
+    return rc;
+}
+
+/*******************************************************************************
+ * KRYLOV KERNELS
+ ******************************************************************************/
+
+static double norm2(const dirac_complex_t * xx, size_t count)
+{
+    double sum = 0.0;
+    size_t ii;
+    for (ii = 0; ii < count; ++ii) {
+        sum += (creal(xx[ii]) * creal(xx[ii])) + (cimag(xx[ii]) * cimag(xx[ii]));
+    }
+    return sqrt(sum);
+}
+
+/*
+ * Advances W to exp(FACTOR * A) * W in steps of the unit interval, each
+ * computed as exp(TAU * H) on the Arnoldi decomposition of the current W
+ * (for a Hermitian A, H is tridiagonal and this is Lanczos). A step whose
+ * a posteriori error estimate is too large is retried at half the length
+ * on the same basis; only the small exponential is recomputed.
+ */
+static int krylov(dirac_complex_t * w, const dirac_t * thata, dirac_complex_t factor, dirac_complex_t * ws)
+{
+    size_t order = dirac_core_rows_get(thata);
+    size_t dimension = (order < KRYLOV) ? order : KRYLOV;
+    dirac_complex_t * vv = ws;
+    dirac_complex_t * hh = &(vv[(dimension + 1) * order]);
+    dirac_complex_t * ff = &(hh[(dimension + 1) * dimension]);
+    dirac_complex_t * small = &(ff[dimension * dimension]);
+    dirac_core_apply_t context = { thata, (const dirac_complex_t *)0, (dirac_complex_t *)0, factor, };
+    size_t grain = dirac_core_apply_grain(thata);
+    dirac_complex_t dot;
+    dirac_complex_t sum;
+    double beta;
+    double elapsed = 0.0;
+    double tau = 1.0;
+    double before;
+    double error;
+    double subdiagonal;
+    size_t mm;
+    size_t jj;
+    size_t ii;
+    size_t kk;
+    int happy;
+    int halvings;
+    int rc = 0;
+
+    while ((rc == 0) && (elapsed < 1.0)) {
+
+        beta = norm2(w, order);
+        if (beta == 0.0) {
+            break;
+        }
+
+        /* Arnoldi with modified Gram-Schmidt. */
+        memset(hh, 0, (dimension + 1) * dimension * sizeof(dirac_complex_t));
+        for (ii = 0; ii < order; ++ii) {
+            vv[ii] = w[ii] / beta;
+        }
+        mm = dimension;
+        happy = 0;
+        subdiagonal = 0.0;
+        for (jj = 0; jj < dimension; ++jj) {
+            context.xx = &(vv[jj * order]);
+            context.yy = &(vv[(jj + 1) * order]);
+            dirac_core_parallel(order, grain, dirac_core_apply, &context);
+            before = norm2(context.yy, order);
+            for (ii = 0; ii <= jj; ++ii) {
+                dot = 0;
+                for (kk = 0; kk < order; ++kk) {
+                    dot += conj(vv[(ii * order) + kk]) * context.yy[kk];
+                }
+                hh[(ii * dimension) + jj] = dot;
+                for (kk = 0; kk < order; ++kk) {
+                    context.yy[kk] -= dot * vv[(ii * order) + kk];
+                }
+            }
+            subdiagonal = norm2(context.yy, order);
+            if (subdiagonal <= (DBL_EPSILON * before)) {
+                /* The subspace is invariant, so the step is exact. */
+                mm = jj + 1;
+                happy = !0;
+                break;
+            }
+            hh[((jj + 1) * dimension) + jj] = subdiagonal;
+            for (kk = 0; kk < order; ++kk) {
+                context.yy[kk] /= subdiagonal;
+            }
+        }
+
+        if (happy) {
+            tau = 1.0 - elapsed;
+        } else if (tau > (1.0 - elapsed)) {
+            tau = 1.0 - elapsed;
+        } else {
+            /* Do nothing. */
+        }
+
+        for (halvings = 0; halvings < HALVINGS; ++halvings) {
+            for (ii = 0; ii < mm; ++ii) {
+                for (kk = 0; kk < mm; ++kk) {
+                    small[(ii * mm) + kk] = tau * hh[(ii * dimension) + kk];
+                }
+            }
+            if (exponentiate(ff, small, mm) < 0) {
+                rc = -1;
+                break;
+            }
+            error = happy ? 0.0 : (beta * tau * subdiagonal * cabs(ff[(mm - 1) * mm]));
+            if (error <= (TOLERANCE * beta * tau)) {
+                break;
+            }
+            tau *= 0.5;
+        }
+        if ((rc < 0) || (halvings >= HALVINGS)) {
+            rc = -1;
+            break;
+        }
+
+        /* W = beta * V * exp(tau * H) * e1 */
+        for (kk = 0; kk < order; ++kk) {
+            sum = 0;
+            for (ii = 0; ii < mm; ++ii) {
+                sum += vv[(ii * order) + kk] * ff[ii * mm];
+            }
+            w[kk] = beta * sum;
+        }
+
+        elapsed += tau;
+        if (halvings == 0) {
+            tau *= 2.0;
+        }
+
+    }
+
+    return rc;
+}
+
+/*******************************************************************************
+ * OPERATIONS
+ ******************************************************************************/
+
+dirac_matrix_t * dirac_matrix_expm(const dirac_matrix_t * thema, dirac_complex_t factor)
+{
+    DIRAC_TRACE_BEGIN;
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * that = (dirac_t *)0;
+    dirac_t * work = (dirac_t *)0;
+    size_t order;
+
+    do {
+
+        if (thata == (const dirac_t *)0) {
+            errno = EINVAL;
+            break;
+        }
+
+        order = dirac_core_rows_get(thata);
+        if ((order == 0) || (dirac_core_cols_get(thata) != order)) {
+            errno = EINVAL;
+            break;
+        }
+
+        /* All of the workspace, up front. */
+        if ((that = dirac_core_allocate(order, order)) == (dirac_t *)0) {
+            break;
+        }
+        if ((work = dirac_core_allocate(SLOTS * order, order)) == (dirac_t *)0) {
+            that = dirac_core_free(that);
+            break;
+        }
+
+        dirac_core_expand(dirac_core_body_mut(work), thata, factor);
+        if (exponentiate(dirac_core_body_mut(that), dirac_core_body_mut(work), order) < 0) {
+            that = dirac_core_free(that);
+            errno = EDOM;
+            break;
+        }
+
+    } while (0);
+
+    if (work != (dirac_t *)0) {
+        (void)dirac_core_free(work);
+    }
+
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_matrix_expm");
+    }
+
+    DIRAC_TRACE_END(DIRAC_TRACE_EXPM, dirac_core_object_get(thema), (const dirac_t *)0, that);
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_matrix_expm_multiply(const dirac_matrix_t * thema, dirac_complex_t factor, const dirac_matrix_t * themb)
+{
+    DIRAC_TRACE_BEGIN;
+    const dirac_t * thata = dirac_core_object_get(thema);
+    const dirac_t * thatb = dirac_core_object_get(themb);
+    dirac_t * that = (dirac_t *)0;
+    dirac_t * work = (dirac_t *)0;
+    size_t order;
+    size_t dimension;
+    size_t length;
+
+    do {
+
+        if ((thata == (const dirac_t *)0) || (thatb == (const dirac_t *)0)) {
+            errno = EINVAL;
+            break;
+        }
+
+        order = dirac_core_rows_get(thata);
+        if ((order == 0) || (dirac_core_cols_get(thata) != order)) {
+            errno = EINVAL;
+            break;
+        }
+
+        if (!dirac_core_is_array(thatb) || (dirac_core_rows_get(thatb) != order) || (dirac_core_cols_get(thatb) != 1)) {
+            errno = EINVAL;
+            break;
+        }
+
+        /* Basis, Hessenberg matrix, small exponential and its workspace. */
+        dimension = (order < KRYLOV) ? order : KRYLOV;
+        length = ((dimension + 1) * order) + ((dimension + 1) * dimension) + (dimension * dimension) + (SLOTS * dimension * dimension);
+
+        if ((that = dirac_core_allocate(order, 1)) == (dirac_t *)0) {
+            break;
+        }
+        if ((work = dirac_core_allocate(length, 1)) == (dirac_t *)0) {
+            that = dirac_core_free(that);
+            break;
+        }
+
+        dirac_core_expand(dirac_core_body_mut(that), thatb, 1.0);
+        if (krylov(dirac_core_body_mut(that), thata, factor, dirac_core_body_mut(work)) < 0) {
+            that = dirac_core_free(that);
+            errno = EDOM;
+            break;
+        }
+
+    } while (0);
+
+    if (work != (dirac_t *)0) {
+        (void)dirac_core_free(work);
+    }
+
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_matrix_expm_multiply");
+    }
+
+    DIRAC_TRACE_END(DIRAC_TRACE_EXPM_MULTIPLY, dirac_core_object_get(thema), dirac_core_object_get(themb), that);
+    return dirac_core_matrix_mut(that);
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
@@ -0,0 +1,408 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the persistence portions of Dirac. The
+ * file is laid out so that once it is mapped the dirac_data_t in it sits
+ * immediately in front of the body exactly as it does in an allocated
+ * object, so the mapping itself is the matrix.
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+typedef struct DiracFile {
+    char magic[8];
+    uint32_t version;
+    uint32_t order;         /* ORDER as written by the host. */
+    uint32_t element;       /* sizeof(dirac_complex_t) */
+    uint32_t index;         /* sizeof(size_t) */
+    uint64_t offset;        /* Of the body from the start of the file. */
+    uint64_t length;        /* Of the body in bytes. */
+    uint32_t generation;    /* Of a shared segment; always zero in a file. */
+} dirac_file_t;
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+static const char MAGIC[8] = { 'D', 'I', 'R', 'A', 'C', 'M', 'A', 'T', };
+
+static const uint32_t ORDER = 0x01020304;
+
+/* Where the dirac_data_t goes so that the body follows it at the offset. */
+static const size_t HEAD = DIRAC_FILE_OFFSET - offsetof(dirac_t, data.body);
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+/*
+ * Writes all of the vector even if the kernel does it in pieces (Linux
+ * transfers at most about 2GB per call).
+ */
+static int writeall(int fd, struct iovec * vector, int count)
+{
+    int rc = 0;
+    ssize_t written;
+    while (count > 0) {
+        written = writev(fd, vector, count);
+        if (written < 0) {
+            if (errno == EINTR) { continue; }
+            rc = -1;
+            break;
+        }
+        while ((count > 0) && (written >= (ssize_t)vector->iov_len)) {
+            written -= vector->iov_len;
+            ++vector;
+            --count;
+        }
+        if (count > 0) {
+            vector->iov_base = (char *)(vector->iov_base) + written;
+            vector->iov_len -= written;
+        }
+    }
+    return rc;
+}
+
+/*
+ * Computes the length in bytes of the body HEAD describes into LENGTHP,
+ * refusing any shape its kind cannot have and any size that overflows.
+ * The head is from the file, so nothing in it is trusted. Returns 0, or -1
+ * if the head is not valid.
+ */
+static int extent(const dirac_data_t * head, size_t * lengthp)
+{
+    size_t elements = 0;
+    size_t indices = 0;
+    size_t packed;
+    size_t bytes;
+    int rc = -1;
+
+    switch (head->kind) {
+    case DIRAC_KIND_DENSE:
+        if (!__builtin_mul_overflow(head->rows, head->columns, &elements)) {
+            rc = 0;
+        }
+        break;
+    case DIRAC_KIND_SPARSE:
+        elements = head->count;
+        if (__builtin_add_overflow(head->rows, 1, &indices)) {
+            /* Do nothing. */
+        } else if (__builtin_add_overflow(indices, head->count, &indices)) {
+            /* Do nothing. */
+        } else {
+            rc = 0;
+        }
+        break;
+    case DIRAC_KIND_DIAGONAL:
+    case DIRAC_KIND_PERMUTATION:
+        elements = head->count;
+        indices = (head->kind == DIRAC_KIND_PERMUTATION) ? head->count : 0;
+        if ((head->rows == head->columns) && (head->count == head->rows)) {
+            rc = 0;
+        }
+        break;
+    case DIRAC_KIND_HERMITIAN:
+    case DIRAC_KIND_TRIANGULAR:
+        elements = head->count;
+        if (head->rows != head->columns) {
+            /* Do nothing. */
+        } else if ((head->rows == SIZE_MAX) || __builtin_mul_overflow(head->rows, head->rows + 1, &packed)) {
+            /* Do nothing. */
+        } else if ((packed / 2) != head->count) {
+            /* Do nothing. */
+        } else {
+            rc = 0;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (rc < 0) {
+        /* Do nothing. */
+    } else if (__builtin_mul_overflow(elements, sizeof(dirac_complex_t), &bytes)) {
+        rc = -1;
+    } else if (__builtin_mul_overflow(indices, sizeof(size_t), &indices)) {
+        rc = -1;
+    } else if (__builtin_add_overflow(bytes, indices, lengthp)) {
+        rc = -1;
+    } else {
+        /* Do nothing. */
+    }
+
+    return rc;
+}
+
+/*******************************************************************************
+ * PRIVATE PERSISTENCE
+ ******************************************************************************/
+
+void dirac_core_file_header(void * header, const dirac_data_t * head)
+{
+    dirac_file_t * file = (dirac_file_t *)header;
+    dirac_data_t * image = (dirac_data_t *)((char *)header + HEAD);
+    memset(header, 0, DIRAC_FILE_OFFSET);
+    memcpy(file->magic, MAGIC, sizeof(MAGIC));
+    file->version = DIRAC_FILE_VERSION;
+    file->order = ORDER;
+    file->element = sizeof(dirac_complex_t);
+    file->index = sizeof(size_t);
+    file->offset = DIRAC_FILE_OFFSET;
+    file->length = dirac_core_length_kind(head->kind, head->rows, head->columns, head->count);
+    /* The stored head is the head of the view the loader will return. */
+    *image = *head;
+    image->flags = DIRAC_FLAG_MAPPED;
+    image->references = 0;
+}
+
+const dirac_data_t * dirac_core_file_check(const void * header, size_t size)
+{
+    const dirac_file_t * file = (const dirac_file_t *)header;
+    const dirac_data_t * head = (const dirac_data_t *)((const char *)header + HEAD);
+    const dirac_data_t * result = (const dirac_data_t *)0;
+    size_t length;
+    if (size < DIRAC_FILE_OFFSET) {
+        /* Do nothing. */
+    } else if (memcmp(file->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        /* Do nothing. */
+    } else if (file->version != DIRAC_FILE_VERSION) {
+        /* Do nothing. */
+    } else if (file->order != ORDER) {
+        /* Do nothing. */
+    } else if (file->element != sizeof(dirac_complex_t)) {
+        /* Do nothing. */
+    } else if (file->index != sizeof(size_t)) {
+        /* Do nothing. */
+    } else if (file->offset != DIRAC_FILE_OFFSET) {
+        /* Do nothing. */
+    } else if (file->length != (size - DIRAC_FILE_OFFSET)) {
+        /* Do nothing. */
+    } else if ((head->flags & DIRAC_FLAG_MAPPED) == 0) {
+        /* Do nothing. */
+    } else if ((head->flags & ~(DIRAC_FLAG_MAPPED | DIRAC_FLAG_SHARED)) != 0) {
+        /* A stored head is never a view, whose origin would be a pointer. */
+    } else if (head->kind > DIRAC_KIND_TRIANGULAR) {
+        /* Do nothing. */
+    } else if (extent(head, &length) < 0) {
+        /* Do nothing. */
+    } else if (length != file->length) {
+        /* Do nothing. */
+    } else {
+        result = head;
+    }
+    return result;
+}
+
+int dirac_core_file_valid(const void * base)
+{
+    const dirac_data_t * head = (const dirac_data_t *)((const char *)base + HEAD);
+    const dirac_complex_t * body = (const dirac_complex_t *)((const char *)base + DIRAC_FILE_OFFSET);
+    const size_t * columns = (const size_t *)(&(body[head->count]));
+    const size_t * offsets = &(columns[head->count]);
+    unsigned char * seen;
+    size_t ii;
+    int valid = !0;
+
+    switch (head->kind) {
+    case DIRAC_KIND_SPARSE:
+        /* Every row lies inside the values and every column inside the matrix. */
+        valid = (offsets[0] == 0) && (offsets[head->rows] == head->count);
+        for (ii = 0; valid && (ii < head->rows); ++ii) {
+            valid = (offsets[ii] <= offsets[ii + 1]);
+        }
+        for (ii = 0; valid && (ii < head->count); ++ii) {
+            valid = (columns[ii] < head->columns);
+        }
+        break;
+    case DIRAC_KIND_PERMUTATION:
+        /* Every column appears exactly once. */
+        if ((seen = (unsigned char *)calloc(head->count + 1, 1)) == (unsigned char *)0) {
+            valid = 0;
+        } else {
+            for (ii = 0; valid && (ii < head->count); ++ii) {
+                valid = (columns[ii] < head->columns) && !seen[columns[ii]];
+                if (valid) { seen[columns[ii]] = !0; }
+            }
+            free(seen);
+        }
+        break;
+    default:
+        break;
+    }
+
+    return valid;
+}
+
+uint32_t * dirac_core_file_generation(const dirac_t * that)
+{
+    dirac_file_t * file = (dirac_file_t *)((char *)dirac_core_body_get(that) - DIRAC_FILE_OFFSET);
+    return &(file->generation);
+}
+
+void dirac_core_unmap(const dirac_t * that)
+{
+    void * base = (void *)((const char *)dirac_core_body_get(that) - DIRAC_FILE_OFFSET);
+    size_t size = DIRAC_FILE_OFFSET + dirac_core_length_get(that);
+    if (munmap(base, size) < 0) {
+        diminuto_perror("dirac_core_unmap: munmap");
+    }
+}
+
+/*******************************************************************************
+ * PUBLIC PERSISTENCE
+ ******************************************************************************/
+
+ssize_t dirac_store(const char * path, const dirac_matrix_t * them)
+{
+    ssize_t total = -1;
+    dirac_t * temp = (dirac_t *)0;
+    const dirac_t * that = dirac_core_object_get(them);
+    union { char bytes[DIRAC_FILE_OFFSET]; dirac_file_t file; } header;
+    struct iovec vector[2];
+    int fd = -1;
+
+    do {
+
+        if (that == (const dirac_t *)0) {
+            errno = EINVAL;
+            diminuto_perror("dirac_store");
+            break;
+        }
+
+        /* A file holds its elements contiguously. */
+        if ((that = dirac_core_dense_get(that, &temp)) == (const dirac_t *)0) {
+            diminuto_perror("dirac_store");
+            break;
+        }
+
+        dirac_core_file_header(&header, &(that->data.head));
+
+        fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            diminuto_perror("dirac_store: open");
+            break;
+        }
+
+        vector[0].iov_base = &header;
+        vector[0].iov_len = sizeof(header);
+        vector[1].iov_base = (void *)dirac_core_body_get(that);
+        vector[1].iov_len = dirac_core_length_get(that);
+        if (writeall(fd, vector, 2) < 0) {
+            diminuto_perror("dirac_store: writev");
+            break;
+        }
+
+        total = sizeof(header) + vector[1].iov_len;
+
+    } while (0);
+
+    if (fd < 0) {
+        /* Do nothing. */
+    } else if (close(fd) < 0) {
+        diminuto_perror("dirac_store: close");
+        total = -1;
+    } else {
+        /* Do nothing. */
+    }
+
+    (void)dirac_core_free(temp);
+
+    return total;
+}
+
+const dirac_matrix_t * dirac_load(const char * path)
+{
+    const dirac_matrix_t * them = (const dirac_matrix_t *)0;
+    struct stat status;
+    void * base = MAP_FAILED;
+    size_t size = 0;
+    int fd = -1;
+
+    do {
+
+        fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            diminuto_perror("dirac_load: open");
+            break;
+        }
+
+        if (fstat(fd, &status) < 0) {
+            diminuto_perror("dirac_load: fstat");
+            break;
+        }
+
+        /* Too small to be a matrix, and mmap would refuse an empty file. */
+        if (status.st_size < DIRAC_FILE_OFFSET) {
+            errno = EINVAL;
+            diminuto_perror("dirac_load");
+            break;
+        }
+
+        size = status.st_size;
+        base = mmap((void *)0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) {
+            diminuto_perror("dirac_load: mmap");
+            break;
+        }
+
+        if ((dirac_core_file_check(base, size) == (const dirac_data_t *)0) || !dirac_core_file_valid(base)) {
+            (void)munmap(base, size);
+            errno = EINVAL;
+            diminuto_perror("dirac_load");
+            break;
+        }
+
+        them = (const dirac_matrix_t *)((const char *)base + DIRAC_FILE_OFFSET);
+
+    } while (0);
+
+    /* The mapping outlives the descriptor. */
+    if (fd >= 0) {
+        (void)close(fd);
+    }
+
+    return them;
+}
+
+void dirac_unload(const dirac_matrix_t * them)
+{
+    const dirac_t * that = dirac_core_object_get(them);
+    if (that == (const dirac_t *)0) {
+        /* Do nothing. */
+    } else if (!dirac_core_is_mapped(that)) {
+        errno = EINVAL;
+        diminuto_perror("dirac_unload");
+    } else {
+        dirac_core_unmap(that);
+    }
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
@@ -0,0 +1,225 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the fixed size portions of Dirac: fully
+ * unrolled products for the 2x2, 4x4 and 8x8 operators of one, two and
+ * three qubit gates, both square and applied to a column vector.
+ *
+ * The kernels treat each complex body as an array of interleaved real and
+ * imaginary doubles (which C99 guarantees is its layout) and expand the
+ * complex product by hand, as in the NOTES of the public header, rather
+ * than using the complex multiply operator. This keeps every term in
+ * registers and avoids the library call C99 requires to recover infinite
+ * results from NaN intermediates.
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <errno.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * CODE GENERATORS
+ ******************************************************************************/
+
+/*
+ * _M_ is the number of columns in A (and rows in B), _Q_ the number of
+ * columns in B and the target, _R_ and _C_ the target row and column, and
+ * _K_ the first term of the inner product. All are constants, so every
+ * index folds at compile time.
+ */
+
+#define A_RE(_M_, _R_, _K_) (aa[2 * (((_R_) * (_M_)) + (_K_))])
+#define A_IM(_M_, _R_, _K_) (aa[(2 * (((_R_) * (_M_)) + (_K_))) + 1])
+#define B_RE(_Q_, _K_, _C_) (bb[2 * (((_K_) * (_Q_)) + (_C_))])
+#define B_IM(_Q_, _K_, _C_) (bb[(2 * (((_K_) * (_Q_)) + (_C_))) + 1])
+
+#define MAC_RE(_M_, _Q_, _R_, _C_, _K_) \
+    ((A_RE(_M_, _R_, _K_) * B_RE(_Q_, _K_, _C_)) - (A_IM(_M_, _R_, _K_) * B_IM(_Q_, _K_, _C_)))
+
+#define MAC_IM(_M_, _Q_, _R_, _C_, _K_) \
+    ((A_RE(_M_, _R_, _K_) * B_IM(_Q_, _K_, _C_)) + (A_IM(_M_, _R_, _K_) * B_RE(_Q_, _K_, _C_)))
+
+#define DOT2_RE(_M_, _Q_, _R_, _C_, _K_) \
+    (MAC_RE(_M_, _Q_, _R_, _C_, _K_) + MAC_RE(_M_, _Q_, _R_, _C_, (_K_) + 1))
+
+#define DOT2_IM(_M_, _Q_, _R_, _C_, _K_) \
+    (MAC_IM(_M_, _Q_, _R_, _C_, _K_) + MAC_IM(_M_, _Q_, _R_, _C_, (_K_) + 1))
+
+#define DOT4_RE(_M_, _Q_, _R_, _C_, _K_) \
+    (DOT2_RE(_M_, _Q_, _R_, _C_, _K_) + DOT2_RE(_M_, _Q_, _R_, _C_, (_K_) + 2))
+
+#define DOT4_IM(_M_, _Q_, _R_, _C_, _K_) \
+    (DOT2_IM(_M_, _Q_, _R_, _C_, _K_) + DOT2_IM(_M_, _Q_, _R_, _C_, (_K_) + 2))
+
+#define DOT8_RE(_M_, _Q_, _R_, _C_, _K_) \
+    (DOT4_RE(_M_, _Q_, _R_, _C_, _K_) + DOT4_RE(_M_, _Q_, _R_, _C_, (_K_) + 4))
+
+#define DOT8_IM(_M_, _Q_, _R_, _C_, _K_) \
+    (DOT4_IM(_M_, _Q_, _R_, _C_, _K_) + DOT4_IM(_M_, _Q_, _R_, _C_, (_K_) + 4))
+
+#define STORE(_DOT_, _M_, _Q_, _R_, _C_) \
+    tt[2 * (((_R_) * (_Q_)) + (_C_))] = _DOT_##_RE(_M_, _Q_, _R_, _C_, 0); \
+    tt[(2 * (((_R_) * (_Q_)) + (_C_))) + 1] = _DOT_##_IM(_M_, _Q_, _R_, _C_, 0)
+
+#define ROW1(_DOT_, _M_, _Q_, _R_, _C_) \
+    STORE(_DOT_, _M_, _Q_, _R_, _C_)
+
+#define ROW2(_DOT_, _M_, _Q_, _R_, _C_) \
+    ROW1(_DOT_, _M_, _Q_, _R_, _C_); ROW1(_DOT_, _M_, _Q_, _R_, (_C_) + 1)
+
+#define ROW4(_DOT_, _M_, _Q_, _R_, _C_) \
+    ROW2(_DOT_, _M_, _Q_, _R_, _C_); ROW2(_DOT_, _M_, _Q_, _R_, (_C_) + 2)
+
+#define ROW8(_DOT_, _M_, _Q_, _R_, _C_) \
+    ROW4(_DOT_, _M_, _Q_, _R_, _C_); ROW4(_DOT_, _M_, _Q_, _R_, (_C_) + 4)
+
+#define ROWS2(_ROW_, _DOT_, _M_, _Q_, _R_) \
+    _ROW_(_DOT_, _M_, _Q_, _R_, 0); _ROW_(_DOT_, _M_, _Q_, (_R_) + 1, 0)
+
+#define ROWS4(_ROW_, _DOT_, _M_, _Q_, _R_) \
+    ROWS2(_ROW_, _DOT_, _M_, _Q_, _R_); ROWS2(_ROW_, _DOT_, _M_, _Q_, (_R_) + 2)
+
+#define ROWS8(_ROW_, _DOT_, _M_, _Q_, _R_) \
+    ROWS4(_ROW_, _DOT_, _M_, _Q_, _R_); ROWS4(_ROW_, _DOT_, _M_, _Q_, (_R_) + 4)
+
+/*******************************************************************************
+ * KERNELS
+ ******************************************************************************/
+
+static void mul_2x2(double * restrict tt, const double * restrict aa, const double * restrict bb) {
+    ROWS2(ROW2, DOT2, 2, 2, 0);
+}
+
+static void mul_4x4(double * restrict tt, const double * restrict aa, const double * restrict bb) {
+    ROWS4(ROW4, DOT4, 4, 4, 0);
+}
+
+static void mul_8x8(double * restrict tt, const double * restrict aa, const double * restrict bb) {
+    ROWS8(ROW8, DOT8, 8, 8, 0);
+}
+
+static void mul_2x1(double * restrict tt, const double * restrict aa, const double * restrict bb) {
+    ROWS2(ROW1, DOT2, 2, 1, 0);
+}
+
+static void mul_4x1(double * restrict tt, const double * restrict aa, const double * restrict bb) {
+    ROWS4(ROW1, DOT4, 4, 1, 0);
+}
+
+static void mul_8x1(double * restrict tt, const double * restrict aa, const double * restrict bb) {
+    ROWS8(ROW1, DOT8, 8, 1, 0);
+}
+
+typedef void (dirac_fixed_t)(double * restrict tt, const double * restrict aa, const double * restrict bb);
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+/*
+ * Returns the kernel for an ORDER x ORDER times ORDER x COLS product, or
+ * null if there is none.
+ */
+static dirac_fixed_t * kernel(size_t order, size_t cols)
+{
+    dirac_fixed_t * fixedp = (dirac_fixed_t *)0;
+    switch (order) {
+    case 2:
+        fixedp = (cols == 2) ? mul_2x2 : (cols == 1) ? mul_2x1 : (dirac_fixed_t *)0;
+        break;
+    case 4:
+        fixedp = (cols == 4) ? mul_4x4 : (cols == 1) ? mul_4x1 : (dirac_fixed_t *)0;
+        break;
+    case 8:
+        fixedp = (cols == 8) ? mul_8x8 : (cols == 1) ? mul_8x1 : (dirac_fixed_t *)0;
+        break;
+    }
+    return fixedp;
+}
+
+/*
+ * The fixed size entry points check what the caller promised at compile
+ * time against what the objects say at run time, and fall back to the
+ * general product if they disagree.
+ */
+static dirac_matrix_t * fixed(dirac_fixed_t * fixedp, size_t order, size_t cols, const dirac_matrix_t * thema, const dirac_matrix_t * themb)
+{
+    const dirac_t * thata = dirac_core_object_get(thema);
+    const dirac_t * thatb = dirac_core_object_get(themb);
+    dirac_t * that = (dirac_t *)0;
+    dirac_matrix_t * them = (dirac_matrix_t *)0;
+    if (!dirac_core_is_dense(thata) || !dirac_core_is_dense(thatb)) {
+        them = dirac_matrix_mul(thema, themb);
+    } else if ((dirac_core_rows_get(thata) != order) || (dirac_core_cols_get(thata) != order)) {
+        them = dirac_matrix_mul(thema, themb);
+    } else if ((dirac_core_rows_get(thatb) != order) || (dirac_core_cols_get(thatb) != cols)) {
+        them = dirac_matrix_mul(thema, themb);
+    } else if ((that = dirac_core_allocate(order, cols)) == (dirac_t *)0) {
+        diminuto_perror("dirac_matrix_mul");
+    } else {
+        (*fixedp)((double *)dirac_core_body_mut(that), (const double *)dirac_core_body_get(thata), (const double *)dirac_core_body_get(thatb));
+        them = dirac_core_matrix_mut(that);
+    }
+    return them;
+}
+
+/*******************************************************************************
+ * PRIVATE OPERATIONS
+ ******************************************************************************/
+
+dirac_t * dirac_core_mul_fixed(dirac_t * that, const dirac_t * thata, const dirac_t * thatb)
+{
+    dirac_fixed_t * fixedp = (dirac_fixed_t *)0;
+    size_t order = dirac_core_rows_get(thata);
+    if (dirac_core_cols_get(thata) != order) {
+        that = (dirac_t *)0;
+    } else if ((fixedp = kernel(order, dirac_core_cols_get(thatb))) == (dirac_fixed_t *)0) {
+        that = (dirac_t *)0;
+    } else {
+        (*fixedp)((double *)dirac_core_body_mut(that), (const double *)dirac_core_body_get(thata), (const double *)dirac_core_body_get(thatb));
+    }
+    return that;
+}
+
+/*******************************************************************************
+ * PUBLIC OPERATIONS
+ ******************************************************************************/
+
+dirac_matrix_t * dirac_matrix_mul_2x2(const dirac_matrix_t * thema, const dirac_matrix_t * themb) {
+    return fixed(mul_2x2, 2, 2, thema, themb);
+}
+
+dirac_matrix_t * dirac_matrix_mul_4x4(const dirac_matrix_t * thema, const dirac_matrix_t * themb) {
+    return fixed(mul_4x4, 4, 4, thema, themb);
+}
+
+dirac_matrix_t * dirac_matrix_mul_8x8(const dirac_matrix_t * thema, const dirac_matrix_t * themb) {
+    return fixed(mul_8x8, 8, 8, thema, themb);
+}
+
+dirac_matrix_t * dirac_matrix_mul_2x1(const dirac_matrix_t * thema, const dirac_matrix_t * themb) {
+    return fixed(mul_2x1, 2, 1, thema, themb);
+}
+
+dirac_matrix_t * dirac_matrix_mul_4x1(const dirac_matrix_t * thema, const dirac_matrix_t * themb) {
+    return fixed(mul_4x1, 4, 1, thema, themb);
+}
+
+dirac_matrix_t * dirac_matrix_mul_8x1(const dirac_matrix_t * thema, const dirac_matrix_t * themb) {
+    return fixed(mul_8x1, 8, 1, thema, themb);
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
@@ -0,0 +1,434 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the output formatting portions of Dirac.
+ * Rows are formatted into fixed size slots of a large buffer, in parallel
+ * for big matrices, and each slot is then written in order.
+ *
+ * Numbers are converted by scaling by an exact power of ten and rounding
+ * the result to an integer, which involves a single rounding error. When
+ * that error could change the decimal rounding (the value is within an
+ * error bound of a tie) the conversion falls back to snprintf, so the
+ * output is always exactly what printf would produce.
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+typedef struct DiracFormatting {
+    const dirac_t * that;
+    char * buffer;
+    size_t * lengths;
+    const char * prefix;
+    size_t first;           /* Row in the matrix of the first slot. */
+    size_t slot;            /* Bytes per slot. */
+    dirac_format_t format;
+    int precision;
+} dirac_formatting_t;
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/* Field width of the historical "%7.4le" format. */
+static const int WIDTH = 7;
+
+/* Bytes of slots formatted before they are written. */
+static const size_t CHUNK = 1 << 22;
+
+static const double POWERS[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static const uint64_t INTEGERS[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+};
+
+/* Largest precision accepted; far more than a double can hold. */
+#define PRECISION (40)
+
+/* Largest precision for which the digits fit in a double's mantissa. */
+static const int FAST = 15;
+
+static const char * KINDS[] = { "dense", "sparse", "diagonal", "permutation", "hermitian", "triangular", "strided", };
+
+static const char HEX[] = "0123456789abcdef";
+
+/*******************************************************************************
+ * CONVERSIONS
+ ******************************************************************************/
+
+static size_t decimal(char * buffer, uint64_t value, int digits)
+{
+    char temporary[24];
+    int ii = 0;
+    do {
+        temporary[ii++] = '0' + (value % 10);
+        value /= 10;
+    } while ((value > 0) || (ii < digits));
+    digits = ii;
+    while (ii > 0) {
+        *(buffer++) = temporary[--ii];
+    }
+    return digits;
+}
+
+/*
+ * Equivalent to snprintf(buffer, size, plus ? "%+.*e" : "%.*e", precision,
+ * value), which it uses whenever the fast conversion might round wrongly.
+ */
+static size_t exponential(char * buffer, size_t size, double value, int precision, int plus)
+{
+    char * bb = buffer;
+    double absolute = fabs(value);
+    double scaled = 0.0;
+    double whole;
+    double fraction;
+    uint64_t digits = 0;
+    int exponent = 0;
+    int power;
+    int tries;
+    int fast = !0;
+    size_t length;
+
+    if (!isfinite(value) || (precision > FAST)) {
+        fast = 0;
+    } else if (absolute == 0.0) {
+        /* Do nothing. */
+    } else {
+        exponent = (int)floor(log10(absolute));
+        /* The logarithm may be off by one near powers of ten. */
+        for (tries = 0; tries < 3; ++tries) {
+            power = precision - exponent;
+            if ((power > 22) || (power < -22)) {
+                fast = 0;
+                break;
+            }
+            scaled = (power >= 0) ? (absolute * POWERS[power]) : (absolute / POWERS[-power]);
+            if (scaled >= INTEGERS[precision + 1]) {
+                ++exponent;
+            } else if (scaled < INTEGERS[precision]) {
+                --exponent;
+            } else {
+                break;
+            }
+        }
+        if (tries >= 3) {
+            fast = 0;
+        }
+        if (fast) {
+            whole = floor(scaled);
+            fraction = scaled - whole;
+            /* Two units in the last place of slack either side of a tie. */
+            if (fabs(fraction - 0.5) <= (scaled * 0x1p-51)) {
+                fast = 0;
+            } else {
+                digits = (uint64_t)whole + ((fraction > 0.5) ? 1 : 0);
+                if (digits == INTEGERS[precision + 1]) {
+                    digits = INTEGERS[precision];
+                    ++exponent;
+                }
+            }
+        }
+    }
+
+    if (fast) {
+        char mantissa[24];
+        (void)decimal(mantissa, digits, precision + 1);
+        if (signbit(value)) {
+            *(bb++) = '-';
+        } else if (plus) {
+            *(bb++) = '+';
+        } else {
+            /* Do nothing. */
+        }
+        *(bb++) = mantissa[0];
+        if (precision > 0) {
+            *(bb++) = '.';
+            memcpy(bb, &(mantissa[1]), precision);
+            bb += precision;
+        }
+        *(bb++) = 'e';
+        *(bb++) = (exponent < 0) ? '-' : '+';
+        bb += decimal(bb, (exponent < 0) ? -exponent : exponent, 2);
+        length = bb - buffer;
+    } else {
+        length = snprintf(buffer, size, plus ? "%+.*e" : "%.*e", precision, value);
+    }
+
+    return length;
+}
+
+/*
+ * Right justifies the conversion in a field of WIDTH characters.
+ */
+static size_t field(char * buffer, double value, int precision, int plus)
+{
+    char temporary[PRECISION + 16];
+    size_t length = exponential(temporary, sizeof(temporary), value, precision, plus);
+    size_t pad = (length < (size_t)WIDTH) ? (WIDTH - length) : 0;
+    memset(buffer, ' ', pad);
+    memcpy(&(buffer[pad]), temporary, length);
+    return pad + length;
+}
+
+static size_t hexadecimal(char * buffer, double value)
+{
+    uint64_t bits;
+    int ii;
+    memcpy(&bits, &value, sizeof(bits));
+    buffer[0] = '0';
+    buffer[1] = 'x';
+    for (ii = 0; ii < 16; ++ii) {
+        buffer[17 - ii] = HEX[bits & 0xf];
+        bits >>= 4;
+    }
+    return 18;
+}
+
+/*******************************************************************************
+ * ROWS
+ ******************************************************************************/
+
+static size_t element(char * buffer, dirac_complex_t value, dirac_format_t format, int precision)
+{
+    char * bb = buffer;
+    *(bb++) = '(';
+    if (format == DIRAC_FORMAT_HEX) {
+        bb += hexadecimal(bb, creal(value));
+        *(bb++) = ',';
+        bb += hexadecimal(bb, cimag(value));
+    } else {
+        bb += field(bb, creal(value), precision, 0);
+        bb += field(bb, cimag(value), precision, !0);
+        *(bb++) = 'i';
+    }
+    *(bb++) = ')';
+    return bb - buffer;
+}
+
+/*
+ * Upper bound on the bytes element() produces, plus a " [column]".
+ */
+static size_t bound(int precision)
+{
+    return 64 + (2 * (precision + WIDTH + 16));
+}
+
+static size_t row(char * buffer, const dirac_t * that, size_t rr, const char * prefix, dirac_format_t format, int precision)
+{
+    char * bb = buffer;
+    const dirac_complex_t * tt = dirac_core_body_get(that);
+    const size_t * columns = (const size_t *)0;
+    const size_t * offsets = (const size_t *)0;
+    size_t length = strlen(prefix);
+    size_t begin;
+    size_t end;
+    size_t ii;
+
+    memcpy(bb, prefix, length);
+    bb += length;
+
+    if (dirac_core_is_array(that)) {
+        end = dirac_core_cols_get(that);
+        for (ii = 0; ii < end; ++ii) {
+            *(bb++) = ' ';
+            bb += element(bb, dirac_core_element(that, rr, ii), format, precision);
+        }
+    } else if (dirac_core_is_packed(that)) {
+        /* Packed rows store only the columns from the diagonal on. */
+        begin = dirac_core_packed_offset(dirac_core_cols_get(that), rr);
+        end = begin + (dirac_core_cols_get(that) - rr);
+        for (ii = begin; ii < end; ++ii) {
+            *(bb++) = ' ';
+            *(bb++) = '[';
+            bb += decimal(bb, rr + (ii - begin), 1);
+            *(bb++) = ']';
+            bb += element(bb, tt[ii], format, precision);
+        }
+    } else {
+        if (dirac_core_kind_get(that) == DIRAC_KIND_SPARSE) {
+            columns = dirac_core_sparse_columns_get(that);
+            offsets = dirac_core_sparse_offsets_get(that);
+        } else if (dirac_core_kind_get(that) == DIRAC_KIND_PERMUTATION) {
+            columns = dirac_core_permutation_columns_get(that);
+        }
+        /* Diagonals and permutations store exactly one element per row. */
+        begin = (offsets != (const size_t *)0) ? offsets[rr] : rr;
+        end = (offsets != (const size_t *)0) ? offsets[rr + 1] : (rr + 1);
+        for (ii = begin; ii < end; ++ii) {
+            *(bb++) = ' ';
+            *(bb++) = '[';
+            bb += decimal(bb, (columns != (const size_t *)0) ? columns[ii] : ii, 1);
+            *(bb++) = ']';
+            bb += element(bb, tt[ii], format, precision);
+        }
+    }
+
+    *(bb++) = '\n';
+
+    return bb - buffer;
+}
+
+/*
+ * Returns the most elements stored in any one row.
+ */
+static size_t widest(const dirac_t * that)
+{
+    size_t most = 1;
+    const size_t * offsets;
+    size_t rr;
+    if (dirac_core_is_array(that) || dirac_core_is_packed(that)) {
+        most = dirac_core_cols_get(that);
+    } else if (dirac_core_kind_get(that) == DIRAC_KIND_SPARSE) {
+        offsets = dirac_core_sparse_offsets_get(that);
+        for (rr = 0, most = 0; rr < dirac_core_rows_get(that); ++rr) {
+            if ((offsets[rr + 1] - offsets[rr]) > most) {
+                most = offsets[rr + 1] - offsets[rr];
+            }
+        }
+    } else {
+        /* Do nothing. */
+    }
+    return most;
+}
+
+static void rows(void * context, size_t begin, size_t end)
+{
+    dirac_formatting_t * formatting = (dirac_formatting_t *)context;
+    size_t ii;
+    for (ii = begin; ii < end; ++ii) {
+        formatting->lengths[ii] = row(&(formatting->buffer[ii * formatting->slot]), formatting->that, formatting->first + ii, formatting->prefix, formatting->format, formatting->precision);
+    }
+}
+
+/*******************************************************************************
+ * PRIVATE FORMATTING
+ ******************************************************************************/
+
+ssize_t dirac_core_format(FILE * fp, const dirac_t * that, dirac_format_t format, int precision)
+{
+    ssize_t total = -1;
+    dirac_formatting_t formatting = { that, (char *)0, (size_t *)0, (const char *)0, 0, 0, format, precision, };
+    uint64_t header[DIRAC_FILE_OFFSET / sizeof(uint64_t)];
+    char prefix[64];
+    dirac_t * temp = (dirac_t *)0;
+    size_t most;
+    size_t chunk;
+    size_t count;
+    size_t ii;
+    ssize_t rc;
+
+    do {
+
+        if ((precision < 0) || (precision > PRECISION)) {
+            errno = EINVAL;
+            break;
+        }
+
+        if (format == DIRAC_FORMAT_BINARY) {
+            /* A file holds its elements contiguously. */
+            if ((that = dirac_core_dense_get(that, &temp)) == (const dirac_t *)0) { break; }
+            dirac_core_file_header(header, &(that->data.head));
+            if (fwrite(header, sizeof(header), 1, fp) != 1) { break; }
+            count = dirac_core_length_get(that);
+            if (fwrite(dirac_core_body_get(that), 1, count, fp) != count) { break; }
+            total = sizeof(header) + count;
+            break;
+        }
+
+        if (dirac_core_is_dense(that)) {
+            rc = fprintf(fp, "dirac@%p: [%zu][%zu]\n", that, dirac_core_rows_get(that), dirac_core_cols_get(that));
+        } else {
+            rc = fprintf(fp, "dirac@%p: [%zu][%zu] %s [%zu]\n", that, dirac_core_rows_get(that), dirac_core_cols_get(that), KINDS[dirac_core_kind_get(that)], dirac_core_count_get(that));
+        }
+        if (rc < 0) { break; }
+        total = rc;
+
+        (void)snprintf(prefix, sizeof(prefix), " matrix@%p:", dirac_core_matrix_get(that));
+        formatting.prefix = prefix;
+        most = widest(that);
+        formatting.slot = strlen(prefix) + (most * bound(precision)) + 1;
+        chunk = CHUNK / formatting.slot;
+        if (chunk > dirac_core_rows_get(that)) { chunk = dirac_core_rows_get(that); }
+        if (chunk < 1) { chunk = 1; }
+
+        formatting.buffer = (char *)malloc(chunk * formatting.slot);
+        formatting.lengths = (size_t *)malloc(chunk * sizeof(size_t));
+        if ((formatting.buffer == (char *)0) || (formatting.lengths == (size_t *)0)) {
+            total = -1;
+            break;
+        }
+
+        for (formatting.first = 0; formatting.first < dirac_core_rows_get(that); formatting.first += count) {
+            count = dirac_core_rows_get(that) - formatting.first;
+            if (count > chunk) { count = chunk; }
+            /* Formatting an element costs something like a hundred multiply-accumulates. */
+            dirac_core_parallel(count, dirac_core_grain(most * 100), rows, &formatting);
+            for (ii = 0; ii < count; ++ii) {
+                if (fwrite(&(formatting.buffer[ii * formatting.slot]), 1, formatting.lengths[ii], fp) != formatting.lengths[ii]) {
+                    break;
+                }
+                total += formatting.lengths[ii];
+            }
+            if (ii < count) {
+                total = -1;
+                break;
+            }
+        }
+
+    } while (0);
+
+    free(formatting.lengths);
+    free(formatting.buffer);
+    (void)dirac_core_free(temp);
+
+    return total;
+}
+
+/*******************************************************************************
+ * PUBLIC FORMATTING
+ ******************************************************************************/
+
+ssize_t dirac_write(FILE * fp, const dirac_matrix_t * them, dirac_format_t format, int precision)
+{
+    ssize_t total = -1;
+    const dirac_t * that = dirac_core_object_get(them);
+    if (that == (const dirac_t *)0) {
+        errno = EINVAL;
+        diminuto_perror("dirac_write");
+    } else if ((total = dirac_core_format(fp, that, format, precision)) < 0) {
+        diminuto_perror("dirac_write");
+    } else {
+        /* Do nothing. */
+    }
+    return total;
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
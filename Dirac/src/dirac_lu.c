@@ -0,0 +1,568 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the LU factorization portions of Dirac.
+ * The factorization is recursive: each half of the columns is factored in
+ * turn, and the trailing half is brought up to date with one triangular
+ * solve and one matrix product, so nearly all of the work is in products
+ * of large blocks split across threads.
+ *
+ * REFERENCES
+ *
+ * S. Toledo, "Locality of Reference in LU Decomposition with Partial
+ * Pivoting", SIAM Journal on Matrix Analysis and Applications, 18.4, 1997
+ *
+ * G. Golub, C. Van Loan, MATRIX COMPUTATIONS, 4th ed., Johns Hopkins
+ * University Press, 2013, 3.2-3.4
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/*
+ * Columns of the target a matrix product updates at a time, so that the
+ * rows of the right operand it reads stay in cache.
+ */
+static const size_t TILE = 256;
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+struct DiracLu {
+    dirac_t * factors;
+    size_t * pivots;
+    int swaps;
+    int singular;
+};
+
+typedef struct DiracUpdate {
+    dirac_complex_t * cc;
+    const dirac_complex_t * aa;
+    const dirac_complex_t * bb;
+    size_t ldc;
+    size_t lda;
+    size_t ldb;
+    size_t muls;
+    size_t cols;
+} dirac_update_t;
+
+typedef struct DiracTriangle {
+    const dirac_complex_t * tt;
+    dirac_complex_t * bb;
+    size_t ldt;
+    size_t ldb;
+    size_t order;
+    int packed;
+} dirac_triangle_t;
+
+/*******************************************************************************
+ * KERNELS
+ ******************************************************************************/
+
+/*
+ * C -= A * B for rows [begin..end) of C, each array with its own row
+ * stride (leading dimension).
+ */
+static void update(void * context, size_t begin, size_t end)
+{
+    const dirac_update_t * updatep = (const dirac_update_t *)context;
+    const dirac_complex_t * restrict arow;
+    const dirac_complex_t * restrict brow;
+    dirac_complex_t * restrict crow;
+    dirac_complex_t factor;
+    size_t low;
+    size_t high;
+    size_t rr;
+    size_t mm;
+    size_t cc;
+
+    for (low = 0; low < updatep->cols; low += TILE) {
+        high = ((low + TILE) < updatep->cols) ? (low + TILE) : updatep->cols;
+        for (rr = begin; rr < end; ++rr) {
+            arow = &(updatep->aa[rr * updatep->lda]);
+            crow = &(updatep->cc[rr * updatep->ldc]);
+            for (mm = 0; mm < updatep->muls; ++mm) {
+                factor = arow[mm];
+                brow = &(updatep->bb[mm * updatep->ldb]);
+                for (cc = low; cc < high; ++cc) {
+                    crow[cc] -= factor * brow[cc];
+                }
+            }
+        }
+    }
+}
+
+static void subtract(dirac_complex_t * cc, size_t ldc, const dirac_complex_t * aa, size_t lda, const dirac_complex_t * bb, size_t ldb, size_t rows, size_t muls, size_t cols)
+{
+    dirac_update_t context = { cc, aa, bb, ldc, lda, ldb, muls, cols, };
+    dirac_core_parallel(rows, dirac_core_grain(muls * cols), update, &context);
+}
+
+/*
+ * B = L^-1 * B for columns [begin..end) of B, where L is the unit lower
+ * triangle of T.
+ */
+static void forward(void * context, size_t begin, size_t end)
+{
+    const dirac_triangle_t * trianglep = (const dirac_triangle_t *)context;
+    const dirac_complex_t * restrict trow;
+    const dirac_complex_t * restrict bjrow;
+    dirac_complex_t * restrict birow;
+    dirac_complex_t factor;
+    size_t ii;
+    size_t jj;
+    size_t cc;
+
+    for (ii = 1; ii < trianglep->order; ++ii) {
+        trow = &(trianglep->tt[ii * trianglep->ldt]);
+        birow = &(trianglep->bb[ii * trianglep->ldb]);
+        for (jj = 0; jj < ii; ++jj) {
+            factor = trow[jj];
+            if (factor == 0) {
+                continue;
+            }
+            bjrow = &(trianglep->bb[jj * trianglep->ldb]);
+            for (cc = begin; cc < end; ++cc) {
+                birow[cc] -= factor * bjrow[cc];
+            }
+        }
+    }
+}
+
+/*
+ * B = U^-1 * B for columns [begin..end) of B, where U is the upper
+ * triangle of T, either dense or packed.
+ */
+static void backward(void * context, size_t begin, size_t end)
+{
+    const dirac_triangle_t * trianglep = (const dirac_triangle_t *)context;
+    size_t order = trianglep->order;
+    const dirac_complex_t * restrict trow;
+    const dirac_complex_t * restrict bjrow;
+    dirac_complex_t * restrict birow;
+    dirac_complex_t factor;
+    size_t ii;
+    size_t jj;
+    size_t cc;
+
+    for (ii = order; ii > 0; --ii) {
+        if (trianglep->packed) {
+            trow = &(trianglep->tt[dirac_core_packed_offset(order, ii - 1) - (ii - 1)]);
+        } else {
+            trow = &(trianglep->tt[(ii - 1) * trianglep->ldt]);
+        }
+        birow = &(trianglep->bb[(ii - 1) * trianglep->ldb]);
+        for (jj = ii; jj < order; ++jj) {
+            factor = trow[jj];
+            if (factor == 0) {
+                continue;
+            }
+            bjrow = &(trianglep->bb[jj * trianglep->ldb]);
+            for (cc = begin; cc < end; ++cc) {
+                birow[cc] -= factor * bjrow[cc];
+            }
+        }
+        factor = 1.0 / trow[ii - 1];
+        for (cc = begin; cc < end; ++cc) {
+            birow[cc] *= factor;
+        }
+    }
+}
+
+/*
+ * Swaps rows I and PIVOTS[I] of the columns [0..COLS) of A for each I in
+ * [0..COUNT) in turn.
+ */
+static void interchange(dirac_complex_t * aa, size_t lda, size_t cols, const size_t * pivots, size_t count)
+{
+    dirac_complex_t swap;
+    size_t ii;
+    size_t cc;
+    for (ii = 0; ii < count; ++ii) {
+        if (pivots[ii] != ii) {
+            for (cc = 0; cc < cols; ++cc) {
+                swap = aa[(ii * lda) + cc];
+                aa[(ii * lda) + cc] = aa[(pivots[ii] * lda) + cc];
+                aa[(pivots[ii] * lda) + cc] = swap;
+            }
+        }
+    }
+}
+
+/*
+ * Factors the ROWS x COLS (ROWS >= COLS) panel A in place into P * L * U,
+ * leaving in PIVOTS the row each row was swapped with, counting from the
+ * top of the panel. Only the panel's own columns are swapped. Returns the
+ * number of zero pivots.
+ */
+static int factor(dirac_complex_t * aa, size_t lda, size_t rows, size_t cols, size_t * pivots)
+{
+    int singular = 0;
+    dirac_triangle_t triangle;
+    dirac_complex_t * a12;
+    dirac_complex_t * a21;
+    dirac_complex_t * a22;
+    dirac_complex_t pivot;
+    dirac_complex_t swap;
+    double largest;
+    double magnitude;
+    size_t half;
+    size_t best;
+    size_t ii;
+
+    if (cols == 1) {
+        best = 0;
+        largest = cabs(aa[0]);
+        for (ii = 1; ii < rows; ++ii) {
+            magnitude = cabs(aa[ii * lda]);
+            if (magnitude > largest) {
+                largest = magnitude;
+                best = ii;
+            }
+        }
+        pivots[0] = best;
+        swap = aa[0];
+        aa[0] = aa[best * lda];
+        aa[best * lda] = swap;
+        if (largest > 0.0) {
+            pivot = 1.0 / aa[0];
+            for (ii = 1; ii < rows; ++ii) {
+                aa[ii * lda] *= pivot;
+            }
+        } else {
+            singular = 1;
+        }
+    } else {
+        half = cols / 2;
+        a12 = &(aa[half]);
+        a21 = &(aa[half * lda]);
+        a22 = &(aa[(half * lda) + half]);
+        singular += factor(aa, lda, rows, half, pivots);
+        interchange(a12, lda, cols - half, pivots, half);
+        triangle.tt = aa;
+        triangle.bb = a12;
+        triangle.ldt = lda;
+        triangle.ldb = lda;
+        triangle.order = half;
+        triangle.packed = 0;
+        dirac_core_parallel(cols - half, dirac_core_grain(half * half), forward, &triangle);
+        subtract(a22, lda, a21, lda, a12, lda, rows - half, half, cols - half);
+        singular += factor(a22, lda, rows - half, cols - half, &(pivots[half]));
+        interchange(a21, lda, half, &(pivots[half]), cols - half);
+        for (ii = half; ii < cols; ++ii) {
+            pivots[ii] += half;
+        }
+    }
+
+    return singular;
+}
+
+/*******************************************************************************
+ * PRIVATE OPERATIONS
+ ******************************************************************************/
+
+int dirac_core_lu_factor(dirac_complex_t * aa, size_t order, size_t * pivots)
+{
+    return (order > 0) ? factor(aa, order, order, order, pivots) : 0;
+}
+
+void dirac_core_lu_solve(const dirac_complex_t * lu, const size_t * pivots, size_t order, dirac_complex_t * bb, size_t cols)
+{
+    dirac_triangle_t triangle = { lu, bb, order, cols, order, 0, };
+    interchange(bb, cols, cols, pivots, order);
+    dirac_core_parallel(cols, dirac_core_grain(order * order), forward, &triangle);
+    dirac_core_parallel(cols, dirac_core_grain(order * order), backward, &triangle);
+}
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+/*
+ * Returns a new dense copy of any kind of right hand side for LU, or null
+ * with errno set.
+ */
+static dirac_t * rhs(const dirac_lu_t * lu, const dirac_t * thatb)
+{
+    dirac_t * that = (dirac_t *)0;
+    if ((lu == (const dirac_lu_t *)0) || (thatb == (const dirac_t *)0)) {
+        errno = EINVAL;
+    } else if (dirac_core_rows_get(thatb) != dirac_core_rows_get(lu->factors)) {
+        errno = EINVAL;
+    } else if (lu->singular) {
+        errno = EDOM;
+    } else if ((that = dirac_core_allocate(dirac_core_rows_get(thatb), dirac_core_cols_get(thatb))) != (dirac_t *)0) {
+        dirac_core_expand(dirac_core_body_mut(that), thatb, 1.0);
+    } else {
+        /* Do nothing. */
+    }
+    return that;
+}
+
+static dirac_lu_t * decompose(const dirac_t * thata)
+{
+    dirac_lu_t * lu = (dirac_lu_t *)0;
+    size_t order;
+    size_t ii;
+
+    do {
+
+        if (thata == (const dirac_t *)0) {
+            errno = EINVAL;
+            break;
+        }
+
+        order = dirac_core_rows_get(thata);
+        if ((order == 0) || (dirac_core_cols_get(thata) != order)) {
+            errno = EINVAL;
+            break;
+        }
+
+        if ((lu = (dirac_lu_t *)malloc(sizeof(dirac_lu_t))) == (dirac_lu_t *)0) {
+            break;
+        }
+        lu->factors = dirac_core_allocate(order, order);
+        lu->pivots = (size_t *)malloc(order * sizeof(size_t));
+        if ((lu->factors == (dirac_t *)0) || (lu->pivots == (size_t *)0)) {
+            dirac_lu_delete(lu);
+            lu = (dirac_lu_t *)0;
+            break;
+        }
+
+        dirac_core_expand(dirac_core_body_mut(lu->factors), thata, 1.0);
+        lu->singular = dirac_core_lu_factor(dirac_core_body_mut(lu->factors), order, lu->pivots);
+        lu->swaps = 0;
+        for (ii = 0; ii < order; ++ii) {
+            if (lu->pivots[ii] != ii) {
+                ++lu->swaps;
+            }
+        }
+
+    } while (0);
+
+    return lu;
+}
+
+/*******************************************************************************
+ * PUBLIC FACTORIZATION
+ ******************************************************************************/
+
+dirac_lu_t * dirac_lu_new(const dirac_matrix_t * thema)
+{
+    dirac_lu_t * lu = decompose(dirac_core_object_get(thema));
+    if (lu == (dirac_lu_t *)0) {
+        diminuto_perror("dirac_lu_new");
+    }
+    return lu;
+}
+
+void dirac_lu_delete(dirac_lu_t * lu)
+{
+    if (lu != (dirac_lu_t *)0) {
+        (void)dirac_core_free(lu->factors);
+        free(lu->pivots);
+        free(lu);
+    }
+}
+
+const dirac_matrix_t * dirac_lu_factors_get(const dirac_lu_t * lu)
+{
+    return (lu != (const dirac_lu_t *)0) ? dirac_core_matrix_get(lu->factors) : (const dirac_matrix_t *)0;
+}
+
+const size_t * dirac_lu_pivots_get(const dirac_lu_t * lu)
+{
+    return (lu != (const dirac_lu_t *)0) ? lu->pivots : (const size_t *)0;
+}
+
+dirac_matrix_t * dirac_lu_solve(const dirac_lu_t * lu, const dirac_matrix_t * themb)
+{
+    dirac_t * that = rhs(lu, dirac_core_object_get(themb));
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_lu_solve");
+    } else {
+        dirac_core_lu_solve(dirac_core_body_get(lu->factors), lu->pivots, dirac_core_rows_get(that), dirac_core_body_mut(that), dirac_core_cols_get(that));
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_complex_t dirac_lu_det(const dirac_lu_t * lu)
+{
+    dirac_complex_t result = CMPLX(NAN, NAN);
+    const dirac_complex_t * tt;
+    size_t order;
+    size_t ii;
+    if (lu == (const dirac_lu_t *)0) {
+        errno = EINVAL;
+        diminuto_perror("dirac_lu_det");
+    } else {
+        tt = dirac_core_body_get(lu->factors);
+        order = dirac_core_rows_get(lu->factors);
+        result = ((lu->swaps % 2) == 0) ? 1.0 : -1.0;
+        for (ii = 0; ii < order; ++ii) {
+            result *= tt[(ii * order) + ii];
+        }
+    }
+    return result;
+}
+
+dirac_matrix_t * dirac_lu_inverse(const dirac_lu_t * lu)
+{
+    dirac_t * that = (dirac_t *)0;
+    dirac_complex_t * tt;
+    size_t order;
+    size_t ii;
+    if (lu == (const dirac_lu_t *)0) {
+        errno = EINVAL;
+    } else if (lu->singular) {
+        errno = EDOM;
+    } else if ((that = dirac_core_allocate(dirac_core_rows_get(lu->factors), dirac_core_rows_get(lu->factors))) != (dirac_t *)0) {
+        tt = dirac_core_body_mut(that);
+        order = dirac_core_rows_get(that);
+        for (ii = 0; ii < order; ++ii) {
+            tt[(ii * order) + ii] = 1.0;
+        }
+        dirac_core_lu_solve(dirac_core_body_get(lu->factors), lu->pivots, order, tt, order);
+    } else {
+        /* Do nothing. */
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_lu_inverse");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+/*******************************************************************************
+ * PUBLIC OPERATIONS
+ ******************************************************************************/
+
+dirac_matrix_t * dirac_matrix_solve(const dirac_matrix_t * thema, const dirac_matrix_t * themb)
+{
+    DIRAC_TRACE_BEGIN;
+    dirac_t * that = (dirac_t *)0;
+    dirac_lu_t * lu = decompose(dirac_core_object_get(thema));
+    if (lu != (dirac_lu_t *)0) {
+        if ((that = rhs(lu, dirac_core_object_get(themb))) != (dirac_t *)0) {
+            dirac_core_lu_solve(dirac_core_body_get(lu->factors), lu->pivots, dirac_core_rows_get(that), dirac_core_body_mut(that), dirac_core_cols_get(that));
+        }
+        dirac_lu_delete(lu);
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_matrix_solve");
+    }
+    DIRAC_TRACE_END(DIRAC_TRACE_SOLVE, dirac_core_object_get(thema), dirac_core_object_get(themb), that);
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_matrix_inv(const dirac_matrix_t * thema)
+{
+    DIRAC_TRACE_BEGIN;
+    dirac_matrix_t * them = (dirac_matrix_t *)0;
+    dirac_lu_t * lu = decompose(dirac_core_object_get(thema));
+    if (lu == (dirac_lu_t *)0) {
+        diminuto_perror("dirac_matrix_inv");
+    } else {
+        them = dirac_lu_inverse(lu);
+        dirac_lu_delete(lu);
+    }
+    DIRAC_TRACE_END(DIRAC_TRACE_INV, dirac_core_object_get(thema), (const dirac_t *)0, dirac_core_object_get(them));
+    return them;
+}
+
+dirac_complex_t dirac_matrix_det(const dirac_matrix_t * thema)
+{
+    DIRAC_TRACE_BEGIN;
+    dirac_complex_t result = CMPLX(NAN, NAN);
+    dirac_lu_t * lu = decompose(dirac_core_object_get(thema));
+    if (lu == (dirac_lu_t *)0) {
+        diminuto_perror("dirac_matrix_det");
+    } else {
+        result = dirac_lu_det(lu);
+        dirac_lu_delete(lu);
+    }
+    DIRAC_TRACE_END(DIRAC_TRACE_DET, dirac_core_object_get(thema), (const dirac_t *)0, (const dirac_t *)0);
+    return result;
+}
+
+dirac_matrix_t * dirac_triangular_solve(const dirac_matrix_t * themt, const dirac_matrix_t * themb)
+{
+    const dirac_t * thatt = dirac_core_object_get(themt);
+    const dirac_t * thatb = dirac_core_object_get(themb);
+    dirac_t * that = (dirac_t *)0;
+    dirac_triangle_t triangle;
+    size_t order;
+    size_t ii;
+
+    do {
+
+        if ((thatt == (const dirac_t *)0) || (thatb == (const dirac_t *)0)) {
+            errno = EINVAL;
+            break;
+        }
+
+        if (dirac_core_kind_get(thatt) != DIRAC_KIND_TRIANGULAR) {
+            errno = EINVAL;
+            break;
+        }
+
+        order = dirac_core_rows_get(thatt);
+        if (dirac_core_rows_get(thatb) != order) {
+            errno = EINVAL;
+            break;
+        }
+
+        for (ii = 0; ii < order; ++ii) {
+            if (dirac_core_body_get(thatt)[dirac_core_packed_offset(order, ii)] == 0) {
+                break;
+            }
+        }
+        if (ii < order) {
+            errno = EDOM;
+            break;
+        }
+
+        if ((that = dirac_core_allocate(order, dirac_core_cols_get(thatb))) == (dirac_t *)0) {
+            break;
+        }
+        dirac_core_expand(dirac_core_body_mut(that), thatb, 1.0);
+
+        triangle.tt = dirac_core_body_get(thatt);
+        triangle.bb = dirac_core_body_mut(that);
+        triangle.ldt = order;
+        triangle.ldb = dirac_core_cols_get(that);
+        triangle.order = order;
+        triangle.packed = !0;
+        dirac_core_parallel(triangle.ldb, dirac_core_grain(order * order / 2), backward, &triangle);
+
+    } while (0);
+
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_triangular_solve");
+    }
+
+    return dirac_core_matrix_mut(that);
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
@@ -0,0 +1,758 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the Matrix Market portions of Dirac. The
+ * file is mapped and the data following the size line is cut into chunks
+ * at line boundaries. One parallel pass counts the entries in each chunk,
+ * which tells every chunk where its entries go, and a second parallel
+ * pass parses them into place.
+ *
+ * REFERENCES
+ *
+ * R. Boisvert, R. Pozo, K. Remington, "The Matrix Market Exchange
+ * Formats: Initial Design", NISTIR 5935, 1996
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+typedef enum DiracMarketField {
+    FIELD_REAL      = 0,
+    FIELD_COMPLEX   = 1,
+    FIELD_INTEGER   = 2,
+    FIELD_PATTERN   = 3,
+} dirac_market_field_t;
+
+typedef enum DiracMarketSymmetry {
+    SYMMETRY_GENERAL    = 0,
+    SYMMETRY_SYMMETRIC  = 1,
+    SYMMETRY_SKEW       = 2,
+    SYMMETRY_HERMITIAN  = 3,
+} dirac_market_symmetry_t;
+
+typedef struct DiracMarket {
+    const char * end;
+    size_t rows;
+    size_t columns;
+    size_t entries;             /* Expected in the file. */
+    int coordinate;             /* Else array. */
+    dirac_market_field_t field;
+    dirac_market_symmetry_t symmetry;
+    size_t chunks;
+    const char ** starts;       /* CHUNKS + 1 boundaries. */
+    size_t * counts;            /* Entries in each chunk, then the first. */
+    int * failures;
+    dirac_complex_t * dense;    /* Parse into a dense body... */
+    size_t * is;                /* ...or into coordinate triples. */
+    size_t * js;
+    dirac_complex_t * values;
+} dirac_market_t;
+
+typedef struct DiracExport {
+    const dirac_t * that;
+    char * buffer;
+    size_t * lengths;
+    size_t first;               /* Entry in the matrix of the first slot. */
+} dirac_export_t;
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/* Nominal bytes of data per parsing chunk. */
+static const size_t CHUNK = 1 << 16;
+
+/* Longest line accepted. */
+static const size_t LINE = 512;
+
+/* Bytes per formatted entry and entries formatted before writing. */
+static const size_t SLOT = 128;
+static const size_t ENTRIES = 1 << 15;
+
+/*******************************************************************************
+ * LINES
+ ******************************************************************************/
+
+/*
+ * Copies the line at HERE into BUFFER without its newline, returning
+ * where the next line begins, or null if the line is too long.
+ */
+static const char * line(const char * here, const char * end, char * buffer)
+{
+    const char * newline = (const char *)memchr(here, '\n', end - here);
+    const char * next = (newline != (const char *)0) ? (newline + 1) : end;
+    size_t length = ((newline != (const char *)0) ? newline : end) - here;
+    if (length >= LINE) {
+        next = (const char *)0;
+    } else {
+        memcpy(buffer, here, length);
+        buffer[length] = '\0';
+    }
+    return next;
+}
+
+static int blank(const char * buffer)
+{
+    while (isspace((unsigned char)*buffer)) { ++buffer; }
+    return (*buffer == '\0') || (*buffer == '%');
+}
+
+static int integer(const char ** here, size_t * valuep)
+{
+    char * end;
+    unsigned long long value;
+    errno = 0;
+    value = strtoull(*here, &end, 10);
+    if ((end == *here) || (errno != 0)) { return 0; }
+    *here = end;
+    *valuep = value;
+    return !0;
+}
+
+static int real(const char ** here, double * valuep)
+{
+    char * end;
+    double value = strtod(*here, &end);
+    if (end == *here) { return 0; }
+    *here = end;
+    *valuep = value;
+    return !0;
+}
+
+/*
+ * Parses one entry. Array entries have no indices.
+ */
+static int parse(const dirac_market_t * market, const char * here, size_t * ip, size_t * jp, dirac_complex_t * valuep)
+{
+    int rc = 0;
+    double re = 1.0;
+    double im = 0.0;
+
+    do {
+
+        if (market->coordinate) {
+            if (!integer(&here, ip)) { break; }
+            if (!integer(&here, jp)) { break; }
+            if ((*ip < 1) || (*ip > market->rows)) { break; }
+            if ((*jp < 1) || (*jp > market->columns)) { break; }
+            --*ip;
+            --*jp;
+        }
+
+        if (market->field != FIELD_PATTERN) {
+            if (!real(&here, &re)) { break; }
+        }
+        if (market->field == FIELD_COMPLEX) {
+            if (!real(&here, &im)) { break; }
+        }
+
+        while (isspace((unsigned char)*here)) { ++here; }
+        if (*here != '\0') { break; }
+
+        *valuep = CMPLX(re, im);
+        rc = !0;
+
+    } while (0);
+
+    return rc;
+}
+
+/*******************************************************************************
+ * PLACEMENT
+ ******************************************************************************/
+
+/*
+ * Array files store a column at a time, and only the lower triangle
+ * (without the diagonal if skew-symmetric) of a symmetric matrix.
+ */
+static inline size_t top(const dirac_market_t * market, size_t column) {
+    return (market->symmetry == SYMMETRY_GENERAL) ? 0 : (market->symmetry == SYMMETRY_SKEW) ? (column + 1) : column;
+}
+
+static void locate(const dirac_market_t * market, size_t entry, size_t * ip, size_t * jp)
+{
+    size_t jj = 0;
+    while (entry >= (market->rows - top(market, jj))) {
+        entry -= market->rows - top(market, jj);
+        ++jj;
+    }
+    *ip = top(market, jj) + entry;
+    *jp = jj;
+}
+
+static inline void advance(const dirac_market_t * market, size_t * ip, size_t * jp) {
+    if (++*ip >= market->rows) {
+        ++*jp;
+        *ip = top(market, *jp);
+    }
+}
+
+static inline dirac_complex_t mirror(const dirac_market_t * market, dirac_complex_t value) {
+    return (market->symmetry == SYMMETRY_HERMITIAN) ? conj(value) : (market->symmetry == SYMMETRY_SKEW) ? -value : value;
+}
+
+static size_t expected(const dirac_market_t * market)
+{
+    size_t count = market->entries;
+    if (market->coordinate) {
+        /* Do nothing. */
+    } else if (market->symmetry == SYMMETRY_GENERAL) {
+        count = market->rows * market->columns;
+    } else if (market->symmetry == SYMMETRY_SKEW) {
+        count = (market->rows * (market->rows - 1)) / 2;
+    } else {
+        count = (market->rows * (market->rows + 1)) / 2;
+    }
+    return count;
+}
+
+/*******************************************************************************
+ * PASSES
+ ******************************************************************************/
+
+static void counting(void * context, size_t begin, size_t end)
+{
+    dirac_market_t * market = (dirac_market_t *)context;
+    char buffer[LINE];
+    const char * here;
+    size_t count;
+    size_t cc;
+    for (cc = begin; cc < end; ++cc) {
+        count = 0;
+        here = market->starts[cc];
+        while (here < market->starts[cc + 1]) {
+            here = line(here, market->starts[cc + 1], buffer);
+            if (here == (const char *)0) {
+                market->failures[cc] = !0;
+                break;
+            }
+            if (!blank(buffer)) {
+                ++count;
+            }
+        }
+        market->counts[cc] = count;
+    }
+}
+
+static void parsing(void * context, size_t begin, size_t end)
+{
+    dirac_market_t * market = (dirac_market_t *)context;
+    char buffer[LINE];
+    const char * here;
+    dirac_complex_t value;
+    size_t entry;
+    size_t ii = 0;
+    size_t jj = 0;
+    size_t cc;
+    for (cc = begin; cc < end; ++cc) {
+        entry = market->counts[cc];
+        if (!market->coordinate && (market->starts[cc] < market->starts[cc + 1])) {
+            locate(market, entry, &ii, &jj);
+        }
+        here = market->starts[cc];
+        while (here < market->starts[cc + 1]) {
+            here = line(here, market->starts[cc + 1], buffer);
+            if (blank(buffer)) {
+                continue;
+            }
+            if (!parse(market, buffer, &ii, &jj, &value)) {
+                market->failures[cc] = !0;
+                break;
+            }
+            if (market->dense != (dirac_complex_t *)0) {
+                market->dense[(ii * market->columns) + jj] = value;
+                if ((market->symmetry != SYMMETRY_GENERAL) && (ii != jj)) {
+                    market->dense[(jj * market->columns) + ii] = mirror(market, value);
+                }
+            } else {
+                market->is[entry] = ii;
+                market->js[entry] = jj;
+                market->values[entry] = value;
+            }
+            if (!market->coordinate) {
+                advance(market, &ii, &jj);
+            }
+            ++entry;
+        }
+    }
+}
+
+/*
+ * Builds a CSR matrix from the triples, which are first extended with the
+ * mirror image of every off-diagonal entry of a symmetric matrix. Two
+ * stable counting sorts, by column and then by row, leave each row sorted
+ * by column.
+ */
+static dirac_t * compress(dirac_market_t * market)
+{
+    dirac_t * that = (dirac_t *)0;
+    size_t * order = (size_t *)0;
+    size_t * cursors = (size_t *)0;
+    size_t * offsets;
+    size_t * columns;
+    dirac_complex_t * values;
+    size_t total = market->entries;
+    size_t ee;
+    size_t kk;
+    void * pointer;
+
+    do {
+
+        if (market->symmetry != SYMMETRY_GENERAL) {
+            for (ee = 0; ee < market->entries; ++ee) {
+                if (market->is[ee] != market->js[ee]) { ++total; }
+            }
+            if ((pointer = realloc(market->is, total * sizeof(size_t))) == (void *)0) { break; }
+            market->is = (size_t *)pointer;
+            if ((pointer = realloc(market->js, total * sizeof(size_t))) == (void *)0) { break; }
+            market->js = (size_t *)pointer;
+            if ((pointer = realloc(market->values, total * sizeof(dirac_complex_t))) == (void *)0) { break; }
+            market->values = (dirac_complex_t *)pointer;
+            for (ee = 0, kk = market->entries; ee < market->entries; ++ee) {
+                if (market->is[ee] == market->js[ee]) { continue; }
+                market->is[kk] = market->js[ee];
+                market->js[kk] = market->is[ee];
+                market->values[kk] = mirror(market, market->values[ee]);
+                ++kk;
+            }
+        }
+
+        order = (size_t *)malloc(total * sizeof(size_t) + 1);
+        cursors = (size_t *)calloc(((market->rows > market->columns) ? market->rows : market->columns) + 1, sizeof(size_t));
+        if ((order == (size_t *)0) || (cursors == (size_t *)0)) { break; }
+
+        that = dirac_core_allocate_kind(DIRAC_KIND_SPARSE, market->rows, market->columns, total);
+        if (that == (dirac_t *)0) { break; }
+        offsets = dirac_core_sparse_offsets_mut(that);
+        columns = dirac_core_sparse_columns_mut(that);
+        values = dirac_core_body_mut(that);
+
+        for (ee = 0; ee < total; ++ee) { ++cursors[market->js[ee] + 1]; }
+        for (kk = 0; kk < market->columns; ++kk) { cursors[kk + 1] += cursors[kk]; }
+        for (ee = 0; ee < total; ++ee) { order[cursors[market->js[ee]]++] = ee; }
+
+        for (ee = 0; ee < total; ++ee) { ++offsets[market->is[ee] + 1]; }
+        for (kk = 0; kk < market->rows; ++kk) { offsets[kk + 1] += offsets[kk]; }
+        memcpy(cursors, offsets, market->rows * sizeof(size_t));
+        for (kk = 0; kk < total; ++kk) {
+            ee = order[kk];
+            columns[cursors[market->is[ee]]] = market->js[ee];
+            values[cursors[market->is[ee]]++] = market->values[ee];
+        }
+
+    } while (0);
+
+    free(cursors);
+    free(order);
+
+    return that;
+}
+
+/*******************************************************************************
+ * HEADERS
+ ******************************************************************************/
+
+static const char * header(dirac_market_t * market, const char * here)
+{
+    char buffer[LINE];
+    char * tokens[5];
+    char * saved;
+    size_t count;
+    const char * next = (const char *)0;
+    const char * sizes;
+
+    do {
+
+        here = line(here, market->end, buffer);
+        if (here == (const char *)0) { break; }
+        for (count = 0; count < 5; ++count) {
+            tokens[count] = strtok_r((count == 0) ? buffer : (char *)0, " \t\r", &saved);
+            if (tokens[count] == (char *)0) { break; }
+        }
+        if (count != 5) { break; }
+        if (strcasecmp(tokens[0], "%%MatrixMarket") != 0) { break; }
+        if (strcasecmp(tokens[1], "matrix") != 0) { break; }
+
+        if (strcasecmp(tokens[2], "coordinate") == 0) {
+            market->coordinate = !0;
+        } else if (strcasecmp(tokens[2], "array") == 0) {
+            market->coordinate = 0;
+        } else {
+            break;
+        }
+
+        if (strcasecmp(tokens[3], "real") == 0) {
+            market->field = FIELD_REAL;
+        } else if (strcasecmp(tokens[3], "complex") == 0) {
+            market->field = FIELD_COMPLEX;
+        } else if (strcasecmp(tokens[3], "integer") == 0) {
+            market->field = FIELD_INTEGER;
+        } else if ((strcasecmp(tokens[3], "pattern") == 0) && market->coordinate) {
+            market->field = FIELD_PATTERN;
+        } else {
+            break;
+        }
+
+        if (strcasecmp(tokens[4], "general") == 0) {
+            market->symmetry = SYMMETRY_GENERAL;
+        } else if (strcasecmp(tokens[4], "symmetric") == 0) {
+            market->symmetry = SYMMETRY_SYMMETRIC;
+        } else if (strcasecmp(tokens[4], "skew-symmetric") == 0) {
+            market->symmetry = SYMMETRY_SKEW;
+        } else if (strcasecmp(tokens[4], "hermitian") == 0) {
+            market->symmetry = SYMMETRY_HERMITIAN;
+        } else {
+            break;
+        }
+
+        /* Comments may follow the banner; the size line is next. */
+        do {
+            if (here >= market->end) { here = (const char *)0; break; }
+            here = line(here, market->end, buffer);
+        } while ((here != (const char *)0) && blank(buffer));
+        if (here == (const char *)0) { break; }
+
+        sizes = buffer;
+        if (!integer(&sizes, &(market->rows))) { break; }
+        if (!integer(&sizes, &(market->columns))) { break; }
+        if (market->coordinate && !integer(&sizes, &(market->entries))) { break; }
+        while (isspace((unsigned char)*sizes)) { ++sizes; }
+        if (*sizes != '\0') { break; }
+
+        if ((market->rows == 0) || (market->columns == 0)) { break; }
+        if ((market->symmetry != SYMMETRY_GENERAL) && (market->rows != market->columns)) { break; }
+        market->entries = expected(market);
+
+        next = here;
+
+    } while (0);
+
+    return next;
+}
+
+/*******************************************************************************
+ * PUBLIC IMPORT
+ ******************************************************************************/
+
+dirac_matrix_t * dirac_market_read(const char * path, dirac_kind_t kind)
+{
+    dirac_t * that = (dirac_t *)0;
+    dirac_t * dense = (dirac_t *)0;
+    dirac_market_t market;
+    struct stat status;
+    void * base = MAP_FAILED;
+    const char * data;
+    size_t size = 0;
+    size_t total;
+    size_t count;
+    size_t cc;
+    int fd = -1;
+
+    memset(&market, 0, sizeof(market));
+
+    do {
+
+        if ((kind != DIRAC_KIND_DENSE) && (kind != DIRAC_KIND_SPARSE)) {
+            errno = EINVAL;
+            diminuto_perror("dirac_market_read");
+            break;
+        }
+
+        fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            diminuto_perror("dirac_market_read: open");
+            break;
+        }
+
+        if (fstat(fd, &status) < 0) {
+            diminuto_perror("dirac_market_read: fstat");
+            break;
+        }
+
+        size = status.st_size;
+        if (size == 0) {
+            errno = EINVAL;
+            diminuto_perror("dirac_market_read");
+            break;
+        }
+
+        base = mmap((void *)0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) {
+            diminuto_perror("dirac_market_read: mmap");
+            break;
+        }
+        (void)madvise(base, size, MADV_SEQUENTIAL);
+
+        market.end = (const char *)base + size;
+        data = header(&market, (const char *)base);
+        if (data == (const char *)0) {
+            errno = EINVAL;
+            diminuto_perror("dirac_market_read: header");
+            break;
+        }
+
+        /* Chunks begin at the first line that starts at or after each multiple of CHUNK. */
+        market.chunks = ((market.end - data) + CHUNK - 1) / CHUNK;
+        if (market.chunks == 0) { market.chunks = 1; }
+        market.starts = (const char **)malloc((market.chunks + 1) * sizeof(const char *));
+        market.counts = (size_t *)calloc(market.chunks, sizeof(size_t));
+        market.failures = (int *)calloc(market.chunks, sizeof(int));
+        if ((market.starts == (const char **)0) || (market.counts == (size_t *)0) || (market.failures == (int *)0)) {
+            diminuto_perror("dirac_market_read: malloc");
+            break;
+        }
+        market.starts[0] = data;
+        for (cc = 1; cc < market.chunks; ++cc) {
+            market.starts[cc] = data + (cc * CHUNK);
+            if (market.starts[cc] < market.starts[cc - 1]) {
+                market.starts[cc] = market.starts[cc - 1];
+            } else if (market.starts[cc][-1] != '\n') {
+                market.starts[cc] = (const char *)memchr(market.starts[cc], '\n', market.end - market.starts[cc]);
+                market.starts[cc] = (market.starts[cc] != (const char *)0) ? (market.starts[cc] + 1) : market.end;
+            } else {
+                /* Do nothing. */
+            }
+        }
+        market.starts[market.chunks] = market.end;
+
+        dirac_core_parallel(market.chunks, 1, counting, &market);
+
+        /* Turn the counts into the index of the first entry of each chunk. */
+        for (cc = 0, total = 0; cc < market.chunks; ++cc) {
+            if (market.failures[cc]) { break; }
+            count = market.counts[cc];
+            market.counts[cc] = total;
+            total += count;
+        }
+        if ((cc < market.chunks) || (total != market.entries)) {
+            errno = EINVAL;
+            diminuto_perror("dirac_market_read: entries");
+            break;
+        }
+
+        if ((kind == DIRAC_KIND_DENSE) || !market.coordinate) {
+            dense = dirac_core_allocate(market.rows, market.columns);
+            if (dense == (dirac_t *)0) {
+                diminuto_perror("dirac_market_read: allocate");
+                break;
+            }
+            market.dense = dirac_core_body_mut(dense);
+        } else {
+            market.is = (size_t *)malloc((market.entries * sizeof(size_t)) + 1);
+            market.js = (size_t *)malloc((market.entries * sizeof(size_t)) + 1);
+            market.values = (dirac_complex_t *)malloc((market.entries * sizeof(dirac_complex_t)) + 1);
+            if ((market.is == (size_t *)0) || (market.js == (size_t *)0) || (market.values == (dirac_complex_t *)0)) {
+                diminuto_perror("dirac_market_read: malloc");
+                break;
+            }
+        }
+
+        dirac_core_parallel(market.chunks, 1, parsing, &market);
+
+        for (cc = 0; cc < market.chunks; ++cc) {
+            if (market.failures[cc]) { break; }
+        }
+        if (cc < market.chunks) {
+            errno = EINVAL;
+            diminuto_perror("dirac_market_read: parse");
+            break;
+        }
+
+        if (kind == DIRAC_KIND_DENSE) {
+            that = dense;
+            dense = (dirac_t *)0;
+        } else if (dense != (dirac_t *)0) {
+            that = dirac_core_to_sparse(dense);
+        } else {
+            that = compress(&market);
+        }
+        if (that == (dirac_t *)0) {
+            diminuto_perror("dirac_market_read: sparse");
+            break;
+        }
+
+    } while (0);
+
+    dirac_core_free(dense);
+    free(market.values);
+    free(market.js);
+    free(market.is);
+    free(market.failures);
+    free(market.counts);
+    free(market.starts);
+    if (base != MAP_FAILED) {
+        (void)munmap(base, size);
+    }
+    if (fd >= 0) {
+        (void)close(fd);
+    }
+
+    return dirac_core_matrix_mut(that);
+}
+
+/*******************************************************************************
+ * EXPORT
+ ******************************************************************************/
+
+static size_t count_entries(const dirac_t * that)
+{
+    return dirac_core_count_get(that);
+}
+
+/*
+ * Dense matrices are written column by column as an array; everything
+ * else is written row by row as coordinates.
+ */
+static size_t format_entry(char * buffer, const dirac_t * that, size_t ee)
+{
+    const dirac_complex_t * tt = dirac_core_body_get(that);
+    const size_t * offsets;
+    size_t rows = dirac_core_rows_get(that);
+    size_t ii;
+    size_t jj;
+    size_t low;
+    size_t high;
+    size_t middle;
+    dirac_complex_t value;
+    int length;
+    if (dirac_core_is_array(that)) {
+        ii = ee % rows;
+        jj = ee / rows;
+        value = dirac_core_element(that, ii, jj);
+        length = snprintf(buffer, SLOT, "%.17g %.17g\n", creal(value), cimag(value));
+    } else {
+        if (dirac_core_kind_get(that) == DIRAC_KIND_SPARSE) {
+            /* The row is the last whose offset is not past the entry. */
+            offsets = dirac_core_sparse_offsets_get(that);
+            for (low = 0, high = rows; (high - low) > 1; ) {
+                middle = (low + high) / 2;
+                if (offsets[middle] <= ee) { low = middle; } else { high = middle; }
+            }
+            ii = low;
+            jj = dirac_core_sparse_columns_get(that)[ee];
+        } else if (dirac_core_kind_get(that) == DIRAC_KIND_PERMUTATION) {
+            ii = ee;
+            jj = dirac_core_permutation_columns_get(that)[ee];
+        } else if (dirac_core_is_packed(that)) {
+            /* The row is the last whose diagonal is not past the entry. */
+            for (low = 0, high = rows; (high - low) > 1; ) {
+                middle = (low + high) / 2;
+                if (dirac_core_packed_offset(rows, middle) <= ee) { low = middle; } else { high = middle; }
+            }
+            ii = low;
+            jj = low + (ee - dirac_core_packed_offset(rows, low));
+        } else {
+            ii = ee;
+            jj = ee;
+        }
+        if (dirac_core_kind_get(that) == DIRAC_KIND_HERMITIAN) {
+            /* Hermitian files store the lower triangle. */
+            length = snprintf(buffer, SLOT, "%zu %zu %.17g %.17g\n", jj + 1, ii + 1, creal(tt[ee]), -cimag(tt[ee]));
+        } else {
+            length = snprintf(buffer, SLOT, "%zu %zu %.17g %.17g\n", ii + 1, jj + 1, creal(tt[ee]), cimag(tt[ee]));
+        }
+    }
+    return length;
+}
+
+static void formatting(void * context, size_t begin, size_t end)
+{
+    dirac_export_t * export = (dirac_export_t *)context;
+    size_t ii;
+    for (ii = begin; ii < end; ++ii) {
+        export->lengths[ii] = format_entry(&(export->buffer[ii * SLOT]), export->that, export->first + ii);
+    }
+}
+
+/*******************************************************************************
+ * PUBLIC EXPORT
+ ******************************************************************************/
+
+ssize_t dirac_market_write(FILE * fp, const dirac_matrix_t * them)
+{
+    ssize_t total = -1;
+    dirac_export_t export = { dirac_core_object_get(them), (char *)0, (size_t *)0, 0, };
+    size_t count;
+    size_t ii;
+    int rc;
+
+    do {
+
+        if (export.that == (const dirac_t *)0) {
+            errno = EINVAL;
+            diminuto_perror("dirac_market_write");
+            break;
+        }
+
+        if (dirac_core_is_array(export.that)) {
+            rc = fprintf(fp, "%%%%MatrixMarket matrix array complex general\n%zu %zu\n", dirac_core_rows_get(export.that), dirac_core_cols_get(export.that));
+        } else if (dirac_core_kind_get(export.that) == DIRAC_KIND_HERMITIAN) {
+            rc = fprintf(fp, "%%%%MatrixMarket matrix coordinate complex hermitian\n%zu %zu %zu\n", dirac_core_rows_get(export.that), dirac_core_cols_get(export.that), count_entries(export.that));
+        } else {
+            rc = fprintf(fp, "%%%%MatrixMarket matrix coordinate complex general\n%zu %zu %zu\n", dirac_core_rows_get(export.that), dirac_core_cols_get(export.that), count_entries(export.that));
+        }
+        if (rc < 0) {
+            diminuto_perror("dirac_market_write: fprintf");
+            break;
+        }
+        total = rc;
+
+        export.buffer = (char *)malloc(ENTRIES * SLOT);
+        export.lengths = (size_t *)malloc(ENTRIES * sizeof(size_t));
+        if ((export.buffer == (char *)0) || (export.lengths == (size_t *)0)) {
+            diminuto_perror("dirac_market_write: malloc");
+            total = -1;
+            break;
+        }
+
+        for (export.first = 0; export.first < count_entries(export.that); export.first += count) {
+            count = count_entries(export.that) - export.first;
+            if (count > ENTRIES) { count = ENTRIES; }
+            /* Formatting an entry costs something like a hundred multiply-accumulates. */
+            dirac_core_parallel(count, dirac_core_grain(100), formatting, &export);
+            for (ii = 0; ii < count; ++ii) {
+                if (fwrite(&(export.buffer[ii * SLOT]), 1, export.lengths[ii], fp) != export.lengths[ii]) { break; }
+                total += export.lengths[ii];
+            }
+            if (ii < count) {
+                diminuto_perror("dirac_market_write: fwrite");
+                total = -1;
+                break;
+            }
+        }
+
+    } while (0);
+
+    free(export.lengths);
+    free(export.buffer);
+
+    return total;
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
@@ -16,8 +16,238 @@
 #include "com/diag/dirac/dirac.h"
 #include "com/diag/diminuto/diminuto_error.h"
 #include <errno.h>
+#include <stdlib.h>
+#include <string.h>
 #include "dirac.h"
 
+/*******************************************************************************
+ * KERNELS
+ ******************************************************************************/
+
+/*
+ * A strided operand is read through its strides, conjugating as it goes if
+ * it is a conjugate view. When the right operand runs down its columns
+ * faster than along its rows, as a transpose or an adjoint does, each
+ * element of the target is a dot product of a row and a column that are
+ * both walked with their shorter strides (i-j-k); otherwise the product
+ * is accumulated in the same i-k-j order as the dense kernel.
+ */
+static void mul_strided(dirac_t * that, const dirac_t * thata, const dirac_t * thatb)
+{
+    const dirac_complex_t * aa = dirac_core_body_get(thata);
+    const dirac_complex_t * bb = dirac_core_body_get(thatb);
+    dirac_complex_t * tt = dirac_core_body_mut(that);
+    size_t rows = dirac_core_rows_get(thata);
+    size_t muls = dirac_core_cols_get(thata);
+    size_t cols = dirac_core_cols_get(thatb);
+    size_t arows = dirac_core_rowstride_get(thata);
+    size_t acols = dirac_core_colstride_get(thata);
+    size_t brows = dirac_core_rowstride_get(thatb);
+    size_t bcols = dirac_core_colstride_get(thatb);
+    int aconj = dirac_core_is_conjugate(thata);
+    int bconj = dirac_core_is_conjugate(thatb);
+    const dirac_complex_t * arow;
+    const dirac_complex_t * brow;
+    const dirac_complex_t * bcol;
+    dirac_complex_t * trow;
+    dirac_complex_t factor;
+    dirac_complex_t sum;
+    size_t rr;
+    size_t mm;
+    size_t cc;
+    if (brows < bcols) {
+        for (rr = 0; rr < rows; ++rr) {
+            arow = &(aa[rr * arows]);
+            trow = &(tt[rr * cols]);
+            for (cc = 0; cc < cols; ++cc) {
+                bcol = &(bb[cc * bcols]);
+                sum = 0;
+                if (bconj) {
+                    for (mm = 0; mm < muls; ++mm) {
+                        sum += (aconj ? conj(arow[mm * acols]) : arow[mm * acols]) * conj(bcol[mm * brows]);
+                    }
+                } else {
+                    for (mm = 0; mm < muls; ++mm) {
+                        sum += (aconj ? conj(arow[mm * acols]) : arow[mm * acols]) * bcol[mm * brows];
+                    }
+                }
+                trow[cc] = sum;
+            }
+        }
+    } else {
+        for (rr = 0; rr < rows; ++rr) {
+            trow = &(tt[rr * cols]);
+            for (cc = 0; cc < cols; ++cc) {
+                trow[cc] = 0;
+            }
+            for (mm = 0; mm < muls; ++mm) {
+                factor = aa[(rr * arows) + (mm * acols)];
+                if (aconj) { factor = conj(factor); }
+                brow = &(bb[mm * brows]);
+                if (bconj) {
+                    for (cc = 0; cc < cols; ++cc) {
+                        trow[cc] += factor * conj(brow[cc * bcols]);
+                    }
+                } else {
+                    for (cc = 0; cc < cols; ++cc) {
+                        trow[cc] += factor * brow[cc * bcols];
+                    }
+                }
+            }
+        }
+    }
+}
+
+/*
+ * The product is accumulated row by row in i-k-j order so that the inner
+ * loop walks both the right operand and the target with unit stride.
+ * Square 2x2, 4x4 and 8x8 operators, applied to a matrix of the same size
+ * or to a column vector, use the fully unrolled kernels instead.
+ */
+dirac_t * dirac_core_mul_into(dirac_t * that, const dirac_t * thata, const dirac_t * thatb)
+{
+    const dirac_complex_t * aa = dirac_core_body_get(thata);
+    const dirac_complex_t * bb = dirac_core_body_get(thatb);
+    dirac_complex_t * tt = dirac_core_body_mut(that);
+    size_t rows = dirac_core_rows_get(thata);
+    size_t muls = dirac_core_cols_get(thata);
+    size_t cols = dirac_core_cols_get(thatb);
+    const dirac_complex_t * arow;
+    const dirac_complex_t * brow;
+    dirac_complex_t * trow;
+    dirac_complex_t factor;
+    size_t rr;
+    size_t mm;
+    size_t cc;
+    if (dirac_core_is_strided(thata) || dirac_core_is_strided(thatb)) {
+        mul_strided(that, thata, thatb);
+    } else if (dirac_core_mul_fixed(that, thata, thatb) == (dirac_t *)0) {
+        for (rr = 0; rr < rows; ++rr) {
+            arow = &(aa[rr * muls]);
+            trow = &(tt[rr * cols]);
+            for (cc = 0; cc < cols; ++cc) {
+                trow[cc] = 0;
+            }
+            for (mm = 0; mm < muls; ++mm) {
+                factor = arow[mm];
+                brow = &(bb[mm * cols]);
+                for (cc = 0; cc < cols; ++cc) {
+                    trow[cc] += factor * brow[cc];
+                }
+            }
+        }
+    }
+    return that;
+}
+
+void dirac_core_apply(void * context, size_t begin, size_t end)
+{
+    const dirac_core_apply_t * applyp = (const dirac_core_apply_t *)context;
+    const dirac_t * thata = applyp->thata;
+    const dirac_complex_t * restrict aa = dirac_core_body_get(thata);
+    const dirac_complex_t * restrict xx = applyp->xx;
+    dirac_complex_t * restrict yy = applyp->yy;
+    size_t cols = dirac_core_cols_get(thata);
+    const size_t * restrict columns;
+    const size_t * restrict offsets;
+    const dirac_complex_t * restrict acol;
+    size_t rowstride;
+    size_t colstride;
+    int conjugate;
+    dirac_complex_t sum;
+    size_t rr;
+    size_t ii;
+
+    switch (dirac_core_kind_get(thata)) {
+
+    case DIRAC_KIND_DENSE:
+        for (rr = begin; rr < end; ++rr) {
+            sum = 0;
+            for (ii = 0; ii < cols; ++ii) {
+                sum += aa[(rr * cols) + ii] * xx[ii];
+            }
+            yy[rr] = applyp->factor * sum;
+        }
+        break;
+
+    case DIRAC_KIND_SPARSE:
+        columns = dirac_core_sparse_columns_get(thata);
+        offsets = dirac_core_sparse_offsets_get(thata);
+        for (rr = begin; rr < end; ++rr) {
+            sum = 0;
+            for (ii = offsets[rr]; ii < offsets[rr + 1]; ++ii) {
+                sum += aa[ii] * xx[columns[ii]];
+            }
+            yy[rr] = applyp->factor * sum;
+        }
+        break;
+
+    case DIRAC_KIND_DIAGONAL:
+        for (rr = begin; rr < end; ++rr) {
+            yy[rr] = applyp->factor * aa[rr] * xx[rr];
+        }
+        break;
+
+    case DIRAC_KIND_PERMUTATION:
+        columns = dirac_core_permutation_columns_get(thata);
+        for (rr = begin; rr < end; ++rr) {
+            yy[rr] = applyp->factor * aa[rr] * xx[columns[rr]];
+        }
+        break;
+
+    case DIRAC_KIND_HERMITIAN:
+    case DIRAC_KIND_TRIANGULAR:
+        dirac_core_packed_apply(yy, thata, xx, 1, begin, end);
+        for (rr = begin; rr < end; ++rr) {
+            yy[rr] *= applyp->factor;
+        }
+        break;
+
+    case DIRAC_KIND_STRIDED:
+        rowstride = dirac_core_rowstride_get(thata);
+        colstride = dirac_core_colstride_get(thata);
+        conjugate = dirac_core_is_conjugate(thata);
+        if (rowstride < colstride) {
+            /* A transpose or adjoint is walked down its columns. */
+            for (rr = begin; rr < end; ++rr) {
+                yy[rr] = 0;
+            }
+            for (ii = 0; ii < cols; ++ii) {
+                acol = &(aa[ii * colstride]);
+                for (rr = begin; rr < end; ++rr) {
+                    yy[rr] += (conjugate ? conj(acol[rr * rowstride]) : acol[rr * rowstride]) * xx[ii];
+                }
+            }
+            for (rr = begin; rr < end; ++rr) {
+                yy[rr] *= applyp->factor;
+            }
+        } else {
+            for (rr = begin; rr < end; ++rr) {
+                sum = 0;
+                for (ii = 0; ii < cols; ++ii) {
+                    sum += (conjugate ? conj(aa[(rr * rowstride) + (ii * colstride)]) : aa[(rr * rowstride) + (ii * colstride)]) * xx[ii];
+                }
+                yy[rr] = applyp->factor * sum;
+            }
+        }
+        break;
+
+    }
+}
+
+size_t dirac_core_apply_grain(const dirac_t * thata)
+{
+    size_t grain;
+    if (dirac_core_kind_get(thata) == DIRAC_KIND_SPARSE) {
+        grain = dirac_core_grain((dirac_core_count_get(thata) / dirac_core_rows_get(thata)) + 1);
+    } else if (dirac_core_is_array(thata) || dirac_core_is_packed(thata)) {
+        grain = dirac_core_grain(dirac_core_cols_get(thata));
+    } else {
+        grain = dirac_core_grain(1);
+    }
+    return grain;
+}
+
 /*******************************************************************************
  * OPERATIONS
  ******************************************************************************/
@@ -33,150 +263,185 @@
 
 dirac_matrix_t * dirac_matrix_dup(const dirac_matrix_t * thema)
 {
+    DIRAC_TRACE_BEGIN;
     const dirac_t * thata = dirac_core_object_get(thema);
 	dirac_t * that = dirac_core_dup(thata); 
     if (that == (dirac_t *)0) {
         diminuto_perror("dirac_matrix_dup");
+    } else if (dirac_core_is_strided(thata)) {
+        dirac_core_expand(dirac_core_body_mut(that), thata, 1.0);
     } else {
-        const dirac_complex_t * aa = dirac_core_body_get(thata);
-        dirac_complex_t * tt = dirac_core_body_mut(that);
-        size_t rows = dirac_core_rows_get(thata);
-        size_t cols = dirac_core_cols_get(thata);
-        int rr;
-        int cc;
-        int ii;
-        for (rr = 0; rr < rows; ++rr) {
-            for (cc = 0; cc < cols; ++cc) {
-                ii = dirac_core_index(thata, rr, cc);
-                (tt)[ii] = (aa)[ii];
-            }
-        }
+        memcpy(dirac_core_body_mut(that), dirac_core_body_get(thata), dirac_core_length_get(thata));
     } 
+
+    DIRAC_TRACE_END(DIRAC_TRACE_DUP, dirac_core_object_get(thema), (const dirac_t *)0, that);
 	return dirac_core_matrix_mut(that);
 }
 
+dirac_matrix_t * dirac_matrix_cow(const dirac_matrix_t * thema)
+{
+    dirac_t * that = dirac_core_object_mut((dirac_matrix_t *)thema);
+    if ((that == (dirac_t *)0) || dirac_core_is_mapped(that) || (__atomic_load_n(&(that->data.head.references), __ATOMIC_RELAXED) == 0)) {
+        errno = EINVAL;
+        diminuto_perror("dirac_matrix_cow");
+        that = (dirac_t *)0;
+    } else {
+        __atomic_add_fetch(&(that->data.head.references), 1, __ATOMIC_RELAXED);
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_matrix_own(dirac_matrix_t * them)
+{
+    dirac_t * that = dirac_core_object_mut(them);
+    dirac_matrix_t * result = (dirac_matrix_t *)0;
+    if (that == (dirac_t *)0) {
+        errno = EINVAL;
+        diminuto_perror("dirac_matrix_own");
+    } else if (__atomic_load_n(&(that->data.head.references), __ATOMIC_ACQUIRE) <= 1) {
+        /* Only the caller holds it, so it may be written in place. */
+        result = them;
+    } else if ((result = dirac_matrix_dup(them)) != (dirac_matrix_t *)0) {
+        dirac_delete(them);
+    } else {
+        /* Do nothing. */
+    }
+    return result;
+}
+
 dirac_matrix_t * dirac_matrix_trn(const dirac_matrix_t * thema)
 {
+    DIRAC_TRACE_BEGIN;
     const dirac_t * thata = dirac_core_object_get(thema);
-	dirac_t * that = dirac_core_trn(thata); 
-    if (that == (dirac_t *)0) {
+	dirac_t * that = (dirac_t *)0;
+    if (dirac_core_is_structured(thata)) {
+        if ((that = dirac_core_trn_structured(thata)) == (dirac_t *)0) {
+            diminuto_perror("dirac_matrix_trn");
+        }
+    } else if ((that = dirac_core_trn(thata)) == (dirac_t *)0) {
         diminuto_perror("dirac_matrix_trn");
     } else {
-        const dirac_complex_t * aa = dirac_core_body_get(thata);
         dirac_complex_t * tt = dirac_core_body_mut(that);
         size_t rows = dirac_core_rows_get(thata);
         size_t cols = dirac_core_cols_get(thata);
         int rr;
         int cc;
-        int ii;
         int jj;
         for (rr = 0; rr < rows; ++rr) {
             for (cc = 0; cc < cols; ++cc) {
-                ii = dirac_core_index(thata, rr, cc);
                 jj = dirac_core_index(that, cc, rr);
-                (tt)[jj] = (aa)[ii];
+                (tt)[jj] = dirac_core_element(thata, rr, cc);
             }
         }
     } 
+
+    DIRAC_TRACE_END(DIRAC_TRACE_TRN, dirac_core_object_get(thema), (const dirac_t *)0, that);
 	return dirac_core_matrix_mut(that);
 }
 
 dirac_matrix_t * dirac_matrix_add(const dirac_matrix_t * thema, const dirac_matrix_t * themb)
 {
+    DIRAC_TRACE_BEGIN;
     const dirac_t * thata = dirac_core_object_get(thema);
     const dirac_t * thatb = dirac_core_object_get(themb);
 	dirac_t * that = dirac_core_sum(thata, thatb);
     if (that == (dirac_t *)0) {
         diminuto_perror("dirac_matrix_add");
     } else {
-        const dirac_complex_t * aa = dirac_core_body_get(thata);
-        const dirac_complex_t * bb = dirac_core_body_get(thatb);
         dirac_complex_t * tt = dirac_core_body_mut(that);
         size_t rows = dirac_core_rows_get(that);
         size_t cols = dirac_core_cols_get(that);
         int rr;
         int cc;
-        int ii;
         for (rr = 0; rr < rows; ++rr) {
             for (cc = 0; cc < cols; ++cc) {
-                ii = dirac_core_index(that, rr, cc);
-                (tt)[ii] = (aa)[ii] + (bb)[ii];
+                (tt)[dirac_core_index(that, rr, cc)] = dirac_core_element(thata, rr, cc) + dirac_core_element(thatb, rr, cc);
             }
         }
     } 
+
+    DIRAC_TRACE_END(DIRAC_TRACE_ADD, dirac_core_object_get(thema), dirac_core_object_get(themb), that);
 	return dirac_core_matrix_mut(that);
 }
 
 dirac_matrix_t * dirac_matrix_sub(const dirac_matrix_t * thema, const dirac_matrix_t * themb)
 {
+    DIRAC_TRACE_BEGIN;
     const dirac_t * thata = dirac_core_object_get(thema);
     const dirac_t * thatb = dirac_core_object_get(themb);
 	dirac_t * that = dirac_core_sum(thata, thatb);
     if (that == (dirac_t *)0) {
         diminuto_perror("dirac_matrix_sub");
     } else {
-        const dirac_complex_t * aa = dirac_core_body_get(thata);
-        const dirac_complex_t * bb = dirac_core_body_get(thatb);
         dirac_complex_t * tt = dirac_core_body_mut(that);
         size_t rows = dirac_core_rows_get(that);
         size_t cols = dirac_core_cols_get(that);
         int rr;
         int cc;
-        int ii;
         for (rr = 0; rr < rows; ++rr) {
             for (cc = 0; cc < cols; ++cc) {
-                ii = dirac_core_index(that, rr, cc);
-                (tt)[ii] = (aa)[ii] - (bb)[ii];
+                (tt)[dirac_core_index(that, rr, cc)] = dirac_core_element(thata, rr, cc) - dirac_core_element(thatb, rr, cc);
             }
         }
     } 
+
+    DIRAC_TRACE_END(DIRAC_TRACE_SUB, dirac_core_object_get(thema), dirac_core_object_get(themb), that);
 	return dirac_core_matrix_mut(that);
 }
 
 dirac_matrix_t * dirac_matrix_mul(const dirac_matrix_t * thema, const dirac_matrix_t * themb)
 {
+    DIRAC_TRACE_BEGIN;
     const dirac_t * thata = dirac_core_object_get(thema);
     const dirac_t * thatb = dirac_core_object_get(themb);
-	dirac_t * that = dirac_core_pro(thata, thatb);
+	dirac_t * that = (dirac_t *)0;
+    dirac_t * tempa = (dirac_t *)0;
+    dirac_t * tempb = (dirac_t *)0;
+    if (!dirac_core_is_array(thata) || !dirac_core_is_array(thatb)) {
+        /* A strided view paired with any other kind is gathered first. */
+        thata = dirac_core_dense_get(thata, &tempa);
+        thatb = dirac_core_dense_get(thatb, &tempb);
+    }
+    if ((thata == (const dirac_t *)0) || (thatb == (const dirac_t *)0)) {
+        /* Do nothing. */
+    } else if (dirac_core_is_array(thata) && dirac_core_is_array(thatb)) {
+        if ((that = dirac_core_pro(thata, thatb)) != (dirac_t *)0) {
+            (void)dirac_core_mul_into(that, thata, thatb);
+        }
+    } else if (dirac_core_is_packed(thata) || dirac_core_is_packed(thatb)) {
+        that = dirac_core_mul_packed(thata, thatb);
+    } else if ((dirac_core_kind_get(thata) == DIRAC_KIND_SPARSE) || (dirac_core_kind_get(thatb) == DIRAC_KIND_SPARSE)) {
+        that = dirac_core_mul_sparse(thata, thatb);
+    } else {
+        that = dirac_core_mul_structured(thata, thatb);
+    }
+    (void)dirac_core_free(tempb);
+    (void)dirac_core_free(tempa);
     if (that == (dirac_t *)0) {
         diminuto_perror("dirac_matrix_mul");
-    } else {
-        const dirac_complex_t * aa = dirac_core_body_get(thata);
-        const dirac_complex_t * bb = dirac_core_body_get(thatb);
-        dirac_complex_t * tt = dirac_core_body_mut(that);
-        size_t rows = dirac_core_rows_get(thata);
-        size_t muls = dirac_core_rows_get(thatb);
-        size_t cols = dirac_core_cols_get(thatb);
-        int rr;
-        int mm;
-        int cc;
-        int ii;
-        int jj;
-        int kk;
-        for (rr = 0; rr < rows; ++rr) {
-            for (mm = 0; mm < muls; ++rr) {
-                for (cc = 0; cc < cols; ++cc) {
-                    ii = dirac_core_index(thata, rr, mm);
-                    jj = dirac_core_index(thatb, mm, cc);
-                    kk = dirac_core_index(that, rr, cc);
-                    (tt)[kk] = (aa)[ii] * (bb)[jj];
-                }
-            }
-        }
-    } 
+    }
+
+    DIRAC_TRACE_END(DIRAC_TRACE_MUL, dirac_core_object_get(thema), dirac_core_object_get(themb), that);
 	return dirac_core_matrix_mut(that);
 }
 
 dirac_matrix_t * dirac_matrix_kro(const dirac_matrix_t * thema, const dirac_matrix_t * themb)
 {
+    DIRAC_TRACE_BEGIN;
     const dirac_t * thata = dirac_core_object_get(thema);
     const dirac_t * thatb = dirac_core_object_get(themb);
-	dirac_t * that = dirac_core_kro(thata, thatb);
-    if (that == (dirac_t *)0) {
-        diminuto_perror("dirac_matrix_mul");
+	dirac_t * that = (dirac_t *)0;
+    if (dirac_core_is_structured(thata) && dirac_core_is_structured(thatb)) {
+        if ((that = dirac_core_kro_structured(thata, thatb)) == (dirac_t *)0) {
+            diminuto_perror("dirac_matrix_kro");
+        }
+    } else if (!dirac_core_is_array(thata) || !dirac_core_is_array(thatb)) {
+        if ((that = dirac_core_kro_sparse(thata, thatb)) == (dirac_t *)0) {
+            diminuto_perror("dirac_matrix_kro");
+        }
+    } else if ((that = dirac_core_kro(thata, thatb)) == (dirac_t *)0) {
+        diminuto_perror("dirac_matrix_kro");
     } else {
-        const dirac_complex_t * aa = dirac_core_body_get(thata);
-        const dirac_complex_t * bb = dirac_core_body_get(thatb);
         dirac_complex_t * tt = dirac_core_body_mut(that);
         size_t rowsa = dirac_core_rows_get(thata);
         size_t colsa = dirac_core_cols_get(thata);
@@ -188,8 +453,6 @@ dirac_matrix_t * dirac_matrix_kro(const dirac_matrix_t * thema, const dirac_matr
         int bc;
         int tr;
         int tc;
-        int ai;
-        int bi;
         int ti;
         for (ar = 0; ar < rowsa; ++ar) {
             for (ac = 0; ac < colsa; ++ac) {
@@ -197,42 +460,476 @@ dirac_matrix_t * dirac_matrix_kro(const dirac_matrix_t * thema, const dirac_matr
                     for (bc = 0; bc < colsb; ++bc) {
                         tr = (ar * rowsb) + br;
                         tc = (ac * colsb) + bc;
-                        ai = dirac_core_index(thata, ar, ac);
-                        bi = dirac_core_index(thatb, br, bc);
                         ti = dirac_core_index(that, tr, tc);
-                        (tt)[ti] = (aa)[ai] * (bb)[bi];
+                        (tt)[ti] = dirac_core_element(thata, ar, ac) * dirac_core_element(thatb, br, bc);
                     }
                 }
             }
         }
     }
+
+    DIRAC_TRACE_END(DIRAC_TRACE_KRO, dirac_core_object_get(thema), dirac_core_object_get(themb), that);
     return dirac_core_matrix_mut(that);
 }
 
 dirac_matrix_t * dirac_matrix_had(const dirac_matrix_t * thema, const dirac_matrix_t * themb)
 {
+    DIRAC_TRACE_BEGIN;
     const dirac_t * thata = dirac_core_object_get(thema);
     const dirac_t * thatb = dirac_core_object_get(themb);
 	dirac_t * that = dirac_core_had(thata, thatb);
     if (that == (dirac_t *)0) {
         diminuto_perror("dirac_matrix_had");
     } else {
-        const dirac_complex_t * aa = dirac_core_body_get(thata);
-        const dirac_complex_t * bb = dirac_core_body_get(thatb);
         dirac_complex_t * tt = dirac_core_body_mut(that);
         size_t rows = dirac_core_rows_get(thata);
-        size_t muls = dirac_core_rows_get(thatb);
         size_t cols = dirac_core_cols_get(thatb);
         int rr;
         int cc;
-        int ii;
-        for (rr = 0; ii < rows; ++rr) {
+        for (rr = 0; rr < rows; ++rr) {
             for (cc = 0; cc < cols; ++cc) {
-                ii = dirac_core_index(that, rr, cc);
-                (tt)[ii] = (aa)[ii] * (bb)[ii];
+                (tt)[dirac_core_index(that, rr, cc)] = dirac_core_element(thata, rr, cc) * dirac_core_element(thatb, rr, cc);
+            }
+        }
+    }
+
+    DIRAC_TRACE_END(DIRAC_TRACE_HAD, dirac_core_object_get(thema), dirac_core_object_get(themb), that);
+    return dirac_core_matrix_mut(that);
+}
+
+/*******************************************************************************
+ * CHAINS
+ ******************************************************************************/
+
+/*
+ * A chain product A0*A1*...An-1 is ordered using the classic dynamic
+ * programming solution to the matrix chain problem, minimizing the number
+ * of complex multiply-accumulates. Intermediate products are computed
+ * into work buffers drawn once from the cache, sized to the largest
+ * intermediate in the plan, and reused; a buffer is not acquired until its
+ * operands are complete, so left-deep, right-deep, and paired plans need
+ * only two ping-pong buffers. Bushier plans draw one more buffer per level.
+ * Only the final product is allocated at its exact shape and returned.
+ */
+
+typedef struct DiracChain {
+    const dirac_t ** operands;
+    size_t * split;
+    dirac_t ** pool;
+    size_t count;
+    size_t pooled;
+    size_t available;
+    size_t capacity;
+} dirac_chain_t;
+
+static inline size_t chain_rows(const dirac_chain_t * chainp, size_t ii) {
+    return dirac_core_rows_get(chainp->operands[ii]);
+}
+
+static inline size_t chain_cols(const dirac_chain_t * chainp, size_t jj) {
+    return dirac_core_cols_get(chainp->operands[jj]);
+}
+
+static dirac_t * chain_acquire(dirac_chain_t * chainp, size_t rows, size_t cols)
+{
+    dirac_t * that = (dirac_t *)0;
+    if (chainp->available > 0) {
+        that = chainp->pool[--chainp->available];
+    } else if (chainp->pooled < chainp->count) {
+        that = dirac_core_allocate(1, chainp->capacity);
+        if (that != (dirac_t *)0) {
+            ++chainp->pooled;
+        }
+    } else {
+        errno = ENOMEM;
+    }
+    if (that != (dirac_t *)0) {
+        that->data.head.rows = rows;
+        that->data.head.columns = cols;
+    }
+    return that;
+}
+
+static void chain_release(dirac_chain_t * chainp, const dirac_t * that, size_t ii, size_t jj)
+{
+    if (ii != jj) {
+        chainp->pool[chainp->available++] = (dirac_t *)that;
+    }
+}
+
+static size_t chain_largest(const dirac_chain_t * chainp, size_t ii, size_t jj)
+{
+    size_t largest = 0;
+    size_t kk;
+    size_t left;
+    size_t right;
+    if ((ii != jj) && !((ii == 0) && (jj == (chainp->count - 1)))) {
+        largest = chain_rows(chainp, ii) * chain_cols(chainp, jj);
+    }
+    if (ii != jj) {
+        kk = chainp->split[(ii * chainp->count) + jj];
+        left = chain_largest(chainp, ii, kk);
+        right = chain_largest(chainp, kk + 1, jj);
+        if (left > largest) { largest = left; }
+        if (right > largest) { largest = right; }
+    }
+    return largest;
+}
+
+static const dirac_t * chain_evaluate(dirac_chain_t * chainp, size_t ii, size_t jj, dirac_t * target)
+{
+    const dirac_t * that = (const dirac_t *)0;
+    const dirac_t * left = (const dirac_t *)0;
+    const dirac_t * right = (const dirac_t *)0;
+    size_t kk;
+    if (ii == jj) {
+        that = chainp->operands[ii];
+    } else {
+        kk = chainp->split[(ii * chainp->count) + jj];
+        if ((left = chain_evaluate(chainp, ii, kk, (dirac_t *)0)) == (const dirac_t *)0) {
+            /* Do nothing. */
+        } else if ((right = chain_evaluate(chainp, kk + 1, jj, (dirac_t *)0)) == (const dirac_t *)0) {
+            chain_release(chainp, left, ii, kk);
+        } else {
+            if (target == (dirac_t *)0) {
+                target = chain_acquire(chainp, chain_rows(chainp, ii), chain_cols(chainp, jj));
+            }
+            if (target != (dirac_t *)0) {
+                that = dirac_core_mul_into(target, left, right);
+            }
+            chain_release(chainp, left, ii, kk);
+            chain_release(chainp, right, kk + 1, jj);
+        }
+    }
+    return that;
+}
+
+static void chain_plan(FILE * fp, const dirac_chain_t * chainp, size_t ii, size_t jj)
+{
+    size_t kk;
+    if (ii == jj) {
+        fprintf(fp, "%zu", ii);
+    } else {
+        kk = chainp->split[(ii * chainp->count) + jj];
+        fputc('(', fp);
+        chain_plan(fp, chainp, ii, kk);
+        fputc('*', fp);
+        chain_plan(fp, chainp, kk + 1, jj);
+        fputc(')', fp);
+    }
+}
+
+dirac_matrix_t * dirac_matrix_mul_chain(const dirac_matrix_t * const thems[], size_t count, FILE * fp)
+{
+    DIRAC_TRACE_BEGIN;
+    dirac_t * that = (dirac_t *)0;
+    dirac_chain_t chain = { (const dirac_t **)0, };
+    size_t * cost = (size_t *)0;
+    size_t length;
+    size_t ii;
+    size_t jj;
+    size_t kk;
+    size_t candidate;
+
+    do {
+
+        if (count == 0) {
+            errno = EINVAL;
+            break;
+        }
+
+        chain.count = count;
+        chain.operands = (const dirac_t **)malloc(count * sizeof(chain.operands[0]));
+        chain.pool = (dirac_t **)malloc(count * sizeof(chain.pool[0]));
+        chain.split = (size_t *)malloc(count * count * sizeof(chain.split[0]));
+        cost = (size_t *)malloc(count * count * sizeof(cost[0]));
+        if ((chain.operands == (const dirac_t **)0) || (chain.pool == (dirac_t **)0) || (chain.split == (size_t *)0) || (cost == (size_t *)0)) {
+            errno = ENOMEM;
+            break;
+        }
+
+        for (ii = 0; ii < count; ++ii) {
+            chain.operands[ii] = dirac_core_object_get(thems[ii]);
+            if (chain.operands[ii] == (const dirac_t *)0) {
+                errno = EINVAL;
+                break;
+            }
+            if (!dirac_core_is_array(chain.operands[ii])) {
+                errno = EINVAL;
+                break;
+            }
+            if ((ii > 0) && (chain_cols(&chain, ii - 1) != chain_rows(&chain, ii))) {
+                errno = EINVAL;
+                break;
+            }
+            cost[(ii * count) + ii] = 0;
+            chain.split[(ii * count) + ii] = ii;
+        }
+        if (ii < count) {
+            break;
+        }
+
+        for (length = 2; length <= count; ++length) {
+            for (ii = 0; ii <= (count - length); ++ii) {
+                jj = ii + length - 1;
+                cost[(ii * count) + jj] = ~(size_t)0;
+                for (kk = ii; kk < jj; ++kk) {
+                    candidate = cost[(ii * count) + kk] + cost[((kk + 1) * count) + jj] + (chain_rows(&chain, ii) * chain_cols(&chain, kk) * chain_cols(&chain, jj));
+                    if (candidate < cost[(ii * count) + jj]) {
+                        cost[(ii * count) + jj] = candidate;
+                        chain.split[(ii * count) + jj] = kk;
+                    }
+                }
+            }
+        }
+
+        if (fp != (FILE *)0) {
+            fprintf(fp, "dirac_matrix_mul_chain: plan ");
+            chain_plan(fp, &chain, 0, count - 1);
+            fprintf(fp, " cost %zu\n", cost[count - 1]);
+            fflush(fp);
+        }
+
+        if (count == 1) {
+            that = dirac_core_dup(chain.operands[0]);
+            if (that != (dirac_t *)0) {
+                dirac_core_expand(dirac_core_body_mut(that), chain.operands[0], 1.0);
+            }
+            break;
+        }
+
+        chain.capacity = chain_largest(&chain, 0, count - 1);
+
+        that = dirac_core_allocate(chain_rows(&chain, 0), chain_cols(&chain, count - 1));
+        if (that == (dirac_t *)0) {
+            break;
+        }
+
+        if (chain_evaluate(&chain, 0, count - 1, that) == (const dirac_t *)0) {
+            that = dirac_core_free(that);
+        }
+
+    } while (0);
+
+    for (ii = 0; ii < chain.available; ++ii) {
+        chain.pool[ii]->data.head.rows = 1;
+        chain.pool[ii]->data.head.columns = chain.capacity;
+        (void)dirac_core_free(chain.pool[ii]);
+    }
+
+    free(cost);
+    free(chain.split);
+    free(chain.pool);
+    free(chain.operands);
+
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_matrix_mul_chain");
+    }
+
+    DIRAC_TRACE_END(DIRAC_TRACE_MUL_CHAIN, (const dirac_t *)0, (const dirac_t *)0, that);
+    return dirac_core_matrix_mut(that);
+}
+
+/*******************************************************************************
+ * POWERS
+ ******************************************************************************/
+
+/*
+ * A^K is computed left to right over the bits of K: each bit squares the
+ * running product, and each set bit then multiplies it by A, for
+ * floor(log2(K)) + popcount(K) - 1 products in all. The products alternate
+ * between the result and a single work buffer; starting in whichever of
+ * the two makes the last product land in the result means nothing is
+ * copied at the end. A that is not dense is expanded into a third buffer.
+ */
+
+static size_t power_products(size_t exponent)
+{
+    size_t products = 0;
+    size_t bits = 0;
+    while (exponent > 1) {
+        products += (exponent & 1);
+        exponent >>= 1;
+        ++bits;
+    }
+    return bits + products;
+}
+
+static dirac_t * power(const dirac_t * thata, size_t exponent)
+{
+    dirac_t * that = (dirac_t *)0;
+    dirac_t * work = (dirac_t *)0;
+    dirac_t * expanded = (dirac_t *)0;
+    const dirac_t * base = thata;
+    dirac_t * source;
+    dirac_t * target;
+    dirac_t * spare;
+    size_t order = dirac_core_rows_get(thata);
+    size_t bit;
+    size_t ii;
+
+    do {
+
+        if ((that = dirac_core_allocate(order, order)) == (dirac_t *)0) {
+            break;
+        }
+
+        if (exponent == 0) {
+            for (ii = 0; ii < order; ++ii) {
+                *dirac_core_point_fast(that, ii, ii) = 1.0;
             }
+            break;
         }
+
+        if (!dirac_core_is_dense(thata)) {
+            if ((expanded = dirac_core_allocate(order, order)) == (dirac_t *)0) {
+                that = dirac_core_free(that);
+                break;
+            }
+            dirac_core_expand(dirac_core_body_mut(expanded), thata, 1.0);
+            base = expanded;
+        }
+
+        if (exponent == 1) {
+            memcpy(dirac_core_body_mut(that), dirac_core_body_get(base), order * order * sizeof(dirac_complex_t));
+            break;
+        }
+
+        if ((work = dirac_core_allocate(order, order)) == (dirac_t *)0) {
+            that = dirac_core_free(that);
+            break;
+        }
+
+        source = ((power_products(exponent) % 2) == 0) ? that : work;
+        spare = (source == that) ? work : that;
+        memcpy(dirac_core_body_mut(source), dirac_core_body_get(base), order * order * sizeof(dirac_complex_t));
+        for (bit = 0; (exponent >> bit) > 1; ++bit) {
+            /* Do nothing. */
+        }
+        while (bit-- > 0) {
+            target = spare;
+            (void)dirac_core_mul_into(target, source, source);
+            spare = source;
+            source = target;
+            if (((exponent >> bit) & 1) != 0) {
+                target = spare;
+                (void)dirac_core_mul_into(target, source, base);
+                spare = source;
+                source = target;
+            }
+        }
+
+    } while (0);
+
+    if (work != (dirac_t *)0) {
+        (void)dirac_core_free(work);
     }
+
+    if (expanded != (dirac_t *)0) {
+        (void)dirac_core_free(expanded);
+    }
+
+    return that;
+}
+
+dirac_matrix_t * dirac_matrix_pow(const dirac_matrix_t * thema, size_t exponent)
+{
+    DIRAC_TRACE_BEGIN;
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * that = (dirac_t *)0;
+    if ((thata == (const dirac_t *)0) || (dirac_core_rows_get(thata) != dirac_core_cols_get(thata))) {
+        errno = EINVAL;
+    } else {
+        that = power(thata, exponent);
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_matrix_pow");
+    }
+
+    DIRAC_TRACE_END(DIRAC_TRACE_POW, dirac_core_object_get(thema), (const dirac_t *)0, that);
+    return dirac_core_matrix_mut(that);
+}
+
+/*
+ * A^K * v is either K products of A with a vector, at the cost of
+ * applying A (N*N for dense and packed, the nonzeros for sparse, N for
+ * diagonal and permutation) each, or A^K followed by one product, at N^3
+ * for each product in the power. The first alternates between the result
+ * and one work vector the same way the power does.
+ */
+dirac_matrix_t * dirac_matrix_pow_apply(const dirac_matrix_t * thema, size_t exponent, const dirac_matrix_t * themv)
+{
+    DIRAC_TRACE_BEGIN;
+    const dirac_t * thata = dirac_core_object_get(thema);
+    const dirac_t * thatv = dirac_core_object_get(themv);
+    dirac_t * that = (dirac_t *)0;
+    dirac_t * work = (dirac_t *)0;
+    dirac_t * powered = (dirac_t *)0;
+    dirac_core_apply_t context = { thata, (const dirac_complex_t *)0, (dirac_complex_t *)0, 1.0, };
+    size_t order;
+    size_t cost;
+    size_t ii;
+
+    do {
+
+        if ((thata == (const dirac_t *)0) || (thatv == (const dirac_t *)0)) {
+            errno = EINVAL;
+            break;
+        }
+
+        order = dirac_core_rows_get(thata);
+        if ((dirac_core_cols_get(thata) != order) || !dirac_core_is_array(thatv) || (dirac_core_rows_get(thatv) != order) || (dirac_core_cols_get(thatv) != 1)) {
+            errno = EINVAL;
+            break;
+        }
+
+        if ((that = dirac_core_allocate(order, 1)) == (dirac_t *)0) {
+            break;
+        }
+
+        if (dirac_core_kind_get(thata) == DIRAC_KIND_SPARSE) {
+            cost = dirac_core_count_get(thata);
+        } else if (dirac_core_is_structured(thata)) {
+            cost = order;
+        } else {
+            cost = order * order;
+        }
+
+        if (((double)exponent * cost) <= ((double)power_products(exponent) * order * order * order)) {
+            if ((work = dirac_core_allocate(order, 1)) == (dirac_t *)0) {
+                that = dirac_core_free(that);
+                break;
+            }
+            context.yy = dirac_core_body_mut(((exponent % 2) == 0) ? that : work);
+            dirac_core_expand(context.yy, thatv, 1.0);
+            for (ii = 0; ii < exponent; ++ii) {
+                context.xx = context.yy;
+                context.yy = dirac_core_body_mut((context.xx == dirac_core_body_get(that)) ? work : that);
+                dirac_core_parallel(order, dirac_core_apply_grain(thata), dirac_core_apply, &context);
+            }
+        } else {
+            if ((powered = power(thata, exponent)) == (dirac_t *)0) {
+                that = dirac_core_free(that);
+                break;
+            }
+            (void)dirac_core_mul_into(that, powered, thatv);
+        }
+
+    } while (0);
+
+    if (work != (dirac_t *)0) {
+        (void)dirac_core_free(work);
+    }
+
+    if (powered != (dirac_t *)0) {
+        (void)dirac_core_free(powered);
+    }
+
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_matrix_pow_apply");
+    }
+
+    DIRAC_TRACE_END(DIRAC_TRACE_POW_APPLY, dirac_core_object_get(thema), dirac_core_object_get(themv), that);
     return dirac_core_matrix_mut(that);
 }
 
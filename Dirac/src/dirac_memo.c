@@ -0,0 +1,450 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the memoization portions of Dirac. Each
+ * result is kept in a hash table under a 128-bit key made from the
+ * operation, its scalar argument and a hash of each operand, and on a list
+ * from the most to the least recently used, from whose far end entries are
+ * evicted when the results together exceed the budget. The memo holds one
+ * reference to each result and hands out others, so an evicted result lives
+ * on until its last holder deletes it, and then goes back to the object
+ * cache like any other.
+ *
+ * REFERENCES
+ *
+ * A. Appleby, "MurmurHash3", 2011
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_criticalsection.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/*
+ * Buckets in the hash table; a power of two.
+ */
+#define BUCKETS (1024)
+
+typedef enum DiracMemoOperation {
+    DIRAC_MEMO_KRO  = 1,
+    DIRAC_MEMO_MUL  = 2,
+    DIRAC_MEMO_EXPM = 3,
+} dirac_memo_operation_t;
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+typedef struct DiracMemo {
+    struct DiracMemo * next;    /* In the same bucket. */
+    struct DiracMemo * newer;   /* Toward the most recently used. */
+    struct DiracMemo * older;   /* Toward the least recently used. */
+    dirac_t * that;
+    uint64_t key[2];
+    size_t bytes;
+} dirac_memo_t;
+
+/*******************************************************************************
+ * GLOBALS
+ ******************************************************************************/
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static dirac_memo_t * table[BUCKETS];
+
+static dirac_memo_t * newest = (dirac_memo_t *)0;
+
+static dirac_memo_t * oldest = (dirac_memo_t *)0;
+
+static size_t budget = 0;
+
+static size_t bytes = 0;
+
+static size_t hits = 0;
+
+static size_t misses = 0;
+
+/*******************************************************************************
+ * HASHING
+ ******************************************************************************/
+
+static inline uint64_t mix(uint64_t kk)
+{
+    kk ^= kk >> 33;
+    kk *= 0xff51afd7ed558ccdULL;
+    kk ^= kk >> 33;
+    kk *= 0xc4ceb9fe1a85ec53ULL;
+    kk ^= kk >> 33;
+    return kk;
+}
+
+/*
+ * Folds LENGTH bytes at DATA into the two lanes of KEY, eight bytes at a
+ * time into each lane in turn.
+ */
+static void fold(uint64_t key[2], const void * data, size_t length)
+{
+    const unsigned char * bb = (const unsigned char *)data;
+    uint64_t word;
+    size_t ii;
+    for (ii = 0; (ii + 16) <= length; ii += 16) {
+        memcpy(&word, &(bb[ii]), sizeof(word));
+        key[0] = ((key[0] ^ (word * 0x87c37b91114253d5ULL)) * 5) + 0x52dce729;
+        memcpy(&word, &(bb[ii + 8]), sizeof(word));
+        key[1] = ((key[1] ^ (word * 0x4cf5ad432745937fULL)) * 5) + 0x38495ab5;
+        key[0] = (key[0] << 27) | (key[0] >> 37);
+        key[1] = (key[1] << 31) | (key[1] >> 33);
+    }
+    for (; ii < length; ++ii) {
+        key[ii & 1] = (key[ii & 1] ^ bb[ii]) * 0x100000001b3ULL;
+    }
+    key[0] = mix(key[0] + length);
+    key[1] = mix(key[1] ^ key[0]);
+}
+
+/*
+ * Folds the shape, kind and stored elements of THATA into KEY; a strided
+ * view is folded as the dense matrix it reads as.
+ */
+static int identify(uint64_t key[2], const dirac_t * thata)
+{
+    dirac_t * temp = (dirac_t *)0;
+    size_t shape[4];
+    int rc = -1;
+    if ((thata = dirac_core_dense_get(thata, &temp)) != (const dirac_t *)0) {
+        shape[0] = dirac_core_rows_get(thata);
+        shape[1] = dirac_core_cols_get(thata);
+        shape[2] = dirac_core_kind_get(thata);
+        shape[3] = dirac_core_is_dense(thata) ? 0 : dirac_core_count_get(thata);
+        fold(key, shape, sizeof(shape));
+        fold(key, dirac_core_body_get(thata), dirac_core_length_get(thata));
+        (void)dirac_core_free(temp);
+        rc = 0;
+    }
+    return rc;
+}
+
+/*******************************************************************************
+ * TABLE
+ ******************************************************************************/
+
+static inline dirac_memo_t ** bucket(const uint64_t key[2])
+{
+    return &(table[key[0] & (BUCKETS - 1)]);
+}
+
+static void unlink_recency(dirac_memo_t * memop)
+{
+    if (memop->newer != (dirac_memo_t *)0) { memop->newer->older = memop->older; } else { newest = memop->older; }
+    if (memop->older != (dirac_memo_t *)0) { memop->older->newer = memop->newer; } else { oldest = memop->newer; }
+    memop->newer = memop->older = (dirac_memo_t *)0;
+}
+
+static void link_recency(dirac_memo_t * memop)
+{
+    memop->newer = (dirac_memo_t *)0;
+    memop->older = newest;
+    if (newest != (dirac_memo_t *)0) { newest->newer = memop; } else { oldest = memop; }
+    newest = memop;
+}
+
+/*
+ * Returns the entry for KEY, or null. Must be called with the mutex held.
+ */
+static dirac_memo_t * find(const uint64_t key[2])
+{
+    dirac_memo_t * memop;
+    for (memop = *bucket(key); memop != (dirac_memo_t *)0; memop = memop->next) {
+        if ((memop->key[0] == key[0]) && (memop->key[1] == key[1])) {
+            break;
+        }
+    }
+    return memop;
+}
+
+/*
+ * Removes MEMOP from the table and the list and returns its result, whose
+ * reference the caller must give up outside of the mutex. Must be called
+ * with the mutex held.
+ */
+static dirac_t * evict(dirac_memo_t * memop)
+{
+    dirac_memo_t ** linkp;
+    dirac_t * that = memop->that;
+    for (linkp = bucket(memop->key); *linkp != memop; linkp = &((*linkp)->next)) {
+        /* Do nothing. */
+    }
+    *linkp = memop->next;
+    unlink_recency(memop);
+    bytes -= memop->bytes;
+    free(memop);
+    return that;
+}
+
+/*
+ * Evicts the least recently used entries until there are no more than
+ * LIMIT bytes, appending their results to DOOMED, which has room for
+ * every entry. Returns the number of results appended.
+ */
+static size_t trim(size_t limit, dirac_t ** doomed)
+{
+    size_t count = 0;
+    while ((bytes > limit) && (oldest != (dirac_memo_t *)0)) {
+        doomed[count++] = evict(oldest);
+    }
+    return count;
+}
+
+/*
+ * Gives up the memo's references to the COUNT results in DOOMED.
+ */
+static void release(dirac_t ** doomed, size_t count)
+{
+    size_t ii;
+    for (ii = 0; ii < count; ++ii) {
+        dirac_delete(dirac_core_matrix_mut(doomed[ii]));
+    }
+}
+
+/*******************************************************************************
+ * MEMOIZATION
+ ******************************************************************************/
+
+/*
+ * Returns the result of OPERATION on THATA, THATB (which may be null) and
+ * FACTOR from the memo if it is there, and otherwise computes it with
+ * COMPUTE and, if it fits the budget, remembers it.
+ */
+static dirac_t * memoize(dirac_memo_operation_t operation, const dirac_t * thata, const dirac_t * thatb, dirac_complex_t factor, dirac_matrix_t * (*compute)(const dirac_matrix_t *, const dirac_matrix_t *, dirac_complex_t))
+{
+    uint64_t key[2] = { operation, ~(uint64_t)operation, };
+    dirac_memo_t * memop = (dirac_memo_t *)0;
+    dirac_memo_t * found;
+    dirac_t * that = (dirac_t *)0;
+    dirac_t * stale = (dirac_t *)0;
+    dirac_t ** doomed = (dirac_t **)0;
+    size_t size;
+    size_t count = 0;
+    size_t limit;
+
+    do {
+
+        DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+            limit = budget;
+        DIMINUTO_CRITICAL_SECTION_END;
+
+        if (limit == 0) {
+            that = dirac_core_object_mut((*compute)(dirac_core_matrix_get(thata), dirac_core_matrix_get(thatb), factor));
+            break;
+        }
+
+        fold(key, &factor, sizeof(factor));
+        if (identify(key, thata) < 0) { break; }
+        if ((thatb != (const dirac_t *)0) && (identify(key, thatb) < 0)) { break; }
+
+        DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+            if ((found = find(key)) != (dirac_memo_t *)0) {
+                unlink_recency(found);
+                link_recency(found);
+                that = dirac_core_object_mut(dirac_matrix_cow(dirac_core_matrix_get(found->that)));
+                hits += 1;
+            } else {
+                misses += 1;
+            }
+        DIMINUTO_CRITICAL_SECTION_END;
+
+        if (that != (dirac_t *)0) { break; }
+
+        /* Computed outside the mutex, so that other threads may use the memo. */
+        that = dirac_core_object_mut((*compute)(dirac_core_matrix_get(thata), dirac_core_matrix_get(thatb), factor));
+        if (that == (dirac_t *)0) { break; }
+
+        size = sizeof(dirac_data_t) + dirac_core_length_get(that);
+        if ((memop = (dirac_memo_t *)malloc(sizeof(dirac_memo_t))) == (dirac_memo_t *)0) { break; }
+
+        DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+            if (size > budget) {
+                /* Too large to keep: the caller has the only reference. */
+            } else if ((found = find(key)) != (dirac_memo_t *)0) {
+                /* Another thread got here first: share its result instead. */
+                stale = that;
+                that = dirac_core_object_mut(dirac_matrix_cow(dirac_core_matrix_get(found->that)));
+            } else if ((doomed = (dirac_t **)malloc(((bytes + size) / sizeof(dirac_data_t) + 1) * sizeof(dirac_t *))) != (dirac_t **)0) {
+                count = trim(budget - size, doomed);
+                memop->that = dirac_core_object_mut(dirac_matrix_cow(dirac_core_matrix_get(that)));
+                memop->key[0] = key[0];
+                memop->key[1] = key[1];
+                memop->bytes = size;
+                memop->next = *bucket(key);
+                *bucket(key) = memop;
+                link_recency(memop);
+                bytes += size;
+                memop = (dirac_memo_t *)0;
+            } else {
+                /* Do nothing. */
+            }
+        DIMINUTO_CRITICAL_SECTION_END;
+
+    } while (0);
+
+    free(memop);
+    release(doomed, count);
+    free(doomed);
+    if (stale != (dirac_t *)0) {
+        dirac_delete(dirac_core_matrix_mut(stale));
+    }
+
+    return that;
+}
+
+static dirac_matrix_t * kro(const dirac_matrix_t * thema, const dirac_matrix_t * themb, dirac_complex_t factor)
+{
+    return dirac_matrix_kro(thema, themb);
+}
+
+static dirac_matrix_t * mul(const dirac_matrix_t * thema, const dirac_matrix_t * themb, dirac_complex_t factor)
+{
+    return dirac_matrix_mul(thema, themb);
+}
+
+static dirac_matrix_t * expm(const dirac_matrix_t * thema, const dirac_matrix_t * themb, dirac_complex_t factor)
+{
+    return dirac_matrix_expm(thema, factor);
+}
+
+/*******************************************************************************
+ * PUBLIC MANAGEMENT
+ ******************************************************************************/
+
+size_t dirac_memo_budget_set(size_t limit)
+{
+    dirac_t ** doomed = (dirac_t **)0;
+    size_t count = 0;
+    size_t prior;
+    DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+        prior = budget;
+        budget = limit;
+        if ((bytes > limit) && ((doomed = (dirac_t **)malloc((bytes / sizeof(dirac_data_t) + 1) * sizeof(dirac_t *))) != (dirac_t **)0)) {
+            count = trim(limit, doomed);
+        }
+    DIMINUTO_CRITICAL_SECTION_END;
+    release(doomed, count);
+    free(doomed);
+    return prior;
+}
+
+size_t dirac_memo_budget_get(void)
+{
+    size_t result;
+    DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+        result = budget;
+    DIMINUTO_CRITICAL_SECTION_END;
+    return result;
+}
+
+void dirac_memo_flush(void)
+{
+    dirac_t ** doomed = (dirac_t **)0;
+    size_t count = 0;
+    DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+        if ((bytes > 0) && ((doomed = (dirac_t **)malloc((bytes / sizeof(dirac_data_t) + 1) * sizeof(dirac_t *))) != (dirac_t **)0)) {
+            count = trim(0, doomed);
+        }
+    DIMINUTO_CRITICAL_SECTION_END;
+    release(doomed, count);
+    free(doomed);
+}
+
+size_t dirac_memo_bytes_get(void)
+{
+    size_t result;
+    DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+        result = bytes;
+    DIMINUTO_CRITICAL_SECTION_END;
+    return result;
+}
+
+size_t dirac_memo_hits_get(void)
+{
+    size_t result;
+    DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+        result = hits;
+    DIMINUTO_CRITICAL_SECTION_END;
+    return result;
+}
+
+size_t dirac_memo_misses_get(void)
+{
+    size_t result;
+    DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+        result = misses;
+    DIMINUTO_CRITICAL_SECTION_END;
+    return result;
+}
+
+/*******************************************************************************
+ * PUBLIC OPERATIONS
+ ******************************************************************************/
+
+dirac_matrix_t * dirac_memo_kro(const dirac_matrix_t * thema, const dirac_matrix_t * themb)
+{
+    dirac_t * that = (dirac_t *)0;
+    if ((thema == (const dirac_matrix_t *)0) || (themb == (const dirac_matrix_t *)0)) {
+        errno = EINVAL;
+    } else {
+        that = memoize(DIRAC_MEMO_KRO, dirac_core_object_get(thema), dirac_core_object_get(themb), 0, kro);
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_memo_kro");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_memo_mul(const dirac_matrix_t * thema, const dirac_matrix_t * themb)
+{
+    dirac_t * that = (dirac_t *)0;
+    if ((thema == (const dirac_matrix_t *)0) || (themb == (const dirac_matrix_t *)0)) {
+        errno = EINVAL;
+    } else {
+        that = memoize(DIRAC_MEMO_MUL, dirac_core_object_get(thema), dirac_core_object_get(themb), 0, mul);
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_memo_mul");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_memo_expm(const dirac_matrix_t * thema, dirac_complex_t factor)
+{
+    dirac_t * that = (dirac_t *)0;
+    if (thema == (const dirac_matrix_t *)0) {
+        errno = EINVAL;
+    } else {
+        that = memoize(DIRAC_MEMO_EXPM, dirac_core_object_get(thema), (const dirac_t *)0, factor, expm);
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_memo_expm");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
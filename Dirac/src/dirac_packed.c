@@ -0,0 +1,391 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the packed Hermitian and triangular
+ * portions of Dirac. Only the upper triangle is stored, a row at a time,
+ * so every kernel here walks stored rows contiguously and finds the lower
+ * triangle of a Hermitian matrix by reading the same rows as columns.
+ *
+ * REFERENCES
+ *
+ * E. Anderson et al., LAPACK USERS' GUIDE, 3rd ed., SIAM, 1999, 5.3.1
+ *
+ * Wikipedia, "Packed storage matrix", 2025-05-01
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <errno.h>
+#include <string.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+typedef struct DiracProduct {
+    dirac_t * that;
+    const dirac_t * thata;
+    const dirac_t * thatb;
+} dirac_product_t;
+
+typedef struct DiracUpdate {
+    dirac_complex_t * cc;
+    const dirac_complex_t * aa;
+    size_t order;
+    size_t rank;
+    double alpha;
+    double beta;
+} dirac_update_t;
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+static inline int is_hermitian(const dirac_t * that) {
+    return (dirac_core_kind_get(that) == DIRAC_KIND_HERMITIAN);
+}
+
+static inline int is_kind(dirac_kind_t kind) {
+    return (kind == DIRAC_KIND_HERMITIAN) || (kind == DIRAC_KIND_TRIANGULAR);
+}
+
+/*
+ * Returns row ROW of a packed body indexed by column, i.e. valid for
+ * columns ROW and up.
+ */
+static inline const dirac_complex_t * packed_row(const dirac_complex_t * aa, size_t order, size_t row) {
+    return &(aa[dirac_core_packed_offset(order, row) - row]);
+}
+
+static dirac_t * allocate(dirac_kind_t kind, size_t order)
+{
+    return dirac_core_allocate_kind(kind, order, order, dirac_core_packed_count(order));
+}
+
+/*******************************************************************************
+ * KERNELS
+ ******************************************************************************/
+
+/*
+ * Each stored row R contributes to target row R (the upper triangle), and
+ * for a Hermitian A, read as a column, to the target rows below it. A range
+ * of target rows reads only its own segment of every stored row above it.
+ */
+void dirac_core_packed_apply(dirac_complex_t * yy, const dirac_t * thata, const dirac_complex_t * xx, size_t cols, size_t begin, size_t end)
+{
+    const dirac_complex_t * restrict aa = dirac_core_body_get(thata);
+    size_t order = dirac_core_rows_get(thata);
+    const dirac_complex_t * restrict arow;
+    const dirac_complex_t * restrict xrow;
+    dirac_complex_t * restrict trow;
+    dirac_complex_t factor;
+    size_t rr;
+    size_t cc;
+    size_t jj;
+
+    memset(&(yy[begin * cols]), 0, (end - begin) * cols * sizeof(dirac_complex_t));
+
+    for (rr = begin; rr < end; ++rr) {
+        arow = packed_row(aa, order, rr);
+        trow = &(yy[rr * cols]);
+        for (cc = rr; cc < order; ++cc) {
+            factor = arow[cc];
+            xrow = &(xx[cc * cols]);
+            for (jj = 0; jj < cols; ++jj) {
+                trow[jj] += factor * xrow[jj];
+            }
+        }
+    }
+
+    if (is_hermitian(thata)) {
+        for (cc = 0; (cc + 1) < end; ++cc) {
+            arow = packed_row(aa, order, cc);
+            xrow = &(xx[cc * cols]);
+            for (rr = ((cc + 1) > begin) ? (cc + 1) : begin; rr < end; ++rr) {
+                factor = conj(arow[rr]);
+                trow = &(yy[rr * cols]);
+                for (jj = 0; jj < cols; ++jj) {
+                    trow[jj] += factor * xrow[jj];
+                }
+            }
+        }
+    }
+}
+
+static void packed_dense(void * context, size_t begin, size_t end)
+{
+    const dirac_product_t * productp = (const dirac_product_t *)context;
+    dirac_core_packed_apply(dirac_core_body_mut(productp->that), productp->thata, dirac_core_body_get(productp->thatb), dirac_core_cols_get(productp->thatb), begin, end);
+}
+
+/*
+ * Dense times packed: row R of A times stored row K of B lands in the
+ * upper part of target row R, and for a Hermitian B the same stored row
+ * read as a column gives target element (R, K).
+ */
+static void dense_packed(void * context, size_t begin, size_t end)
+{
+    const dirac_product_t * productp = (const dirac_product_t *)context;
+    const dirac_complex_t * restrict aa = dirac_core_body_get(productp->thata);
+    const dirac_complex_t * restrict bb = dirac_core_body_get(productp->thatb);
+    dirac_complex_t * restrict tt = dirac_core_body_mut(productp->that);
+    size_t order = dirac_core_rows_get(productp->thatb);
+    int hermitian = is_hermitian(productp->thatb);
+    const dirac_complex_t * restrict arow;
+    const dirac_complex_t * restrict brow;
+    dirac_complex_t * restrict trow;
+    dirac_complex_t factor;
+    dirac_complex_t sum;
+    size_t rr;
+    size_t kk;
+    size_t cc;
+
+    for (rr = begin; rr < end; ++rr) {
+        arow = &(aa[rr * order]);
+        trow = &(tt[rr * order]);
+        memset(trow, 0, order * sizeof(dirac_complex_t));
+        for (kk = 0; kk < order; ++kk) {
+            brow = packed_row(bb, order, kk);
+            factor = arow[kk];
+            for (cc = kk; cc < order; ++cc) {
+                trow[cc] += factor * brow[cc];
+            }
+            if (hermitian) {
+                sum = 0;
+                for (cc = kk + 1; cc < order; ++cc) {
+                    sum += arow[cc] * conj(brow[cc]);
+                }
+                trow[kk] += sum;
+            }
+        }
+    }
+}
+
+static void update_row(const dirac_update_t * updatep, size_t row)
+{
+    const dirac_complex_t * restrict arow = &(updatep->aa[row * updatep->rank]);
+    const dirac_complex_t * restrict brow;
+    dirac_complex_t * restrict crow = &(updatep->cc[dirac_core_packed_offset(updatep->order, row) - row]);
+    dirac_complex_t sum;
+    size_t cc;
+    size_t jj;
+
+    for (cc = row; cc < updatep->order; ++cc) {
+        brow = &(updatep->aa[cc * updatep->rank]);
+        sum = 0;
+        for (jj = 0; jj < updatep->rank; ++jj) {
+            sum += arow[jj] * conj(brow[jj]);
+        }
+        /* Like the BLAS, a zero BETA ignores whatever C held, even NaN. */
+        crow[cc] = (updatep->beta == 0.0) ? (updatep->alpha * sum) : ((updatep->beta * crow[cc]) + (updatep->alpha * sum));
+    }
+
+    crow[row] = creal(crow[row]);
+}
+
+/*
+ * Item I is rows I and ORDER-1-I, so that every item is the same amount
+ * of work however the items are split among threads.
+ */
+static void update(void * context, size_t begin, size_t end)
+{
+    const dirac_update_t * updatep = (const dirac_update_t *)context;
+    size_t ii;
+    for (ii = begin; ii < end; ++ii) {
+        update_row(updatep, ii);
+        if ((updatep->order - 1 - ii) != ii) {
+            update_row(updatep, updatep->order - 1 - ii);
+        }
+    }
+}
+
+/*******************************************************************************
+ * PRIVATE OPERATIONS
+ ******************************************************************************/
+
+/*
+ * A packed operand paired with anything but a dense one is expanded into
+ * a temporary first.
+ */
+dirac_t * dirac_core_mul_packed(const dirac_t * thata, const dirac_t * thatb)
+{
+    dirac_product_t product = { (dirac_t *)0, thata, thatb, };
+    dirac_t * temp = (dirac_t *)0;
+    const dirac_t * other;
+    size_t order;
+
+    do {
+
+        if (dirac_core_cols_get(thata) != dirac_core_rows_get(thatb)) {
+            errno = EINVAL;
+            break;
+        }
+
+        if (dirac_core_is_packed(thata) && dirac_core_is_dense(thatb)) {
+            if ((product.that = dirac_core_pro(thata, thatb)) != (dirac_t *)0) {
+                order = dirac_core_rows_get(thata);
+                dirac_core_parallel(order, dirac_core_grain(order * dirac_core_cols_get(thatb)), packed_dense, &product);
+            }
+            break;
+        }
+
+        if (dirac_core_is_dense(thata) && dirac_core_is_packed(thatb)) {
+            if ((product.that = dirac_core_pro(thata, thatb)) != (dirac_t *)0) {
+                order = dirac_core_rows_get(thatb);
+                dirac_core_parallel(dirac_core_rows_get(thata), dirac_core_grain(order * order), dense_packed, &product);
+            }
+            break;
+        }
+
+        other = dirac_core_is_packed(thata) ? thata : thatb;
+        if ((temp = dirac_core_allocate(dirac_core_rows_get(other), dirac_core_cols_get(other))) == (dirac_t *)0) {
+            break;
+        }
+        dirac_core_expand(dirac_core_body_mut(temp), other, 1.0);
+        if (other == thata) {
+            thata = temp;
+        } else {
+            thatb = temp;
+        }
+
+        if (dirac_core_is_packed(thata) || dirac_core_is_packed(thatb)) {
+            product.that = dirac_core_mul_packed(thata, thatb);
+        } else if ((dirac_core_kind_get(thata) == DIRAC_KIND_SPARSE) || (dirac_core_kind_get(thatb) == DIRAC_KIND_SPARSE)) {
+            product.that = dirac_core_mul_sparse(thata, thatb);
+        } else if (dirac_core_is_structured(thata) || dirac_core_is_structured(thatb)) {
+            product.that = dirac_core_mul_structured(thata, thatb);
+        } else if ((product.that = dirac_core_pro(thata, thatb)) != (dirac_t *)0) {
+            (void)dirac_core_mul_into(product.that, thata, thatb);
+        } else {
+            /* Do nothing. */
+        }
+
+    } while (0);
+
+    (void)dirac_core_free(temp);
+
+    return product.that;
+}
+
+/*******************************************************************************
+ * PUBLIC OPERATIONS
+ ******************************************************************************/
+
+dirac_matrix_t * dirac_hermitian_new(size_t order)
+{
+    dirac_t * that = allocate(DIRAC_KIND_HERMITIAN, order);
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_hermitian_new");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_triangular_new(size_t order)
+{
+    dirac_t * that = allocate(DIRAC_KIND_TRIANGULAR, order);
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_triangular_new");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_packed_from_dense(const dirac_matrix_t * thema, dirac_kind_t kind)
+{
+    dirac_t * temp;
+    const dirac_t * thata = dirac_core_dense_get(dirac_core_object_get(thema), &temp);
+    dirac_t * that = (dirac_t *)0;
+    const dirac_complex_t * aa;
+    dirac_complex_t * tt;
+    size_t order;
+    size_t rr;
+
+    if ((thata == (const dirac_t *)0) || !dirac_core_is_dense(thata) || !is_kind(kind)) {
+        errno = EINVAL;
+    } else if (dirac_core_rows_get(thata) != dirac_core_cols_get(thata)) {
+        errno = EINVAL;
+    } else if ((that = allocate(kind, dirac_core_rows_get(thata))) != (dirac_t *)0) {
+        aa = dirac_core_body_get(thata);
+        tt = dirac_core_body_mut(that);
+        order = dirac_core_rows_get(thata);
+        for (rr = 0; rr < order; ++rr) {
+            memcpy(&(tt[dirac_core_packed_offset(order, rr)]), &(aa[(rr * order) + rr]), (order - rr) * sizeof(dirac_complex_t));
+        }
+    } else {
+        /* Do nothing. */
+    }
+
+    (void)dirac_core_free(temp);
+
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_packed_from_dense");
+    }
+
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_packed_to_dense(const dirac_matrix_t * thema)
+{
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * that = (dirac_t *)0;
+    if ((thata == (const dirac_t *)0) || !dirac_core_is_packed(thata)) {
+        errno = EINVAL;
+    } else if ((that = dirac_core_allocate(dirac_core_rows_get(thata), dirac_core_cols_get(thata))) != (dirac_t *)0) {
+        dirac_core_expand(dirac_core_body_mut(that), thata, 1.0);
+    } else {
+        /* Do nothing. */
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_packed_to_dense");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_hermitian_update(dirac_matrix_t * themc, double alpha, const dirac_matrix_t * thema, double beta)
+{
+    dirac_t * thatc = dirac_core_object_mut(themc);
+    dirac_t * temp;
+    const dirac_t * thata = dirac_core_dense_get(dirac_core_object_get(thema), &temp);
+    dirac_update_t context;
+
+    if ((thatc == (dirac_t *)0) || (thata == (const dirac_t *)0)) {
+        errno = EINVAL;
+        thatc = (dirac_t *)0;
+    } else if (!is_hermitian(thatc) || !dirac_core_is_dense(thata)) {
+        errno = EINVAL;
+        thatc = (dirac_t *)0;
+    } else if (dirac_core_rows_get(thata) != dirac_core_rows_get(thatc)) {
+        errno = EINVAL;
+        thatc = (dirac_t *)0;
+    } else {
+        context.cc = dirac_core_body_mut(thatc);
+        context.aa = dirac_core_body_get(thata);
+        context.order = dirac_core_rows_get(thatc);
+        context.rank = dirac_core_cols_get(thata);
+        context.alpha = alpha;
+        context.beta = beta;
+        dirac_core_parallel((context.order + 1) / 2, dirac_core_grain((context.order + 1) * context.rank), update, &context);
+    }
+
+    (void)dirac_core_free(temp);
+
+    if (thatc == (dirac_t *)0) {
+        diminuto_perror("dirac_hermitian_update");
+    }
+
+    return dirac_core_matrix_mut(thatc);
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
@@ -0,0 +1,595 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the reduction portions of Dirac. Every
+ * reduction is a sum of terms computed on the fly. The terms are split
+ * into at most PARTIALS blocks, the blocks are summed in parallel, and
+ * each block and then the partial sums of the blocks are summed pairwise:
+ * the halves of a range are summed separately and then added, down to
+ * leaves of LEAF terms summed in a simple loop the compiler can vectorize.
+ * The rounding error grows with the logarithm of the number of terms
+ * rather than the number itself. Since the blocks depend only on the
+ * number of terms, the result does not depend on the number of threads.
+ *
+ * REFERENCES
+ *
+ * N. Higham, "The Accuracy of Floating Point Summation", SIAM Journal on
+ * Scientific Computing, 14.4, 1993
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/*
+ * The most terms a leaf sums directly.
+ */
+static const size_t LEAF = 32;
+
+/*
+ * The most blocks a reduction is split into.
+ */
+#define PARTIALS (256)
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+/*
+ * Returns the sum of the terms [BEGIN..END) of a reduction.
+ */
+typedef dirac_complex_t (dirac_leaf_t)(const void * context, size_t begin, size_t end);
+
+typedef struct DiracReduce {
+    dirac_leaf_t * leaf;
+    const void * context;
+    dirac_complex_t * partials;
+    size_t count;
+    size_t block;
+} dirac_reduce_t;
+
+typedef struct DiracOperands {
+    const dirac_t * thata;
+    const dirac_complex_t * xx;
+    const dirac_complex_t * yy;
+} dirac_operands_t;
+
+typedef struct DiracPartial {
+    dirac_complex_t * tt;
+    const dirac_complex_t * aa;
+    const size_t * kept;
+    const size_t * traced;
+    size_t order;
+    size_t keeps;
+    size_t traces;
+} dirac_partial_t;
+
+/*******************************************************************************
+ * FRAMEWORK
+ ******************************************************************************/
+
+static dirac_complex_t pairwise(dirac_leaf_t * leaf, const void * context, size_t begin, size_t end)
+{
+    size_t half;
+    if ((end - begin) <= LEAF) {
+        return (*leaf)(context, begin, end);
+    }
+    half = begin + ((end - begin) / 2);
+    return pairwise(leaf, context, begin, half) + pairwise(leaf, context, half, end);
+}
+
+static void blocks(void * context, size_t begin, size_t end)
+{
+    const dirac_reduce_t * reducep = (const dirac_reduce_t *)context;
+    size_t low;
+    size_t high;
+    size_t bb;
+    for (bb = begin; bb < end; ++bb) {
+        low = bb * reducep->block;
+        high = ((low + reducep->block) < reducep->count) ? (low + reducep->block) : reducep->count;
+        reducep->partials[bb] = pairwise(reducep->leaf, reducep->context, low, high);
+    }
+}
+
+static dirac_complex_t partials(const void * context, size_t begin, size_t end)
+{
+    const dirac_complex_t * restrict pp = (const dirac_complex_t *)context;
+    double re = 0.0;
+    double im = 0.0;
+    size_t ii;
+    for (ii = begin; ii < end; ++ii) {
+        re += creal(pp[ii]);
+        im += cimag(pp[ii]);
+    }
+    return CMPLX(re, im);
+}
+
+/*
+ * Returns the sum of the COUNT terms of LEAF, each of which costs about
+ * WORK complex multiply-accumulates.
+ */
+static dirac_complex_t reduce(dirac_leaf_t * leaf, const void * context, size_t count, size_t work)
+{
+    dirac_complex_t partial[PARTIALS];
+    dirac_reduce_t reduction;
+    size_t number;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    reduction.leaf = leaf;
+    reduction.context = context;
+    reduction.partials = partial;
+    reduction.count = count;
+    reduction.block = (count + PARTIALS - 1) / PARTIALS;
+    if (reduction.block < LEAF) {
+        reduction.block = LEAF;
+    }
+    number = (count + reduction.block - 1) / reduction.block;
+
+    dirac_core_parallel(number, dirac_core_grain(reduction.block * work), blocks, &reduction);
+
+    return pairwise(partials, partial, 0, number);
+}
+
+/*******************************************************************************
+ * LEAVES
+ ******************************************************************************/
+
+/*
+ * Diagonal elements [BEGIN..END) of A.
+ */
+static dirac_complex_t trace(const void * context, size_t begin, size_t end)
+{
+    const dirac_t * thata = ((const dirac_operands_t *)context)->thata;
+    const dirac_complex_t * restrict aa = dirac_core_body_get(thata);
+    size_t order = dirac_core_rows_get(thata);
+    const size_t * restrict columns;
+    const size_t * restrict offsets;
+    double re = 0.0;
+    double im = 0.0;
+    dirac_complex_t value;
+    size_t rr;
+    size_t ii;
+
+    for (rr = begin; rr < end; ++rr) {
+        value = 0;
+        switch (dirac_core_kind_get(thata)) {
+        case DIRAC_KIND_DENSE:
+        case DIRAC_KIND_STRIDED:
+            value = dirac_core_element(thata, rr, rr);
+            break;
+        case DIRAC_KIND_SPARSE:
+            columns = dirac_core_sparse_columns_get(thata);
+            offsets = dirac_core_sparse_offsets_get(thata);
+            for (ii = offsets[rr]; ii < offsets[rr + 1]; ++ii) {
+                if (columns[ii] == rr) {
+                    value = aa[ii];
+                    break;
+                }
+            }
+            break;
+        case DIRAC_KIND_DIAGONAL:
+            value = aa[rr];
+            break;
+        case DIRAC_KIND_PERMUTATION:
+            columns = dirac_core_permutation_columns_get(thata);
+            value = (columns[rr] == rr) ? aa[rr] : 0;
+            break;
+        case DIRAC_KIND_HERMITIAN:
+        case DIRAC_KIND_TRIANGULAR:
+            value = aa[dirac_core_packed_offset(order, rr)];
+            break;
+        }
+        re += creal(value);
+        im += cimag(value);
+    }
+
+    return CMPLX(re, im);
+}
+
+/*
+ * Squared magnitudes of the stored elements [BEGIN..END).
+ */
+static dirac_complex_t squares(const void * context, size_t begin, size_t end)
+{
+    const dirac_complex_t * restrict aa = dirac_core_body_get(((const dirac_operands_t *)context)->thata);
+    double sum = 0.0;
+    size_t ii;
+    for (ii = begin; ii < end; ++ii) {
+        sum += (creal(aa[ii]) * creal(aa[ii])) + (cimag(aa[ii]) * cimag(aa[ii]));
+    }
+    return sum;
+}
+
+/*
+ * Squared magnitudes of the rows [BEGIN..END) of a packed Hermitian A, in
+ * which each stored element off the diagonal stands for two.
+ */
+static dirac_complex_t hermitian_squares(const void * context, size_t begin, size_t end)
+{
+    const dirac_t * thata = ((const dirac_operands_t *)context)->thata;
+    const dirac_complex_t * restrict aa = dirac_core_body_get(thata);
+    size_t order = dirac_core_rows_get(thata);
+    const dirac_complex_t * restrict arow;
+    double diagonal = 0.0;
+    double off = 0.0;
+    size_t rr;
+    size_t cc;
+    for (rr = begin; rr < end; ++rr) {
+        arow = &(aa[dirac_core_packed_offset(order, rr) - rr]);
+        diagonal += (creal(arow[rr]) * creal(arow[rr])) + (cimag(arow[rr]) * cimag(arow[rr]));
+        for (cc = rr + 1; cc < order; ++cc) {
+            off += (creal(arow[cc]) * creal(arow[cc])) + (cimag(arow[cc]) * cimag(arow[cc]));
+        }
+    }
+    return diagonal + (2.0 * off);
+}
+
+/*
+ * Terms [BEGIN..END) of conj(x) . y.
+ */
+static dirac_complex_t inner(const void * context, size_t begin, size_t end)
+{
+    const dirac_operands_t * operandsp = (const dirac_operands_t *)context;
+    const dirac_complex_t * restrict xx = operandsp->xx;
+    const dirac_complex_t * restrict yy = operandsp->yy;
+    double re = 0.0;
+    double im = 0.0;
+    size_t ii;
+    for (ii = begin; ii < end; ++ii) {
+        re += (creal(xx[ii]) * creal(yy[ii])) + (cimag(xx[ii]) * cimag(yy[ii]));
+        im += (creal(xx[ii]) * cimag(yy[ii])) - (cimag(xx[ii]) * creal(yy[ii]));
+    }
+    return CMPLX(re, im);
+}
+
+/*
+ * Rows [BEGIN..END) of conj(x) . (A * x), each row of A * x computed and
+ * consumed in place. For a packed Hermitian A only the stored upper
+ * triangle is read: x'Ax is the sum of a[r][r]|x[r]|^2 plus twice the real
+ * part of conj(x[r]) a[r][c] x[c] over c > r.
+ */
+static dirac_complex_t expectation(const void * context, size_t begin, size_t end)
+{
+    const dirac_operands_t * operandsp = (const dirac_operands_t *)context;
+    const dirac_t * thata = operandsp->thata;
+    const dirac_complex_t * restrict aa = dirac_core_body_get(thata);
+    const dirac_complex_t * restrict xx = operandsp->xx;
+    size_t order = dirac_core_rows_get(thata);
+    const dirac_complex_t * restrict arow;
+    const size_t * restrict columns;
+    const size_t * restrict offsets;
+    dirac_complex_t total = 0;
+    dirac_complex_t sum;
+    double magnitude;
+    size_t rr;
+    size_t ii;
+
+    switch (dirac_core_kind_get(thata)) {
+
+    case DIRAC_KIND_DENSE:
+        for (rr = begin; rr < end; ++rr) {
+            arow = &(aa[rr * order]);
+            sum = 0;
+            for (ii = 0; ii < order; ++ii) {
+                sum += arow[ii] * xx[ii];
+            }
+            total += conj(xx[rr]) * sum;
+        }
+        break;
+
+    case DIRAC_KIND_STRIDED:
+        for (rr = begin; rr < end; ++rr) {
+            sum = 0;
+            for (ii = 0; ii < order; ++ii) {
+                sum += dirac_core_element(thata, rr, ii) * xx[ii];
+            }
+            total += conj(xx[rr]) * sum;
+        }
+        break;
+
+    case DIRAC_KIND_SPARSE:
+        columns = dirac_core_sparse_columns_get(thata);
+        offsets = dirac_core_sparse_offsets_get(thata);
+        for (rr = begin; rr < end; ++rr) {
+            sum = 0;
+            for (ii = offsets[rr]; ii < offsets[rr + 1]; ++ii) {
+                sum += aa[ii] * xx[columns[ii]];
+            }
+            total += conj(xx[rr]) * sum;
+        }
+        break;
+
+    case DIRAC_KIND_DIAGONAL:
+        for (rr = begin; rr < end; ++rr) {
+            magnitude = (creal(xx[rr]) * creal(xx[rr])) + (cimag(xx[rr]) * cimag(xx[rr]));
+            total += aa[rr] * magnitude;
+        }
+        break;
+
+    case DIRAC_KIND_PERMUTATION:
+        columns = dirac_core_permutation_columns_get(thata);
+        for (rr = begin; rr < end; ++rr) {
+            total += conj(xx[rr]) * aa[rr] * xx[columns[rr]];
+        }
+        break;
+
+    case DIRAC_KIND_HERMITIAN:
+        for (rr = begin; rr < end; ++rr) {
+            arow = &(aa[dirac_core_packed_offset(order, rr) - rr]);
+            sum = 0;
+            for (ii = rr + 1; ii < order; ++ii) {
+                sum += arow[ii] * xx[ii];
+            }
+            magnitude = (creal(xx[rr]) * creal(xx[rr])) + (cimag(xx[rr]) * cimag(xx[rr]));
+            total += (creal(arow[rr]) * magnitude) + (2.0 * creal(conj(xx[rr]) * sum));
+        }
+        break;
+
+    case DIRAC_KIND_TRIANGULAR:
+        for (rr = begin; rr < end; ++rr) {
+            arow = &(aa[dirac_core_packed_offset(order, rr) - rr]);
+            sum = 0;
+            for (ii = rr; ii < order; ++ii) {
+                sum += arow[ii] * xx[ii];
+            }
+            total += conj(xx[rr]) * sum;
+        }
+        break;
+
+    }
+
+    return total;
+}
+
+/*******************************************************************************
+ * PUBLIC OPERATIONS
+ ******************************************************************************/
+
+dirac_complex_t dirac_matrix_trace(const dirac_matrix_t * thema)
+{
+    DIRAC_TRACE_BEGIN;
+    dirac_complex_t result = CMPLX(NAN, NAN);
+    dirac_operands_t operands = { dirac_core_object_get(thema), };
+    if ((operands.thata == (const dirac_t *)0) || (dirac_core_rows_get(operands.thata) != dirac_core_cols_get(operands.thata))) {
+        errno = EINVAL;
+        diminuto_perror("dirac_matrix_trace");
+    } else {
+        result = reduce(trace, &operands, dirac_core_rows_get(operands.thata), 1);
+    }
+    DIRAC_TRACE_END(DIRAC_TRACE_TRACE, dirac_core_object_get(thema), (const dirac_t *)0, (const dirac_t *)0);
+    return result;
+}
+
+double dirac_matrix_norm(const dirac_matrix_t * thema)
+{
+    DIRAC_TRACE_BEGIN;
+    double result = NAN;
+    dirac_t * temp;
+    dirac_operands_t operands = { dirac_core_dense_get(dirac_core_object_get(thema), &temp), };
+    if (operands.thata == (const dirac_t *)0) {
+        errno = EINVAL;
+        diminuto_perror("dirac_matrix_norm");
+    } else if (dirac_core_kind_get(operands.thata) == DIRAC_KIND_HERMITIAN) {
+        result = sqrt(creal(reduce(hermitian_squares, &operands, dirac_core_rows_get(operands.thata), dirac_core_rows_get(operands.thata) / 2)));
+    } else {
+        result = sqrt(creal(reduce(squares, &operands, dirac_core_count_get(operands.thata), 1)));
+    }
+    (void)dirac_core_free(temp);
+    DIRAC_TRACE_END(DIRAC_TRACE_NORM, dirac_core_object_get(thema), (const dirac_t *)0, (const dirac_t *)0);
+    return result;
+}
+
+dirac_complex_t dirac_matrix_inner(const dirac_matrix_t * thema, const dirac_matrix_t * themb)
+{
+    DIRAC_TRACE_BEGIN;
+    dirac_complex_t result = CMPLX(NAN, NAN);
+    dirac_t * tempa;
+    dirac_t * tempb;
+    const dirac_t * thata = dirac_core_dense_get(dirac_core_object_get(thema), &tempa);
+    const dirac_t * thatb = dirac_core_dense_get(dirac_core_object_get(themb), &tempb);
+    dirac_operands_t operands;
+    if ((thata == (const dirac_t *)0) || (thatb == (const dirac_t *)0) || !dirac_core_is_dense(thata) || !dirac_core_is_dense(thatb) || (dirac_core_rows_get(thata) != dirac_core_rows_get(thatb)) || (dirac_core_cols_get(thata) != dirac_core_cols_get(thatb))) {
+        errno = EINVAL;
+        diminuto_perror("dirac_matrix_inner");
+    } else {
+        operands.thata = thata;
+        operands.xx = dirac_core_body_get(thata);
+        operands.yy = dirac_core_body_get(thatb);
+        result = reduce(inner, &operands, dirac_core_count_get(thata), 1);
+    }
+    (void)dirac_core_free(tempb);
+    (void)dirac_core_free(tempa);
+    DIRAC_TRACE_END(DIRAC_TRACE_INNER, dirac_core_object_get(thema), dirac_core_object_get(themb), (const dirac_t *)0);
+    return result;
+}
+
+dirac_complex_t dirac_matrix_expectation(const dirac_matrix_t * thema, const dirac_matrix_t * themv)
+{
+    DIRAC_TRACE_BEGIN;
+    dirac_complex_t result = CMPLX(NAN, NAN);
+    dirac_t * tempv;
+    const dirac_t * thata = dirac_core_object_get(thema);
+    const dirac_t * thatv = dirac_core_dense_get(dirac_core_object_get(themv), &tempv);
+    dirac_operands_t operands;
+    size_t order;
+    if ((thata == (const dirac_t *)0) || (thatv == (const dirac_t *)0) || (dirac_core_rows_get(thata) != dirac_core_cols_get(thata)) || !dirac_core_is_dense(thatv) || (dirac_core_rows_get(thatv) != dirac_core_rows_get(thata)) || (dirac_core_cols_get(thatv) != 1)) {
+        errno = EINVAL;
+        diminuto_perror("dirac_matrix_expectation");
+    } else {
+        order = dirac_core_rows_get(thata);
+        operands.thata = thata;
+        operands.xx = dirac_core_body_get(thatv);
+        operands.yy = operands.xx;
+        result = reduce(expectation, &operands, order, (dirac_core_count_get(thata) / ((order > 0) ? order : 1)) + 1);
+    }
+    (void)dirac_core_free(tempv);
+    DIRAC_TRACE_END(DIRAC_TRACE_EXPECTATION, dirac_core_object_get(thema), dirac_core_object_get(themv), (const dirac_t *)0);
+    return result;
+}
+
+/*******************************************************************************
+ * PARTIAL TRACE
+ ******************************************************************************/
+
+/*
+ * Subsystem I of DIMS[I] states has stride DIMS[I+1]*...*DIMS[COUNT-1] in
+ * an index of the whole system. Element (a, b) of the reduced matrix is
+ * the sum over t of element (kept[a] + traced[t], kept[b] + traced[t]) of
+ * the whole, where kept[] and traced[] are the contributions to the index
+ * of every combination of states of the kept and the traced subsystems;
+ * so each term is at kept[a]*N + kept[b] + traced[t]*(N+1).
+ */
+
+void dirac_core_offsets(size_t * table, const size_t dims[], size_t count, uint64_t mask)
+{
+    size_t stride = 1;
+    size_t length = 1;
+    size_t ii;
+    size_t jj;
+    size_t kk;
+    table[0] = 0;
+    for (ii = count; ii > 0; --ii) {
+        if ((mask & ((uint64_t)1 << (ii - 1))) != 0) {
+            /* The new subsystem is more significant than those so far. */
+            for (jj = dims[ii - 1]; jj > 0; --jj) {
+                for (kk = 0; kk < length; ++kk) {
+                    table[((jj - 1) * length) + kk] = table[kk] + ((jj - 1) * stride);
+                }
+            }
+            length *= dims[ii - 1];
+        }
+        stride *= dims[ii - 1];
+    }
+}
+
+static void partial(void * context, size_t begin, size_t end)
+{
+    const dirac_partial_t * partialp = (const dirac_partial_t *)context;
+    const dirac_complex_t * restrict aa = partialp->aa;
+    const size_t * restrict traced = partialp->traced;
+    size_t diagonal = partialp->order + 1;
+    const dirac_complex_t * restrict base;
+    double re;
+    double im;
+    size_t rr;
+    size_t cc;
+    size_t tt;
+    for (rr = begin; rr < end; ++rr) {
+        for (cc = 0; cc < partialp->keeps; ++cc) {
+            base = &(aa[(partialp->kept[rr] * partialp->order) + partialp->kept[cc]]);
+            re = 0.0;
+            im = 0.0;
+            for (tt = 0; tt < partialp->traces; ++tt) {
+                re += creal(base[traced[tt] * diagonal]);
+                im += cimag(base[traced[tt] * diagonal]);
+            }
+            partialp->tt[(rr * partialp->keeps) + cc] = CMPLX(re, im);
+        }
+    }
+}
+
+dirac_matrix_t * dirac_matrix_ptrace(const dirac_matrix_t * thema, const size_t dims[], size_t count, uint64_t keep)
+{
+    DIRAC_TRACE_BEGIN;
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * that = (dirac_t *)0;
+    dirac_t * expanded = (dirac_t *)0;
+    size_t * table = (size_t *)0;
+    dirac_partial_t context;
+    size_t order = 1;
+    size_t ii;
+
+    do {
+
+        if ((thata == (const dirac_t *)0) || (dims == (const size_t *)0) || (count == 0) || (count > 64)) {
+            errno = EINVAL;
+            break;
+        }
+
+        if ((count < 64) && ((keep >> count) != 0)) {
+            errno = EINVAL;
+            break;
+        }
+
+        context.keeps = 1;
+        context.traces = 1;
+        for (ii = 0; ii < count; ++ii) {
+            if (dims[ii] == 0) {
+                break;
+            }
+            order *= dims[ii];
+            if ((keep & ((uint64_t)1 << ii)) != 0) {
+                context.keeps *= dims[ii];
+            } else {
+                context.traces *= dims[ii];
+            }
+        }
+        if ((ii < count) || (dirac_core_rows_get(thata) != order) || (dirac_core_cols_get(thata) != order)) {
+            errno = EINVAL;
+            break;
+        }
+
+        if ((table = (size_t *)malloc((context.keeps + context.traces) * sizeof(size_t))) == (size_t *)0) {
+            break;
+        }
+
+        if (!dirac_core_is_dense(thata)) {
+            if ((expanded = dirac_core_allocate(order, order)) == (dirac_t *)0) {
+                break;
+            }
+            dirac_core_expand(dirac_core_body_mut(expanded), thata, 1.0);
+            thata = expanded;
+        }
+
+        if ((that = dirac_core_allocate(context.keeps, context.keeps)) == (dirac_t *)0) {
+            break;
+        }
+
+        dirac_core_offsets(table, dims, count, keep);
+        dirac_core_offsets(&(table[context.keeps]), dims, count, ~keep);
+        context.tt = dirac_core_body_mut(that);
+        context.aa = dirac_core_body_get(thata);
+        context.kept = table;
+        context.traced = &(table[context.keeps]);
+        context.order = order;
+        dirac_core_parallel(context.keeps, dirac_core_grain(context.keeps * context.traces), partial, &context);
+
+    } while (0);
+
+    if (expanded != (dirac_t *)0) {
+        (void)dirac_core_free(expanded);
+    }
+
+    free(table);
+
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_matrix_ptrace");
+    }
+
+    DIRAC_TRACE_END(DIRAC_TRACE_PTRACE, dirac_core_object_get(thema), (const dirac_t *)0, that);
+    return dirac_core_matrix_mut(that);
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
@@ -0,0 +1,381 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the measurement sampling portions of
+ * Dirac. The probabilities of the outcomes are computed once, in
+ * parallel, and made into an alias table, after which each shot costs two
+ * random numbers and one comparison whatever the number of outcomes.
+ * Shots are drawn in fixed chunks, each from its own random stream seeded
+ * from the seed and the number of the chunk, so a seed always produces
+ * the same shots however many threads draw them.
+ *
+ * REFERENCES
+ *
+ * M. Vose, "A Linear Algorithm for Generating Random Numbers with a Given
+ * Distribution", IEEE Transactions on Software Engineering, 17.9, 1991
+ *
+ * D. Blackman, S. Vigna, "Scrambled Linear Pseudorandom Number
+ * Generators", ACM Transactions on Mathematical Software, 47.4, 2021
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/*
+ * Shots drawn from each random stream.
+ */
+static const size_t CHUNK = 4096;
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+struct DiracSampler {
+    double * probability;
+    size_t * alias;
+    size_t outcomes;
+};
+
+typedef struct DiracWeigh {
+    double * weights;
+    const dirac_complex_t * aa;
+    const size_t * kept;
+    const size_t * traced;
+    size_t traces;
+} dirac_weigh_t;
+
+typedef struct DiracDraw {
+    const dirac_sampler_t * sampler;
+    uint64_t * shots;
+    size_t count;
+    uint64_t seed;
+} dirac_draw_t;
+
+/*******************************************************************************
+ * RANDOM NUMBERS
+ ******************************************************************************/
+
+/*
+ * Each stream is a xoshiro256** generator whose state is filled from
+ * splitmix64 starting at the seed mixed with the number of the stream.
+ */
+
+typedef struct DiracRandom {
+    uint64_t state[4];
+} dirac_random_t;
+
+static inline uint64_t splitmix(uint64_t * xp)
+{
+    uint64_t zz = (*xp += 0x9e3779b97f4a7c15ULL);
+    zz = (zz ^ (zz >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    zz = (zz ^ (zz >> 27)) * 0x94d049bb133111ebULL;
+    return zz ^ (zz >> 31);
+}
+
+static inline uint64_t rotate(uint64_t xx, int kk)
+{
+    return (xx << kk) | (xx >> (64 - kk));
+}
+
+static void start(dirac_random_t * randomp, uint64_t seed, uint64_t stream)
+{
+    uint64_t xx = seed ^ splitmix(&stream);
+    size_t ii;
+    for (ii = 0; ii < 4; ++ii) {
+        randomp->state[ii] = splitmix(&xx);
+    }
+}
+
+static inline uint64_t next(dirac_random_t * randomp)
+{
+    uint64_t * ss = randomp->state;
+    uint64_t result = rotate(ss[1] * 5, 7) * 9;
+    uint64_t tt = ss[1] << 17;
+    ss[2] ^= ss[0];
+    ss[3] ^= ss[1];
+    ss[1] ^= ss[2];
+    ss[0] ^= ss[3];
+    ss[2] ^= tt;
+    ss[3] = rotate(ss[3], 45);
+    return result;
+}
+
+/*
+ * Returns a uniform double in [0..1).
+ */
+static inline double uniform(dirac_random_t * randomp)
+{
+    return (double)(next(randomp) >> 11) * 0x1.0p-53;
+}
+
+/*******************************************************************************
+ * KERNELS
+ ******************************************************************************/
+
+static void weigh(void * context, size_t begin, size_t end)
+{
+    const dirac_weigh_t * weighp = (const dirac_weigh_t *)context;
+    const dirac_complex_t * restrict aa = weighp->aa;
+    const size_t * restrict traced = weighp->traced;
+    const dirac_complex_t * restrict base;
+    double sum;
+    size_t mm;
+    size_t tt;
+    for (mm = begin; mm < end; ++mm) {
+        base = &(aa[weighp->kept[mm]]);
+        sum = 0.0;
+        for (tt = 0; tt < weighp->traces; ++tt) {
+            sum += (creal(base[traced[tt]]) * creal(base[traced[tt]])) + (cimag(base[traced[tt]]) * cimag(base[traced[tt]]));
+        }
+        weighp->weights[mm] = sum;
+    }
+}
+
+static void draw(void * context, size_t begin, size_t end)
+{
+    const dirac_draw_t * drawp = (const dirac_draw_t *)context;
+    const double * restrict probability = drawp->sampler->probability;
+    const size_t * restrict alias = drawp->sampler->alias;
+    double outcomes = (double)drawp->sampler->outcomes;
+    uint64_t * restrict shots = drawp->shots;
+    dirac_random_t generator;
+    size_t low;
+    size_t high;
+    size_t cc;
+    size_t ii;
+    size_t column;
+    for (cc = begin; cc < end; ++cc) {
+        start(&generator, drawp->seed, cc);
+        low = cc * CHUNK;
+        high = ((low + CHUNK) < drawp->count) ? (low + CHUNK) : drawp->count;
+        for (ii = low; ii < high; ++ii) {
+            column = (size_t)(uniform(&generator) * outcomes);
+            if (column >= drawp->sampler->outcomes) {
+                column = drawp->sampler->outcomes - 1;
+            }
+            shots[ii] = (uniform(&generator) < probability[column]) ? column : alias[column];
+        }
+    }
+}
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+/*
+ * Makes the alias table from the OUTCOMES weights in PROBABILITY, which it
+ * overwrites. Returns -1 if the weights are all zero.
+ */
+static int tabulate(double * probability, size_t * alias, size_t outcomes)
+{
+    size_t * small = (size_t *)0;
+    size_t * large = (size_t *)0;
+    size_t smalls = 0;
+    size_t larges = 0;
+    size_t ll;
+    size_t ss;
+    size_t ii;
+    double total = 0.0;
+    double scale;
+    int rc = -1;
+
+    do {
+
+        for (ii = 0; ii < outcomes; ++ii) {
+            total += probability[ii];
+        }
+        if (!((total > 0.0) && isfinite(total))) {
+            errno = EDOM;
+            break;
+        }
+
+        if ((small = (size_t *)malloc(2 * outcomes * sizeof(size_t))) == (size_t *)0) {
+            break;
+        }
+        large = &(small[outcomes]);
+
+        scale = outcomes / total;
+        for (ii = 0; ii < outcomes; ++ii) {
+            probability[ii] *= scale;
+            alias[ii] = ii;
+            if (probability[ii] < 1.0) {
+                small[smalls++] = ii;
+            } else {
+                large[larges++] = ii;
+            }
+        }
+
+        while ((smalls > 0) && (larges > 0)) {
+            ss = small[--smalls];
+            ll = large[larges - 1];
+            alias[ss] = ll;
+            probability[ll] -= 1.0 - probability[ss];
+            if (probability[ll] < 1.0) {
+                --larges;
+                small[smalls++] = ll;
+            }
+        }
+
+        /* Whatever is left over is one to within rounding. */
+        while (larges > 0) {
+            probability[large[--larges]] = 1.0;
+        }
+        while (smalls > 0) {
+            probability[small[--smalls]] = 1.0;
+        }
+
+        rc = 0;
+
+    } while (0);
+
+    free(small);
+
+    return rc;
+}
+
+/*******************************************************************************
+ * PUBLIC OPERATIONS
+ ******************************************************************************/
+
+dirac_sampler_t * dirac_sampler_new(const dirac_matrix_t * themv, uint64_t keep)
+{
+    dirac_t * temp = (dirac_t *)0;
+    const dirac_t * thatv = dirac_core_object_get(themv);
+    dirac_sampler_t * sampler = (dirac_sampler_t *)0;
+    size_t * table = (size_t *)0;
+    size_t dims[64];
+    dirac_weigh_t context;
+    size_t length;
+    size_t qubits;
+    size_t ii;
+
+    do {
+
+        if ((thatv == (const dirac_t *)0) || !dirac_core_is_array(thatv) || (dirac_core_cols_get(thatv) != 1) || (dirac_core_rows_get(thatv) == 0)) {
+            errno = EINVAL;
+            break;
+        }
+
+        if ((thatv = dirac_core_dense_get(thatv, &temp)) == (const dirac_t *)0) {
+            break;
+        }
+
+        length = dirac_core_rows_get(thatv);
+        for (qubits = 0; (qubits < 64) && ((length >> qubits) > 1); ++qubits) {
+            dims[qubits] = 2;
+        }
+
+        if (keep == DIRAC_SAMPLE_ALL) {
+            context.traces = 1;
+        } else if ((((size_t)1 << qubits) != length) || ((qubits < 64) && ((keep >> qubits) != 0))) {
+            errno = EINVAL;
+            break;
+        } else {
+            context.traces = length;
+            for (ii = 0; ii < qubits; ++ii) {
+                if ((keep & ((uint64_t)1 << ii)) != 0) {
+                    context.traces /= 2;
+                }
+            }
+        }
+
+        if ((sampler = (dirac_sampler_t *)malloc(sizeof(dirac_sampler_t))) == (dirac_sampler_t *)0) {
+            break;
+        }
+        sampler->outcomes = length / context.traces;
+        sampler->probability = (double *)malloc(sampler->outcomes * sizeof(double));
+        sampler->alias = (size_t *)malloc(sampler->outcomes * sizeof(size_t));
+        table = (size_t *)malloc((sampler->outcomes + context.traces) * sizeof(size_t));
+        if ((sampler->probability == (double *)0) || (sampler->alias == (size_t *)0) || (table == (size_t *)0)) {
+            dirac_sampler_delete(sampler);
+            sampler = (dirac_sampler_t *)0;
+            break;
+        }
+
+        if (keep == DIRAC_SAMPLE_ALL) {
+            for (ii = 0; ii < length; ++ii) {
+                table[ii] = ii;
+            }
+            table[length] = 0;
+        } else {
+            dirac_core_offsets(table, dims, qubits, keep);
+            dirac_core_offsets(&(table[sampler->outcomes]), dims, qubits, ~keep);
+        }
+
+        context.weights = sampler->probability;
+        context.aa = dirac_core_body_get(thatv);
+        context.kept = table;
+        context.traced = &(table[sampler->outcomes]);
+        dirac_core_parallel(sampler->outcomes, dirac_core_grain(context.traces), weigh, &context);
+
+        if (tabulate(sampler->probability, sampler->alias, sampler->outcomes) < 0) {
+            dirac_sampler_delete(sampler);
+            sampler = (dirac_sampler_t *)0;
+            break;
+        }
+
+    } while (0);
+
+    free(table);
+    (void)dirac_core_free(temp);
+
+    if (sampler == (dirac_sampler_t *)0) {
+        diminuto_perror("dirac_sampler_new");
+    }
+
+    return sampler;
+}
+
+void dirac_sampler_delete(dirac_sampler_t * sampler)
+{
+    if (sampler != (dirac_sampler_t *)0) {
+        free(sampler->alias);
+        free(sampler->probability);
+        free(sampler);
+    }
+}
+
+size_t dirac_sampler_outcomes_get(const dirac_sampler_t * sampler)
+{
+    return (sampler != (const dirac_sampler_t *)0) ? sampler->outcomes : 0;
+}
+
+ssize_t dirac_sampler_draw(const dirac_sampler_t * sampler, uint64_t seed, uint64_t * shots, size_t count)
+{
+    ssize_t result = -1;
+    dirac_draw_t context;
+    if ((sampler == (const dirac_sampler_t *)0) || ((shots == (uint64_t *)0) && (count > 0))) {
+        errno = EINVAL;
+        diminuto_perror("dirac_sampler_draw");
+    } else {
+        context.sampler = sampler;
+        context.shots = shots;
+        context.count = count;
+        context.seed = seed;
+        dirac_core_parallel((count + CHUNK - 1) / CHUNK, dirac_core_grain(CHUNK), draw, &context);
+        result = count;
+    }
+    return result;
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
@@ -0,0 +1,337 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the shared memory portions of Dirac. A
+ * segment is laid out exactly like a matrix file, so the mapping is the
+ * matrix, and the generation counter in the file header is the word that
+ * waiting processes sleep on with a futex.
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+/*
+ * Not private futexes: the waiters and the waker are in different
+ * processes.
+ */
+
+static int futex_wait(uint32_t * word, uint32_t expected, const struct timespec * timeout)
+{
+    return syscall(SYS_futex, word, FUTEX_WAIT, expected, timeout, (uint32_t *)0, 0);
+}
+
+static int futex_wake(uint32_t * word)
+{
+    return syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, (struct timespec *)0, (uint32_t *)0, 0);
+}
+
+/*
+ * Returns the object of a shared segment, or null with errno set.
+ */
+static const dirac_t * shared(const dirac_matrix_t * them, const char * name)
+{
+    const dirac_t * that = dirac_core_object_get(them);
+    if (that == (const dirac_t *)0) {
+        /* Do nothing. */
+    } else if ((that->data.head.flags & DIRAC_FLAG_SHARED) == 0) {
+        errno = EINVAL;
+        diminuto_perror(name);
+        that = (const dirac_t *)0;
+    } else {
+        /* Do nothing. */
+    }
+    return that;
+}
+
+/*******************************************************************************
+ * SEGMENTS
+ ******************************************************************************/
+
+dirac_matrix_t * dirac_shared_new(const char * name, size_t rows, size_t columns)
+{
+    dirac_matrix_t * them = (dirac_matrix_t *)0;
+    dirac_data_t head = { rows, columns, rows * columns, DIRAC_KIND_DENSE, 0, };
+    dirac_data_t * image;
+    void * base = MAP_FAILED;
+    size_t size = 0;
+    int fd = -1;
+
+    do {
+
+        if ((rows == 0) || (columns == 0)) {
+            errno = EINVAL;
+            diminuto_perror("dirac_shared_new");
+            break;
+        }
+
+        /* Never reshape a segment that other processes may have mapped. */
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd < 0) {
+            diminuto_perror("dirac_shared_new: shm_open");
+            break;
+        }
+
+        size = DIRAC_FILE_OFFSET + dirac_core_length_kind(head.kind, rows, columns, head.count);
+        if (ftruncate(fd, size) < 0) {
+            diminuto_perror("dirac_shared_new: ftruncate");
+            (void)shm_unlink(name);
+            break;
+        }
+
+        base = mmap((void *)0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            diminuto_perror("dirac_shared_new: mmap");
+            (void)shm_unlink(name);
+            break;
+        }
+
+        /* The body is already zero, and so is the generation. */
+        dirac_core_file_header(base, &head);
+        image = (dirac_data_t *)((char *)base + DIRAC_FILE_OFFSET - offsetof(dirac_t, data.body));
+        image->flags |= DIRAC_FLAG_SHARED;
+
+        them = (dirac_matrix_t *)((char *)base + DIRAC_FILE_OFFSET);
+
+    } while (0);
+
+    if (fd >= 0) {
+        (void)close(fd);
+    }
+
+    return them;
+}
+
+const dirac_matrix_t * dirac_shared_attach(const char * name)
+{
+    const dirac_matrix_t * them = (const dirac_matrix_t *)0;
+    const dirac_data_t * head;
+    struct stat status;
+    void * base = MAP_FAILED;
+    size_t size = 0;
+    int fd = -1;
+
+    do {
+
+        fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0) {
+            diminuto_perror("dirac_shared_attach: shm_open");
+            break;
+        }
+
+        if (fstat(fd, &status) < 0) {
+            diminuto_perror("dirac_shared_attach: fstat");
+            break;
+        }
+
+        if (status.st_size < DIRAC_FILE_OFFSET) {
+            errno = EINVAL;
+            diminuto_perror("dirac_shared_attach");
+            break;
+        }
+
+        size = status.st_size;
+        base = mmap((void *)0, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            diminuto_perror("dirac_shared_attach: mmap");
+            break;
+        }
+
+        head = dirac_core_file_check(base, size);
+        if ((head == (const dirac_data_t *)0) || ((head->flags & DIRAC_FLAG_SHARED) == 0) || !dirac_core_file_valid(base)) {
+            (void)munmap(base, size);
+            errno = EINVAL;
+            diminuto_perror("dirac_shared_attach");
+            break;
+        }
+
+        them = (const dirac_matrix_t *)((const char *)base + DIRAC_FILE_OFFSET);
+
+    } while (0);
+
+    if (fd >= 0) {
+        (void)close(fd);
+    }
+
+    return them;
+}
+
+int dirac_shared_unlink(const char * name)
+{
+    int rc = shm_unlink(name);
+    if (rc < 0) {
+        diminuto_perror("dirac_shared_unlink: shm_unlink");
+    }
+    return rc;
+}
+
+/*******************************************************************************
+ * GENERATIONS
+ ******************************************************************************/
+
+/*
+ * The generation is a sequence lock: it is odd while the producer is
+ * changing the body and even once it has published it.
+ */
+
+int dirac_shared_begin(dirac_matrix_t * them)
+{
+    int rc = -1;
+    const dirac_t * that = shared(them, "dirac_shared_begin");
+    uint32_t * word;
+    uint32_t generation;
+    if (that != (const dirac_t *)0) {
+        word = dirac_core_file_generation(that);
+        generation = __atomic_load_n(word, __ATOMIC_RELAXED);
+        if ((generation & 1) == 0) {
+            __atomic_store_n(word, generation + 1, __ATOMIC_RELAXED);
+            /* No store to the body may be seen before the counter is odd. */
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+        }
+        rc = 0;
+    }
+    return rc;
+}
+
+int64_t dirac_shared_publish(dirac_matrix_t * them)
+{
+    int64_t result = -1;
+    const dirac_t * that = shared(them, "dirac_shared_publish");
+    uint32_t * word;
+    uint32_t generation;
+    if (that != (const dirac_t *)0) {
+        word = dirac_core_file_generation(that);
+        generation = (__atomic_load_n(word, __ATOMIC_RELAXED) | 1) + 1;
+        __atomic_store_n(word, generation, __ATOMIC_RELEASE);
+        if (futex_wake(word) < 0) {
+            diminuto_perror("dirac_shared_publish: futex");
+        } else {
+            result = generation;
+        }
+    }
+    return result;
+}
+
+int64_t dirac_shared_generation_get(const dirac_matrix_t * them)
+{
+    int64_t result = -1;
+    const dirac_t * that = shared(them, "dirac_shared_generation_get");
+    if (that != (const dirac_t *)0) {
+        result = __atomic_load_n(dirac_core_file_generation(that), __ATOMIC_ACQUIRE);
+    }
+    return result;
+}
+
+int64_t dirac_shared_wait(const dirac_matrix_t * them, int64_t generation, int milliseconds)
+{
+    int64_t result = -1;
+    const dirac_t * that = shared(them, "dirac_shared_wait");
+    uint32_t * word;
+    uint32_t current;
+    struct timespec now;
+    struct timespec deadline = { 0, 0, };
+    struct timespec remaining;
+    struct timespec * timeout = (struct timespec *)0;
+
+    do {
+
+        if (that == (const dirac_t *)0) {
+            break;
+        }
+
+        word = dirac_core_file_generation(that);
+
+        if (milliseconds >= 0) {
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_sec += milliseconds / 1000;
+            deadline.tv_nsec += (milliseconds % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec += 1;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            timeout = &remaining;
+        }
+
+        while (!0) {
+
+            current = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+            if (((current & 1) == 0) && (current != (uint32_t)generation)) {
+                result = current;
+                break;
+            }
+
+            if (timeout != (struct timespec *)0) {
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                remaining.tv_sec = deadline.tv_sec - now.tv_sec;
+                remaining.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+                if (remaining.tv_nsec < 0) {
+                    remaining.tv_sec -= 1;
+                    remaining.tv_nsec += 1000000000L;
+                }
+                if (remaining.tv_sec < 0) {
+                    errno = ETIMEDOUT;
+                    break;
+                }
+            }
+
+            /* Returns at once if the counter has already moved on. */
+            if (futex_wait(word, current, timeout) == 0) {
+                /* Do nothing. */
+            } else if (errno == EAGAIN) {
+                /* Do nothing. */
+            } else if (errno == EINTR) {
+                /* Do nothing. */
+            } else if (errno == ETIMEDOUT) {
+                /* Do nothing. */
+            } else {
+                diminuto_perror("dirac_shared_wait: futex");
+                break;
+            }
+
+        }
+
+    } while (0);
+
+    return result;
+}
+
+int dirac_shared_valid(const dirac_matrix_t * them, int64_t generation)
+{
+    int rc = 0;
+    const dirac_t * that = shared(them, "dirac_shared_valid");
+    if (that != (const dirac_t *)0) {
+        /* No load from the body may be seen after the counter is read. */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        rc = (__atomic_load_n(dirac_core_file_generation(that), __ATOMIC_RELAXED) == (uint32_t)generation);
+    }
+    return rc;
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
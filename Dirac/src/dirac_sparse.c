@@ -0,0 +1,572 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the sparse-related portions of Dirac.
+ *
+ * REFERENCES
+ *
+ * Wikipedia, "Sparse matrix", 2025-05-01
+ *
+ * F. Gustavson, "Two Fast Algorithms for Sparse Matrices: Multiplication
+ * and Permuted Transposition", ACM TOMS, 4.3, 1978
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+typedef struct DiracProduct {
+    dirac_t * that;
+    const dirac_t * thata;
+    const dirac_t * thatb;
+} dirac_product_t;
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+static inline int is_sparse(const dirac_t * that) {
+    return (dirac_core_kind_get(that) == DIRAC_KIND_SPARSE);
+}
+
+static int compare(const void * a, const void * b)
+{
+    size_t aa = *(const size_t *)a;
+    size_t bb = *(const size_t *)b;
+    /* Didn't use subtraction so as to insure result fits in an int. */
+    if (aa < bb) {
+        return -1;
+    } else if (aa > bb) {
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+static dirac_t * structured_to_sparse(const dirac_t * thata)
+{
+    dirac_t * that = (dirac_t *)0;
+    const dirac_complex_t * aa = dirac_core_body_get(thata);
+    const size_t * acolumns = (dirac_core_kind_get(thata) == DIRAC_KIND_PERMUTATION) ? dirac_core_permutation_columns_get(thata) : (const size_t *)0;
+    size_t rows = dirac_core_rows_get(thata);
+    size_t nonzeros = 0;
+    dirac_complex_t * tt;
+    size_t * columns;
+    size_t * offsets;
+    size_t rr;
+    size_t ii;
+
+    for (rr = 0; rr < rows; ++rr) {
+        if (aa[rr] != 0) {
+            ++nonzeros;
+        }
+    }
+
+    that = dirac_core_allocate_kind(DIRAC_KIND_SPARSE, rows, dirac_core_cols_get(thata), nonzeros);
+    if (that != (dirac_t *)0) {
+        tt = dirac_core_body_mut(that);
+        columns = dirac_core_sparse_columns_mut(that);
+        offsets = dirac_core_sparse_offsets_mut(that);
+        for (rr = 0, ii = 0; rr < rows; ++rr) {
+            offsets[rr] = ii;
+            if (aa[rr] != 0) {
+                tt[ii] = aa[rr];
+                columns[ii] = (acolumns != (const size_t *)0) ? acolumns[rr] : rr;
+                ++ii;
+            }
+        }
+        offsets[rows] = ii;
+    }
+
+    return that;
+}
+
+static dirac_t * dense_to_sparse(const dirac_t * thata)
+{
+    dirac_t * that = (dirac_t *)0;
+    const dirac_complex_t * aa = dirac_core_body_get(thata);
+    size_t rows = dirac_core_rows_get(thata);
+    size_t cols = dirac_core_cols_get(thata);
+    size_t nonzeros = 0;
+    dirac_complex_t * tt;
+    size_t * columns;
+    size_t * offsets;
+    size_t rr;
+    size_t cc;
+    size_t ii;
+
+    for (ii = 0; ii < (rows * cols); ++ii) {
+        if (aa[ii] != 0) {
+            ++nonzeros;
+        }
+    }
+
+    that = dirac_core_allocate_kind(DIRAC_KIND_SPARSE, rows, cols, nonzeros);
+    if (that != (dirac_t *)0) {
+        tt = dirac_core_body_mut(that);
+        columns = dirac_core_sparse_columns_mut(that);
+        offsets = dirac_core_sparse_offsets_mut(that);
+        for (rr = 0, ii = 0; rr < rows; ++rr) {
+            offsets[rr] = ii;
+            for (cc = 0; cc < cols; ++cc) {
+                if (aa[(rr * cols) + cc] != 0) {
+                    tt[ii] = aa[(rr * cols) + cc];
+                    columns[ii] = cc;
+                    ++ii;
+                }
+            }
+        }
+        offsets[rows] = ii;
+    }
+
+    return that;
+}
+
+/*******************************************************************************
+ * KERNELS
+ ******************************************************************************/
+
+/*
+ * Sparse times dense: each target row is the sum of the rows of B selected
+ * by the nonzeros of the same row of A. The inner loop runs with unit
+ * stride across a row of B and the target, so the compiler can vectorize
+ * it; a column vector B degenerates to a gathered dot product.
+ */
+static void sparse_dense(void * context, size_t begin, size_t end)
+{
+    const dirac_product_t * productp = (const dirac_product_t *)context;
+    const dirac_complex_t * restrict aa = dirac_core_body_get(productp->thata);
+    const size_t * restrict columns = dirac_core_sparse_columns_get(productp->thata);
+    const size_t * restrict offsets = dirac_core_sparse_offsets_get(productp->thata);
+    const dirac_complex_t * restrict bb = dirac_core_body_get(productp->thatb);
+    dirac_complex_t * restrict tt = dirac_core_body_mut(productp->that);
+    size_t cols = dirac_core_cols_get(productp->thatb);
+    const dirac_complex_t * restrict brow;
+    dirac_complex_t * restrict trow;
+    dirac_complex_t factor;
+    dirac_complex_t sum;
+    size_t rr;
+    size_t ii;
+    size_t cc;
+
+    if (cols == 1) {
+        for (rr = begin; rr < end; ++rr) {
+            sum = 0;
+            for (ii = offsets[rr]; ii < offsets[rr + 1]; ++ii) {
+                sum += aa[ii] * bb[columns[ii]];
+            }
+            tt[rr] = sum;
+        }
+    } else {
+        for (rr = begin; rr < end; ++rr) {
+            trow = &(tt[rr * cols]);
+            for (ii = offsets[rr]; ii < offsets[rr + 1]; ++ii) {
+                factor = aa[ii];
+                brow = &(bb[columns[ii] * cols]);
+                for (cc = 0; cc < cols; ++cc) {
+                    trow[cc] += factor * brow[cc];
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Dense times sparse: each element of a row of A scales the corresponding
+ * sparse row of B, which is scattered into the target row.
+ */
+static void dense_sparse(void * context, size_t begin, size_t end)
+{
+    const dirac_product_t * productp = (const dirac_product_t *)context;
+    const dirac_complex_t * restrict aa = dirac_core_body_get(productp->thata);
+    const dirac_complex_t * restrict bb = dirac_core_body_get(productp->thatb);
+    const size_t * restrict columns = dirac_core_sparse_columns_get(productp->thatb);
+    const size_t * restrict offsets = dirac_core_sparse_offsets_get(productp->thatb);
+    dirac_complex_t * restrict tt = dirac_core_body_mut(productp->that);
+    size_t muls = dirac_core_cols_get(productp->thata);
+    size_t cols = dirac_core_cols_get(productp->thatb);
+    dirac_complex_t * restrict trow;
+    dirac_complex_t factor;
+    size_t rr;
+    size_t mm;
+    size_t ii;
+
+    for (rr = begin; rr < end; ++rr) {
+        trow = &(tt[rr * cols]);
+        for (mm = 0; mm < muls; ++mm) {
+            factor = aa[(rr * muls) + mm];
+            if (factor != 0) {
+                for (ii = offsets[mm]; ii < offsets[mm + 1]; ++ii) {
+                    trow[columns[ii]] += factor * bb[ii];
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Sparse times sparse using Gustavson's algorithm: a symbolic pass counts
+ * the nonzeros of each target row using a marker per column, then a
+ * numeric pass accumulates each row in a dense scratch row and gathers it.
+ */
+static dirac_t * sparse_sparse(const dirac_t * thata, const dirac_t * thatb)
+{
+    dirac_t * that = (dirac_t *)0;
+    const dirac_complex_t * aa = dirac_core_body_get(thata);
+    const size_t * acolumns = dirac_core_sparse_columns_get(thata);
+    const size_t * aoffsets = dirac_core_sparse_offsets_get(thata);
+    const dirac_complex_t * bb = dirac_core_body_get(thatb);
+    const size_t * bcolumns = dirac_core_sparse_columns_get(thatb);
+    const size_t * boffsets = dirac_core_sparse_offsets_get(thatb);
+    size_t rows = dirac_core_rows_get(thata);
+    size_t cols = dirac_core_cols_get(thatb);
+    size_t * marker = (size_t *)0;
+    dirac_complex_t * scratch = (dirac_complex_t *)0;
+    dirac_complex_t * tt;
+    size_t * tcolumns;
+    size_t * toffsets;
+    size_t nonzeros = 0;
+    size_t rr;
+    size_t ii;
+    size_t jj;
+    size_t cc;
+    size_t first;
+
+    do {
+
+        marker = (size_t *)malloc(cols * sizeof(marker[0]));
+        scratch = (dirac_complex_t *)malloc(cols * sizeof(scratch[0]));
+        if ((marker == (size_t *)0) || (scratch == (dirac_complex_t *)0)) {
+            errno = ENOMEM;
+            break;
+        }
+
+        for (cc = 0; cc < cols; ++cc) {
+            marker[cc] = ~(size_t)0;
+        }
+        for (rr = 0; rr < rows; ++rr) {
+            for (ii = aoffsets[rr]; ii < aoffsets[rr + 1]; ++ii) {
+                for (jj = boffsets[acolumns[ii]]; jj < boffsets[acolumns[ii] + 1]; ++jj) {
+                    if (marker[bcolumns[jj]] != rr) {
+                        marker[bcolumns[jj]] = rr;
+                        ++nonzeros;
+                    }
+                }
+            }
+        }
+
+        that = dirac_core_allocate_kind(DIRAC_KIND_SPARSE, rows, cols, nonzeros);
+        if (that == (dirac_t *)0) {
+            break;
+        }
+        tt = dirac_core_body_mut(that);
+        tcolumns = dirac_core_sparse_columns_mut(that);
+        toffsets = dirac_core_sparse_offsets_mut(that);
+
+        for (cc = 0; cc < cols; ++cc) {
+            marker[cc] = ~(size_t)0;
+        }
+        for (rr = 0, nonzeros = 0; rr < rows; ++rr) {
+            toffsets[rr] = first = nonzeros;
+            for (ii = aoffsets[rr]; ii < aoffsets[rr + 1]; ++ii) {
+                for (jj = boffsets[acolumns[ii]]; jj < boffsets[acolumns[ii] + 1]; ++jj) {
+                    cc = bcolumns[jj];
+                    if (marker[cc] != rr) {
+                        marker[cc] = rr;
+                        scratch[cc] = 0;
+                        tcolumns[nonzeros++] = cc;
+                    }
+                    scratch[cc] += aa[ii] * bb[jj];
+                }
+            }
+            qsort(&(tcolumns[first]), nonzeros - first, sizeof(tcolumns[0]), compare);
+            for (jj = first; jj < nonzeros; ++jj) {
+                tt[jj] = scratch[tcolumns[jj]];
+            }
+        }
+        toffsets[rows] = nonzeros;
+
+    } while (0);
+
+    free(scratch);
+    free(marker);
+
+    return that;
+}
+
+/*******************************************************************************
+ * PRIVATE OPERATIONS
+ ******************************************************************************/
+
+dirac_t * dirac_core_to_sparse(const dirac_t * thata)
+{
+    dirac_t * that = (dirac_t *)0;
+    dirac_t * temp;
+    if (dirac_core_is_dense(thata)) {
+        that = dense_to_sparse(thata);
+    } else if (dirac_core_is_structured(thata)) {
+        that = structured_to_sparse(thata);
+    } else if (!dirac_core_is_packed(thata) && !dirac_core_is_strided(thata)) {
+        errno = EINVAL;
+    } else if ((temp = dirac_core_allocate(dirac_core_rows_get(thata), dirac_core_cols_get(thata))) != (dirac_t *)0) {
+        dirac_core_expand(dirac_core_body_mut(temp), thata, 1.0);
+        that = dense_to_sparse(temp);
+        (void)dirac_core_free(temp);
+    } else {
+        /* Do nothing. */
+    }
+    return that;
+}
+
+/*
+ * A diagonal or permutation operand that reaches here is paired with a
+ * sparse one, so it is compressed into a temporary first.
+ */
+dirac_t * dirac_core_mul_sparse(const dirac_t * thata, const dirac_t * thatb)
+{
+    dirac_product_t product = { (dirac_t *)0, thata, thatb, };
+    dirac_t * tempa = (dirac_t *)0;
+    dirac_t * tempb = (dirac_t *)0;
+    size_t work;
+
+    do {
+
+        if (!dirac_core_is_structured(thata)) {
+            /* Do nothing. */
+        } else if ((tempa = structured_to_sparse(thata)) == (dirac_t *)0) {
+            break;
+        } else {
+            thata = product.thata = tempa;
+        }
+
+        if (!dirac_core_is_structured(thatb)) {
+            /* Do nothing. */
+        } else if ((tempb = structured_to_sparse(thatb)) == (dirac_t *)0) {
+            break;
+        } else {
+            thatb = product.thatb = tempb;
+        }
+
+        if (dirac_core_cols_get(thata) != dirac_core_rows_get(thatb)) {
+            errno = EINVAL;
+        } else if (is_sparse(thata) && is_sparse(thatb)) {
+            product.that = sparse_sparse(thata, thatb);
+        } else if (is_sparse(thata) && dirac_core_is_dense(thatb)) {
+            if ((product.that = dirac_core_pro(thata, thatb)) != (dirac_t *)0) {
+                work = ((dirac_core_count_get(thata) / (dirac_core_rows_get(thata) + 1)) + 1) * dirac_core_cols_get(thatb);
+                dirac_core_parallel(dirac_core_rows_get(thata), dirac_core_grain(work), sparse_dense, &product);
+            }
+        } else if (dirac_core_is_dense(thata) && is_sparse(thatb)) {
+            if ((product.that = dirac_core_pro(thata, thatb)) != (dirac_t *)0) {
+                work = dirac_core_count_get(thatb) + 1;
+                dirac_core_parallel(dirac_core_rows_get(thata), dirac_core_grain(work), dense_sparse, &product);
+            }
+        } else {
+            errno = EINVAL;
+        }
+
+    } while (0);
+
+    (void)dirac_core_free(tempb);
+    (void)dirac_core_free(tempa);
+
+    return product.that;
+}
+
+/*
+ * The Kronecker product of two CSR matrices is generated directly in CSR
+ * order: target row (ar * rowsb) + br is the cross product of the nonzeros
+ * of row ar of A and row br of B, and its columns come out sorted. An
+ * operand of any other kind is first compressed into a temporary.
+ */
+dirac_t * dirac_core_kro_sparse(const dirac_t * thata, const dirac_t * thatb)
+{
+    dirac_t * that = (dirac_t *)0;
+    dirac_t * tempa = (dirac_t *)0;
+    dirac_t * tempb = (dirac_t *)0;
+    const dirac_complex_t * aa;
+    const size_t * acolumns;
+    const size_t * aoffsets;
+    const dirac_complex_t * bb;
+    const size_t * bcolumns;
+    const size_t * boffsets;
+    dirac_complex_t * tt;
+    size_t * tcolumns;
+    size_t * toffsets;
+    size_t rowsa;
+    size_t rowsb;
+    size_t colsb;
+    size_t ar;
+    size_t br;
+    size_t ai;
+    size_t bi;
+    size_t ti;
+
+    do {
+
+        if (is_sparse(thata)) {
+            /* Do nothing. */
+        } else if ((tempa = dirac_core_to_sparse(thata)) == (dirac_t *)0) {
+            break;
+        } else {
+            thata = tempa;
+        }
+
+        if (is_sparse(thatb)) {
+            /* Do nothing. */
+        } else if ((tempb = dirac_core_to_sparse(thatb)) == (dirac_t *)0) {
+            break;
+        } else {
+            thatb = tempb;
+        }
+
+        rowsa = dirac_core_rows_get(thata);
+        rowsb = dirac_core_rows_get(thatb);
+        colsb = dirac_core_cols_get(thatb);
+
+        that = dirac_core_allocate_kind(DIRAC_KIND_SPARSE, rowsa * rowsb, dirac_core_cols_get(thata) * colsb, dirac_core_count_get(thata) * dirac_core_count_get(thatb));
+        if (that == (dirac_t *)0) {
+            break;
+        }
+
+        aa = dirac_core_body_get(thata);
+        acolumns = dirac_core_sparse_columns_get(thata);
+        aoffsets = dirac_core_sparse_offsets_get(thata);
+        bb = dirac_core_body_get(thatb);
+        bcolumns = dirac_core_sparse_columns_get(thatb);
+        boffsets = dirac_core_sparse_offsets_get(thatb);
+        tt = dirac_core_body_mut(that);
+        tcolumns = dirac_core_sparse_columns_mut(that);
+        toffsets = dirac_core_sparse_offsets_mut(that);
+
+        for (ar = 0, ti = 0; ar < rowsa; ++ar) {
+            for (br = 0; br < rowsb; ++br) {
+                toffsets[(ar * rowsb) + br] = ti;
+                for (ai = aoffsets[ar]; ai < aoffsets[ar + 1]; ++ai) {
+                    for (bi = boffsets[br]; bi < boffsets[br + 1]; ++bi) {
+                        tt[ti] = aa[ai] * bb[bi];
+                        tcolumns[ti] = (acolumns[ai] * colsb) + bcolumns[bi];
+                        ++ti;
+                    }
+                }
+            }
+        }
+        toffsets[rowsa * rowsb] = ti;
+
+    } while (0);
+
+    (void)dirac_core_free(tempb);
+    (void)dirac_core_free(tempa);
+
+    return that;
+}
+
+/*******************************************************************************
+ * PUBLIC GETTORS
+ ******************************************************************************/
+
+size_t dirac_sparse_count_get(const dirac_matrix_t * them) {
+    return dirac_core_count_get(dirac_core_object_get(them));
+}
+
+const size_t * dirac_sparse_columns_get(const dirac_matrix_t * them) {
+    const dirac_t * that = dirac_core_object_get(them);
+    return is_sparse(that) ? dirac_core_sparse_columns_get(that) : (const size_t *)0;
+}
+
+size_t * dirac_sparse_columns_mut(dirac_matrix_t * them) {
+    dirac_t * that = dirac_core_object_mut(them);
+    return is_sparse(that) ? dirac_core_sparse_columns_mut(that) : (size_t *)0;
+}
+
+const size_t * dirac_sparse_offsets_get(const dirac_matrix_t * them) {
+    const dirac_t * that = dirac_core_object_get(them);
+    return is_sparse(that) ? dirac_core_sparse_offsets_get(that) : (const size_t *)0;
+}
+
+size_t * dirac_sparse_offsets_mut(dirac_matrix_t * them) {
+    dirac_t * that = dirac_core_object_mut(them);
+    return is_sparse(that) ? dirac_core_sparse_offsets_mut(that) : (size_t *)0;
+}
+
+/*******************************************************************************
+ * PUBLIC OPERATIONS
+ ******************************************************************************/
+
+dirac_matrix_t * dirac_sparse_new(size_t rows, size_t columns, size_t count)
+{
+    dirac_t * that = dirac_core_allocate_kind(DIRAC_KIND_SPARSE, rows, columns, count);
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_sparse_new");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_sparse_from_dense(const dirac_matrix_t * thema)
+{
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * that = (dirac_t *)0;
+    if (!dirac_core_is_array(thata)) {
+        errno = EINVAL;
+    } else {
+        that = dirac_core_to_sparse(thata);
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_sparse_from_dense");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_sparse_to_dense(const dirac_matrix_t * thema)
+{
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * that = (dirac_t *)0;
+    const dirac_complex_t * aa;
+    const size_t * columns;
+    const size_t * offsets;
+    dirac_complex_t * tt;
+    size_t rows;
+    size_t cols;
+    size_t rr;
+    size_t ii;
+    if (!is_sparse(thata)) {
+        errno = EINVAL;
+    } else if ((that = dirac_core_allocate(dirac_core_rows_get(thata), dirac_core_cols_get(thata))) != (dirac_t *)0) {
+        aa = dirac_core_body_get(thata);
+        columns = dirac_core_sparse_columns_get(thata);
+        offsets = dirac_core_sparse_offsets_get(thata);
+        tt = dirac_core_body_mut(that);
+        rows = dirac_core_rows_get(thata);
+        cols = dirac_core_cols_get(thata);
+        for (rr = 0; rr < rows; ++rr) {
+            for (ii = offsets[rr]; ii < offsets[rr + 1]; ++ii) {
+                tt[(rr * cols) + columns[ii]] += aa[ii];
+            }
+        }
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_sparse_to_dense");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
@@ -0,0 +1,560 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the streaming portions of Dirac. Each
+ * stream owns two block buffers from the object cache. While the caller
+ * works on one, POSIX asynchronous I/O fills (or drains) the other, so
+ * computation and I/O overlap and at most two blocks per stream are ever
+ * in memory.
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <aio.h>
+#include <sys/stat.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+struct DiracStream {
+    struct aiocb control[2];
+    dirac_t * buffer[2];
+    size_t first[2];        /* First row in each buffer. */
+    int pending[2];         /* Asynchronous I/O in flight on each buffer. */
+    size_t rows;
+    size_t columns;
+    size_t block;           /* Rows per buffer. */
+    size_t next;            /* First row not yet submitted. */
+    int current;            /* Buffer last handed to the caller. */
+    int ready;              /* Writer: caller has the current buffer. */
+    int writing;
+    int fd;
+};
+
+typedef void (dirac_stream_kernel_t)(dirac_complex_t * tt, const dirac_complex_t * aa, const dirac_complex_t * bb, size_t count);
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/* Bytes per block if the caller leaves it to us. */
+static const size_t BLOCK = 1 << 20;
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+static inline size_t stride(const dirac_stream_t * stream) {
+    return stream->columns * sizeof(dirac_complex_t);
+}
+
+static size_t rows_per_block(size_t block, size_t rows, size_t columns)
+{
+    if (block == 0) {
+        block = BLOCK / (columns * sizeof(dirac_complex_t));
+    }
+    if (block > rows) {
+        block = rows;
+    }
+    if (block == 0) {
+        block = 1;
+    }
+    return block;
+}
+
+static int submit(dirac_stream_t * stream, int ii)
+{
+    int rc = 0;
+    size_t count = stream->rows - stream->next;
+    struct aiocb * control = &(stream->control[ii]);
+    if (count > stream->block) {
+        count = stream->block;
+    }
+    stream->buffer[ii]->data.head.rows = count;
+    stream->first[ii] = stream->next;
+    memset(control, 0, sizeof(*control));
+    control->aio_fildes = stream->fd;
+    control->aio_offset = DIRAC_FILE_OFFSET + (stream->next * stride(stream));
+    control->aio_buf = dirac_core_body_mut(stream->buffer[ii]);
+    control->aio_nbytes = count * stride(stream);
+    control->aio_sigevent.sigev_notify = SIGEV_NONE;
+    rc = stream->writing ? aio_write(control) : aio_read(control);
+    if (rc == 0) {
+        stream->pending[ii] = !0;
+        stream->next += count;
+    }
+    return rc;
+}
+
+static int complete(dirac_stream_t * stream, int ii)
+{
+    int rc = 0;
+    const struct aiocb * list[1];
+    ssize_t transferred;
+    if (stream->pending[ii]) {
+        list[0] = &(stream->control[ii]);
+        while ((rc = aio_error(list[0])) == EINPROGRESS) {
+            (void)aio_suspend(list, 1, (const struct timespec *)0);
+        }
+        transferred = aio_return(&(stream->control[ii]));
+        stream->pending[ii] = 0;
+        if (transferred < 0) {
+            errno = rc;
+            rc = -1;
+        } else if (transferred != (ssize_t)(stream->control[ii].aio_nbytes)) {
+            errno = EIO;
+            rc = -1;
+        } else {
+            rc = 0;
+        }
+    }
+    return rc;
+}
+
+static dirac_stream_t * create(int fd, size_t rows, size_t columns, size_t block, int writing)
+{
+    dirac_stream_t * stream = (dirac_stream_t *)malloc(sizeof(dirac_stream_t));
+    if (stream != (dirac_stream_t *)0) {
+        memset(stream, 0, sizeof(*stream));
+        stream->rows = rows;
+        stream->columns = columns;
+        stream->block = rows_per_block(block, rows, columns);
+        stream->current = 1;
+        stream->writing = writing;
+        stream->fd = fd;
+        stream->buffer[0] = dirac_core_allocate(stream->block, columns);
+        stream->buffer[1] = dirac_core_allocate(stream->block, columns);
+        if ((stream->buffer[0] == (dirac_t *)0) || (stream->buffer[1] == (dirac_t *)0)) {
+            dirac_core_free(stream->buffer[1]);
+            dirac_core_free(stream->buffer[0]);
+            free(stream);
+            stream = (dirac_stream_t *)0;
+        }
+    }
+    return stream;
+}
+
+/*******************************************************************************
+ * PUBLIC STREAMS
+ ******************************************************************************/
+
+dirac_stream_t * dirac_stream_reader(const char * path, size_t block)
+{
+    dirac_stream_t * stream = (dirac_stream_t *)0;
+    uint64_t header[DIRAC_FILE_OFFSET / sizeof(uint64_t)];
+    const dirac_data_t * head = (const dirac_data_t *)0;
+    struct stat status;
+    int fd = -1;
+
+    do {
+
+        fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            diminuto_perror("dirac_stream_reader: open");
+            break;
+        }
+
+        if (fstat(fd, &status) < 0) {
+            diminuto_perror("dirac_stream_reader: fstat");
+            break;
+        }
+
+        if (pread(fd, header, sizeof(header), 0) != sizeof(header)) {
+            errno = EINVAL;
+            diminuto_perror("dirac_stream_reader: pread");
+            break;
+        }
+
+        head = dirac_core_file_check(header, status.st_size);
+        if (head == (const dirac_data_t *)0) {
+            errno = EINVAL;
+            diminuto_perror("dirac_stream_reader");
+            break;
+        }
+
+        /* Only dense rows can be located without reading what precedes them. */
+        if ((head->kind != DIRAC_KIND_DENSE) || (head->rows == 0) || (head->columns == 0)) {
+            errno = EINVAL;
+            diminuto_perror("dirac_stream_reader");
+            break;
+        }
+
+        stream = create(fd, head->rows, head->columns, block, 0);
+        if (stream == (dirac_stream_t *)0) {
+            diminuto_perror("dirac_stream_reader: create");
+            break;
+        }
+
+        /* Start reading the first block right away. */
+        if (submit(stream, 0) < 0) {
+            diminuto_perror("dirac_stream_reader: aio_read");
+            (void)dirac_stream_close(stream);
+            stream = (dirac_stream_t *)0;
+            fd = -1;
+            break;
+        }
+
+    } while (0);
+
+    if ((stream == (dirac_stream_t *)0) && (fd >= 0)) {
+        (void)close(fd);
+    }
+
+    return stream;
+}
+
+dirac_stream_t * dirac_stream_writer(const char * path, size_t rows, size_t columns, size_t block)
+{
+    dirac_stream_t * stream = (dirac_stream_t *)0;
+    uint64_t header[DIRAC_FILE_OFFSET / sizeof(uint64_t)];
+    dirac_data_t head = { rows, columns, 0, DIRAC_KIND_DENSE, 0, };
+    int fd = -1;
+
+    do {
+
+        if ((rows == 0) || (columns == 0)) {
+            errno = EINVAL;
+            diminuto_perror("dirac_stream_writer");
+            break;
+        }
+
+        fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            diminuto_perror("dirac_stream_writer: open");
+            break;
+        }
+
+        dirac_core_file_header(header, &head);
+        if (pwrite(fd, header, sizeof(header), 0) != sizeof(header)) {
+            diminuto_perror("dirac_stream_writer: pwrite");
+            break;
+        }
+
+        /* Blocks may land in any order, so the file has its full size now. */
+        if (ftruncate(fd, DIRAC_FILE_OFFSET + (rows * columns * sizeof(dirac_complex_t))) < 0) {
+            diminuto_perror("dirac_stream_writer: ftruncate");
+            break;
+        }
+
+        stream = create(fd, rows, columns, block, !0);
+        if (stream == (dirac_stream_t *)0) {
+            diminuto_perror("dirac_stream_writer: create");
+            break;
+        }
+
+    } while (0);
+
+    if ((stream == (dirac_stream_t *)0) && (fd >= 0)) {
+        (void)close(fd);
+    }
+
+    return stream;
+}
+
+size_t dirac_stream_rows_get(const dirac_stream_t * stream) {
+    return stream->rows;
+}
+
+size_t dirac_stream_cols_get(const dirac_stream_t * stream) {
+    return stream->columns;
+}
+
+size_t dirac_stream_block_get(const dirac_stream_t * stream) {
+    return stream->block;
+}
+
+size_t dirac_stream_row_get(const dirac_stream_t * stream) {
+    return stream->first[stream->current];
+}
+
+const dirac_matrix_t * dirac_stream_read(dirac_stream_t * stream)
+{
+    const dirac_matrix_t * them = (const dirac_matrix_t *)0;
+    int ii = 1 - stream->current;
+
+    do {
+
+        if (stream->writing) {
+            errno = EINVAL;
+            diminuto_perror("dirac_stream_read");
+            break;
+        }
+
+        /* Nothing in flight means every block has been handed out. */
+        if (!stream->pending[ii]) {
+            errno = 0;
+            break;
+        }
+
+        if (complete(stream, ii) < 0) {
+            diminuto_perror("dirac_stream_read: aio_return");
+            break;
+        }
+
+        /* The buffer the caller just finished with receives the next block. */
+        stream->current = ii;
+        if (stream->next >= stream->rows) {
+            /* Do nothing. */
+        } else if (submit(stream, 1 - ii) < 0) {
+            diminuto_perror("dirac_stream_read: aio_read");
+            break;
+        } else {
+            /* Do nothing. */
+        }
+
+        them = dirac_core_matrix_get(stream->buffer[ii]);
+
+    } while (0);
+
+    return them;
+}
+
+dirac_matrix_t * dirac_stream_block(dirac_stream_t * stream)
+{
+    dirac_matrix_t * them = (dirac_matrix_t *)0;
+    int ii = 1 - stream->current;
+    size_t count;
+
+    do {
+
+        if (!stream->writing) {
+            errno = EINVAL;
+            diminuto_perror("dirac_stream_block");
+            break;
+        }
+
+        if (stream->ready) {
+            them = dirac_core_matrix_mut(stream->buffer[stream->current]);
+            break;
+        }
+
+        if (stream->next >= stream->rows) {
+            errno = 0;
+            break;
+        }
+
+        /* This buffer may still be draining the block before last. */
+        if (complete(stream, ii) < 0) {
+            diminuto_perror("dirac_stream_block: aio_return");
+            break;
+        }
+
+        count = stream->rows - stream->next;
+        if (count > stream->block) {
+            count = stream->block;
+        }
+        stream->buffer[ii]->data.head.rows = count;
+        stream->first[ii] = stream->next;
+        stream->current = ii;
+        stream->ready = !0;
+
+        them = dirac_core_matrix_mut(stream->buffer[ii]);
+
+    } while (0);
+
+    return them;
+}
+
+int dirac_stream_write(dirac_stream_t * stream)
+{
+    int rc = -1;
+
+    if (!stream->writing || !stream->ready) {
+        errno = EINVAL;
+        diminuto_perror("dirac_stream_write");
+    } else if (submit(stream, stream->current) < 0) {
+        diminuto_perror("dirac_stream_write: aio_write");
+    } else {
+        stream->ready = 0;
+        rc = 0;
+    }
+
+    return rc;
+}
+
+int dirac_stream_close(dirac_stream_t * stream)
+{
+    int rc = 0;
+    int ii;
+
+    if (stream != (dirac_stream_t *)0) {
+        for (ii = 0; ii < 2; ++ii) {
+            if (complete(stream, ii) < 0) {
+                diminuto_perror("dirac_stream_close: aio_return");
+                rc = -1;
+            }
+            /* Buffers go back to the cache at the size they were taken. */
+            stream->buffer[ii]->data.head.rows = stream->block;
+            dirac_core_free(stream->buffer[ii]);
+        }
+        if (stream->writing && (stream->next < stream->rows)) {
+            errno = EINVAL;
+            diminuto_perror("dirac_stream_close: incomplete");
+            rc = -1;
+        }
+        if (close(stream->fd) < 0) {
+            diminuto_perror("dirac_stream_close: close");
+            rc = -1;
+        }
+        free(stream);
+    }
+
+    return rc;
+}
+
+/*******************************************************************************
+ * KERNELS
+ ******************************************************************************/
+
+static void add(dirac_complex_t * tt, const dirac_complex_t * aa, const dirac_complex_t * bb, size_t count)
+{
+    size_t ii;
+    for (ii = 0; ii < count; ++ii) {
+        tt[ii] = aa[ii] + bb[ii];
+    }
+}
+
+static void had(dirac_complex_t * tt, const dirac_complex_t * aa, const dirac_complex_t * bb, size_t count)
+{
+    size_t ii;
+    for (ii = 0; ii < count; ++ii) {
+        tt[ii] = aa[ii] * bb[ii];
+    }
+}
+
+static ssize_t elementwise(const char * name, const char * pathc, const char * patha, const char * pathb, size_t block, dirac_stream_kernel_t * kernel)
+{
+    ssize_t total = -1;
+    dirac_stream_t * streama = (dirac_stream_t *)0;
+    dirac_stream_t * streamb = (dirac_stream_t *)0;
+    dirac_stream_t * streamc = (dirac_stream_t *)0;
+    const dirac_matrix_t * thema;
+    const dirac_matrix_t * themb;
+    dirac_matrix_t * themc;
+    size_t rows = 0;
+
+    do {
+
+        streama = dirac_stream_reader(patha, block);
+        if (streama == (dirac_stream_t *)0) { break; }
+        streamb = dirac_stream_reader(pathb, streama->block);
+        if (streamb == (dirac_stream_t *)0) { break; }
+
+        if ((streama->rows != streamb->rows) || (streama->columns != streamb->columns)) {
+            errno = EINVAL;
+            diminuto_perror(name);
+            break;
+        }
+
+        streamc = dirac_stream_writer(pathc, streama->rows, streama->columns, streama->block);
+        if (streamc == (dirac_stream_t *)0) { break; }
+
+        while ((thema = dirac_stream_read(streama)) != (const dirac_matrix_t *)0) {
+            themb = dirac_stream_read(streamb);
+            if (themb == (const dirac_matrix_t *)0) { break; }
+            themc = dirac_stream_block(streamc);
+            if (themc == (dirac_matrix_t *)0) { break; }
+            (*kernel)((dirac_complex_t *)themc, (const dirac_complex_t *)thema, (const dirac_complex_t *)themb, dirac_rows_get(thema) * streama->columns);
+            if (dirac_stream_write(streamc) < 0) { break; }
+            rows += dirac_rows_get(thema);
+        }
+
+        if (rows == streama->rows) {
+            total = rows;
+        }
+
+    } while (0);
+
+    if (dirac_stream_close(streamc) < 0) { total = -1; }
+    (void)dirac_stream_close(streamb);
+    (void)dirac_stream_close(streama);
+
+    return total;
+}
+
+/*******************************************************************************
+ * PUBLIC OPERATIONS
+ ******************************************************************************/
+
+ssize_t dirac_stream_add(const char * pathc, const char * patha, const char * pathb, size_t block)
+{
+    return elementwise("dirac_stream_add", pathc, patha, pathb, block, add);
+}
+
+ssize_t dirac_stream_had(const char * pathc, const char * patha, const char * pathb, size_t block)
+{
+    return elementwise("dirac_stream_had", pathc, patha, pathb, block, had);
+}
+
+ssize_t dirac_stream_mul(const char * pathc, const char * patha, const dirac_matrix_t * themb, size_t block)
+{
+    ssize_t total = -1;
+    const dirac_t * thatb = dirac_core_object_get(themb);
+    dirac_stream_t * streama = (dirac_stream_t *)0;
+    dirac_stream_t * streamc = (dirac_stream_t *)0;
+    const dirac_matrix_t * thema;
+    dirac_matrix_t * themc;
+    size_t rows = 0;
+
+    do {
+
+        if (thatb == (const dirac_t *)0) {
+            errno = EINVAL;
+            diminuto_perror("dirac_stream_mul");
+            break;
+        }
+
+        streama = dirac_stream_reader(patha, block);
+        if (streama == (dirac_stream_t *)0) { break; }
+
+        if (!dirac_core_is_array(thatb) || (streama->columns != dirac_core_rows_get(thatb))) {
+            errno = EINVAL;
+            diminuto_perror("dirac_stream_mul");
+            break;
+        }
+
+        /* Same rows per block in and out so that the blocks line up. */
+        streamc = dirac_stream_writer(pathc, streama->rows, dirac_core_cols_get(thatb), streama->block);
+        if (streamc == (dirac_stream_t *)0) { break; }
+
+        while ((thema = dirac_stream_read(streama)) != (const dirac_matrix_t *)0) {
+            themc = dirac_stream_block(streamc);
+            if (themc == (dirac_matrix_t *)0) { break; }
+            (void)dirac_core_mul_into(dirac_core_object_mut(themc), dirac_core_object_get(thema), thatb);
+            if (dirac_stream_write(streamc) < 0) { break; }
+            rows += dirac_rows_get(thema);
+        }
+
+        if (rows == streama->rows) {
+            total = rows;
+        }
+
+    } while (0);
+
+    if (dirac_stream_close(streamc) < 0) { total = -1; }
+    (void)dirac_stream_close(streama);
+
+    return total;
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
@@ -0,0 +1,333 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the diagonal and permutation portions of
+ * Dirac. A diagonal is treated throughout as a permutation whose column
+ * for row R is R, so every kernel here touches each stored element once.
+ *
+ * REFERENCES
+ *
+ * Wikipedia, "Diagonal matrix", 2025-05-01
+ *
+ * Wikipedia, "Permutation matrix", 2025-05-01
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <errno.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+typedef struct DiracProduct {
+    dirac_t * that;
+    const dirac_t * thata;
+    const dirac_t * thatb;
+} dirac_product_t;
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+static inline int is_permutation(const dirac_t * that) {
+    return (dirac_core_kind_get(that) == DIRAC_KIND_PERMUTATION);
+}
+
+/*
+ * Returns the column of the only element (which may be zero) in row ROW.
+ */
+static inline size_t column(const dirac_t * that, size_t row) {
+    return is_permutation(that) ? dirac_core_permutation_columns_get(that)[row] : row;
+}
+
+/*******************************************************************************
+ * KERNELS
+ ******************************************************************************/
+
+/*
+ * Structured times dense: target row R is row column(R) of B scaled.
+ */
+static void structured_dense(void * context, size_t begin, size_t end)
+{
+    const dirac_product_t * productp = (const dirac_product_t *)context;
+    const dirac_complex_t * restrict aa = dirac_core_body_get(productp->thata);
+    const dirac_complex_t * restrict bb = dirac_core_body_get(productp->thatb);
+    dirac_complex_t * restrict tt = dirac_core_body_mut(productp->that);
+    size_t cols = dirac_core_cols_get(productp->thatb);
+    const dirac_complex_t * restrict brow;
+    dirac_complex_t * restrict trow;
+    dirac_complex_t factor;
+    size_t rr;
+    size_t cc;
+
+    for (rr = begin; rr < end; ++rr) {
+        factor = aa[rr];
+        brow = &(bb[column(productp->thata, rr) * cols]);
+        trow = &(tt[rr * cols]);
+        for (cc = 0; cc < cols; ++cc) {
+            trow[cc] = factor * brow[cc];
+        }
+    }
+}
+
+/*
+ * Dense times structured: column R of A, scaled, lands in target column
+ * column(R) of B. Rows of the target are independent.
+ */
+static void dense_structured(void * context, size_t begin, size_t end)
+{
+    const dirac_product_t * productp = (const dirac_product_t *)context;
+    const dirac_complex_t * restrict aa = dirac_core_body_get(productp->thata);
+    const dirac_complex_t * restrict bb = dirac_core_body_get(productp->thatb);
+    dirac_complex_t * restrict tt = dirac_core_body_mut(productp->that);
+    size_t cols = dirac_core_cols_get(productp->thata);
+    const dirac_complex_t * restrict arow;
+    dirac_complex_t * restrict trow;
+    size_t rr;
+    size_t cc;
+
+    if (is_permutation(productp->thatb)) {
+        const size_t * restrict columns = dirac_core_permutation_columns_get(productp->thatb);
+        for (rr = begin; rr < end; ++rr) {
+            arow = &(aa[rr * cols]);
+            trow = &(tt[rr * cols]);
+            for (cc = 0; cc < cols; ++cc) {
+                trow[columns[cc]] = arow[cc] * bb[cc];
+            }
+        }
+    } else {
+        for (rr = begin; rr < end; ++rr) {
+            arow = &(aa[rr * cols]);
+            trow = &(tt[rr * cols]);
+            for (cc = 0; cc < cols; ++cc) {
+                trow[cc] = arow[cc] * bb[cc];
+            }
+        }
+    }
+}
+
+/*
+ * Structured times structured: row R of A selects row column(R) of B.
+ */
+static dirac_t * structured_structured(const dirac_t * thata, const dirac_t * thatb)
+{
+    dirac_t * that = (dirac_t *)0;
+    const dirac_complex_t * aa = dirac_core_body_get(thata);
+    const dirac_complex_t * bb = dirac_core_body_get(thatb);
+    dirac_complex_t * tt;
+    size_t * columns;
+    size_t order = dirac_core_rows_get(thata);
+    size_t rr;
+    size_t cc;
+
+    if (!is_permutation(thata) && !is_permutation(thatb)) {
+        if ((that = dirac_core_allocate_kind(DIRAC_KIND_DIAGONAL, order, order, order)) != (dirac_t *)0) {
+            tt = dirac_core_body_mut(that);
+            for (rr = 0; rr < order; ++rr) {
+                tt[rr] = aa[rr] * bb[rr];
+            }
+        }
+    } else {
+        if ((that = dirac_core_allocate_kind(DIRAC_KIND_PERMUTATION, order, order, order)) != (dirac_t *)0) {
+            tt = dirac_core_body_mut(that);
+            columns = dirac_core_permutation_columns_mut(that);
+            for (rr = 0; rr < order; ++rr) {
+                cc = column(thata, rr);
+                tt[rr] = aa[rr] * bb[cc];
+                columns[rr] = column(thatb, cc);
+            }
+        }
+    }
+
+    return that;
+}
+
+/*******************************************************************************
+ * PRIVATE OPERATIONS
+ ******************************************************************************/
+
+dirac_t * dirac_core_mul_structured(const dirac_t * thata, const dirac_t * thatb)
+{
+    dirac_product_t product = { (dirac_t *)0, thata, thatb, };
+    size_t work;
+
+    if (dirac_core_cols_get(thata) != dirac_core_rows_get(thatb)) {
+        errno = EINVAL;
+    } else if (dirac_core_is_structured(thata) && dirac_core_is_structured(thatb)) {
+        product.that = structured_structured(thata, thatb);
+    } else if (dirac_core_is_structured(thata) && dirac_core_is_dense(thatb)) {
+        if ((product.that = dirac_core_pro(thata, thatb)) != (dirac_t *)0) {
+            work = dirac_core_cols_get(thatb);
+            dirac_core_parallel(dirac_core_rows_get(thata), dirac_core_grain(work), structured_dense, &product);
+        }
+    } else if (dirac_core_is_dense(thata) && dirac_core_is_structured(thatb)) {
+        if ((product.that = dirac_core_pro(thata, thatb)) != (dirac_t *)0) {
+            work = dirac_core_cols_get(thata);
+            dirac_core_parallel(dirac_core_rows_get(thata), dirac_core_grain(work), dense_structured, &product);
+        }
+    } else {
+        errno = EINVAL;
+    }
+
+    return product.that;
+}
+
+/*
+ * Row (ar * orderb) + br of the Kronecker product of two structured
+ * matrices has its only element in column (column(ar) * orderb) +
+ * column(br), so the result is itself structured.
+ */
+dirac_t * dirac_core_kro_structured(const dirac_t * thata, const dirac_t * thatb)
+{
+    dirac_t * that = (dirac_t *)0;
+    const dirac_complex_t * aa = dirac_core_body_get(thata);
+    const dirac_complex_t * bb = dirac_core_body_get(thatb);
+    dirac_complex_t * tt;
+    size_t * columns = (size_t *)0;
+    size_t ordera = dirac_core_rows_get(thata);
+    size_t orderb = dirac_core_rows_get(thatb);
+    size_t order = ordera * orderb;
+    size_t ar;
+    size_t br;
+    size_t tr;
+
+    if (!dirac_core_is_structured(thata) || !dirac_core_is_structured(thatb)) {
+        errno = EINVAL;
+    } else if (!is_permutation(thata) && !is_permutation(thatb)) {
+        that = dirac_core_allocate_kind(DIRAC_KIND_DIAGONAL, order, order, order);
+    } else if ((that = dirac_core_allocate_kind(DIRAC_KIND_PERMUTATION, order, order, order)) != (dirac_t *)0) {
+        columns = dirac_core_permutation_columns_mut(that);
+    }
+
+    if (that != (dirac_t *)0) {
+        tt = dirac_core_body_mut(that);
+        for (ar = 0, tr = 0; ar < ordera; ++ar) {
+            for (br = 0; br < orderb; ++br, ++tr) {
+                tt[tr] = aa[ar] * bb[br];
+                if (columns != (size_t *)0) {
+                    columns[tr] = (column(thata, ar) * orderb) + column(thatb, br);
+                }
+            }
+        }
+    }
+
+    return that;
+}
+
+dirac_t * dirac_core_trn_structured(const dirac_t * thata)
+{
+    dirac_t * that = (dirac_t *)0;
+    const dirac_complex_t * aa = dirac_core_body_get(thata);
+    dirac_complex_t * tt;
+    size_t * columns;
+    size_t order = dirac_core_rows_get(thata);
+    size_t rr;
+    size_t cc;
+
+    if (!dirac_core_is_structured(thata)) {
+        errno = EINVAL;
+    } else if ((that = dirac_core_allocate_kind(dirac_core_kind_get(thata), order, order, order)) == (dirac_t *)0) {
+        /* Do nothing. */
+    } else if (!is_permutation(thata)) {
+        tt = dirac_core_body_mut(that);
+        for (rr = 0; rr < order; ++rr) {
+            tt[rr] = aa[rr];
+        }
+    } else {
+        tt = dirac_core_body_mut(that);
+        columns = dirac_core_permutation_columns_mut(that);
+        for (rr = 0; rr < order; ++rr) {
+            cc = column(thata, rr);
+            tt[cc] = aa[rr];
+            columns[cc] = rr;
+        }
+    }
+
+    return that;
+}
+
+/*******************************************************************************
+ * PUBLIC GETTORS
+ ******************************************************************************/
+
+const size_t * dirac_permutation_columns_get(const dirac_matrix_t * them) {
+    const dirac_t * that = dirac_core_object_get(them);
+    return is_permutation(that) ? dirac_core_permutation_columns_get(that) : (const size_t *)0;
+}
+
+size_t * dirac_permutation_columns_mut(dirac_matrix_t * them) {
+    dirac_t * that = dirac_core_object_mut(them);
+    return is_permutation(that) ? dirac_core_permutation_columns_mut(that) : (size_t *)0;
+}
+
+/*******************************************************************************
+ * PUBLIC OPERATIONS
+ ******************************************************************************/
+
+dirac_matrix_t * dirac_diagonal_new(size_t order)
+{
+    dirac_t * that = dirac_core_allocate_kind(DIRAC_KIND_DIAGONAL, order, order, order);
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_diagonal_new");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_permutation_new(size_t order)
+{
+    dirac_t * that = dirac_core_allocate_kind(DIRAC_KIND_PERMUTATION, order, order, order);
+    dirac_complex_t * tt;
+    size_t * columns;
+    size_t rr;
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_permutation_new");
+    } else {
+        tt = dirac_core_body_mut(that);
+        columns = dirac_core_permutation_columns_mut(that);
+        for (rr = 0; rr < order; ++rr) {
+            tt[rr] = 1;
+            columns[rr] = rr;
+        }
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_structured_to_dense(const dirac_matrix_t * thema)
+{
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * that = (dirac_t *)0;
+    const dirac_complex_t * aa;
+    dirac_complex_t * tt;
+    size_t order;
+    size_t rr;
+    if (!dirac_core_is_structured(thata)) {
+        errno = EINVAL;
+    } else if ((that = dirac_core_allocate(dirac_core_rows_get(thata), dirac_core_cols_get(thata))) != (dirac_t *)0) {
+        aa = dirac_core_body_get(thata);
+        tt = dirac_core_body_mut(that);
+        order = dirac_core_rows_get(thata);
+        for (rr = 0; rr < order; ++rr) {
+            tt[(rr * order) + column(thata, rr)] = aa[rr];
+        }
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_structured_to_dense");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
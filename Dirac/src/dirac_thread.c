@@ -0,0 +1,132 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the threading-related portions of Dirac.
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include <pthread.h>
+#include <unistd.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+/*
+ * Ranges are described on the stack, so the number of threads is bounded.
+ */
+static const size_t MAXIMUM = 64;
+
+/*******************************************************************************
+ * GLOBALS
+ ******************************************************************************/
+
+/*
+ * Set and read from any thread, so it is only accessed atomically.
+ */
+static size_t threads = 0;
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+typedef struct DiracRange {
+    dirac_core_body_t * body;
+    void * context;
+    size_t begin;
+    size_t end;
+    pthread_t thread;
+    int started;
+} dirac_range_t;
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+static void * worker(void * arg)
+{
+    dirac_range_t * rangep = (dirac_range_t *)arg;
+    (*rangep->body)(rangep->context, rangep->begin, rangep->end);
+    return (void *)0;
+}
+
+/*******************************************************************************
+ * PUBLIC PARALLELISM
+ ******************************************************************************/
+
+size_t dirac_threads_set(size_t count)
+{
+    return __atomic_exchange_n(&threads, count, __ATOMIC_RELAXED);
+}
+
+size_t dirac_threads_get(void)
+{
+    size_t count = __atomic_load_n(&threads, __ATOMIC_RELAXED);
+    long online;
+    if (count == 0) {
+        online = sysconf(_SC_NPROCESSORS_ONLN);
+        count = (online > 0) ? (size_t)online : 1;
+    }
+    if (count > MAXIMUM) {
+        count = MAXIMUM;
+    }
+    return count;
+}
+
+/*******************************************************************************
+ * PRIVATE PARALLELISM
+ ******************************************************************************/
+
+void dirac_core_parallel(size_t count, size_t grain, dirac_core_body_t * body, void * context)
+{
+    size_t workers = dirac_threads_get();
+    size_t ii;
+    size_t begin;
+
+    if (grain == 0) {
+        grain = 1;
+    }
+    if (workers > (count / grain)) {
+        workers = count / grain;
+    }
+
+    if (workers <= 1) {
+        (*body)(context, 0, count);
+    } else {
+        dirac_range_t ranges[workers];
+        for (ii = 0, begin = 0; ii < workers; ++ii) {
+            ranges[ii].body = body;
+            ranges[ii].context = context;
+            ranges[ii].begin = begin;
+            ranges[ii].end = begin = ((ii + 1) * count) / workers;
+            ranges[ii].started = 0;
+        }
+        for (ii = 0; ii < (workers - 1); ++ii) {
+            ranges[ii].started = (pthread_create(&(ranges[ii].thread), (pthread_attr_t *)0, worker, &(ranges[ii])) == 0);
+            if (!ranges[ii].started) {
+                (void)worker(&(ranges[ii]));
+            }
+        }
+        (void)worker(&(ranges[workers - 1]));
+        for (ii = 0; ii < (workers - 1); ++ii) {
+            if (ranges[ii].started) {
+                (void)pthread_join(ranges[ii].thread, (void **)0);
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
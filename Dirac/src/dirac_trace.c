@@ -0,0 +1,446 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the tracing portions of Dirac. Each thread
+ * records into a buffer of its own, found through a thread local pointer,
+ * so recording takes no lock; the buffers are kept on a list, under a
+ * mutex, from which a snapshot or an export reads them. A reset does not
+ * touch the buffers, which their threads may be writing, but advances an
+ * epoch; a thread that finds its buffer from an earlier epoch clears it
+ * before recording, and a snapshot ignores buffers from earlier epochs.
+ * When a thread exits its buffer is kept, with its statistics, for the
+ * next new thread to use.
+ *
+ * REFERENCES
+ *
+ * Google, "Trace Event Format", 2016
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_criticalsection.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * CONSTANTS
+ ******************************************************************************/
+
+static const char * NAMES[] = {
+    "dirac_matrix_dup",
+    "dirac_matrix_trn",
+    "dirac_matrix_add",
+    "dirac_matrix_sub",
+    "dirac_matrix_mul",
+    "dirac_matrix_kro",
+    "dirac_matrix_had",
+    "dirac_matrix_mul_chain",
+    "dirac_matrix_pow",
+    "dirac_matrix_pow_apply",
+    "dirac_matrix_expm",
+    "dirac_matrix_expm_multiply",
+    "dirac_matrix_eigh",
+    "dirac_matrix_eigh_range",
+    "dirac_matrix_solve",
+    "dirac_matrix_inv",
+    "dirac_matrix_det",
+    "dirac_matrix_ptrace",
+    "dirac_matrix_trace",
+    "dirac_matrix_norm",
+    "dirac_matrix_inner",
+    "dirac_matrix_expectation",
+};
+
+/*
+ * Events kept per thread between resets; the buffer for them is allocated
+ * the first time the thread records one.
+ */
+#define EVENTS (1 << 16)
+
+/*******************************************************************************
+ * TYPES
+ ******************************************************************************/
+
+typedef struct DiracTraceEvent {
+    uint64_t begin;
+    uint64_t cycles;
+    uint64_t bytes;
+    uint32_t tid;
+    uint32_t operation;
+} dirac_trace_event_t;
+
+typedef struct DiracTraceBuffer {
+    struct DiracTraceBuffer * next;
+    unsigned int epoch;
+    int owned;
+    uint32_t tid;
+    size_t count;
+    dirac_trace_event_t * events;
+    dirac_trace_statistics_t statistics[DIRAC_TRACE_OPERATIONS];
+} dirac_trace_buffer_t;
+
+/*******************************************************************************
+ * GLOBALS
+ ******************************************************************************/
+
+int dirac_core_trace_mode = DIRAC_TRACE_OFF;
+
+#if DIRAC_TRACING
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+static pthread_key_t key;
+
+static dirac_trace_buffer_t * buffers = (dirac_trace_buffer_t *)0;
+
+static __thread dirac_trace_buffer_t * local = (dirac_trace_buffer_t *)0;
+
+static unsigned int epoch = 1;
+
+static double nanoseconds = 0.0; /* Per cycle. */
+
+static uint64_t origin = 0;
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+/*
+ * Only the owning thread writes a buffer, so an increment needs no locked
+ * instruction, only atomic loads and stores that a snapshot can read.
+ */
+static inline void bump(uint64_t * valuep, uint64_t delta)
+{
+    __atomic_store_n(valuep, __atomic_load_n(valuep, __ATOMIC_RELAXED) + delta, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t peek(const uint64_t * valuep)
+{
+    return __atomic_load_n(valuep, __ATOMIC_RELAXED);
+}
+
+static void release(void * arg)
+{
+    dirac_trace_buffer_t * bp = (dirac_trace_buffer_t *)arg;
+    DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+        bp->owned = 0;
+    DIMINUTO_CRITICAL_SECTION_END;
+}
+
+static void initialize(void)
+{
+    (void)pthread_key_create(&key, release);
+}
+
+/*
+ * Gives the calling thread a buffer, an unowned one if there is one.
+ */
+static dirac_trace_buffer_t * adopt(void)
+{
+    dirac_trace_buffer_t * bp;
+    (void)pthread_once(&once, initialize);
+    DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+        for (bp = buffers; bp != (dirac_trace_buffer_t *)0; bp = bp->next) {
+            if (!bp->owned) { break; }
+        }
+        if (bp != (dirac_trace_buffer_t *)0) {
+            /* Do nothing. */
+        } else if ((bp = (dirac_trace_buffer_t *)calloc(1, sizeof(dirac_trace_buffer_t))) != (dirac_trace_buffer_t *)0) {
+            bp->next = buffers;
+            buffers = bp;
+        } else {
+            /* Do nothing. */
+        }
+        if (bp != (dirac_trace_buffer_t *)0) {
+            bp->owned = !0;
+            bp->tid = (uint32_t)syscall(SYS_gettid);
+        }
+    DIMINUTO_CRITICAL_SECTION_END;
+    if (bp != (dirac_trace_buffer_t *)0) {
+        (void)pthread_setspecific(key, bp);
+        local = bp;
+    }
+    return bp;
+}
+
+static void clear(dirac_trace_buffer_t * bp)
+{
+    uint64_t * valuep = (uint64_t *)&(bp->statistics[0]);
+    size_t ii;
+    for (ii = 0; ii < (sizeof(bp->statistics) / (sizeof(uint64_t))); ++ii) {
+        __atomic_store_n(&(valuep[ii]), 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&(bp->count), 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * Finds the ratio of nanoseconds to cycles over a few milliseconds.
+ */
+static void calibrate(void)
+{
+    struct timespec before;
+    struct timespec after;
+    uint64_t start;
+    uint64_t end;
+    double elapsed;
+    clock_gettime(CLOCK_MONOTONIC, &before);
+    start = dirac_core_trace_clock();
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &after);
+        elapsed = ((double)(after.tv_sec - before.tv_sec) * 1e9) + (double)(after.tv_nsec - before.tv_nsec);
+    } while (elapsed < 10e6);
+    end = dirac_core_trace_clock();
+    nanoseconds = elapsed / (double)(end - start);
+    origin = start;
+}
+
+/*******************************************************************************
+ * PRIVATE TRACING
+ ******************************************************************************/
+
+size_t dirac_core_trace_bytes(const dirac_t * thata, const dirac_t * thatb, const dirac_t * that)
+{
+    const dirac_t * thats[3] = { thata, thatb, that, };
+    size_t bytes = 0;
+    size_t ii;
+    for (ii = 0; ii < 3; ++ii) {
+        if (thats[ii] == (const dirac_t *)0) {
+            /* Do nothing. */
+        } else if (dirac_core_is_array(thats[ii])) {
+            bytes += dirac_core_rows_get(thats[ii]) * dirac_core_cols_get(thats[ii]) * sizeof(dirac_complex_t);
+        } else {
+            bytes += dirac_core_length_get(thats[ii]);
+        }
+    }
+    return bytes;
+}
+
+void dirac_core_trace_record(dirac_trace_operation_t operation, uint64_t begin, size_t bytes)
+{
+    uint64_t end = dirac_core_trace_clock();
+    dirac_trace_buffer_t * bp = local;
+    dirac_trace_statistics_t * sp;
+    dirac_trace_event_t * ep;
+    unsigned int current;
+    uint64_t cycles;
+    uint64_t elapsed;
+    unsigned int bucket;
+    size_t count;
+
+    do {
+
+        if ((bp == (dirac_trace_buffer_t *)0) && ((bp = adopt()) == (dirac_trace_buffer_t *)0)) {
+            break;
+        }
+
+        current = __atomic_load_n(&epoch, __ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&(bp->epoch), __ATOMIC_RELAXED) != current) {
+            clear(bp);
+            __atomic_store_n(&(bp->epoch), current, __ATOMIC_RELEASE);
+        }
+
+        cycles = end - begin;
+        elapsed = (uint64_t)(cycles * nanoseconds);
+        bucket = (elapsed == 0) ? 0 : (63 - __builtin_clzll(elapsed));
+        if (bucket >= DIRAC_TRACE_BUCKETS) { bucket = DIRAC_TRACE_BUCKETS - 1; }
+
+        sp = &(bp->statistics[operation]);
+        bump(&(sp->calls), 1);
+        bump(&(sp->cycles), cycles);
+        bump(&(sp->nanoseconds), elapsed);
+        bump(&(sp->bytes), bytes);
+        bump(&(sp->histogram[bucket]), 1);
+
+        if (__atomic_load_n(&dirac_core_trace_mode, __ATOMIC_RELAXED) != DIRAC_TRACE_EVENTS) {
+            break;
+        }
+
+        if ((bp->events == (dirac_trace_event_t *)0) && ((ep = (dirac_trace_event_t *)malloc(EVENTS * sizeof(dirac_trace_event_t))) != (dirac_trace_event_t *)0)) {
+            __atomic_store_n(&(bp->events), ep, __ATOMIC_RELEASE);
+        }
+        count = __atomic_load_n(&(bp->count), __ATOMIC_RELAXED);
+        if ((bp->events == (dirac_trace_event_t *)0) || (count >= EVENTS)) {
+            break;
+        }
+        ep = &(bp->events[count]);
+        ep->begin = begin;
+        ep->cycles = cycles;
+        ep->bytes = bytes;
+        ep->tid = bp->tid;
+        ep->operation = operation;
+        /* The export reads no further than the count, so it is stored last. */
+        __atomic_store_n(&(bp->count), count + 1, __ATOMIC_RELEASE);
+
+    } while (0);
+}
+
+#endif
+
+/*******************************************************************************
+ * PUBLIC TRACING
+ ******************************************************************************/
+
+const char * dirac_trace_name(dirac_trace_operation_t operation)
+{
+    return ((unsigned int)operation < DIRAC_TRACE_OPERATIONS) ? NAMES[operation] : (const char *)0;
+}
+
+int dirac_trace_set(int mode)
+{
+    int prior = -1;
+#if DIRAC_TRACING
+    if ((mode != DIRAC_TRACE_OFF) && (mode != DIRAC_TRACE_COUNT) && (mode != DIRAC_TRACE_EVENTS)) {
+        errno = EINVAL;
+        diminuto_perror("dirac_trace_set");
+    } else {
+        DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+            if ((mode != DIRAC_TRACE_OFF) && (nanoseconds == 0.0)) {
+                calibrate();
+            }
+            /* Released, so that a thread that sees the mode sees the calibration. */
+            prior = __atomic_exchange_n(&dirac_core_trace_mode, mode, __ATOMIC_ACQ_REL);
+        DIMINUTO_CRITICAL_SECTION_END;
+    }
+#else
+    errno = ENOSYS;
+    diminuto_perror("dirac_trace_set");
+#endif
+    return prior;
+}
+
+int dirac_trace_get(void)
+{
+    return __atomic_load_n(&dirac_core_trace_mode, __ATOMIC_RELAXED);
+}
+
+int dirac_trace_snapshot(dirac_trace_statistics_t statistics[])
+{
+    int rc = -1;
+#if DIRAC_TRACING
+    dirac_trace_buffer_t * bp;
+    unsigned int current;
+    size_t oo;
+    size_t bb;
+#endif
+
+    do {
+
+        if (statistics == (dirac_trace_statistics_t *)0) {
+            errno = EINVAL;
+            diminuto_perror("dirac_trace_snapshot");
+            break;
+        }
+
+        memset(statistics, 0, DIRAC_TRACE_OPERATIONS * sizeof(statistics[0]));
+
+#if DIRAC_TRACING
+        DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+            current = __atomic_load_n(&epoch, __ATOMIC_RELAXED);
+            for (bp = buffers; bp != (dirac_trace_buffer_t *)0; bp = bp->next) {
+                if (__atomic_load_n(&(bp->epoch), __ATOMIC_ACQUIRE) != current) {
+                    continue;
+                }
+                for (oo = 0; oo < DIRAC_TRACE_OPERATIONS; ++oo) {
+                    statistics[oo].calls += peek(&(bp->statistics[oo].calls));
+                    statistics[oo].cycles += peek(&(bp->statistics[oo].cycles));
+                    statistics[oo].nanoseconds += peek(&(bp->statistics[oo].nanoseconds));
+                    statistics[oo].bytes += peek(&(bp->statistics[oo].bytes));
+                    for (bb = 0; bb < DIRAC_TRACE_BUCKETS; ++bb) {
+                        statistics[oo].histogram[bb] += peek(&(bp->statistics[oo].histogram[bb]));
+                    }
+                }
+            }
+        DIMINUTO_CRITICAL_SECTION_END;
+#endif
+
+        rc = 0;
+
+    } while (0);
+
+    return rc;
+}
+
+void dirac_trace_reset(void)
+{
+#if DIRAC_TRACING
+    DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+        __atomic_add_fetch(&epoch, 1, __ATOMIC_RELEASE);
+    DIMINUTO_CRITICAL_SECTION_END;
+#endif
+}
+
+ssize_t dirac_trace_export(FILE * fp)
+{
+    ssize_t total = -1;
+#if DIRAC_TRACING
+    dirac_trace_buffer_t * bp;
+    const dirac_trace_event_t * ep;
+    unsigned int current;
+    size_t count;
+    size_t ii;
+    long pid = (long)getpid();
+#endif
+
+    do {
+
+        if (fp == (FILE *)0) {
+            errno = EINVAL;
+            diminuto_perror("dirac_trace_export");
+            break;
+        }
+
+        total = 0;
+        fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", fp);
+
+#if DIRAC_TRACING
+        DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+            current = __atomic_load_n(&epoch, __ATOMIC_RELAXED);
+            for (bp = buffers; bp != (dirac_trace_buffer_t *)0; bp = bp->next) {
+                if (__atomic_load_n(&(bp->epoch), __ATOMIC_ACQUIRE) != current) {
+                    continue;
+                }
+                count = __atomic_load_n(&(bp->count), __ATOMIC_ACQUIRE);
+                ep = __atomic_load_n(&(bp->events), __ATOMIC_ACQUIRE);
+                for (ii = 0; ii < count; ++ii, ++ep) {
+                    /* Complete events, in microseconds since tracing was first turned on. */
+                    fprintf(fp, "%s\n{\"name\":\"%s\",\"cat\":\"dirac\",\"ph\":\"X\",\"pid\":%ld,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"bytes\":%llu}}",
+                        (total > 0) ? "," : "",
+                        NAMES[ep->operation], pid, (unsigned long)ep->tid,
+                        ((double)(ep->begin - origin) * nanoseconds) / 1000.0,
+                        ((double)ep->cycles * nanoseconds) / 1000.0,
+                        (unsigned long long)ep->bytes);
+                    total += 1;
+                }
+            }
+        DIMINUTO_CRITICAL_SECTION_END;
+#endif
+
+        fputs("\n]}\n", fp);
+        fflush(fp);
+
+    } while (0);
+
+    return total;
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
@@ -0,0 +1,271 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-cdirac<BR>
+ *
+ * This is the implementation of the view portions of Dirac. A view is a
+ * head and a small descriptor, the address of its first element and its
+ * row and column strides, in place of the elements themselves, so making
+ * one copies nothing however large the matrix it views. A view of a view
+ * composes the strides, so it too addresses the original elements.
+ */
+
+/*******************************************************************************
+ * PREREQUISITES
+ ******************************************************************************/
+
+#include "com/diag/dirac/dirac.h"
+#include "com/diag/diminuto/diminuto_error.h"
+#include <errno.h>
+#include "dirac.h"
+
+/*******************************************************************************
+ * HELPERS
+ ******************************************************************************/
+
+/*
+ * Returns a view of the ROWS x COLUMNS block of THATA, a dense matrix or a
+ * view, whose first element is (ROW, COLUMN).
+ */
+static dirac_t * subview(const dirac_t * thata, size_t row, size_t column, size_t rows, size_t columns)
+{
+    dirac_complex_t * origin = (dirac_complex_t *)dirac_core_body_get(thata);
+    size_t rowstride = dirac_core_rowstride_get(thata);
+    size_t colstride = dirac_core_colstride_get(thata);
+    return dirac_core_view(&(origin[(row * rowstride) + (column * colstride)]), rows, columns, rowstride, colstride, dirac_core_is_conjugate(thata));
+}
+
+/*******************************************************************************
+ * PUBLIC OPERATIONS
+ ******************************************************************************/
+
+dirac_matrix_t * dirac_view_new(const dirac_matrix_t * thema, size_t offset, size_t rows, size_t columns, size_t rowstride, size_t colstride)
+{
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * that = (dirac_t *)0;
+    size_t count;
+    size_t last;
+
+    do {
+
+        if ((thata == (const dirac_t *)0) || !dirac_core_is_dense(thata) || (rows == 0) || (columns == 0)) {
+            errno = EINVAL;
+            break;
+        }
+
+        /* The strides only ever step forward, so the last element is the furthest. */
+        count = dirac_core_rows_get(thata) * dirac_core_cols_get(thata);
+        if ((rowstride > (count / rows)) || (colstride > (count / columns))) {
+            errno = EINVAL;
+            break;
+        }
+        last = offset + ((rows - 1) * rowstride) + ((columns - 1) * colstride);
+        if ((offset >= count) || (last >= count) || (last < offset)) {
+            errno = EINVAL;
+            break;
+        }
+
+        that = dirac_core_view((dirac_complex_t *)dirac_core_body_get(thata) + offset, rows, columns, rowstride, colstride, 0);
+
+    } while (0);
+
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_view_new");
+    }
+
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_view_block(const dirac_matrix_t * thema, size_t row, size_t column, size_t rows, size_t columns)
+{
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * that = (dirac_t *)0;
+    if ((thata == (const dirac_t *)0) || !dirac_core_is_array(thata) || (rows == 0) || (columns == 0)) {
+        errno = EINVAL;
+    } else if ((row >= dirac_core_rows_get(thata)) || (rows > (dirac_core_rows_get(thata) - row))) {
+        errno = EINVAL;
+    } else if ((column >= dirac_core_cols_get(thata)) || (columns > (dirac_core_cols_get(thata) - column))) {
+        errno = EINVAL;
+    } else {
+        that = subview(thata, row, column, rows, columns);
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_view_block");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_view_row(const dirac_matrix_t * thema, size_t row)
+{
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * that = (dirac_t *)0;
+    if ((thata == (const dirac_t *)0) || !dirac_core_is_array(thata) || (row >= dirac_core_rows_get(thata))) {
+        errno = EINVAL;
+    } else {
+        that = subview(thata, row, 0, 1, dirac_core_cols_get(thata));
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_view_row");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_view_col(const dirac_matrix_t * thema, size_t column)
+{
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * that = (dirac_t *)0;
+    if ((thata == (const dirac_t *)0) || !dirac_core_is_array(thata) || (column >= dirac_core_cols_get(thata))) {
+        errno = EINVAL;
+    } else {
+        that = subview(thata, 0, column, dirac_core_rows_get(thata), 1);
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_view_col");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_view_reshape(const dirac_matrix_t * thema, size_t rows, size_t columns)
+{
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * that = (dirac_t *)0;
+    if ((thata == (const dirac_t *)0) || !dirac_core_is_dense(thata) || (rows == 0) || (columns == 0)) {
+        errno = EINVAL;
+    } else if ((rows * columns) != (dirac_core_rows_get(thata) * dirac_core_cols_get(thata))) {
+        errno = EINVAL;
+    } else {
+        that = dirac_core_view((dirac_complex_t *)dirac_core_body_get(thata), rows, columns, columns, 1, 0);
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_view_reshape");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+/*
+ * A transpose swaps the strides as well as the dimensions; an adjoint
+ * also toggles the conjugation, so the adjoint of an adjoint reads the
+ * elements as they are stored.
+ */
+static dirac_t * transpose(const dirac_t * thata, int conjugate)
+{
+    return dirac_core_view((dirac_complex_t *)dirac_core_body_get(thata), dirac_core_cols_get(thata), dirac_core_rows_get(thata), dirac_core_colstride_get(thata), dirac_core_rowstride_get(thata), conjugate);
+}
+
+dirac_matrix_t * dirac_view_trn(const dirac_matrix_t * thema)
+{
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * that = (dirac_t *)0;
+    if ((thata == (const dirac_t *)0) || !dirac_core_is_array(thata)) {
+        errno = EINVAL;
+    } else {
+        that = transpose(thata, dirac_core_is_conjugate(thata));
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_view_trn");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+dirac_matrix_t * dirac_view_adj(const dirac_matrix_t * thema)
+{
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * that = (dirac_t *)0;
+    if ((thata == (const dirac_t *)0) || !dirac_core_is_array(thata)) {
+        errno = EINVAL;
+    } else {
+        that = transpose(thata, !dirac_core_is_conjugate(thata));
+    }
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_view_adj");
+    }
+    return dirac_core_matrix_mut(that);
+}
+
+int dirac_view_is(const dirac_matrix_t * them)
+{
+    const dirac_t * that = dirac_core_object_get(them);
+    return (that != (const dirac_t *)0) && dirac_core_is_view(that);
+}
+
+dirac_complex_t * dirac_view_point(dirac_matrix_t * them, size_t row, size_t column)
+{
+    dirac_t * that = dirac_core_object_mut(them);
+    dirac_complex_t * result = (dirac_complex_t *)0;
+    if ((that == (dirac_t *)0) || !dirac_core_is_array(that)) {
+        /* Do nothing. */
+    } else if ((row >= dirac_core_rows_get(that)) || (column >= dirac_core_cols_get(that))) {
+        /* Do nothing. */
+    } else {
+        result = dirac_core_point_fast(that, row, column);
+    }
+    return result;
+}
+
+dirac_matrix_t * dirac_view_assign(dirac_matrix_t * themv, const dirac_matrix_t * thema)
+{
+    dirac_t * thatv = dirac_core_object_mut(themv);
+    const dirac_t * thata = dirac_core_object_get(thema);
+    dirac_t * temp = (dirac_t *)0;
+    dirac_t * that = (dirac_t *)0;
+    const dirac_complex_t * aa;
+    dirac_complex_t * vv;
+    size_t rows;
+    size_t cols;
+    size_t rr;
+    size_t cc;
+
+    do {
+
+        if ((thatv == (dirac_t *)0) || (thata == (const dirac_t *)0) || !dirac_core_is_array(thatv)) {
+            errno = EINVAL;
+            break;
+        }
+
+        rows = dirac_core_rows_get(thatv);
+        cols = dirac_core_cols_get(thatv);
+        if ((dirac_core_rows_get(thata) != rows) || (dirac_core_cols_get(thata) != cols)) {
+            errno = EINVAL;
+            break;
+        }
+
+        if (dirac_core_is_dense(thatv) && !dirac_core_is_array(thata)) {
+            /* Expanding straight into the target needs no copy. */
+            dirac_core_expand(dirac_core_body_mut(thatv), thata, 1.0);
+            that = thatv;
+            break;
+        }
+
+        /* A may overlap V, so every element is read before any is written. */
+        if ((temp = dirac_core_allocate(rows, cols)) == (dirac_t *)0) {
+            break;
+        }
+        dirac_core_expand(dirac_core_body_mut(temp), thata, 1.0);
+
+        aa = dirac_core_body_get(temp);
+        vv = dirac_core_body_mut(thatv);
+        for (rr = 0; rr < rows; ++rr) {
+            for (cc = 0; cc < cols; ++cc) {
+                vv[dirac_core_index(thatv, rr, cc)] = dirac_core_is_conjugate(thatv) ? conj(aa[(rr * cols) + cc]) : aa[(rr * cols) + cc];
+            }
+        }
+        that = thatv;
+
+    } while (0);
+
+    (void)dirac_core_free(temp);
+
+    if (that == (dirac_t *)0) {
+        diminuto_perror("dirac_view_assign");
+    }
+
+    return dirac_core_matrix_mut(that);
+}
+
+/*******************************************************************************
+ * END
+ ******************************************************************************/
@@ -0,0 +1,405 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac circuit functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac circuit functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include <errno.h>
+#include <math.h>
+
+static const double R = 0.70710678118654752;
+
+/*
+ * Fills a gate of SIZE rows and columns with arbitrary values.
+ */
+static dirac_matrix_t * arbitrary(size_t size, size_t seed)
+{
+    dirac_matrix_t * gate = dirac_new_base(size, size);
+    dirac_complex_t * gg = (dirac_complex_t *)gate;
+    size_t ii;
+    for (ii = 0; ii < (size * size); ++ii) {
+        gg[ii] = CMPLX(cos((double)(ii + seed)), sin((double)((ii * 3) + seed)));
+    }
+    return gate;
+}
+
+static int same(const dirac_matrix_t * one, const dirac_matrix_t * two, size_t length)
+{
+    const dirac_complex_t * oo = (const dirac_complex_t *)one;
+    const dirac_complex_t * tt = (const dirac_complex_t *)two;
+    size_t ii;
+    for (ii = 0; ii < length; ++ii) {
+        if (cabs(oo[ii] - tt[ii]) > (1.0e-9 * (1.0 + cabs(oo[ii])))) {
+            return 0;
+        }
+    }
+    return !0;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        /* H on qubit 0 then CNOT from 0 to 1 makes a Bell state. */
+        DIRAC_OBJECT_CONST(2, 2) H =
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { R, R, },
+                { R, -R, },
+            DIRAC_OBJECT_INIT_END;
+        DIRAC_OBJECT_CONST(4, 4) CNOT =
+            DIRAC_OBJECT_INIT_BEGIN(4, 4)
+                { 1, 0, 0, 0, },
+                { 0, 1, 0, 0, },
+                { 0, 0, 0, 1, },
+                { 0, 0, 1, 0, },
+            DIRAC_OBJECT_INIT_END;
+        DIRAC_OBJECT_CONST(4, 1) zero =
+            DIRAC_OBJECT_INIT_BEGIN(4, 1)
+                { 1, }, { 0, }, { 0, }, { 0, },
+            DIRAC_OBJECT_INIT_END;
+        static const size_t ZERO[] = { 0, };
+        static const size_t ZEROONE[] = { 0, 1, };
+        dirac_circuit_t * circuit;
+        dirac_matrix_t * state;
+        dirac_complex_t * ss;
+
+        circuit = dirac_circuit_new(2);
+        ASSERT(circuit != (dirac_circuit_t *)0);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(H), ZERO, 1) == 0);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(CNOT), ZEROONE, 2) == 1);
+        ASSERT(dirac_circuit_gates_get(circuit) == 2);
+
+        state = dirac_circuit_apply(circuit, DIRAC_MATRIX_GET(zero));
+        ASSERT(state != (dirac_matrix_t *)0);
+        ss = (dirac_complex_t *)state;
+        ASSERT(cabs(ss[0] - R) < 1.0e-12);
+        ASSERT(cabs(ss[1]) < 1.0e-12);
+        ASSERT(cabs(ss[2]) < 1.0e-12);
+        ASSERT(cabs(ss[3] - R) < 1.0e-12);
+        dirac_delete(state);
+
+        ASSERT(dirac_circuit_compile(circuit, 2) == 1);
+        ASSERT(dirac_circuit_gates_get(circuit) == 1);
+        state = dirac_circuit_apply(circuit, DIRAC_MATRIX_GET(zero));
+        ASSERT(state != (dirac_matrix_t *)0);
+        ss = (dirac_complex_t *)state;
+        ASSERT(cabs(ss[0] - R) < 1.0e-12);
+        ASSERT(cabs(ss[1]) < 1.0e-12);
+        ASSERT(cabs(ss[2]) < 1.0e-12);
+        ASSERT(cabs(ss[3] - R) < 1.0e-12);
+        dirac_delete(state);
+
+        dirac_circuit_delete(circuit);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* A gate on qubit 1 of 3 is I (x) G (x) I. */
+        static const size_t ONE[] = { 1, };
+        dirac_matrix_t * gate = arbitrary(2, 7);
+        dirac_matrix_t * eye = dirac_new_base(2, 2);
+        dirac_matrix_t * vector = arbitrary(8, 3);
+        dirac_matrix_t * temp;
+        dirac_matrix_t * whole;
+        dirac_matrix_t * expected;
+        dirac_matrix_t * actual;
+        dirac_circuit_t * circuit;
+
+        ((dirac_complex_t *)eye)[0] = 1.0;
+        ((dirac_complex_t *)eye)[3] = 1.0;
+        temp = dirac_matrix_kro(eye, gate);
+        whole = dirac_matrix_kro(temp, eye);
+        dirac_delete(temp);
+
+        /* Only the first column of the arbitrary square serves as the state. */
+        temp = dirac_new_base(8, 1);
+        for (size_t ii = 0; ii < 8; ++ii) {
+            ((dirac_complex_t *)temp)[ii] = ((dirac_complex_t *)vector)[ii * 8];
+        }
+        dirac_delete(vector);
+        vector = temp;
+
+        expected = dirac_matrix_mul(whole, vector);
+        circuit = dirac_circuit_new(3);
+        ASSERT(dirac_circuit_gate(circuit, gate, ONE, 1) == 0);
+        actual = dirac_circuit_apply(circuit, vector);
+        ASSERT(actual != (dirac_matrix_t *)0);
+        ASSERT(same(expected, actual, 8));
+
+        dirac_circuit_delete(circuit);
+        dirac_delete(actual);
+        dirac_delete(expected);
+        dirac_delete(whole);
+        dirac_delete(vector);
+        dirac_delete(eye);
+        dirac_delete(gate);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Compiling at any width never changes what the circuit does. */
+        static const size_t QUBITS = 10;
+        static const size_t TARGETS[][3] = {
+            { 0, }, { 3, 1, }, { 9, }, { 4, 2, 8, }, { 1, }, { 5, 6, },
+            { 6, 5, }, { 7, }, { 2, 9, }, { 0, 4, }, { 8, 3, 0, }, { 5, },
+            { 3, }, { 9, 7, }, { 1, 6, 2, }, { 4, }, { 0, 9, }, { 8, },
+        };
+        static const size_t COUNTS[] = {
+            1, 2, 1, 3, 1, 2,
+            2, 1, 2, 2, 3, 1,
+            1, 2, 3, 1, 2, 1,
+        };
+        static const size_t GATES = sizeof(COUNTS) / sizeof(COUNTS[0]);
+        size_t length = (size_t)1 << QUBITS;
+        dirac_matrix_t * vector = dirac_new_base(length, 1);
+        dirac_matrix_t * gates[sizeof(COUNTS) / sizeof(COUNTS[0])];
+        dirac_matrix_t * expected;
+        dirac_matrix_t * actual;
+        dirac_circuit_t * circuit;
+        size_t prior;
+        size_t width;
+        ssize_t count;
+        size_t ii;
+
+        for (ii = 0; ii < length; ++ii) {
+            ((dirac_complex_t *)vector)[ii] = CMPLX(sin((double)ii), cos((double)(ii * ii)));
+        }
+        for (ii = 0; ii < GATES; ++ii) {
+            gates[ii] = arbitrary((size_t)1 << COUNTS[ii], ii);
+        }
+
+        circuit = dirac_circuit_new(QUBITS);
+        for (ii = 0; ii < GATES; ++ii) {
+            ASSERT(dirac_circuit_gate(circuit, gates[ii], TARGETS[ii], COUNTS[ii]) == ii);
+        }
+        prior = dirac_threads_set(1);
+        expected = dirac_circuit_apply(circuit, vector);
+        ASSERT(expected != (dirac_matrix_t *)0);
+        dirac_circuit_delete(circuit);
+
+        for (width = 1; width <= 6; ++width) {
+            circuit = dirac_circuit_new(QUBITS);
+            for (ii = 0; ii < GATES; ++ii) {
+                ASSERT(dirac_circuit_gate(circuit, gates[ii], TARGETS[ii], COUNTS[ii]) == ii);
+            }
+            count = dirac_circuit_compile(circuit, width);
+            ASSERT(count > 0);
+            ASSERT(count <= GATES);
+            ASSERT(dirac_circuit_gates_get(circuit) == count);
+            if (width >= 5) {
+                ASSERT((count * 3) < GATES);
+            }
+            /* Compiling again may fold further but changes nothing. */
+            ASSERT(dirac_circuit_compile(circuit, width) <= count);
+            dirac_threads_set(4);
+            actual = dirac_circuit_apply(circuit, vector);
+            ASSERT(actual != (dirac_matrix_t *)0);
+            ASSERT(same(expected, actual, length));
+            dirac_delete(actual);
+            dirac_threads_set(1);
+            dirac_circuit_delete(circuit);
+        }
+
+        dirac_threads_set(prior);
+
+        for (ii = 0; ii < GATES; ++ii) {
+            dirac_delete(gates[ii]);
+        }
+        dirac_delete(expected);
+        dirac_delete(vector);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Inverse pairs cancel, even around gates that commute with them. */
+        DIRAC_OBJECT_CONST(2, 2) H =
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { R, R, },
+                { R, -R, },
+            DIRAC_OBJECT_INIT_END;
+        DIRAC_OBJECT_CONST(2, 2) X =
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { 0, 1, },
+                { 1, 0, },
+            DIRAC_OBJECT_INIT_END;
+        DIRAC_OBJECT_CONST(2, 2) S =
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { 1, 0, },
+                { 0, 0+1i, },
+            DIRAC_OBJECT_INIT_END;
+        DIRAC_OBJECT_CONST(2, 2) SDAGGER =
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { 1, 0, },
+                { 0, 0-1i, },
+            DIRAC_OBJECT_INIT_END;
+        DIRAC_OBJECT_CONST(4, 4) CNOT =
+            DIRAC_OBJECT_INIT_BEGIN(4, 4)
+                { 1, 0, 0, 0, },
+                { 0, 1, 0, 0, },
+                { 0, 0, 0, 1, },
+                { 0, 0, 1, 0, },
+            DIRAC_OBJECT_INIT_END;
+        DIRAC_OBJECT_CONST(4, 4) CZ =
+            DIRAC_OBJECT_INIT_BEGIN(4, 4)
+                { 1, 0, 0, 0, },
+                { 0, 1, 0, 0, },
+                { 0, 0, 1, 0, },
+                { 0, 0, 0, -1, },
+            DIRAC_OBJECT_INIT_END;
+        static const size_t ZERO[] = { 0, };
+        static const size_t ONE[] = { 1, };
+        static const size_t ZEROONE[] = { 0, 1, };
+        dirac_matrix_t * vector = dirac_new_base(4, 1);
+        dirac_complex_t * vv = (dirac_complex_t *)vector;
+        dirac_complex_t * aa;
+        dirac_matrix_t * actual;
+        dirac_circuit_t * circuit;
+
+        vv[0] = 0.1+0.2i;
+        vv[1] = 0.3-0.4i;
+        vv[2] = -0.5+0.6i;
+        vv[3] = 0.7+0.8i;
+
+        /* H H, X CNOT CNOT X on one qubit wide: nothing is left. */
+        circuit = dirac_circuit_new(2);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(H), ZERO, 1) >= 0);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(H), ZERO, 1) >= 0);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(X), ONE, 1) >= 0);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(CNOT), ZEROONE, 2) >= 0);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(CNOT), ZEROONE, 2) >= 0);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(X), ONE, 1) >= 0);
+        ASSERT(dirac_circuit_compile(circuit, 1) == 0);
+        dirac_circuit_delete(circuit);
+
+        /* X on 0 commutes past X on 1 and cancels. */
+        circuit = dirac_circuit_new(2);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(X), ZERO, 1) >= 0);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(X), ONE, 1) >= 0);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(X), ZERO, 1) >= 0);
+        ASSERT(dirac_circuit_compile(circuit, 1) == 1);
+        dirac_circuit_delete(circuit);
+
+        /* S on 0 commutes past the diagonal CZ and cancels with S dagger. */
+        circuit = dirac_circuit_new(2);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(S), ZERO, 1) >= 0);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(CZ), ZEROONE, 2) >= 0);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(SDAGGER), ZERO, 1) >= 0);
+        ASSERT(dirac_circuit_compile(circuit, 1) == 1);
+        actual = dirac_circuit_apply(circuit, vector);
+        ASSERT(actual != (dirac_matrix_t *)0);
+        aa = (dirac_complex_t *)actual;
+        ASSERT(cabs(aa[0] - vv[0]) < 1.0e-12);
+        ASSERT(cabs(aa[1] - vv[1]) < 1.0e-12);
+        ASSERT(cabs(aa[2] - vv[2]) < 1.0e-12);
+        ASSERT(cabs(aa[3] + vv[3]) < 1.0e-12);
+        dirac_delete(actual);
+        dirac_circuit_delete(circuit);
+
+        /* But not past the CNOT, which is not diagonal. */
+        circuit = dirac_circuit_new(2);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(S), ZERO, 1) >= 0);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(CNOT), ZEROONE, 2) >= 0);
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(SDAGGER), ZERO, 1) >= 0);
+        ASSERT(dirac_circuit_compile(circuit, 1) == 3);
+        dirac_circuit_delete(circuit);
+
+        dirac_delete(vector);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        DIRAC_OBJECT_CONST(2, 2) X =
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { 0, 1, },
+                { 1, 0, },
+            DIRAC_OBJECT_INIT_END;
+        static const size_t BAD[] = { 3, };
+        static const size_t TWICE[] = { 1, 1, };
+        static const size_t ZERO[] = { 0, };
+        dirac_matrix_t * vector = dirac_new_base(4, 1);
+        dirac_circuit_t * circuit;
+
+        errno = 0;
+        ASSERT(dirac_circuit_new(0) == (dirac_circuit_t *)0);
+        ASSERT(errno == EINVAL);
+
+        circuit = dirac_circuit_new(3);
+        ASSERT(circuit != (dirac_circuit_t *)0);
+        errno = 0;
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(X), BAD, 1) == -1);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(X), TWICE, 2) == -1);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_circuit_gate(circuit, DIRAC_MATRIX_GET(X), ZERO, 0) == -1);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_circuit_gate(circuit, vector, ZERO, 1) == -1);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_circuit_compile(circuit, 0) == -1);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_circuit_compile(circuit, DIRAC_CIRCUIT_MAXIMUM + 1) == -1);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_circuit_apply(circuit, vector) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        ASSERT(dirac_circuit_gates_get(circuit) == 0);
+        ASSERT(dirac_circuit_compile(circuit, 3) == 0);
+        dirac_circuit_delete(circuit);
+        dirac_circuit_delete((dirac_circuit_t *)0);
+        ASSERT(dirac_circuit_gates_get((dirac_circuit_t *)0) == 0);
+
+        dirac_delete(vector);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -15,8 +15,34 @@
 #include "com/diag/diminuto/diminuto_dump.h"
 #include "com/diag/diminuto/diminuto_log.h"
 #include "com/diag/dirac/dirac.h"
+#include <pthread.h>
 #include "dirac.h"
 
+static void * churn(void * arg)
+{
+    static const size_t ORDERS[] = { 1, 2, 4, 8, 16, 32, };
+    dirac_matrix_t * matrices[16] = { (dirac_matrix_t *)0, };
+    unsigned int seed = (unsigned int)(uintptr_t)arg;
+    uintptr_t failures = 0;
+    size_t order;
+    size_t slot;
+    int ii;
+    for (ii = 0; ii < 20000; ++ii) {
+        slot = rand_r(&seed) % diminuto_countof(matrices);
+        if ((matrices[slot] != (dirac_matrix_t *)0) && (((dirac_complex_t *)matrices[slot])[0] != (double)(uintptr_t)arg)) {
+            failures += 1;
+        }
+        dirac_delete(matrices[slot]);
+        order = ORDERS[rand_r(&seed) % diminuto_countof(ORDERS)];
+        matrices[slot] = dirac_new_base(order, order);
+        ((dirac_complex_t *)matrices[slot])[0] = (double)(uintptr_t)arg;
+    }
+    for (slot = 0; slot < diminuto_countof(matrices); ++slot) {
+        dirac_delete(matrices[slot]);
+    }
+    return (void *)failures;
+}
+
 int main(void)
 {
     SETLOGMASK();
@@ -84,6 +110,7 @@ int main(void)
 
         object.data.head.rows = 5;
         object.data.head.columns = 7;
+        object.data.head.flags = 0;
 
         dirac_matrix_t * them = dirac_core_matrix_mut(&object);
         ASSERT(them == &(object.data.body[0][0]));
@@ -416,8 +443,8 @@ int main(void)
 
         that = dirac_core_pro(that1, that3);
         ASSERT(that != (dirac_t *)0);
-        ASSERT(dirac_core_rows_get(that) == 5);
-        ASSERT(dirac_core_cols_get(that) == 5);
+        ASSERT(dirac_core_rows_get(that) == 3);
+        ASSERT(dirac_core_cols_get(that) == 7);
 
         that = dirac_core_free(that);
         ASSERT(that == (dirac_t *)0);
@@ -637,6 +664,37 @@ int main(void)
         STATUS();
     }
 
+    {
+        TEST();
+
+        /* Many threads allocating and freeing at once. */
+        pthread_t threads[8];
+        void * result;
+        uintptr_t ii;
+        size_t waits;
+        uint64_t waited = ~(uint64_t)0;
+
+        dirac_contention_reset();
+        ASSERT(dirac_contention_get(&waited) == 0);
+        ASSERT(waited == 0);
+
+        for (ii = 0; ii < diminuto_countof(threads); ++ii) {
+            ASSERT(pthread_create(&(threads[ii]), (pthread_attr_t *)0, churn, (void *)(ii + 1)) == 0);
+        }
+        for (ii = 0; ii < diminuto_countof(threads); ++ii) {
+            ASSERT(pthread_join(threads[ii], &result) == 0);
+            ASSERT(result == (void *)0);
+        }
+
+        waits = dirac_contention_get(&waited);
+        fprintf(stderr, "waits=%zu waited=%lluns\n", waits, (unsigned long long)waited);
+        ASSERT((waits > 0) || (waited == 0));
+        ASSERT(dirac_audit() == (dirac_t *)0);
+        ASSERT(dirac_dump((FILE *)0) >= 0);
+
+        STATUS();
+    }
+
     {
         TEST();
 
@@ -0,0 +1,349 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac eigensystem functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac eigensystem functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include "unittest-dirac-primes.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*
+ * Returns the largest |A*x - lambda*x| over the columns x of VECTORS.
+ */
+static double residual(const dirac_matrix_t * thema, const dirac_matrix_t * values, const dirac_matrix_t * vectors)
+{
+    const dirac_complex_t * lambda = (const dirac_complex_t *)values;
+    const dirac_complex_t * xx = (const dirac_complex_t *)vectors;
+    dirac_matrix_t * product = dirac_matrix_mul(thema, vectors);
+    const dirac_complex_t * ax = (const dirac_complex_t *)product;
+    size_t order = dirac_rows_get(vectors);
+    size_t count = dirac_cols_get(vectors);
+    double largest = 0.0;
+    double difference;
+    size_t rr;
+    size_t cc;
+    for (rr = 0; rr < order; ++rr) {
+        for (cc = 0; cc < count; ++cc) {
+            difference = cabs(ax[(rr * count) + cc] - (lambda[cc] * xx[(rr * count) + cc]));
+            if (!(difference <= largest)) { largest = difference; }
+        }
+    }
+    dirac_delete(product);
+    return largest;
+}
+
+/*
+ * Returns how far X'*X is from the identity.
+ */
+static double orthogonality(const dirac_matrix_t * vectors)
+{
+    const dirac_complex_t * xx = (const dirac_complex_t *)vectors;
+    size_t order = dirac_rows_get(vectors);
+    size_t count = dirac_cols_get(vectors);
+    dirac_complex_t sum;
+    double largest = 0.0;
+    double difference;
+    size_t ii;
+    size_t jj;
+    size_t kk;
+    for (ii = 0; ii < count; ++ii) {
+        for (jj = 0; jj < count; ++jj) {
+            sum = 0;
+            for (kk = 0; kk < order; ++kk) {
+                sum += conj(xx[(kk * count) + ii]) * xx[(kk * count) + jj];
+            }
+            difference = cabs(sum - ((ii == jj) ? 1.0 : 0.0));
+            if (!(difference <= largest)) { largest = difference; }
+        }
+    }
+    return largest;
+}
+
+static int ordered(const dirac_matrix_t * values)
+{
+    const dirac_complex_t * lambda = (const dirac_complex_t *)values;
+    size_t ii;
+    for (ii = 0; ii < dirac_rows_get(values); ++ii) {
+        if (cimag(lambda[ii]) != 0.0) { return 0; }
+        if ((ii > 0) && (creal(lambda[ii]) < creal(lambda[ii - 1]))) { return 0; }
+    }
+    return !0;
+}
+
+static dirac_matrix_t * hermitian(size_t order)
+{
+    dirac_matrix_t * them = dirac_new_base(order, order);
+    dirac_complex_t * hh = (dirac_complex_t *)them;
+    size_t rr;
+    size_t cc;
+    for (rr = 0; rr < order; ++rr) {
+        hh[(rr * order) + rr] = (PRIMES[rr % 100] % 7) - 3.0;
+        for (cc = rr + 1; cc < order; ++cc) {
+            hh[(rr * order) + cc] = CMPLX(((PRIMES[(rr + cc) % 100] % 5) - 2.0) / 4.0, ((PRIMES[(rr * cc) % 100] % 3) - 1.0) / 4.0);
+            hh[(cc * order) + rr] = conj(hh[(rr * order) + cc]);
+        }
+    }
+    return them;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        /* Pauli Y has eigenvalues -1 and +1 with complex eigenvectors. */
+        DIRAC_OBJECT_CONST(2, 2) yy =
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { 0.0+0.0i, 0.0-1.0i, },
+                { 0.0+1.0i, 0.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        dirac_matrix_t * vectors = (dirac_matrix_t *)0;
+        dirac_matrix_t * values;
+
+        values = dirac_matrix_eigh(DIRAC_MATRIX_GET(yy), &vectors);
+        ASSERT(values != (dirac_matrix_t *)0);
+        ASSERT(vectors != (dirac_matrix_t *)0);
+        ASSERT(dirac_rows_get(values) == 2);
+        ASSERT(dirac_cols_get(values) == 1);
+        ASSERT(dirac_rows_get(vectors) == 2);
+        ASSERT(dirac_cols_get(vectors) == 2);
+        ASSERT(ordered(values));
+        ASSERT(fabs(creal(((dirac_complex_t *)values)[0]) + 1.0) < 1e-15);
+        ASSERT(fabs(creal(((dirac_complex_t *)values)[1]) - 1.0) < 1e-15);
+        ASSERT(residual(DIRAC_MATRIX_GET(yy), values, vectors) < 1e-15);
+        ASSERT(orthogonality(vectors) < 1e-15);
+        dirac_delete(vectors);
+        dirac_delete(values);
+
+        /* A one by one is its own eigenvalue. */
+        dirac_matrix_t * one = dirac_new_base(1, 1);
+        ((dirac_complex_t *)one)[0] = -2.5;
+        values = dirac_matrix_eigh(one, &vectors);
+        ASSERT(values != (dirac_matrix_t *)0);
+        ASSERT(((dirac_complex_t *)values)[0] == -2.5);
+        ASSERT(cabs(((dirac_complex_t *)vectors)[0]) == 1.0);
+        dirac_delete(vectors);
+        dirac_delete(values);
+        dirac_delete(one);
+
+        /* Any kind: a diagonal, with repeated eigenvalues. */
+        static const size_t ORDER = 40;
+        dirac_matrix_t * diagonal = dirac_diagonal_new(ORDER);
+        size_t ii;
+        for (ii = 0; ii < ORDER; ++ii) {
+            ((dirac_complex_t *)diagonal)[ii] = (double)((ORDER - ii) % 7);
+        }
+        values = dirac_matrix_eigh(diagonal, &vectors);
+        ASSERT(values != (dirac_matrix_t *)0);
+        ASSERT(ordered(values));
+        ASSERT(((dirac_complex_t *)values)[0] == 0.0);
+        ASSERT(((dirac_complex_t *)values)[ORDER - 1] == 6.0);
+        ASSERT(residual(diagonal, values, vectors) < 1e-14);
+        ASSERT(orthogonality(vectors) < 1e-14);
+        dirac_delete(vectors);
+        dirac_delete(values);
+        dirac_delete(diagonal);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /*
+         * X (x) X (x) X (x) X on sixteen states has two eigenvalues, each
+         * eight times over, which makes divide and conquer deflate.
+         */
+        dirac_matrix_t * xx = dirac_permutation_new(16);
+        size_t ii;
+        for (ii = 0; ii < 16; ++ii) {
+            dirac_permutation_columns_mut(xx)[ii] = 15 - ii;
+        }
+        dirac_matrix_t * big = dirac_matrix_kro(xx, xx);
+        dirac_matrix_t * vectors = (dirac_matrix_t *)0;
+        dirac_matrix_t * values = dirac_matrix_eigh(big, &vectors);
+        ASSERT(values != (dirac_matrix_t *)0);
+        ASSERT(dirac_rows_get(values) == 256);
+        ASSERT(ordered(values));
+        for (ii = 0; ii < 256; ++ii) {
+            ASSERT(fabs(creal(((dirac_complex_t *)values)[ii]) - ((ii < 128) ? -1.0 : 1.0)) < 1e-13);
+        }
+        ASSERT(residual(big, values, vectors) < 1e-13);
+        ASSERT(orthogonality(vectors) < 1e-13);
+        dirac_delete(vectors);
+        dirac_delete(values);
+        dirac_delete(big);
+        dirac_delete(xx);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        size_t prior = dirac_threads_set(4);
+        static const size_t ORDER = 150;
+        dirac_matrix_t * hh = hermitian(ORDER);
+        dirac_matrix_t * vectors = (dirac_matrix_t *)0;
+        dirac_matrix_t * values;
+        size_t ii;
+
+        values = dirac_matrix_eigh(hh, &vectors);
+        ASSERT(values != (dirac_matrix_t *)0);
+        ASSERT(vectors != (dirac_matrix_t *)0);
+        ASSERT(ordered(values));
+        ASSERT(residual(hh, values, vectors) < 1e-11);
+        ASSERT(orthogonality(vectors) < 1e-12);
+
+        /* The trace is the sum of the eigenvalues. */
+        double trace = 0.0;
+        double sum = 0.0;
+        for (ii = 0; ii < ORDER; ++ii) {
+            trace += creal(((dirac_complex_t *)hh)[(ii * ORDER) + ii]);
+            sum += creal(((dirac_complex_t *)values)[ii]);
+        }
+        ASSERT(fabs(trace - sum) < 1e-10);
+
+        /* The values alone are the same values. */
+        dirac_matrix_t * alone = dirac_matrix_eigh(hh, (dirac_matrix_t **)0);
+        ASSERT(alone != (dirac_matrix_t *)0);
+        ASSERT(ordered(alone));
+        for (ii = 0; ii < ORDER; ++ii) {
+            ASSERT(cabs(((dirac_complex_t *)alone)[ii] - ((dirac_complex_t *)values)[ii]) < 1e-11);
+        }
+        dirac_delete(alone);
+
+        /* So is a range of them, say the ground state and a few above it. */
+        dirac_matrix_t * some = (dirac_matrix_t *)0;
+        dirac_matrix_t * range = dirac_matrix_eigh_range(hh, 0, 5, &some);
+        ASSERT(range != (dirac_matrix_t *)0);
+        ASSERT(some != (dirac_matrix_t *)0);
+        ASSERT(dirac_rows_get(range) == 5);
+        ASSERT(dirac_rows_get(some) == ORDER);
+        ASSERT(dirac_cols_get(some) == 5);
+        ASSERT(ordered(range));
+        for (ii = 0; ii < 5; ++ii) {
+            ASSERT(cabs(((dirac_complex_t *)range)[ii] - ((dirac_complex_t *)values)[ii]) < 1e-11);
+        }
+        ASSERT(residual(hh, range, some) < 1e-11);
+        ASSERT(orthogonality(some) < 1e-12);
+        dirac_delete(some);
+        dirac_delete(range);
+
+        range = dirac_matrix_eigh_range(hh, 70, 20, &some);
+        ASSERT(range != (dirac_matrix_t *)0);
+        for (ii = 0; ii < 20; ++ii) {
+            ASSERT(cabs(((dirac_complex_t *)range)[ii] - ((dirac_complex_t *)values)[70 + ii]) < 1e-11);
+        }
+        ASSERT(residual(hh, range, some) < 1e-11);
+        ASSERT(orthogonality(some) < 1e-11);
+        dirac_delete(some);
+        dirac_delete(range);
+
+        range = dirac_matrix_eigh_range(hh, ORDER - 1, 1, (dirac_matrix_t **)0);
+        ASSERT(range != (dirac_matrix_t *)0);
+        ASSERT(cabs(((dirac_complex_t *)range)[0] - ((dirac_complex_t *)values)[ORDER - 1]) < 1e-11);
+        dirac_delete(range);
+
+        /* A sparse Hamiltonian has the same spectrum. */
+        dirac_matrix_t * sparse = dirac_sparse_from_dense(hh);
+        dirac_matrix_t * other = dirac_matrix_eigh(sparse, (dirac_matrix_t **)0);
+        ASSERT(other != (dirac_matrix_t *)0);
+        for (ii = 0; ii < ORDER; ++ii) {
+            ASSERT(cabs(((dirac_complex_t *)other)[ii] - ((dirac_complex_t *)values)[ii]) < 1e-11);
+        }
+        dirac_delete(other);
+        dirac_delete(sparse);
+
+        dirac_delete(vectors);
+        dirac_delete(values);
+        dirac_delete(hh);
+        dirac_threads_set(prior);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* A range with a cluster of equal eigenvalues still gets a basis. */
+        dirac_matrix_t * xx = dirac_permutation_new(16);
+        size_t ii;
+        for (ii = 0; ii < 16; ++ii) {
+            dirac_permutation_columns_mut(xx)[ii] = 15 - ii;
+        }
+        dirac_matrix_t * vectors = (dirac_matrix_t *)0;
+        dirac_matrix_t * values = dirac_matrix_eigh_range(xx, 4, 8, &vectors);
+        ASSERT(values != (dirac_matrix_t *)0);
+        for (ii = 0; ii < 8; ++ii) {
+            ASSERT(fabs(creal(((dirac_complex_t *)values)[ii]) - ((ii < 4) ? -1.0 : 1.0)) < 1e-13);
+        }
+        ASSERT(residual(xx, values, vectors) < 1e-12);
+        ASSERT(orthogonality(vectors) < 1e-12);
+        dirac_delete(vectors);
+        dirac_delete(values);
+        dirac_delete(xx);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_matrix_t * wide = dirac_new_base(2, 3);
+        dirac_matrix_t * square = dirac_new_base(3, 3);
+        dirac_matrix_t * vectors = (dirac_matrix_t *)0;
+
+        ASSERT(dirac_matrix_eigh(wide, &vectors) == (dirac_matrix_t *)0);
+        ASSERT(vectors == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_eigh_range(wide, 0, 1, &vectors) == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_eigh_range(square, 0, 0, &vectors) == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_eigh_range(square, 2, 2, &vectors) == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_eigh_range(square, 4, 1, &vectors) == (dirac_matrix_t *)0);
+        ASSERT(vectors == (dirac_matrix_t *)0);
+
+        /* Something that has no eigenvalues to find. */
+        ((dirac_complex_t *)square)[4] = NAN;
+        ASSERT(dirac_matrix_eigh(square, (dirac_matrix_t **)0) == (dirac_matrix_t *)0);
+
+        dirac_delete(square);
+        dirac_delete(wide);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
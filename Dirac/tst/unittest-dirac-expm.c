@@ -0,0 +1,357 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac matrix exponential functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac matrix exponential functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include "unittest-dirac-primes.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static double distance(const dirac_matrix_t * thema, const dirac_matrix_t * themb)
+{
+    const dirac_complex_t * aa = (const dirac_complex_t *)thema;
+    const dirac_complex_t * bb = (const dirac_complex_t *)themb;
+    double largest = 0.0;
+    double difference;
+    size_t ii;
+    if (dirac_rows_get(thema) != dirac_rows_get(themb)) { return INFINITY; }
+    if (dirac_cols_get(thema) != dirac_cols_get(themb)) { return INFINITY; }
+    for (ii = 0; ii < (dirac_rows_get(thema) * dirac_cols_get(thema)); ++ii) {
+        difference = cabs(aa[ii] - bb[ii]);
+        if (!(difference <= largest)) { largest = difference; }
+    }
+    return largest;
+}
+
+/*
+ * Returns how far U*U' is from the identity.
+ */
+static double unitarity(const dirac_matrix_t * them)
+{
+    const dirac_complex_t * uu = (const dirac_complex_t *)them;
+    size_t order = dirac_rows_get(them);
+    dirac_complex_t sum;
+    double largest = 0.0;
+    double difference;
+    size_t rr;
+    size_t cc;
+    size_t kk;
+    for (rr = 0; rr < order; ++rr) {
+        for (cc = 0; cc < order; ++cc) {
+            sum = 0;
+            for (kk = 0; kk < order; ++kk) {
+                sum += uu[(rr * order) + kk] * conj(uu[(cc * order) + kk]);
+            }
+            difference = cabs(sum - ((rr == cc) ? 1.0 : 0.0));
+            if (!(difference <= largest)) { largest = difference; }
+        }
+    }
+    return largest;
+}
+
+static dirac_matrix_t * hermitian(size_t order)
+{
+    dirac_matrix_t * them = dirac_new_base(order, order);
+    dirac_complex_t * hh = (dirac_complex_t *)them;
+    size_t rr;
+    size_t cc;
+    for (rr = 0; rr < order; ++rr) {
+        hh[(rr * order) + rr] = (PRIMES[rr % 100] % 7) - 3.0;
+        for (cc = rr + 1; cc < order; ++cc) {
+            hh[(rr * order) + cc] = CMPLX(((PRIMES[(rr + cc) % 100] % 5) - 2.0) / 4.0, ((PRIMES[(rr * cc) % 100] % 3) - 1.0) / 4.0);
+            hh[(cc * order) + rr] = conj(hh[(rr * order) + cc]);
+        }
+    }
+    return them;
+}
+
+/*
+ * A chain of sites with hopping between neighbors and an on site energy.
+ */
+static dirac_matrix_t * chain(size_t order)
+{
+    dirac_matrix_t * them = dirac_sparse_new(order, order, (3 * order) - 2);
+    dirac_complex_t * values = (dirac_complex_t *)them;
+    size_t * columns = dirac_sparse_columns_mut(them);
+    size_t * offsets = dirac_sparse_offsets_mut(them);
+    size_t rr;
+    size_t ii = 0;
+    for (rr = 0; rr < order; ++rr) {
+        offsets[rr] = ii;
+        if (rr > 0) {
+            values[ii] = CMPLX(1.0, -0.5);
+            columns[ii++] = rr - 1;
+        }
+        values[ii] = (PRIMES[rr % 100] % 5) - 2.0;
+        columns[ii++] = rr;
+        if (rr < (order - 1)) {
+            values[ii] = CMPLX(1.0, 0.5);
+            columns[ii++] = rr + 1;
+        }
+    }
+    offsets[order] = ii;
+    return them;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        DIRAC_OBJECT_CONST(2, 2) zero = DIRAC_OBJECT_INIT(2, 2);
+        DIRAC_OBJECT_CONST(2, 2) identity =
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { 1.0+0.0i, 0.0+0.0i, },
+                { 0.0+0.0i, 1.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        DIRAC_OBJECT_CONST(2, 2) nilpotent =
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { 0.0+0.0i, 1.0+0.0i, },
+                { 0.0+0.0i, 0.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        DIRAC_OBJECT_CONST(2, 2) shear =
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { 1.0+0.0i, 3.0+0.0i, },
+                { 0.0+0.0i, 1.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        dirac_matrix_t * them;
+
+        them = dirac_matrix_expm(DIRAC_MATRIX_GET(zero), 1.0);
+        ASSERT(them != (dirac_matrix_t *)0);
+        ASSERT(distance(them, DIRAC_MATRIX_GET(identity)) == 0.0);
+        dirac_delete(them);
+
+        them = dirac_matrix_expm(DIRAC_MATRIX_GET(nilpotent), 3.0);
+        ASSERT(them != (dirac_matrix_t *)0);
+        ASSERT(distance(them, DIRAC_MATRIX_GET(shear)) < 1e-14);
+        dirac_delete(them);
+
+        /* Diagonals of any kind and size of norm (so any degree and scaling). */
+        static const double NORMS[] = { 0.001, 0.1, 0.5, 1.5, 4.0, 40.0, };
+        size_t ii;
+        for (ii = 0; ii < (sizeof(NORMS) / sizeof(NORMS[0])); ++ii) {
+            dirac_matrix_t * diagonal = dirac_diagonal_new(2);
+            ((dirac_complex_t *)diagonal)[0] = NORMS[ii];
+            ((dirac_complex_t *)diagonal)[1] = CMPLX(0.0, -NORMS[ii]);
+            them = dirac_matrix_expm(diagonal, -1.0);
+            ASSERT(them != (dirac_matrix_t *)0);
+            ASSERT(dirac_kind_get(them) == DIRAC_KIND_DENSE);
+            ASSERT(fabs(creal(((dirac_complex_t *)them)[0]) - exp(-NORMS[ii])) <= (1e-13 * exp(-NORMS[ii])));
+            ASSERT(cabs(((dirac_complex_t *)them)[1]) == 0.0);
+            ASSERT(cabs(((dirac_complex_t *)them)[2]) == 0.0);
+            ASSERT(cabs(((dirac_complex_t *)them)[3] - cexp(CMPLX(0.0, NORMS[ii]))) < 1e-13);
+            dirac_delete(them);
+            dirac_delete(diagonal);
+        }
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* exp(-i theta X) = cos(theta) I - i sin(theta) X */
+        dirac_matrix_t * xx = dirac_permutation_new(2);
+        dirac_permutation_columns_mut(xx)[0] = 1;
+        dirac_permutation_columns_mut(xx)[1] = 0;
+        static const double THETAS[] = { 0.01, 0.3, 1.0, 10.0, 100.0, };
+        size_t ii;
+        for (ii = 0; ii < (sizeof(THETAS) / sizeof(THETAS[0])); ++ii) {
+            dirac_complex_t * uu = (dirac_complex_t *)dirac_matrix_expm(xx, CMPLX(0.0, -THETAS[ii]));
+            ASSERT(uu != (dirac_complex_t *)0);
+            ASSERT(cabs(uu[0] - cos(THETAS[ii])) < 1e-12);
+            ASSERT(cabs(uu[1] - CMPLX(0.0, -sin(THETAS[ii]))) < 1e-12);
+            ASSERT(cabs(uu[2] - CMPLX(0.0, -sin(THETAS[ii]))) < 1e-12);
+            ASSERT(cabs(uu[3] - cos(THETAS[ii])) < 1e-12);
+            dirac_delete(uu);
+        }
+        dirac_delete(xx);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        size_t prior = dirac_threads_set(4);
+        dirac_matrix_t * hh = hermitian(48);
+
+        /* Time evolution is unitary and composes. */
+        dirac_matrix_t * half = dirac_matrix_expm(hh, CMPLX(0.0, -1.5));
+        ASSERT(half != (dirac_matrix_t *)0);
+        ASSERT(unitarity(half) < 1e-12);
+        dirac_matrix_t * whole = dirac_matrix_expm(hh, CMPLX(0.0, -3.0));
+        ASSERT(whole != (dirac_matrix_t *)0);
+        ASSERT(unitarity(whole) < 1e-12);
+        dirac_matrix_t * twice = dirac_matrix_mul(half, half);
+        ASSERT(distance(twice, whole) < 1e-11);
+        dirac_delete(twice);
+
+        /* The inverse is the evolution backwards. */
+        dirac_matrix_t * back = dirac_matrix_expm(hh, CMPLX(0.0, 3.0));
+        dirac_matrix_t * product = dirac_matrix_mul(whole, back);
+        ASSERT(unitarity(product) < 1e-12);
+        ASSERT(cabs(((dirac_complex_t *)product)[0] - 1.0) < 1e-12);
+        dirac_delete(product);
+        dirac_delete(back);
+
+        /* The same from a sparse Hamiltonian. */
+        dirac_matrix_t * sparse = dirac_sparse_from_dense(hh);
+        dirac_matrix_t * other = dirac_matrix_expm(sparse, CMPLX(0.0, -3.0));
+        ASSERT(other != (dirac_matrix_t *)0);
+        ASSERT(distance(other, whole) < 1e-12);
+        dirac_delete(other);
+        dirac_delete(sparse);
+
+        /* And the Krylov product agrees with the product of the whole. */
+        dirac_matrix_t * vector = dirac_new_base(48, 1);
+        size_t ii;
+        for (ii = 0; ii < 48; ++ii) {
+            ((dirac_complex_t *)vector)[ii] = CMPLX((PRIMES[ii] % 3) - 1.0, (PRIMES[ii + 1] % 5) - 2.0);
+        }
+        dirac_matrix_t * expected = dirac_matrix_mul(whole, vector);
+        dirac_matrix_t * actual = dirac_matrix_expm_multiply(hh, CMPLX(0.0, -3.0), vector);
+        ASSERT(actual != (dirac_matrix_t *)0);
+        ASSERT(dirac_rows_get(actual) == 48);
+        ASSERT(dirac_cols_get(actual) == 1);
+        ASSERT(distance(actual, expected) < 1e-9);
+        dirac_delete(actual);
+        dirac_delete(expected);
+
+        dirac_delete(vector);
+        dirac_delete(whole);
+        dirac_delete(half);
+        dirac_delete(hh);
+        dirac_threads_set(prior);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* A long sparse chain evolved for long enough to take many steps. */
+        size_t prior = dirac_threads_set(4);
+        static const size_t ORDER = 300;
+        dirac_matrix_t * hh = chain(ORDER);
+        dirac_matrix_t * dense = dirac_sparse_to_dense(hh);
+        dirac_matrix_t * vector = dirac_new_base(ORDER, 1);
+        ((dirac_complex_t *)vector)[ORDER / 2] = 1.0;
+
+        dirac_matrix_t * uu = dirac_matrix_expm(dense, CMPLX(0.0, -20.0));
+        ASSERT(uu != (dirac_matrix_t *)0);
+        dirac_matrix_t * expected = dirac_matrix_mul(uu, vector);
+        dirac_matrix_t * actual = dirac_matrix_expm_multiply(hh, CMPLX(0.0, -20.0), vector);
+        ASSERT(actual != (dirac_matrix_t *)0);
+        ASSERT(distance(actual, expected) < 1e-9);
+
+        double norm = 0.0;
+        size_t ii;
+        for (ii = 0; ii < ORDER; ++ii) {
+            norm += cabs(((dirac_complex_t *)actual)[ii]) * cabs(((dirac_complex_t *)actual)[ii]);
+        }
+        ASSERT(fabs(norm - 1.0) < 1e-10);
+
+        dirac_delete(actual);
+        dirac_delete(expected);
+        dirac_delete(uu);
+
+        /* Growth and decay as well as rotation. */
+        uu = dirac_matrix_expm(dense, -0.5);
+        expected = dirac_matrix_mul(uu, vector);
+        actual = dirac_matrix_expm_multiply(hh, -0.5, vector);
+        ASSERT(actual != (dirac_matrix_t *)0);
+        ASSERT(distance(actual, expected) < 1e-9);
+        dirac_delete(actual);
+        dirac_delete(expected);
+        dirac_delete(uu);
+
+        dirac_delete(vector);
+        dirac_delete(dense);
+        dirac_delete(hh);
+        dirac_threads_set(prior);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Small spaces are exhausted before the Krylov dimension is reached. */
+        dirac_matrix_t * xx = dirac_permutation_new(4);
+        dirac_permutation_columns_mut(xx)[0] = 2;
+        dirac_permutation_columns_mut(xx)[2] = 0;
+        ((dirac_complex_t *)xx)[1] = CMPLX(0.0, 1.0);
+        dirac_matrix_t * vector = dirac_new_base(4, 1);
+        ((dirac_complex_t *)vector)[0] = 1.0;
+        ((dirac_complex_t *)vector)[1] = 2.0;
+        dirac_matrix_t * uu = dirac_matrix_expm(xx, CMPLX(0.0, -0.7));
+        dirac_matrix_t * expected = dirac_matrix_mul(uu, vector);
+        dirac_matrix_t * actual = dirac_matrix_expm_multiply(xx, CMPLX(0.0, -0.7), vector);
+        ASSERT(actual != (dirac_matrix_t *)0);
+        ASSERT(distance(actual, expected) < 1e-13);
+        dirac_delete(actual);
+        dirac_delete(expected);
+        dirac_delete(uu);
+
+        /* A zero vector stays zero. */
+        memset(vector, 0, 4 * sizeof(dirac_complex_t));
+        actual = dirac_matrix_expm_multiply(xx, 1.0, vector);
+        ASSERT(actual != (dirac_matrix_t *)0);
+        ASSERT(distance(actual, vector) == 0.0);
+        dirac_delete(actual);
+
+        /* Operands must be square and conformable. */
+        dirac_matrix_t * wide = dirac_new_base(2, 3);
+        ASSERT(dirac_matrix_expm(wide, 1.0) == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_expm_multiply(wide, 1.0, vector) == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_expm_multiply(xx, 1.0, wide) == (dirac_matrix_t *)0);
+        dirac_delete(wide);
+
+        /* Something that cannot be exponentiated. */
+        dirac_matrix_t * bad = dirac_new_base(2, 2);
+        ((dirac_complex_t *)bad)[1] = INFINITY;
+        ASSERT(dirac_matrix_expm(bad, 1.0) == (dirac_matrix_t *)0);
+        dirac_delete(bad);
+
+        dirac_delete(vector);
+        dirac_delete(xx);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
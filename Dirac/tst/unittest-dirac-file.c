@@ -0,0 +1,249 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac persistence functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac persistence functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include "unittest-dirac-fixtures.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <fcntl.h>
+
+/* Where the stored head is in a file. */
+static const off_t HEAD = DIRAC_FILE_OFFSET - offsetof(dirac_t, data.body);
+
+/*
+ * Overwrites SIZE bytes of the file at PATH at OFFSET with DATA.
+ */
+static ssize_t patch(const char * path, off_t offset, const void * data, size_t size)
+{
+    ssize_t written = -1;
+    int fd = open(path, O_WRONLY);
+    if (fd >= 0) {
+        written = pwrite(fd, data, size, offset);
+        close(fd);
+    }
+    return written;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    char path[] = "/tmp/unittest-dirac-file-XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT(fd >= 0);
+    close(fd);
+
+    {
+        TEST();
+
+        dirac_matrix_t * them = filled(17, 9, 3);
+        ssize_t total = dirac_store(path, them);
+        ASSERT(total == (DIRAC_FILE_OFFSET + (17 * 9 * sizeof(dirac_complex_t))));
+
+        const dirac_matrix_t * view = dirac_load(path);
+        ASSERT(view != (const dirac_matrix_t *)0);
+        ASSERT(((uintptr_t)view % DIRAC_FILE_ALIGNMENT) == 0);
+        ASSERT(dirac_rows_get(view) == 17);
+        ASSERT(dirac_cols_get(view) == 9);
+        ASSERT(dirac_kind_get(view) == DIRAC_KIND_DENSE);
+        ASSERT(memcmp(view, them, 17 * 9 * sizeof(dirac_complex_t)) == 0);
+
+        /* A view is an ordinary operand. */
+        dirac_matrix_t * sum = dirac_matrix_add(view, them);
+        ASSERT(sum != (dirac_matrix_t *)0);
+        ASSERT(((dirac_complex_t *)sum)[100] == (2.0 * ((dirac_complex_t *)them)[100]));
+        dirac_delete(sum);
+
+        dirac_matrix_t * copy = dirac_matrix_dup(view);
+        ASSERT(copy != (dirac_matrix_t *)0);
+        ASSERT(memcmp(copy, them, 17 * 9 * sizeof(dirac_complex_t)) == 0);
+        dirac_delete(copy);
+
+        dirac_unload(view);
+        dirac_delete(them);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_matrix_t * them = dirac_permutation_new(5);
+        dirac_permutation_columns_mut(them)[0] = 4;
+        dirac_permutation_columns_mut(them)[4] = 0;
+        ((dirac_complex_t *)them)[2] = -1.0i;
+        ASSERT(dirac_store(path, them) > 0);
+
+        const dirac_matrix_t * view = dirac_load(path);
+        ASSERT(view != (const dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(view) == DIRAC_KIND_PERMUTATION);
+        ASSERT(dirac_permutation_columns_get(view)[0] == 4);
+        ASSERT(dirac_permutation_columns_get(view)[4] == 0);
+        ASSERT(((const dirac_complex_t *)view)[2] == -1.0i);
+
+        dirac_matrix_t * dense = dirac_structured_to_dense(view);
+        ASSERT(dense != (dirac_matrix_t *)0);
+        ASSERT(((dirac_complex_t *)dense)[4] == 1.0);
+        ASSERT(((dirac_complex_t *)dense)[(2 * 5) + 2] == -1.0i);
+        dirac_delete(dense);
+
+        /* dirac_delete recognizes a view and unmaps it. */
+        dirac_delete((dirac_matrix_t *)view);
+        dirac_delete(them);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_matrix_t * them = filled(4, 4, 5);
+        ASSERT(dirac_store(path, them) > 0);
+
+        /* Truncated files are rejected. */
+        ASSERT(truncate(path, DIRAC_FILE_OFFSET + 8) == 0);
+        ASSERT(dirac_load(path) == (const dirac_matrix_t *)0);
+        ASSERT(truncate(path, 16) == 0);
+        ASSERT(dirac_load(path) == (const dirac_matrix_t *)0);
+
+        /* So are files that are not matrices. */
+        FILE * fp = fopen(path, "w");
+        ASSERT(fp != (FILE *)0);
+        for (size_t ii = 0; ii < 512; ++ii) { fputc('X', fp); }
+        fclose(fp);
+        ASSERT(dirac_load(path) == (const dirac_matrix_t *)0);
+
+        ASSERT(dirac_load("/nonexistent/unittest-dirac-file") == (const dirac_matrix_t *)0);
+
+        /* Only views can be unloaded. */
+        dirac_unload(them);
+        ASSERT(dirac_rows_get(them) == 4);
+        dirac_delete(them);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* A head whose size wraps around to the length of the file is rejected. */
+        dirac_matrix_t * them = filled(4, 4, 7);
+        size_t rows = ((size_t)1 << 60) + 4;
+        ASSERT(dirac_store(path, them) > 0);
+        ASSERT(patch(path, HEAD + offsetof(dirac_data_t, rows), &rows, sizeof(rows)) == sizeof(rows));
+        ASSERT(dirac_load(path) == (const dirac_matrix_t *)0);
+
+        /* So is a diagonal head that is not square. */
+        dirac_matrix_t * diagonal = dirac_diagonal_new(4);
+        rows = 5;
+        ASSERT(dirac_store(path, diagonal) > 0);
+        ASSERT(patch(path, HEAD + offsetof(dirac_data_t, rows), &rows, sizeof(rows)) == sizeof(rows));
+        ASSERT(dirac_load(path) == (const dirac_matrix_t *)0);
+
+        /* So is a head that claims to be a view. */
+        unsigned int flags = DIRAC_FLAG_MAPPED | DIRAC_FLAG_VIEW;
+        ASSERT(dirac_store(path, them) > 0);
+        ASSERT(patch(path, HEAD + offsetof(dirac_data_t, flags), &flags, sizeof(flags)) == sizeof(flags));
+        ASSERT(dirac_load(path) == (const dirac_matrix_t *)0);
+        flags = DIRAC_FLAG_MAPPED | DIRAC_FLAG_CONJUGATE;
+        ASSERT(patch(path, HEAD + offsetof(dirac_data_t, flags), &flags, sizeof(flags)) == sizeof(flags));
+        ASSERT(dirac_load(path) == (const dirac_matrix_t *)0);
+
+        dirac_delete(diagonal);
+        dirac_delete(them);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* A sparse file whose indices leave the matrix is rejected. */
+        dirac_matrix_t * dense = filled(6, 5, 11);
+        dirac_matrix_t * them = dirac_sparse_from_dense(dense);
+        size_t count = dirac_sparse_count_get(them);
+        off_t columns = DIRAC_FILE_OFFSET + (count * sizeof(dirac_complex_t));
+        off_t offsets = columns + (count * sizeof(size_t));
+        const dirac_matrix_t * view;
+        size_t value;
+
+        ASSERT(them != (dirac_matrix_t *)0);
+        ASSERT(count == (6 * 5));
+        ASSERT(dirac_store(path, them) > 0);
+        ASSERT((view = dirac_load(path)) != (const dirac_matrix_t *)0);
+        dirac_unload(view);
+
+        value = 5;
+        ASSERT(patch(path, columns + (7 * sizeof(size_t)), &value, sizeof(value)) == sizeof(value));
+        ASSERT(dirac_load(path) == (const dirac_matrix_t *)0);
+
+        ASSERT(dirac_store(path, them) > 0);
+        value = count + 1;
+        ASSERT(patch(path, offsets + (2 * sizeof(size_t)), &value, sizeof(value)) == sizeof(value));
+        ASSERT(dirac_load(path) == (const dirac_matrix_t *)0);
+
+        ASSERT(dirac_store(path, them) > 0);
+        value = count - 1;
+        ASSERT(patch(path, offsets + (6 * sizeof(size_t)), &value, sizeof(value)) == sizeof(value));
+        ASSERT(dirac_load(path) == (const dirac_matrix_t *)0);
+
+        dirac_delete(them);
+        dirac_delete(dense);
+
+        /* So is a permutation whose columns are out of range or repeated. */
+        them = dirac_permutation_new(5);
+        columns = DIRAC_FILE_OFFSET + (5 * sizeof(dirac_complex_t));
+
+        ASSERT(dirac_store(path, them) > 0);
+        value = 5;
+        ASSERT(patch(path, columns + (3 * sizeof(size_t)), &value, sizeof(value)) == sizeof(value));
+        ASSERT(dirac_load(path) == (const dirac_matrix_t *)0);
+
+        ASSERT(dirac_store(path, them) > 0);
+        value = 1;
+        ASSERT(patch(path, columns + (3 * sizeof(size_t)), &value, sizeof(value)) == sizeof(value));
+        ASSERT(dirac_load(path) == (const dirac_matrix_t *)0);
+
+        dirac_delete(them);
+
+        STATUS();
+    }
+
+    unlink(path);
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,206 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac fixed size functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac fixed size functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include "unittest-dirac-fixtures.h"
+#include <math.h>
+
+/*
+ * The reference is computed independently of the library's kernels.
+ */
+static int verify(const dirac_matrix_t * them, const dirac_matrix_t * thema, const dirac_matrix_t * themb)
+{
+    const dirac_complex_t * tt = (const dirac_complex_t *)them;
+    const dirac_complex_t * aa = (const dirac_complex_t *)thema;
+    const dirac_complex_t * bb = (const dirac_complex_t *)themb;
+    size_t rows = dirac_rows_get(thema);
+    size_t muls = dirac_cols_get(thema);
+    size_t cols = dirac_cols_get(themb);
+    dirac_complex_t sum;
+    size_t rr;
+    size_t cc;
+    size_t mm;
+    if (them == (const dirac_matrix_t *)0) { return 0; }
+    if (dirac_rows_get(them) != rows) { return 0; }
+    if (dirac_cols_get(them) != cols) { return 0; }
+    for (rr = 0; rr < rows; ++rr) {
+        for (cc = 0; cc < cols; ++cc) {
+            sum = 0;
+            for (mm = 0; mm < muls; ++mm) {
+                sum += aa[(rr * muls) + mm] * bb[(mm * cols) + cc];
+            }
+            if (cabs(tt[(rr * cols) + cc] - sum) > 1e-9) { return 0; }
+        }
+    }
+    return !0;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        dirac_matrix_t * a2 = filled(2, 2, 1);
+        dirac_matrix_t * b2 = filled(2, 2, 2);
+        dirac_matrix_t * v2 = filled(2, 1, 3);
+        dirac_matrix_t * a4 = filled(4, 4, 4);
+        dirac_matrix_t * b4 = filled(4, 4, 5);
+        dirac_matrix_t * v4 = filled(4, 1, 6);
+        dirac_matrix_t * a8 = filled(8, 8, 7);
+        dirac_matrix_t * b8 = filled(8, 8, 8);
+        dirac_matrix_t * v8 = filled(8, 1, 9);
+        dirac_matrix_t * that;
+
+        that = dirac_matrix_mul_2x2(a2, b2);
+        ASSERT(verify(that, a2, b2));
+        dirac_delete(that);
+
+        that = dirac_matrix_mul_4x4(a4, b4);
+        ASSERT(verify(that, a4, b4));
+        dirac_delete(that);
+
+        that = dirac_matrix_mul_8x8(a8, b8);
+        ASSERT(verify(that, a8, b8));
+        dirac_delete(that);
+
+        that = dirac_matrix_mul_2x1(a2, v2);
+        ASSERT(verify(that, a2, v2));
+        dirac_delete(that);
+
+        that = dirac_matrix_mul_4x1(a4, v4);
+        ASSERT(verify(that, a4, v4));
+        dirac_delete(that);
+
+        that = dirac_matrix_mul_8x1(a8, v8);
+        ASSERT(verify(that, a8, v8));
+        dirac_delete(that);
+
+        that = dirac_matrix_mul(a8, b8);
+        ASSERT(verify(that, a8, b8));
+        dirac_delete(that);
+
+        that = dirac_matrix_mul(a4, v4);
+        ASSERT(verify(that, a4, v4));
+        dirac_delete(that);
+
+        dirac_delete(v8);
+        dirac_delete(b8);
+        dirac_delete(a8);
+        dirac_delete(v4);
+        dirac_delete(b4);
+        dirac_delete(a4);
+        dirac_delete(v2);
+        dirac_delete(b2);
+        dirac_delete(a2);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        DIRAC_OBJECT_CONST(2, 2) hadamard = 
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { M_SQRT1_2+0.0i, M_SQRT1_2+0.0i, },
+                { M_SQRT1_2+0.0i, -M_SQRT1_2+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        const dirac_complex_t (*h)[2][2] = DIRAC_MATRIX_GET(hadamard);
+
+        DIRAC_OBJECT_CONST(2, 1) zero = 
+            DIRAC_OBJECT_INIT_BEGIN(2, 1)
+                { 1.0+0.0i, },
+                { 0.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        const dirac_complex_t (*ket)[2][1] = DIRAC_MATRIX_GET(zero);
+
+        dirac_complex_t (*plus)[2][1] = dirac_mul(2, 2, 1, h, ket);
+        ASSERT(plus != (dirac_complex_t (*)[2][1])0);
+        ASSERT(cabs((*plus)[0][0] - M_SQRT1_2) < 1e-12);
+        ASSERT(cabs((*plus)[1][0] - M_SQRT1_2) < 1e-12);
+
+        dirac_complex_t (*identity)[2][2] = dirac_mul(2, 2, 2, h, h);
+        ASSERT(identity != (dirac_complex_t (*)[2][2])0);
+        ASSERT(cabs((*identity)[0][0] - 1.0) < 1e-12);
+        ASSERT(cabs((*identity)[0][1]) < 1e-12);
+        ASSERT(cabs((*identity)[1][0]) < 1e-12);
+        ASSERT(cabs((*identity)[1][1] - 1.0) < 1e-12);
+
+        dirac_delete(identity);
+        dirac_delete(plus);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_matrix_t * a3 = filled(3, 3, 10);
+        dirac_matrix_t * b3 = filled(3, 2, 11);
+        dirac_matrix_t * that;
+
+        /* Shapes that do not match the kernel fall back to the general product. */
+
+        that = dirac_matrix_mul_2x2(a3, b3);
+        ASSERT(verify(that, a3, b3));
+        dirac_delete(that);
+
+        that = dirac_mul(3, 3, 2, a3, b3);
+        ASSERT(verify(that, a3, b3));
+        dirac_delete(that);
+
+        ASSERT(dirac_matrix_mul_4x4(b3, a3) == (dirac_matrix_t *)0);
+
+        dirac_matrix_t * diagonal = dirac_diagonal_new(2);
+        ((dirac_complex_t *)diagonal)[0] = 2.0;
+        ((dirac_complex_t *)diagonal)[1] = -1.0i;
+        dirac_matrix_t * v2 = filled(2, 1, 12);
+
+        dirac_complex_t (*scaled)[2][1] = dirac_mul(2, 2, 1, diagonal, v2);
+        ASSERT(scaled != (dirac_complex_t (*)[2][1])0);
+        ASSERT((*scaled)[0][0] == (2.0 * ((dirac_complex_t *)v2)[0]));
+        ASSERT((*scaled)[1][0] == (-1.0i * ((dirac_complex_t *)v2)[1]));
+
+        dirac_delete(scaled);
+        dirac_delete(v2);
+        dirac_delete(diagonal);
+        dirac_delete(b3);
+        dirac_delete(a3);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,54 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+#ifndef _H_COM_DIAG_DIRAC_UNITTEST_FIXTURES_
+#define _H_COM_DIAG_DIRAC_UNITTEST_FIXTURES_
+
+/**
+ * @file
+ *
+ * Copyright 2025 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock (mailto:coverclock@diag.com)<BR>
+ * https://github.com/coverclock/com-diag-codex<BR>
+ *
+ * These are helpers shared by the unit tests.
+ */
+
+#include "com/diag/dirac/dirac.h"
+#include "unittest-dirac-primes.h"
+#include <complex.h>
+
+/*
+ * Returns true if two dense matrices have the same shape and their
+ * elements agree to within a relative tolerance.
+ */
+static inline int equivalent(const dirac_matrix_t * thema, const dirac_matrix_t * themb)
+{
+    const dirac_complex_t * aa = (const dirac_complex_t *)thema;
+    const dirac_complex_t * bb = (const dirac_complex_t *)themb;
+    size_t ii;
+    if ((thema == (const dirac_matrix_t *)0) || (themb == (const dirac_matrix_t *)0)) { return 0; }
+    if (dirac_rows_get(thema) != dirac_rows_get(themb)) { return 0; }
+    if (dirac_cols_get(thema) != dirac_cols_get(themb)) { return 0; }
+    for (ii = 0; ii < (dirac_rows_get(thema) * dirac_cols_get(thema)); ++ii) {
+        if (cabs(aa[ii] - bb[ii]) > (1e-9 * (1.0 + cabs(bb[ii])))) { return 0; }
+    }
+    return !0;
+}
+
+/*
+ * Returns a new ROWS by COLS dense matrix of small Gaussian integers drawn
+ * from the primes starting at SEED. The real parts are odd, so no element
+ * is zero, and sums and products of them are exact.
+ */
+static inline dirac_matrix_t * filled(size_t rows, size_t cols, size_t seed)
+{
+    dirac_matrix_t * them = dirac_new_base(rows, cols);
+    dirac_complex_t * body = (dirac_complex_t *)them;
+    size_t ii;
+    for (ii = 0; ii < (rows * cols); ++ii) {
+        body[ii] = CMPLX((2.0 * (PRIMES[(ii + seed) % 100] % 9)) - 7.0, (PRIMES[((ii * 7) + seed) % 100] % 13) - 6.0);
+    }
+    return them;
+}
+
+#endif
@@ -0,0 +1,260 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac formatting functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac formatting functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include "unittest-dirac-primes.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <float.h>
+#include <math.h>
+
+static const double VALUES[] = {
+    0.0, -0.0, 1.0, -1.0, 0.5, 2.5, 9.99995, 9.99994999, 9.99995001,
+    0.1, 0.2, 0.3, 1.0 / 3.0, -2.0 / 3.0, 123456.5, 1e22, 1e23, 1e-5,
+    1.00005e-5, 1e100, -1e-100, 1e-300, 5e-324, DBL_MIN, DBL_MAX,
+    M_PI, M_E, M_SQRT1_2, -M_SQRT1_2, 1.25, 1.35, 1.45, 999999.5,
+    INFINITY, -INFINITY,
+};
+
+/*
+ * This is how dirac_print formatted matrices before it used dirac_write.
+ */
+static void reference(FILE * fp, const dirac_matrix_t * them, int precision)
+{
+    const dirac_complex_t * tt = (const dirac_complex_t *)them;
+    size_t rows = dirac_rows_get(them);
+    size_t cols = dirac_cols_get(them);
+    size_t rr;
+    size_t cc;
+    fprintf(fp, "dirac@%p: [%zu][%zu]\n", (const char *)them - offsetof(dirac_t, data.body), rows, cols);
+    for (rr = 0; rr < rows; ++rr) {
+        fprintf(fp, " matrix@%p:", them);
+        for (cc = 0; cc < cols; ++cc) {
+            fprintf(fp, " (%7.*le%+7.*lei)", precision, creal(tt[(rr * cols) + cc]), precision, cimag(tt[(rr * cols) + cc]));
+        }
+        fputc('\n', fp);
+    }
+}
+
+static int compare(const dirac_matrix_t * them, int precision)
+{
+    char * expected = (char *)0;
+    char * actual = (char *)0;
+    size_t expectedsize = 0;
+    size_t actualsize = 0;
+    FILE * fp;
+    ssize_t total;
+    int rc;
+    fp = open_memstream(&expected, &expectedsize);
+    reference(fp, them, precision);
+    fclose(fp);
+    fp = open_memstream(&actual, &actualsize);
+    total = dirac_write(fp, them, DIRAC_FORMAT_TEXT, precision);
+    fclose(fp);
+    rc = (total == (ssize_t)actualsize) && (expectedsize == actualsize) && (memcmp(expected, actual, actualsize) == 0);
+    if (!rc) {
+        fprintf(stderr, "precision %d expected:\n%s\nactual:\n%s\n", precision, expected, actual);
+    }
+    free(actual);
+    free(expected);
+    return rc;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        size_t count = sizeof(VALUES) / sizeof(VALUES[0]);
+        dirac_matrix_t * them = dirac_new_base(count, count);
+        dirac_complex_t * tt = (dirac_complex_t *)them;
+        size_t rr;
+        size_t cc;
+        for (rr = 0; rr < count; ++rr) {
+            for (cc = 0; cc < count; ++cc) {
+                tt[(rr * count) + cc] = CMPLX(VALUES[rr], VALUES[cc]);
+            }
+        }
+
+        ASSERT(compare(them, DIRAC_PRECISION));
+        ASSERT(compare(them, 0));
+        ASSERT(compare(them, 1));
+        ASSERT(compare(them, 8));
+        ASSERT(compare(them, 15));
+        ASSERT(compare(them, 17));
+        ASSERT(compare(them, 40));
+
+        ASSERT(dirac_write(stderr, them, DIRAC_FORMAT_TEXT, 41) < 0);
+        ASSERT(dirac_write(stderr, them, DIRAC_FORMAT_TEXT, -1) < 0);
+
+        tt[0] = CMPLX(NAN, -NAN);
+        ASSERT(compare(them, DIRAC_PRECISION));
+
+        dirac_delete(them);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Enough rows to be formatted in parallel and in several chunks. */
+        size_t prior = dirac_threads_set(4);
+        dirac_matrix_t * them = dirac_new_base(900, 120);
+        dirac_complex_t * tt = (dirac_complex_t *)them;
+        uint64_t bits = 0x123456789abcdef0ULL;
+        size_t ii;
+        double re;
+        double im;
+        for (ii = 0; ii < (900 * 120); ++ii) {
+            bits = (bits * 6364136223846793005ULL) + 1442695040888963407ULL;
+            re = ldexp((double)(bits >> 11), -53 + (int)((bits >> 3) % 40) - 20) * ((bits & 1) ? -1.0 : 1.0);
+            im = (double)PRIMES[ii % 100] / (double)PRIMES[(ii / 100) % 100];
+            tt[ii] = CMPLX(re, im);
+        }
+        ASSERT(compare(them, DIRAC_PRECISION));
+        ASSERT(compare(them, 6));
+        ASSERT(compare(them, 12));
+        dirac_delete(them);
+        dirac_threads_set(prior);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        DIRAC_OBJECT_CONST(2, 2) those =
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { 1.0+0.0i, 0.0-2.0i, },
+                { -0.5+0.25i, 0.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        const dirac_complex_t (*them)[2][2] = DIRAC_MATRIX_GET(those);
+
+        /* dirac_print and dirac_write at the default precision agree. */
+        char * printed = (char *)0;
+        char * written = (char *)0;
+        size_t printedsize = 0;
+        size_t writtensize = 0;
+        FILE * fp;
+        fp = open_memstream(&printed, &printedsize);
+        dirac_print(fp, them);
+        fclose(fp);
+        fp = open_memstream(&written, &writtensize);
+        ASSERT(dirac_write(fp, them, DIRAC_FORMAT_TEXT, DIRAC_PRECISION) > 0);
+        fclose(fp);
+        ASSERT(printedsize == writtensize);
+        ASSERT(memcmp(printed, written, printedsize) == 0);
+        ASSERT(strstr(printed, " (1.0000e+00+0.0000e+00i) (0.0000e+00-2.0000e+00i)\n") != (char *)0);
+        ASSERT(strstr(printed, " (-5.0000e-01+2.5000e-01i) (0.0000e+00+0.0000e+00i)\n") != (char *)0);
+        free(written);
+        free(printed);
+
+        /* Hexadecimal is exact. */
+        fp = open_memstream(&written, &writtensize);
+        ASSERT(dirac_write(fp, them, DIRAC_FORMAT_HEX, 0) > 0);
+        fclose(fp);
+        ASSERT(strstr(written, " (0x3ff0000000000000,0x0000000000000000) (0x0000000000000000,0xc000000000000000)\n") != (char *)0);
+        ASSERT(strstr(written, " (0xbfe0000000000000,0x3fd0000000000000) (0x0000000000000000,0x0000000000000000)\n") != (char *)0);
+        free(written);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_matrix_t * them = dirac_sparse_new(3, 4, 2);
+        ((dirac_complex_t *)them)[0] = 1.5;
+        ((dirac_complex_t *)them)[1] = CMPLX(0.0, -2.0);
+        dirac_sparse_columns_mut(them)[0] = 3;
+        dirac_sparse_columns_mut(them)[1] = 0;
+        dirac_sparse_offsets_mut(them)[0] = 0;
+        dirac_sparse_offsets_mut(them)[1] = 1;
+        dirac_sparse_offsets_mut(them)[2] = 1;
+        dirac_sparse_offsets_mut(them)[3] = 2;
+
+        char * written = (char *)0;
+        size_t writtensize = 0;
+        FILE * fp = open_memstream(&written, &writtensize);
+        ASSERT(dirac_write(fp, them, DIRAC_FORMAT_TEXT, DIRAC_PRECISION) > 0);
+        fclose(fp);
+        ASSERT(strstr(written, "] sparse [2]\n") != (char *)0);
+        ASSERT(strstr(written, ": [3](1.5000e+00+0.0000e+00i)\n") != (char *)0);
+        ASSERT(strstr(written, ":\n") != (char *)0);
+        ASSERT(strstr(written, ": [0](0.0000e+00-2.0000e+00i)\n") != (char *)0);
+        free(written);
+
+        dirac_delete(them);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        char path[] = "/tmp/unittest-dirac-format-XXXXXX";
+        close(mkstemp(path));
+
+        dirac_matrix_t * them = dirac_new_base(5, 3);
+        size_t ii;
+        for (ii = 0; ii < 15; ++ii) {
+            ((dirac_complex_t *)them)[ii] = CMPLX(PRIMES[ii], -(double)PRIMES[ii + 1]);
+        }
+
+        FILE * fp = fopen(path, "w");
+        ASSERT(fp != (FILE *)0);
+        ASSERT(dirac_write(fp, them, DIRAC_FORMAT_BINARY, 0) == (DIRAC_FILE_OFFSET + (15 * sizeof(dirac_complex_t))));
+        fclose(fp);
+
+        const dirac_matrix_t * view = dirac_load(path);
+        ASSERT(view != (const dirac_matrix_t *)0);
+        ASSERT(dirac_rows_get(view) == 5);
+        ASSERT(dirac_cols_get(view) == 3);
+        ASSERT(memcmp(view, them, 15 * sizeof(dirac_complex_t)) == 0);
+        dirac_unload(view);
+
+        dirac_delete(them);
+        unlink(path);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
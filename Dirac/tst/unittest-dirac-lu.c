@@ -0,0 +1,377 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac LU factorization functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac LU factorization functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include "unittest-dirac-primes.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*
+ * Returns the largest |A*X - B|.
+ */
+static double residual(const dirac_matrix_t * thema, const dirac_matrix_t * themx, const dirac_matrix_t * themb)
+{
+    dirac_matrix_t * product = dirac_matrix_mul(thema, themx);
+    const dirac_complex_t * ax = (const dirac_complex_t *)product;
+    const dirac_complex_t * bb = (const dirac_complex_t *)themb;
+    size_t count = dirac_rows_get(themb) * dirac_cols_get(themb);
+    double largest = 0.0;
+    double difference;
+    size_t ii;
+    for (ii = 0; ii < count; ++ii) {
+        difference = cabs(ax[ii] - bb[ii]);
+        if (!(difference <= largest)) { largest = difference; }
+    }
+    dirac_delete(product);
+    return largest;
+}
+
+/*
+ * Returns how far A*B is from the identity.
+ */
+static double identity(const dirac_matrix_t * thema, const dirac_matrix_t * themb)
+{
+    dirac_matrix_t * product = dirac_matrix_mul(thema, themb);
+    const dirac_complex_t * pp = (const dirac_complex_t *)product;
+    size_t order = dirac_rows_get(product);
+    double largest = 0.0;
+    double difference;
+    size_t rr;
+    size_t cc;
+    for (rr = 0; rr < order; ++rr) {
+        for (cc = 0; cc < order; ++cc) {
+            difference = cabs(pp[(rr * order) + cc] - ((rr == cc) ? 1.0 : 0.0));
+            if (!(difference <= largest)) { largest = difference; }
+        }
+    }
+    dirac_delete(product);
+    return largest;
+}
+
+/*
+ * Returns a diagonally dominant, hence well conditioned, complex matrix.
+ */
+static dirac_matrix_t * general(size_t rows, size_t cols)
+{
+    dirac_matrix_t * them = dirac_new_base(rows, cols);
+    dirac_complex_t * aa = (dirac_complex_t *)them;
+    size_t rr;
+    size_t cc;
+    for (rr = 0; rr < rows; ++rr) {
+        for (cc = 0; cc < cols; ++cc) {
+            aa[(rr * cols) + cc] = CMPLX(((PRIMES[(rr + (3 * cc)) % 100] % 11) - 5.0) / 8.0, ((PRIMES[((7 * rr) + cc) % 100] % 7) - 3.0) / 8.0);
+        }
+        if ((rows == cols) && (rr < cols)) {
+            aa[(rr * cols) + rr] += (rr % 2) ? -4.0 : 4.0;
+        }
+    }
+    return them;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        /* The first column has a zero on top, so the rows must be swapped. */
+        DIRAC_OBJECT_CONST(3, 3) aa =
+            DIRAC_OBJECT_INIT_BEGIN(3, 3)
+                { 0.0+0.0i, 2.0+0.0i, 1.0+0.0i, },
+                { 1.0+0.0i, 1.0+1.0i, 0.0+0.0i, },
+                { 2.0+0.0i, 0.0+0.0i, 3.0-1.0i, },
+            DIRAC_OBJECT_INIT_END;
+        DIRAC_OBJECT_CONST(3, 2) bb =
+            DIRAC_OBJECT_INIT_BEGIN(3, 2)
+                { 1.0+0.0i, 0.0+1.0i, },
+                { 2.0+0.0i, 1.0+0.0i, },
+                { 3.0+0.0i, 0.0-1.0i, },
+            DIRAC_OBJECT_INIT_END;
+        dirac_lu_t * lu;
+        dirac_matrix_t * xx;
+        dirac_matrix_t * inverse;
+        dirac_complex_t det;
+
+        lu = dirac_lu_new(DIRAC_MATRIX_GET(aa));
+        ASSERT(lu != (dirac_lu_t *)0);
+        ASSERT(dirac_rows_get(dirac_lu_factors_get(lu)) == 3);
+        ASSERT(dirac_cols_get(dirac_lu_factors_get(lu)) == 3);
+        ASSERT(dirac_lu_pivots_get(lu)[0] == 2);
+
+        xx = dirac_lu_solve(lu, DIRAC_MATRIX_GET(bb));
+        ASSERT(xx != (dirac_matrix_t *)0);
+        ASSERT(dirac_rows_get(xx) == 3);
+        ASSERT(dirac_cols_get(xx) == 2);
+        ASSERT(residual(DIRAC_MATRIX_GET(aa), xx, DIRAC_MATRIX_GET(bb)) < 1e-14);
+        dirac_delete(xx);
+
+        /* det = 0*(...) - 2*(3-i - 0) + 1*(0 - 2*(1+i)) = -8. */
+        det = dirac_lu_det(lu);
+        ASSERT(cabs(det - (-8.0)) < 1e-14);
+
+        inverse = dirac_lu_inverse(lu);
+        ASSERT(inverse != (dirac_matrix_t *)0);
+        ASSERT(identity(DIRAC_MATRIX_GET(aa), inverse) < 1e-14);
+        ASSERT(identity(inverse, DIRAC_MATRIX_GET(aa)) < 1e-14);
+        dirac_delete(inverse);
+
+        dirac_lu_delete(lu);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* The factors are reused for as many right hand sides as needed. */
+        dirac_matrix_t * aa = general(37, 37);
+        dirac_lu_t * lu = dirac_lu_new(aa);
+        dirac_matrix_t * bb;
+        dirac_matrix_t * xx;
+        size_t cols;
+
+        ASSERT(lu != (dirac_lu_t *)0);
+
+        for (cols = 1; cols <= 9; cols += 4) {
+            bb = general(37, cols);
+            xx = dirac_lu_solve(lu, bb);
+            ASSERT(xx != (dirac_matrix_t *)0);
+            ASSERT(dirac_cols_get(xx) == cols);
+            ASSERT(residual(aa, xx, bb) < 1e-13);
+            dirac_delete(xx);
+            xx = dirac_matrix_solve(aa, bb);
+            ASSERT(xx != (dirac_matrix_t *)0);
+            ASSERT(residual(aa, xx, bb) < 1e-13);
+            dirac_delete(xx);
+            dirac_delete(bb);
+        }
+
+        dirac_lu_delete(lu);
+        dirac_delete(aa);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Determinants of structured matrices are known in closed form. */
+        dirac_matrix_t * diagonal = dirac_diagonal_new(4);
+        dirac_matrix_t * permutation = dirac_permutation_new(4);
+        dirac_matrix_t * triangular = dirac_triangular_new(4);
+        dirac_matrix_t * sparse;
+        dirac_matrix_t * dense;
+        size_t * columns;
+        dirac_complex_t det;
+        size_t rr;
+        size_t cc;
+
+        ((dirac_complex_t *)diagonal)[0] = 2.0;
+        ((dirac_complex_t *)diagonal)[1] = 0.0 + 1.0i;
+        ((dirac_complex_t *)diagonal)[2] = -3.0;
+        ((dirac_complex_t *)diagonal)[3] = 0.5;
+        det = dirac_matrix_det(diagonal);
+        ASSERT(cabs(det - (-3.0i)) < 1e-15);
+
+        /* A single transposition is odd, a three cycle even. */
+        columns = dirac_permutation_columns_mut(permutation);
+        columns[0] = 1;
+        columns[1] = 0;
+        det = dirac_matrix_det(permutation);
+        ASSERT(cabs(det - (-1.0)) < 1e-15);
+        columns[0] = 1;
+        columns[1] = 2;
+        columns[2] = 0;
+        det = dirac_matrix_det(permutation);
+        ASSERT(cabs(det - 1.0) < 1e-15);
+
+        for (rr = 0; rr < 4; ++rr) {
+            for (cc = rr; cc < 4; ++cc) {
+                ((dirac_complex_t *)triangular)[DIRAC_PACKED_INDEX(4, rr, cc)] = (rr == cc) ? (rr + 1.0) : 7.0;
+            }
+        }
+        det = dirac_matrix_det(triangular);
+        ASSERT(cabs(det - 24.0) < 1e-13);
+
+        dense = general(6, 6);
+        sparse = dirac_sparse_from_dense(dense);
+        ASSERT(sparse != (dirac_matrix_t *)0);
+        det = dirac_matrix_det(dense);
+        ASSERT(cabs(det - dirac_matrix_det(sparse)) < (1e-13 * cabs(det)));
+        dirac_delete(sparse);
+        dirac_delete(dense);
+
+        dirac_delete(triangular);
+        dirac_delete(permutation);
+        dirac_delete(diagonal);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Triangular systems are solved by back substitution alone. */
+        dirac_matrix_t * triangular = dirac_triangular_new(23);
+        dirac_matrix_t * bb = general(23, 5);
+        dirac_matrix_t * xx;
+        dirac_matrix_t * yy;
+        size_t rr;
+        size_t cc;
+
+        for (rr = 0; rr < 23; ++rr) {
+            for (cc = rr; cc < 23; ++cc) {
+                ((dirac_complex_t *)triangular)[DIRAC_PACKED_INDEX(23, rr, cc)] = (rr == cc) ? CMPLX(2.0 + (rr % 3), 1.0) : CMPLX(((PRIMES[rr + cc] % 5) - 2.0) / 8.0, 0.25);
+            }
+        }
+
+        xx = dirac_triangular_solve(triangular, bb);
+        ASSERT(xx != (dirac_matrix_t *)0);
+        ASSERT(dirac_rows_get(xx) == 23);
+        ASSERT(dirac_cols_get(xx) == 5);
+        ASSERT(residual(triangular, xx, bb) < 1e-14);
+
+        yy = dirac_matrix_solve(triangular, bb);
+        ASSERT(yy != (dirac_matrix_t *)0);
+        ASSERT(residual(triangular, yy, bb) < 1e-14);
+
+        dirac_delete(yy);
+        dirac_delete(xx);
+        dirac_delete(bb);
+        dirac_delete(triangular);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Large enough for several levels of recursion and threads. */
+        size_t prior = dirac_threads_set(4);
+        dirac_matrix_t * aa = general(203, 203);
+        dirac_matrix_t * bb = general(203, 17);
+        dirac_matrix_t * xx;
+        dirac_matrix_t * inverse;
+        dirac_lu_t * lu;
+
+        lu = dirac_lu_new(aa);
+        ASSERT(lu != (dirac_lu_t *)0);
+
+        xx = dirac_lu_solve(lu, bb);
+        ASSERT(xx != (dirac_matrix_t *)0);
+        ASSERT(residual(aa, xx, bb) < 1e-12);
+        dirac_delete(xx);
+
+        inverse = dirac_matrix_inv(aa);
+        ASSERT(inverse != (dirac_matrix_t *)0);
+        ASSERT(identity(aa, inverse) < 1e-12);
+        dirac_delete(inverse);
+
+        dirac_lu_delete(lu);
+        dirac_delete(bb);
+        dirac_delete(aa);
+        dirac_threads_set(prior);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        DIRAC_OBJECT_CONST(3, 3) singular =
+            DIRAC_OBJECT_INIT_BEGIN(3, 3)
+                { 1.0+0.0i, 2.0+0.0i, 3.0+0.0i, },
+                { 2.0+0.0i, 4.0+0.0i, 6.0+0.0i, },
+                { 0.0+1.0i, 0.0+0.0i, 1.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        dirac_matrix_t * wide = general(2, 3);
+        dirac_matrix_t * column = general(2, 1);
+        dirac_matrix_t * triangular = dirac_triangular_new(3);
+        dirac_lu_t * lu;
+        dirac_complex_t det;
+
+        /* A singular matrix factors, has a zero determinant, and no more. */
+        lu = dirac_lu_new(DIRAC_MATRIX_GET(singular));
+        ASSERT(lu != (dirac_lu_t *)0);
+        det = dirac_lu_det(lu);
+        ASSERT(cabs(det) == 0.0);
+        errno = 0;
+        ASSERT(dirac_lu_solve(lu, column) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_lu_inverse(lu) == (dirac_matrix_t *)0);
+        ASSERT(errno == EDOM);
+        errno = 0;
+        ASSERT(dirac_matrix_inv(DIRAC_MATRIX_GET(singular)) == (dirac_matrix_t *)0);
+        ASSERT(errno == EDOM);
+        dirac_lu_delete(lu);
+
+        errno = 0;
+        ASSERT(dirac_lu_new(wide) == (dirac_lu_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        det = dirac_matrix_det(wide);
+        ASSERT(isnan(creal(det)));
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_matrix_solve((dirac_matrix_t *)0, column) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+
+        /* A zero on the diagonal of a triangular matrix is singular. */
+        errno = 0;
+        ASSERT(dirac_triangular_solve(triangular, wide) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_triangular_solve(wide, column) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        dirac_delete(column);
+        column = general(3, 1);
+        errno = 0;
+        ASSERT(dirac_triangular_solve(triangular, column) == (dirac_matrix_t *)0);
+        ASSERT(errno == EDOM);
+
+        dirac_lu_delete((dirac_lu_t *)0);
+
+        dirac_delete(triangular);
+        dirac_delete(column);
+        dirac_delete(wide);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,308 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac Matrix Market functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac Matrix Market functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include "unittest-dirac-primes.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static char path[] = "/tmp/unittest-dirac-market-XXXXXX";
+
+static void text(const char * contents)
+{
+    FILE * fp = fopen(path, "w");
+    fputs(contents, fp);
+    fclose(fp);
+}
+
+static int same(const dirac_matrix_t * thema, const dirac_matrix_t * themb)
+{
+    size_t ii;
+    if (dirac_rows_get(thema) != dirac_rows_get(themb)) { return 0; }
+    if (dirac_cols_get(thema) != dirac_cols_get(themb)) { return 0; }
+    /* Values, not bits: mirroring a zero may produce a negative zero. */
+    for (ii = 0; ii < (dirac_rows_get(thema) * dirac_cols_get(thema)); ++ii) {
+        if (((const dirac_complex_t *)thema)[ii] != ((const dirac_complex_t *)themb)[ii]) { return 0; }
+    }
+    return !0;
+}
+
+static dirac_matrix_t * densify(dirac_matrix_t * them)
+{
+    dirac_matrix_t * that = dirac_sparse_to_dense(them);
+    dirac_delete(them);
+    return that;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    close(mkstemp(path));
+
+    {
+        TEST();
+
+        DIRAC_OBJECT_CONST(3, 4) those =
+            DIRAC_OBJECT_INIT_BEGIN(3, 4)
+                { 1.0+2.0i, 0.0+0.0i, 0.0+0.0i, -3.5+0.0i, },
+                { 0.0+0.0i, 0.0+0.0i, 0.0-1.0i, 0.0+0.0i, },
+                { 0.25+0.0i, 0.0+0.0i, 0.0+0.0i, 7.0+7.0i, },
+            DIRAC_OBJECT_INIT_END;
+        const dirac_complex_t (*expected)[3][4] = DIRAC_MATRIX_GET(those);
+
+        text(
+            "%%MatrixMarket matrix coordinate complex general\n"
+            "% A comment.\n"
+            "%\n"
+            "3 4 5\n"
+            "1 1 1.0 2.0\n"
+            "3 4 7 7\n"
+            "\n"
+            "2 3 0 -1\n"
+            "1 4 -3.5e0 0\n"
+            "3 1 2.5e-1 0.0"
+        );
+
+        dirac_matrix_t * them = dirac_market_read(path, DIRAC_KIND_DENSE);
+        ASSERT(them != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(them) == DIRAC_KIND_DENSE);
+        ASSERT(same(them, expected));
+        dirac_delete(them);
+
+        them = dirac_market_read(path, DIRAC_KIND_SPARSE);
+        ASSERT(them != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(them) == DIRAC_KIND_SPARSE);
+        ASSERT(dirac_sparse_count_get(them) == 5);
+        /* Rows come out sorted by column whatever the order in the file. */
+        ASSERT(dirac_sparse_offsets_get(them)[1] == 2);
+        ASSERT(dirac_sparse_columns_get(them)[0] == 0);
+        ASSERT(dirac_sparse_columns_get(them)[1] == 3);
+        them = densify(them);
+        ASSERT(same(them, expected));
+        dirac_delete(them);
+
+        ASSERT(dirac_market_read(path, DIRAC_KIND_DIAGONAL) == (dirac_matrix_t *)0);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        DIRAC_OBJECT_CONST(3, 3) those =
+            DIRAC_OBJECT_INIT_BEGIN(3, 3)
+                { 1.0+0.0i, 2.0-1.0i, 0.0+0.0i, },
+                { 2.0+1.0i, 5.0+0.0i, 0.0-3.0i, },
+                { 0.0+0.0i, 0.0+3.0i, 6.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        const dirac_complex_t (*hermitian)[3][3] = DIRAC_MATRIX_GET(those);
+
+        text(
+            "%%MatrixMarket matrix coordinate complex hermitian\n"
+            "3 3 5\n"
+            "1 1 1 0\n"
+            "2 1 2 1\n"
+            "2 2 5 0\n"
+            "3 2 0 3\n"
+            "3 3 6 0\n"
+        );
+
+        dirac_matrix_t * them = dirac_market_read(path, DIRAC_KIND_DENSE);
+        ASSERT(them != (dirac_matrix_t *)0);
+        ASSERT(same(them, hermitian));
+        dirac_delete(them);
+
+        them = dirac_market_read(path, DIRAC_KIND_SPARSE);
+        ASSERT(them != (dirac_matrix_t *)0);
+        ASSERT(dirac_sparse_count_get(them) == 7);
+        them = densify(them);
+        ASSERT(same(them, hermitian));
+        dirac_delete(them);
+
+        /* The same matrix as a hermitian array (lower triangle by columns). */
+        text(
+            "%%MatrixMarket matrix array complex hermitian\n"
+            "3 3\n"
+            "1 0\n2 1\n0 0\n"
+            "5 0\n0 3\n"
+            "6 0\n"
+        );
+
+        them = dirac_market_read(path, DIRAC_KIND_DENSE);
+        ASSERT(them != (dirac_matrix_t *)0);
+        ASSERT(same(them, hermitian));
+        dirac_delete(them);
+
+        text(
+            "%%MatrixMarket matrix array real skew-symmetric\n"
+            "3 3\n"
+            "1\n2\n"
+            "3\n"
+        );
+
+        them = dirac_market_read(path, DIRAC_KIND_DENSE);
+        ASSERT(them != (dirac_matrix_t *)0);
+        ASSERT(((dirac_complex_t *)them)[(1 * 3) + 0] == 1.0);
+        ASSERT(((dirac_complex_t *)them)[(0 * 3) + 1] == -1.0);
+        ASSERT(((dirac_complex_t *)them)[(2 * 3) + 0] == 2.0);
+        ASSERT(((dirac_complex_t *)them)[(2 * 3) + 1] == 3.0);
+        ASSERT(((dirac_complex_t *)them)[(1 * 3) + 2] == -3.0);
+        ASSERT(((dirac_complex_t *)them)[(1 * 3) + 1] == 0.0);
+        dirac_delete(them);
+
+        text(
+            "%%MatrixMarket matrix coordinate pattern symmetric\n"
+            "2 2 2\n"
+            "2 1\n"
+            "2 2\n"
+        );
+
+        them = dirac_market_read(path, DIRAC_KIND_SPARSE);
+        ASSERT(them != (dirac_matrix_t *)0);
+        ASSERT(dirac_sparse_count_get(them) == 3);
+        them = densify(them);
+        ASSERT(((dirac_complex_t *)them)[0] == 0.0);
+        ASSERT(((dirac_complex_t *)them)[1] == 1.0);
+        ASSERT(((dirac_complex_t *)them)[2] == 1.0);
+        ASSERT(((dirac_complex_t *)them)[3] == 1.0);
+        dirac_delete(them);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        static const char * BAD[] = {
+            "",
+            "%%MatrixMarket matrix coordinate complex general\n",
+            "%%MatrixMarket vector coordinate complex general\n2 2 0\n",
+            "%%MatrixMarket matrix coordinate quaternion general\n2 2 0\n",
+            "%%MatrixMarket matrix array pattern general\n2 2\n",
+            "%%MatrixMarket matrix coordinate complex symmetric\n2 3 0\n",
+            "%%MatrixMarket matrix coordinate complex general\n2 2 1\n3 1 0 0\n",
+            "%%MatrixMarket matrix coordinate complex general\n2 2 1\n0 1 0 0\n",
+            "%%MatrixMarket matrix coordinate complex general\n2 2 2\n1 1 0 0\n",
+            "%%MatrixMarket matrix coordinate complex general\n2 2 1\n1 1 0 0\n2 2 0 0\n",
+            "%%MatrixMarket matrix coordinate complex general\n2 2 1\n1 1 0\n",
+            "%%MatrixMarket matrix coordinate complex general\n2 2 1\n1 1 0 0 0\n",
+            "%%MatrixMarket matrix array real general\n2 2\n1\n2\n3\n",
+        };
+        size_t ii;
+
+        for (ii = 0; ii < (sizeof(BAD) / sizeof(BAD[0])); ++ii) {
+            text(BAD[ii]);
+            ASSERT(dirac_market_read(path, DIRAC_KIND_DENSE) == (dirac_matrix_t *)0);
+            ASSERT(dirac_market_read(path, DIRAC_KIND_SPARSE) == (dirac_matrix_t *)0);
+        }
+
+        ASSERT(dirac_market_read("/nonexistent/unittest-dirac-market", DIRAC_KIND_DENSE) == (dirac_matrix_t *)0);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Big enough to be cut into many chunks and written in several pieces. */
+        size_t prior = dirac_threads_set(4);
+        dirac_matrix_t * them = dirac_new_base(211, 199);
+        dirac_complex_t * tt = (dirac_complex_t *)them;
+        size_t ii;
+        for (ii = 0; ii < (211 * 199); ++ii) {
+            tt[ii] = CMPLX((double)PRIMES[ii % 100] / (double)PRIMES[(ii / 7) % 100], -1.0 / (double)(ii + 1));
+        }
+
+        FILE * fp = fopen(path, "w");
+        ASSERT(fp != (FILE *)0);
+        ASSERT(dirac_market_write(fp, them) > 0);
+        fclose(fp);
+
+        dirac_matrix_t * that = dirac_market_read(path, DIRAC_KIND_DENSE);
+        ASSERT(that != (dirac_matrix_t *)0);
+        ASSERT(same(that, them));
+        dirac_delete(that);
+
+        /* Array files can be imported as sparse too. */
+        that = dirac_market_read(path, DIRAC_KIND_SPARSE);
+        ASSERT(that != (dirac_matrix_t *)0);
+        that = densify(that);
+        ASSERT(same(that, them));
+        dirac_delete(that);
+
+        /* Sparse matrices are written as coordinates. */
+        dirac_matrix_t * sparse = dirac_sparse_from_dense(them);
+        fp = fopen(path, "w");
+        ASSERT(fp != (FILE *)0);
+        ASSERT(dirac_market_write(fp, sparse) > 0);
+        fclose(fp);
+        dirac_delete(sparse);
+
+        that = dirac_market_read(path, DIRAC_KIND_SPARSE);
+        ASSERT(that != (dirac_matrix_t *)0);
+        that = densify(that);
+        ASSERT(same(that, them));
+        dirac_delete(that);
+
+        dirac_delete(them);
+
+        /* So are the structured kinds. */
+        them = dirac_permutation_new(5);
+        dirac_permutation_columns_mut(them)[1] = 3;
+        dirac_permutation_columns_mut(them)[3] = 1;
+        ((dirac_complex_t *)them)[3] = -1.0;
+        fp = fopen(path, "w");
+        ASSERT(fp != (FILE *)0);
+        ASSERT(dirac_market_write(fp, them) > 0);
+        fclose(fp);
+
+        that = dirac_market_read(path, DIRAC_KIND_DENSE);
+        ASSERT(that != (dirac_matrix_t *)0);
+        dirac_matrix_t * dense = dirac_structured_to_dense(them);
+        ASSERT(same(that, dense));
+        dirac_delete(dense);
+        dirac_delete(that);
+        dirac_delete(them);
+
+        dirac_threads_set(prior);
+
+        STATUS();
+    }
+
+    unlink(path);
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
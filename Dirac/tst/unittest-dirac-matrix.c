@@ -13,6 +13,8 @@
 #include "com/diag/diminuto/diminuto_unittest.h"
 #include "com/diag/dirac/dirac.h"
 #include "unittest-dirac-primes.h"
+#include <stdlib.h>
+#include <string.h>
 
 int main(void)
 {
@@ -212,6 +214,267 @@ int main(void)
         STATUS();
     }
 
+    {
+        TEST();
+
+        DIRAC_OBJECT_CONST(2, 3) those1 = 
+            DIRAC_OBJECT_INIT_BEGIN(2, 3)
+                { 1.0+0.0i, 2.0+0.0i, 0.0+1.0i, },
+                { 0.0+0.0i, 1.0+1.0i, 3.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        const dirac_complex_t (*them1)[2][3] = DIRAC_MATRIX_GET(those1);
+
+        DIRAC_OBJECT_CONST(3, 2) those2 = 
+            DIRAC_OBJECT_INIT_BEGIN(3, 2)
+                { 1.0+0.0i, 0.0+1.0i, },
+                { 2.0+0.0i, 1.0+0.0i, },
+                { 0.0+0.0i, 0.0-1.0i, },
+            DIRAC_OBJECT_INIT_END;
+        const dirac_complex_t (*them2)[3][2] = DIRAC_MATRIX_GET(those2);
+
+        DIRAC_OBJECT_CONST(2, 2) those3 = 
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { 5.0+0.0i, 3.0+1.0i, },
+                { 2.0+2.0i, 1.0-2.0i, },
+            DIRAC_OBJECT_INIT_END;
+        const dirac_complex_t (*them3)[2][2] = DIRAC_MATRIX_GET(those3);
+
+        dirac_complex_t (*that)[2][2] = dirac_matrix_mul(them1, them2);
+        ASSERT(that != (dirac_complex_t (*)[2][2])0);
+
+        dirac_print(stdout, that);
+
+        ASSERT(dirac_rows_get(that) == 2);
+        ASSERT(dirac_cols_get(that) == 2);
+
+        int rr;
+        int cc;
+        for (rr = 0; rr < 2; ++rr) {
+            for (cc = 0; cc < 2; ++cc) {
+                ASSERT((*them3)[rr][cc] == (*that)[rr][cc]);
+            }
+        }
+
+        dirac_delete(that);
+
+        ASSERT(dirac_matrix_mul(them1, them1) == (dirac_matrix_t *)0);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        static const size_t DIMS[] = { 10, 30, 5, 60, 3, };
+        static const size_t COUNT = (sizeof(DIMS) / sizeof(DIMS[0])) - 1;
+        dirac_matrix_t * thems[(sizeof(DIMS) / sizeof(DIMS[0])) - 1];
+        dirac_complex_t * body;
+        size_t ii;
+        size_t jj;
+
+        for (ii = 0; ii < COUNT; ++ii) {
+            thems[ii] = dirac_new_base(DIMS[ii], DIMS[ii + 1]);
+            ASSERT(thems[ii] != (dirac_matrix_t *)0);
+            body = (dirac_complex_t *)thems[ii];
+            for (jj = 0; jj < (DIMS[ii] * DIMS[ii + 1]); ++jj) {
+                body[jj] = CMPLX((double)(PRIMES[(ii + jj) % 10] % 7), (double)(PRIMES[(ii * jj) % 10] % 5) - 2.0);
+            }
+        }
+
+        char * plan = (char *)0;
+        size_t size = 0;
+        FILE * fp = open_memstream(&plan, &size);
+        ASSERT(fp != (FILE *)0);
+
+        dirac_matrix_t * that = dirac_matrix_mul_chain((const dirac_matrix_t * const *)thems, COUNT, fp);
+        ASSERT(that != (dirac_matrix_t *)0);
+        ASSERT(dirac_rows_get(that) == DIMS[0]);
+        ASSERT(dirac_cols_get(that) == DIMS[COUNT]);
+
+        fclose(fp);
+        fputs(plan, stdout);
+        ASSERT(strcmp(plan, "dirac_matrix_mul_chain: plan (0*(1*(2*3))) cost 2250\n") == 0);
+        free(plan);
+
+        dirac_matrix_t * temp1 = dirac_matrix_mul(thems[0], thems[1]);
+        dirac_matrix_t * temp2 = dirac_matrix_mul(temp1, thems[2]);
+        dirac_matrix_t * expected = dirac_matrix_mul(temp2, thems[3]);
+        ASSERT(expected != (dirac_matrix_t *)0);
+
+        const dirac_complex_t * aa = (const dirac_complex_t *)that;
+        const dirac_complex_t * bb = (const dirac_complex_t *)expected;
+        for (jj = 0; jj < (DIMS[0] * DIMS[COUNT]); ++jj) {
+            ASSERT(cabs(aa[jj] - bb[jj]) < (1e-9 * (1.0 + cabs(bb[jj]))));
+        }
+
+        dirac_delete(expected);
+        dirac_delete(temp2);
+        dirac_delete(temp1);
+        dirac_delete(that);
+
+        that = dirac_matrix_mul_chain((const dirac_matrix_t * const *)&(thems[1]), 1, (FILE *)0);
+        ASSERT(that != (dirac_matrix_t *)0);
+        ASSERT(memcmp(that, thems[1], DIMS[1] * DIMS[2] * sizeof(dirac_complex_t)) == 0);
+        dirac_delete(that);
+
+        ASSERT(dirac_matrix_mul_chain((const dirac_matrix_t * const *)&(thems[1]), 0, (FILE *)0) == (dirac_matrix_t *)0);
+
+        dirac_matrix_t * swapped[2] = { thems[1], thems[0], };
+        ASSERT(dirac_matrix_mul_chain((const dirac_matrix_t * const *)swapped, 2, (FILE *)0) == (dirac_matrix_t *)0);
+
+        for (ii = 0; ii < COUNT; ++ii) {
+            dirac_delete(thems[ii]);
+        }
+
+        ASSERT(dirac_audit() == (dirac_t *)0);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        static const size_t ORDER = 6;
+        dirac_matrix_t * them = dirac_new_base(ORDER, ORDER);
+        dirac_matrix_t * vector = dirac_new_base(ORDER, 1);
+        dirac_matrix_t * diagonal = dirac_diagonal_new(ORDER);
+        dirac_matrix_t * sparse;
+        dirac_matrix_t * expected;
+        dirac_matrix_t * that;
+        dirac_matrix_t * temp;
+        const dirac_complex_t * aa;
+        const dirac_complex_t * bb;
+        dirac_complex_t * body;
+        size_t kk;
+        size_t jj;
+
+        body = (dirac_complex_t *)them;
+        for (jj = 0; jj < (ORDER * ORDER); ++jj) {
+            body[jj] = CMPLX((double)(PRIMES[jj % 20] % 7) - 3.0, (double)(PRIMES[(3 * jj) % 20] % 5) - 2.0) / 8.0;
+        }
+        body = (dirac_complex_t *)vector;
+        for (jj = 0; jj < ORDER; ++jj) {
+            body[jj] = CMPLX(1.0, (double)jj);
+        }
+        body = (dirac_complex_t *)diagonal;
+        for (jj = 0; jj < ORDER; ++jj) {
+            body[jj] = CMPLX(0.5, (double)jj / 4.0);
+        }
+        sparse = dirac_sparse_from_dense(them);
+        ASSERT(sparse != (dirac_matrix_t *)0);
+
+        /* Every power up to 17 agrees with repeated multiplication. */
+        expected = dirac_new_base(ORDER, ORDER);
+        body = (dirac_complex_t *)expected;
+        for (jj = 0; jj < ORDER; ++jj) {
+            body[(jj * ORDER) + jj] = 1.0;
+        }
+        for (kk = 0; kk <= 17; ++kk) {
+            that = dirac_matrix_pow(them, kk);
+            ASSERT(that != (dirac_matrix_t *)0);
+            ASSERT(dirac_rows_get(that) == ORDER);
+            ASSERT(dirac_cols_get(that) == ORDER);
+            aa = (const dirac_complex_t *)that;
+            bb = (const dirac_complex_t *)expected;
+            for (jj = 0; jj < (ORDER * ORDER); ++jj) {
+                ASSERT(cabs(aa[jj] - bb[jj]) < (1e-12 * (1.0 + cabs(bb[jj]))));
+            }
+            dirac_delete(that);
+            that = dirac_matrix_pow(sparse, kk);
+            ASSERT(that != (dirac_matrix_t *)0);
+            aa = (const dirac_complex_t *)that;
+            for (jj = 0; jj < (ORDER * ORDER); ++jj) {
+                ASSERT(cabs(aa[jj] - bb[jj]) < (1e-12 * (1.0 + cabs(bb[jj]))));
+            }
+            dirac_delete(that);
+            temp = dirac_matrix_mul(expected, them);
+            dirac_delete(expected);
+            expected = temp;
+        }
+        dirac_delete(expected);
+
+        /* Small powers of a vector apply A over and over. */
+        for (kk = 0; kk <= 9; ++kk) {
+            expected = dirac_matrix_dup(vector);
+            for (jj = 0; jj < kk; ++jj) {
+                temp = dirac_matrix_mul(them, expected);
+                dirac_delete(expected);
+                expected = temp;
+            }
+            bb = (const dirac_complex_t *)expected;
+            that = dirac_matrix_pow_apply(them, kk, vector);
+            ASSERT(that != (dirac_matrix_t *)0);
+            ASSERT(dirac_rows_get(that) == ORDER);
+            ASSERT(dirac_cols_get(that) == 1);
+            aa = (const dirac_complex_t *)that;
+            for (jj = 0; jj < ORDER; ++jj) {
+                ASSERT(cabs(aa[jj] - bb[jj]) < (1e-12 * (1.0 + cabs(bb[jj]))));
+            }
+            dirac_delete(that);
+            that = dirac_matrix_pow_apply(sparse, kk, vector);
+            ASSERT(that != (dirac_matrix_t *)0);
+            aa = (const dirac_complex_t *)that;
+            for (jj = 0; jj < ORDER; ++jj) {
+                ASSERT(cabs(aa[jj] - bb[jj]) < (1e-12 * (1.0 + cabs(bb[jj]))));
+            }
+            dirac_delete(that);
+            dirac_delete(expected);
+        }
+
+        /* A large power of a dense operator is cheaper squared. */
+        that = dirac_matrix_pow_apply(them, 1000, vector);
+        ASSERT(that != (dirac_matrix_t *)0);
+        temp = dirac_matrix_pow(them, 1000);
+        ASSERT(temp != (dirac_matrix_t *)0);
+        expected = dirac_matrix_mul(temp, vector);
+        aa = (const dirac_complex_t *)that;
+        bb = (const dirac_complex_t *)expected;
+        for (jj = 0; jj < ORDER; ++jj) {
+            ASSERT(cabs(aa[jj] - bb[jj]) <= (1e-12 * (1.0 + cabs(bb[jj]))));
+        }
+        dirac_delete(expected);
+        dirac_delete(temp);
+        dirac_delete(that);
+
+        /* A diagonal power is the power of each element. */
+        that = dirac_matrix_pow(diagonal, 7);
+        ASSERT(that != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(that) == DIRAC_KIND_DENSE);
+        aa = (const dirac_complex_t *)that;
+        bb = (const dirac_complex_t *)diagonal;
+        for (jj = 0; jj < (ORDER * ORDER); ++jj) {
+            if ((jj % (ORDER + 1)) == 0) {
+                ASSERT(cabs(aa[jj] - cpow(bb[jj / (ORDER + 1)], 7)) < 1e-12);
+            } else {
+                ASSERT(aa[jj] == 0);
+            }
+        }
+        dirac_delete(that);
+        that = dirac_matrix_pow_apply(diagonal, 7, vector);
+        ASSERT(that != (dirac_matrix_t *)0);
+        aa = (const dirac_complex_t *)that;
+        for (jj = 0; jj < ORDER; ++jj) {
+            ASSERT(cabs(aa[jj] - (cpow(bb[jj], 7) * ((const dirac_complex_t *)vector)[jj])) < 1e-12);
+        }
+        dirac_delete(that);
+
+        temp = dirac_new_base(ORDER, 2);
+        ASSERT(dirac_matrix_pow(temp, 2) == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_pow_apply(temp, 2, vector) == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_pow_apply(them, 2, temp) == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_pow_apply(them, 2, (dirac_matrix_t *)0) == (dirac_matrix_t *)0);
+        dirac_delete(temp);
+
+        dirac_delete(sparse);
+        dirac_delete(diagonal);
+        dirac_delete(vector);
+        dirac_delete(them);
+
+        ASSERT(dirac_audit() == (dirac_t *)0);
+
+        STATUS();
+    }
+
     {
         TEST();
 
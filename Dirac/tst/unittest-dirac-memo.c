@@ -0,0 +1,313 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac memoization functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac memoization functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+
+static dirac_matrix_t * identity(void)
+{
+    dirac_matrix_t * matrix = dirac_new_base(2, 2);
+    dirac_complex_t * mm = (dirac_complex_t *)matrix;
+    mm[0] = 1.0; mm[1] = 0.0;
+    mm[2] = 0.0; mm[3] = 1.0;
+    return matrix;
+}
+
+static dirac_matrix_t * hadamard(void)
+{
+    dirac_matrix_t * matrix = dirac_new_base(2, 2);
+    dirac_complex_t * mm = (dirac_complex_t *)matrix;
+    mm[0] = M_SQRT1_2; mm[1] = M_SQRT1_2;
+    mm[2] = M_SQRT1_2; mm[3] = -M_SQRT1_2;
+    return matrix;
+}
+
+/*
+ * Builds I (x) I (x) H (x) I with the memo.
+ */
+static dirac_matrix_t * chain(const dirac_matrix_t * ii, const dirac_matrix_t * hh)
+{
+    dirac_matrix_t * two = dirac_memo_kro(ii, ii);
+    dirac_matrix_t * three = dirac_memo_kro(two, hh);
+    dirac_matrix_t * four = dirac_memo_kro(three, ii);
+    dirac_delete(three);
+    dirac_delete(two);
+    return four;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        /* Off by default: every result is new and nothing is kept. */
+        dirac_matrix_t * ii = identity();
+        dirac_matrix_t * hh = hadamard();
+        dirac_matrix_t * one;
+        dirac_matrix_t * two;
+
+        ASSERT(dirac_memo_budget_get() == 0);
+        one = dirac_memo_kro(ii, hh);
+        two = dirac_memo_kro(ii, hh);
+        ASSERT(one != (dirac_matrix_t *)0);
+        ASSERT(two != (dirac_matrix_t *)0);
+        ASSERT(one != two);
+        ASSERT(dirac_references_get(one) == 1);
+        ASSERT(dirac_memo_bytes_get() == 0);
+        ASSERT(dirac_memo_hits_get() == 0);
+        ASSERT(dirac_memo_misses_get() == 0);
+
+        dirac_delete(two);
+        dirac_delete(one);
+        dirac_delete(hh);
+        dirac_delete(ii);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_matrix_t * ii = identity();
+        dirac_matrix_t * hh = hadamard();
+        dirac_matrix_t * first;
+        dirac_matrix_t * second;
+        dirac_matrix_t * expected;
+        dirac_matrix_t * temp;
+        dirac_matrix_t * mine;
+
+        ASSERT(dirac_memo_budget_set(1 << 20) == 0);
+        ASSERT(dirac_memo_budget_get() == (1 << 20));
+
+        first = chain(ii, hh);
+        ASSERT(first != (dirac_matrix_t *)0);
+        ASSERT(dirac_memo_misses_get() == 3);
+        ASSERT(dirac_memo_hits_get() == 0);
+        ASSERT(dirac_memo_bytes_get() > 0);
+        /* Held by the caller and by the memo. */
+        ASSERT(dirac_references_get(first) == 2);
+
+        second = chain(ii, hh);
+        ASSERT(second == first);
+        ASSERT(dirac_memo_misses_get() == 3);
+        ASSERT(dirac_memo_hits_get() == 3);
+        ASSERT(dirac_references_get(first) == 3);
+
+        /* The same as building it the ordinary way. */
+        expected = dirac_matrix_kro(ii, ii);
+        temp = dirac_matrix_kro(expected, hh);
+        dirac_delete(expected);
+        expected = dirac_matrix_kro(temp, ii);
+        dirac_delete(temp);
+        ASSERT(dirac_rows_get(first) == 16);
+        ASSERT(dirac_cols_get(first) == 16);
+        ASSERT(memcmp(first, expected, 16 * 16 * sizeof(dirac_complex_t)) == 0);
+
+        /* Equal operands that are different objects still hit. */
+        temp = identity();
+        mine = dirac_memo_kro(temp, temp);
+        ASSERT(dirac_memo_hits_get() == 4);
+        dirac_delete(mine);
+        dirac_delete(temp);
+
+        /* Writing needs a private copy, leaving the memo's alone. */
+        mine = dirac_matrix_own(second);
+        ASSERT(mine != first);
+        ASSERT(dirac_references_get(first) == 2);
+        ((dirac_complex_t *)mine)[0] = 42.0;
+        ASSERT(memcmp(first, expected, 16 * 16 * sizeof(dirac_complex_t)) == 0);
+
+        dirac_delete(mine);
+        dirac_delete(expected);
+        dirac_delete(first);
+
+        dirac_memo_flush();
+        ASSERT(dirac_memo_bytes_get() == 0);
+        ASSERT(dirac_memo_budget_get() == (1 << 20));
+
+        dirac_delete(hh);
+        dirac_delete(ii);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Products and exponentials with different arguments are different. */
+        dirac_matrix_t * hh = hadamard();
+        dirac_matrix_t * one;
+        dirac_matrix_t * two;
+        dirac_matrix_t * three;
+        dirac_matrix_t * expected;
+        size_t hits;
+        size_t misses;
+
+        hits = dirac_memo_hits_get();
+        misses = dirac_memo_misses_get();
+
+        one = dirac_memo_expm(hh, CMPLX(0.0, -0.5));
+        two = dirac_memo_expm(hh, CMPLX(0.0, -0.25));
+        three = dirac_memo_expm(hh, CMPLX(0.0, -0.5));
+        ASSERT(one != two);
+        ASSERT(one == three);
+        ASSERT(dirac_memo_hits_get() == (hits + 1));
+        ASSERT(dirac_memo_misses_get() == (misses + 2));
+        expected = dirac_matrix_expm(hh, CMPLX(0.0, -0.5));
+        ASSERT(memcmp(one, expected, 4 * sizeof(dirac_complex_t)) == 0);
+        dirac_delete(expected);
+        dirac_delete(three);
+        dirac_delete(two);
+        dirac_delete(one);
+
+        /* The product is not the Kronecker product of the same operands. */
+        one = dirac_memo_mul(hh, hh);
+        two = dirac_memo_kro(hh, hh);
+        ASSERT(one != two);
+        ASSERT(dirac_rows_get(one) == 2);
+        ASSERT(dirac_rows_get(two) == 4);
+        expected = dirac_matrix_mul(hh, hh);
+        ASSERT(memcmp(one, expected, 4 * sizeof(dirac_complex_t)) == 0);
+        dirac_delete(expected);
+        dirac_delete(two);
+        dirac_delete(one);
+
+        dirac_memo_flush();
+        dirac_delete(hh);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* A small budget keeps only the most recently used. */
+        dirac_matrix_t * matrices[4];
+        dirac_matrix_t * results[4];
+        dirac_matrix_t * again;
+        size_t bytes;
+        size_t hits;
+        size_t ii;
+
+        for (ii = 0; ii < 4; ++ii) {
+            matrices[ii] = hadamard();
+            ((dirac_complex_t *)matrices[ii])[0] = (double)ii;
+            results[ii] = dirac_memo_kro(matrices[ii], matrices[ii]);
+            ASSERT(results[ii] != (dirac_matrix_t *)0);
+            if (ii == 0) {
+                bytes = dirac_memo_bytes_get();
+                ASSERT(bytes > 0);
+                /* Room for two results but not three. */
+                dirac_memo_budget_set((2 * bytes) + (bytes / 2));
+            }
+        }
+        ASSERT(dirac_memo_bytes_get() == (2 * bytes));
+        /* The evicted ones are now held by the caller alone. */
+        ASSERT(dirac_references_get(results[0]) == 1);
+        ASSERT(dirac_references_get(results[1]) == 1);
+        ASSERT(dirac_references_get(results[2]) == 2);
+        ASSERT(dirac_references_get(results[3]) == 2);
+
+        /* Using one makes it the most recently used. */
+        hits = dirac_memo_hits_get();
+        again = dirac_memo_kro(matrices[2], matrices[2]);
+        ASSERT(again == results[2]);
+        ASSERT(dirac_memo_hits_get() == (hits + 1));
+        dirac_delete(again);
+        again = dirac_memo_kro(matrices[0], matrices[0]);
+        ASSERT(again != results[0]);
+        ASSERT(dirac_references_get(results[3]) == 1);
+        ASSERT(dirac_references_get(results[2]) == 2);
+        dirac_delete(again);
+
+        /* Too large to keep at all. */
+        dirac_memo_budget_set(bytes / 2);
+        ASSERT(dirac_memo_bytes_get() == 0);
+        again = dirac_memo_kro(matrices[1], matrices[1]);
+        ASSERT(again != (dirac_matrix_t *)0);
+        ASSERT(dirac_references_get(again) == 1);
+        ASSERT(dirac_memo_bytes_get() == 0);
+        dirac_delete(again);
+
+        /* A budget of zero turns it off and empties it. */
+        dirac_memo_budget_set(1 << 20);
+        again = dirac_memo_kro(matrices[1], matrices[1]);
+        ASSERT(dirac_memo_bytes_get() == bytes);
+        ASSERT(dirac_memo_budget_set(0) == (1 << 20));
+        ASSERT(dirac_memo_bytes_get() == 0);
+        ASSERT(dirac_references_get(again) == 1);
+        dirac_delete(again);
+
+        for (ii = 0; ii < 4; ++ii) {
+            ASSERT(dirac_references_get(results[ii]) == 1);
+            dirac_delete(results[ii]);
+            dirac_delete(matrices[ii]);
+        }
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        errno = 0;
+        ASSERT(dirac_memo_kro((dirac_matrix_t *)0, (dirac_matrix_t *)0) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_memo_mul((dirac_matrix_t *)0, (dirac_matrix_t *)0) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_memo_expm((dirac_matrix_t *)0, 1.0) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Whatever the memo still holds goes back to the cache and is freed. */
+        dirac_matrix_t * hh = hadamard();
+        dirac_matrix_t * kk;
+
+        dirac_memo_budget_set(1 << 20);
+        kk = dirac_memo_kro(hh, hh);
+        dirac_delete(kk);
+        dirac_delete(hh);
+        ASSERT(dirac_memo_bytes_get() > 0);
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+        ASSERT(dirac_memo_bytes_get() == 0);
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,368 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac packed Hermitian and triangular functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac packed Hermitian and triangular functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include "unittest-dirac-fixtures.h"
+#include "unittest-dirac-primes.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+
+/*
+ * Compares a dense result against an expected one and deletes it.
+ */
+static int consume(dirac_matrix_t * them, const dirac_matrix_t * expected)
+{
+    int result = 0;
+    if (them == (dirac_matrix_t *)0) {
+        /* Do nothing. */
+    } else if (dirac_kind_get(them) != DIRAC_KIND_DENSE) {
+        /* Do nothing. */
+    } else {
+        result = equivalent(them, expected);
+    }
+    if (them != (dirac_matrix_t *)0) { dirac_delete(them); }
+    return result;
+}
+
+static dirac_matrix_t * hermitian(size_t order)
+{
+    dirac_matrix_t * them = dirac_new_base(order, order);
+    dirac_complex_t * hh = (dirac_complex_t *)them;
+    size_t rr;
+    size_t cc;
+    for (rr = 0; rr < order; ++rr) {
+        hh[(rr * order) + rr] = (PRIMES[rr % 100] % 7) - 3.0;
+        for (cc = rr + 1; cc < order; ++cc) {
+            hh[(rr * order) + cc] = CMPLX((PRIMES[(rr + cc) % 100] % 5) - 2.0, (PRIMES[(rr * cc) % 100] % 3) - 1.0);
+            hh[(cc * order) + rr] = conj(hh[(rr * order) + cc]);
+        }
+    }
+    return them;
+}
+
+static dirac_matrix_t * triangular(size_t order)
+{
+    dirac_matrix_t * them = filled(order, order, 0);
+    dirac_complex_t * tt = (dirac_complex_t *)them;
+    size_t rr;
+    size_t cc;
+    for (rr = 0; rr < order; ++rr) {
+        for (cc = 0; cc < rr; ++cc) {
+            tt[(rr * order) + cc] = 0;
+        }
+    }
+    return them;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        ASSERT(DIRAC_PACKED_INDEX(4, 0, 0) == 0);
+        ASSERT(DIRAC_PACKED_INDEX(4, 0, 3) == 3);
+        ASSERT(DIRAC_PACKED_INDEX(4, 1, 1) == 4);
+        ASSERT(DIRAC_PACKED_INDEX(4, 2, 2) == 7);
+        ASSERT(DIRAC_PACKED_INDEX(4, 2, 3) == 8);
+        ASSERT(DIRAC_PACKED_INDEX(4, 3, 3) == 9);
+
+        dirac_matrix_t * them = dirac_hermitian_new(4);
+        ASSERT(them != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(them) == DIRAC_KIND_HERMITIAN);
+        ASSERT(dirac_rows_get(them) == 4);
+        ASSERT(dirac_cols_get(them) == 4);
+        ASSERT(((dirac_complex_t *)them)[9] == 0.0);
+        ((dirac_complex_t *)them)[DIRAC_PACKED_INDEX(4, 1, 2)] = CMPLX(1.0, 2.0);
+        ((dirac_complex_t *)them)[DIRAC_PACKED_INDEX(4, 3, 3)] = 5.0;
+        dirac_matrix_t * dense = dirac_packed_to_dense(them);
+        ASSERT(dense != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(dense) == DIRAC_KIND_DENSE);
+        ASSERT(((dirac_complex_t *)dense)[(1 * 4) + 2] == CMPLX(1.0, 2.0));
+        ASSERT(((dirac_complex_t *)dense)[(2 * 4) + 1] == CMPLX(1.0, -2.0));
+        ASSERT(((dirac_complex_t *)dense)[(3 * 4) + 3] == 5.0);
+        ASSERT(((dirac_complex_t *)dense)[(0 * 4) + 0] == 0.0);
+        dirac_delete(dense);
+        dirac_delete(them);
+
+        them = dirac_triangular_new(3);
+        ASSERT(them != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(them) == DIRAC_KIND_TRIANGULAR);
+        ((dirac_complex_t *)them)[DIRAC_PACKED_INDEX(3, 0, 2)] = 7.0;
+        dense = dirac_packed_to_dense(them);
+        ASSERT(((dirac_complex_t *)dense)[(0 * 3) + 2] == 7.0);
+        ASSERT(((dirac_complex_t *)dense)[(2 * 3) + 0] == 0.0);
+        dirac_delete(dense);
+        dirac_delete(them);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Round trips, and the lower triangle of the source is not read. */
+        static const size_t ORDER = 37;
+        dirac_matrix_t * hh = hermitian(ORDER);
+        dirac_matrix_t * packed = dirac_packed_from_dense(hh, DIRAC_KIND_HERMITIAN);
+        ASSERT(packed != (dirac_matrix_t *)0);
+        ASSERT(consume(dirac_packed_to_dense(packed), hh));
+        dirac_matrix_t * copy = dirac_matrix_dup(packed);
+        ASSERT(dirac_kind_get(copy) == DIRAC_KIND_HERMITIAN);
+        ASSERT(consume(dirac_packed_to_dense(copy), hh));
+        dirac_delete(copy);
+
+        dirac_matrix_t * tt = triangular(ORDER);
+        dirac_matrix_t * full = filled(ORDER, ORDER, 0);
+        dirac_matrix_t * upper = dirac_packed_from_dense(full, DIRAC_KIND_TRIANGULAR);
+        ASSERT(upper != (dirac_matrix_t *)0);
+        ASSERT(consume(dirac_packed_to_dense(upper), tt));
+
+        dirac_delete(upper);
+        dirac_delete(full);
+        dirac_delete(tt);
+        dirac_delete(packed);
+        dirac_delete(hh);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Every product with a packed operand agrees with the dense one. */
+        size_t prior = dirac_threads_set(4);
+        static const size_t ORDER = 70;
+        dirac_matrix_t * hh = hermitian(ORDER);
+        dirac_matrix_t * tt = triangular(ORDER);
+        dirac_matrix_t * ph = dirac_packed_from_dense(hh, DIRAC_KIND_HERMITIAN);
+        dirac_matrix_t * pt = dirac_packed_from_dense(tt, DIRAC_KIND_TRIANGULAR);
+        dirac_matrix_t * vector = filled(ORDER, 1, 0);
+        dirac_matrix_t * block = filled(ORDER, 5, 0);
+        dirac_matrix_t * wide = filled(3, ORDER, 0);
+        dirac_matrix_t * square = filled(ORDER, ORDER, 0);
+        dirac_matrix_t * expected;
+
+        expected = dirac_matrix_mul(hh, vector);
+        ASSERT(consume(dirac_matrix_mul(ph, vector), expected));
+        dirac_delete(expected);
+
+        expected = dirac_matrix_mul(tt, vector);
+        ASSERT(consume(dirac_matrix_mul(pt, vector), expected));
+        dirac_delete(expected);
+
+        expected = dirac_matrix_mul(hh, block);
+        ASSERT(consume(dirac_matrix_mul(ph, block), expected));
+        dirac_delete(expected);
+
+        expected = dirac_matrix_mul(wide, hh);
+        ASSERT(consume(dirac_matrix_mul(wide, ph), expected));
+        dirac_delete(expected);
+
+        expected = dirac_matrix_mul(wide, tt);
+        ASSERT(consume(dirac_matrix_mul(wide, pt), expected));
+        dirac_delete(expected);
+
+        expected = dirac_matrix_mul(square, hh);
+        ASSERT(consume(dirac_matrix_mul(square, ph), expected));
+        dirac_delete(expected);
+
+        expected = dirac_matrix_mul(hh, tt);
+        ASSERT(consume(dirac_matrix_mul(ph, pt), expected));
+        dirac_delete(expected);
+
+        dirac_matrix_t * sparse = dirac_sparse_from_dense(square);
+        expected = dirac_matrix_mul(hh, square);
+        ASSERT(consume(dirac_matrix_mul(ph, sparse), expected));
+        dirac_delete(expected);
+        dirac_delete(sparse);
+
+        dirac_matrix_t * diagonal = dirac_diagonal_new(ORDER);
+        size_t ii;
+        for (ii = 0; ii < ORDER; ++ii) {
+            ((dirac_complex_t *)diagonal)[ii] = CMPLX(ii, -1.0);
+        }
+        dirac_matrix_t * dd = dirac_structured_to_dense(diagonal);
+        expected = dirac_matrix_mul(dd, tt);
+        ASSERT(consume(dirac_matrix_mul(diagonal, pt), expected));
+        dirac_delete(expected);
+        dirac_delete(dd);
+        dirac_delete(diagonal);
+
+        /* A Kronecker product with a packed operand is sparse. */
+        dirac_matrix_t * small = dirac_packed_from_dense(hh, DIRAC_KIND_HERMITIAN);
+        dirac_matrix_t * two = hermitian(2);
+        dirac_matrix_t * ptwo = dirac_packed_from_dense(two, DIRAC_KIND_HERMITIAN);
+        expected = dirac_matrix_kro(two, hh);
+        dirac_matrix_t * product = dirac_matrix_kro(ptwo, small);
+        ASSERT(product != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(product) == DIRAC_KIND_SPARSE);
+        ASSERT(consume(dirac_sparse_to_dense(product), expected));
+        dirac_delete(product);
+        dirac_delete(expected);
+        dirac_delete(ptwo);
+        dirac_delete(two);
+        dirac_delete(small);
+
+        ASSERT(dirac_matrix_mul(ph, wide) == (dirac_matrix_t *)0);
+
+        dirac_delete(square);
+        dirac_delete(wide);
+        dirac_delete(block);
+        dirac_delete(vector);
+        dirac_delete(pt);
+        dirac_delete(ph);
+        dirac_delete(tt);
+        dirac_delete(hh);
+        dirac_threads_set(prior);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* C = alpha * A * A' + beta * C for odd and even orders. */
+        size_t prior = dirac_threads_set(4);
+        static const size_t ORDERS[] = { 1, 2, 9, 64, };
+        size_t oo;
+        for (oo = 0; oo < (sizeof(ORDERS) / sizeof(ORDERS[0])); ++oo) {
+            size_t order = ORDERS[oo];
+            dirac_matrix_t * hh = hermitian(order);
+            dirac_matrix_t * cc = dirac_packed_from_dense(hh, DIRAC_KIND_HERMITIAN);
+            dirac_matrix_t * aa = filled(order, 3, 0);
+            dirac_matrix_t * expected = dirac_new_base(order, order);
+            size_t rr;
+            size_t kk;
+            size_t jj;
+            for (rr = 0; rr < order; ++rr) {
+                for (kk = 0; kk < order; ++kk) {
+                    dirac_complex_t sum = 0;
+                    for (jj = 0; jj < 3; ++jj) {
+                        sum += ((dirac_complex_t *)aa)[(rr * 3) + jj] * conj(((dirac_complex_t *)aa)[(kk * 3) + jj]);
+                    }
+                    ((dirac_complex_t *)expected)[(rr * order) + kk] = (0.5 * sum) + (2.0 * ((dirac_complex_t *)hh)[(rr * order) + kk]);
+                }
+            }
+            ASSERT(dirac_hermitian_update(cc, 0.5, aa, 2.0) == cc);
+            ASSERT(consume(dirac_packed_to_dense(cc), expected));
+            dirac_delete(expected);
+            dirac_delete(aa);
+            dirac_delete(cc);
+            dirac_delete(hh);
+        }
+
+        /* A density matrix from a pure state, even over garbage. */
+        dirac_matrix_t * rho = dirac_hermitian_new(4);
+        ((dirac_complex_t *)rho)[0] = NAN;
+        dirac_matrix_t * psi = dirac_new_base(4, 1);
+        ((dirac_complex_t *)psi)[0] = M_SQRT1_2;
+        ((dirac_complex_t *)psi)[3] = CMPLX(0.0, M_SQRT1_2);
+        ASSERT(dirac_hermitian_update(rho, 1.0, psi, 0.0) == rho);
+        ASSERT(cabs(((dirac_complex_t *)rho)[DIRAC_PACKED_INDEX(4, 0, 0)] - 0.5) < 1e-15);
+        ASSERT(cabs(((dirac_complex_t *)rho)[DIRAC_PACKED_INDEX(4, 0, 3)] - CMPLX(0.0, -0.5)) < 1e-15);
+        ASSERT(cabs(((dirac_complex_t *)rho)[DIRAC_PACKED_INDEX(4, 3, 3)] - 0.5) < 1e-15);
+        ASSERT(((dirac_complex_t *)rho)[DIRAC_PACKED_INDEX(4, 1, 1)] == 0.0);
+
+        /* Misfits. */
+        dirac_matrix_t * tall = dirac_new_base(5, 1);
+        dirac_matrix_t * upper = dirac_triangular_new(4);
+        ASSERT(dirac_hermitian_update(rho, 1.0, tall, 0.0) == (dirac_matrix_t *)0);
+        ASSERT(dirac_hermitian_update(upper, 1.0, psi, 0.0) == (dirac_matrix_t *)0);
+        ASSERT(dirac_hermitian_update(psi, 1.0, psi, 0.0) == (dirac_matrix_t *)0);
+        ASSERT(dirac_packed_from_dense(tall, DIRAC_KIND_HERMITIAN) == (dirac_matrix_t *)0);
+        ASSERT(dirac_packed_from_dense(rho, DIRAC_KIND_HERMITIAN) == (dirac_matrix_t *)0);
+        dirac_matrix_t * square = dirac_new_base(4, 4);
+        ASSERT(dirac_packed_from_dense(square, DIRAC_KIND_SPARSE) == (dirac_matrix_t *)0);
+        ASSERT(dirac_packed_to_dense(square) == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_add(rho, rho) == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_trn(rho) == (dirac_matrix_t *)0);
+        dirac_delete(square);
+        dirac_delete(upper);
+        dirac_delete(tall);
+
+        dirac_delete(psi);
+        dirac_delete(rho);
+        dirac_threads_set(prior);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Packed matrices persist, export, exponentiate and diagonalize. */
+        static const size_t ORDER = 12;
+        dirac_matrix_t * hh = hermitian(ORDER);
+        dirac_matrix_t * ph = dirac_packed_from_dense(hh, DIRAC_KIND_HERMITIAN);
+
+        char path[] = "/tmp/unittest-dirac-packed-XXXXXX";
+        close(mkstemp(path));
+        ASSERT(dirac_store(path, ph) > 0);
+        const dirac_matrix_t * view = dirac_load(path);
+        ASSERT(view != (const dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(view) == DIRAC_KIND_HERMITIAN);
+        ASSERT(consume(dirac_packed_to_dense(view), hh));
+        dirac_unload(view);
+
+        FILE * fp = fopen(path, "w");
+        ASSERT(fp != (FILE *)0);
+        ASSERT(dirac_market_write(fp, ph) > 0);
+        fclose(fp);
+        dirac_matrix_t * imported = dirac_market_read(path, DIRAC_KIND_DENSE);
+        ASSERT(consume(imported, hh));
+        unlink(path);
+
+        ASSERT(dirac_write(stderr, ph, DIRAC_FORMAT_TEXT, 2) > 0);
+
+        dirac_matrix_t * vector = filled(ORDER, 1, 0);
+        dirac_matrix_t * expected = dirac_matrix_expm_multiply(hh, CMPLX(0.0, -0.3), vector);
+        ASSERT(consume(dirac_matrix_expm_multiply(ph, CMPLX(0.0, -0.3), vector), expected));
+        dirac_delete(expected);
+        dirac_delete(vector);
+
+        expected = dirac_matrix_eigh(hh, (dirac_matrix_t **)0);
+        ASSERT(consume(dirac_matrix_eigh(ph, (dirac_matrix_t **)0), expected));
+        dirac_delete(expected);
+
+        dirac_delete(ph);
+        dirac_delete(hh);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,414 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac reduction functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac reduction functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include "unittest-dirac-primes.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static dirac_matrix_t * column(size_t order)
+{
+    dirac_matrix_t * them = dirac_new_base(order, 1);
+    dirac_complex_t * vv = (dirac_complex_t *)them;
+    size_t ii;
+    for (ii = 0; ii < order; ++ii) {
+        vv[ii] = CMPLX(((PRIMES[ii % 100] % 9) - 4.0) / 4.0, ((PRIMES[(ii * 7) % 100] % 5) - 2.0) / 4.0);
+    }
+    return them;
+}
+
+/*
+ * Returns the dense Hermitian matrix with a zero or two in every other
+ * place off the diagonal.
+ */
+static dirac_matrix_t * hermitian(size_t order)
+{
+    dirac_matrix_t * them = dirac_new_base(order, order);
+    dirac_complex_t * hh = (dirac_complex_t *)them;
+    size_t rr;
+    size_t cc;
+    for (rr = 0; rr < order; ++rr) {
+        hh[(rr * order) + rr] = (PRIMES[rr % 100] % 7) - 3.0;
+        for (cc = rr + 1; cc < order; ++cc) {
+            if (((rr + cc) % 2) == 0) {
+                continue;
+            }
+            hh[(rr * order) + cc] = CMPLX(((PRIMES[(rr + cc) % 100] % 5) - 2.0) / 4.0, ((PRIMES[(rr * cc) % 100] % 3) - 1.0) / 4.0);
+            hh[(cc * order) + rr] = conj(hh[(rr * order) + cc]);
+        }
+    }
+    return them;
+}
+
+/*
+ * Returns <v|A|v> the long way.
+ */
+static dirac_complex_t expected(const dirac_matrix_t * thema, const dirac_matrix_t * themv)
+{
+    dirac_matrix_t * product = dirac_matrix_mul(thema, themv);
+    const dirac_complex_t * av = (const dirac_complex_t *)product;
+    const dirac_complex_t * vv = (const dirac_complex_t *)themv;
+    dirac_complex_t sum = 0;
+    size_t ii;
+    for (ii = 0; ii < dirac_rows_get(themv); ++ii) {
+        sum += conj(vv[ii]) * av[ii];
+    }
+    dirac_delete(product);
+    return sum;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        DIRAC_OBJECT_CONST(3, 3) aa =
+            DIRAC_OBJECT_INIT_BEGIN(3, 3)
+                { 1.0+1.0i, 2.0+0.0i, 0.0+0.0i, },
+                { 0.0+0.0i, -3.0+0.0i, 4.0+0.0i, },
+                { 0.0-2.0i, 0.0+0.0i, 5.0-0.5i, },
+            DIRAC_OBJECT_INIT_END;
+        DIRAC_OBJECT_CONST(3, 1) psi =
+            DIRAC_OBJECT_INIT_BEGIN(3, 1)
+                { 1.0+0.0i, },
+                { 0.0+1.0i, },
+                { 2.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        DIRAC_OBJECT_CONST(3, 1) phi =
+            DIRAC_OBJECT_INIT_BEGIN(3, 1)
+                { 0.0+1.0i, },
+                { 1.0+0.0i, },
+                { 0.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        dirac_complex_t value;
+        double norm;
+
+        value = dirac_matrix_trace(DIRAC_MATRIX_GET(aa));
+        ASSERT(value == (3.0 + 0.5i));
+
+        /* 2 + 4 + 9 + 16 + 4 + 25.25 */
+        norm = dirac_matrix_norm(DIRAC_MATRIX_GET(aa));
+        ASSERT(fabs(norm - sqrt(60.25)) < 1e-15);
+        norm = dirac_matrix_norm(DIRAC_MATRIX_GET(psi));
+        ASSERT(fabs(norm - sqrt(6.0)) < 1e-15);
+
+        /* <psi|phi> = 1*i + (-i)*1 + 2*0 */
+        value = dirac_matrix_inner(DIRAC_MATRIX_GET(psi), DIRAC_MATRIX_GET(phi));
+        ASSERT(value == 0);
+        value = dirac_matrix_inner(DIRAC_MATRIX_GET(psi), DIRAC_MATRIX_GET(psi));
+        ASSERT(value == 6.0);
+        value = dirac_matrix_inner(DIRAC_MATRIX_GET(aa), DIRAC_MATRIX_GET(aa));
+        ASSERT(value == 60.25);
+
+        value = dirac_matrix_expectation(DIRAC_MATRIX_GET(aa), DIRAC_MATRIX_GET(psi));
+        ASSERT(cabs(value - expected(DIRAC_MATRIX_GET(aa), DIRAC_MATRIX_GET(psi))) < 1e-14);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Every kind agrees with its dense equivalent. */
+        static const size_t ORDER = 77;
+        dirac_matrix_t * dense = hermitian(ORDER);
+        dirac_matrix_t * vector = column(ORDER);
+        dirac_matrix_t * kinds[5];
+        dirac_matrix_t * equivalent;
+        dirac_complex_t trace;
+        dirac_complex_t value;
+        double norm;
+        size_t * columns;
+        size_t ii;
+        size_t jj;
+
+        kinds[0] = dirac_sparse_from_dense(dense);
+        kinds[1] = dirac_packed_from_dense(dense, DIRAC_KIND_HERMITIAN);
+        kinds[2] = dirac_packed_from_dense(dense, DIRAC_KIND_TRIANGULAR);
+        kinds[3] = dirac_diagonal_new(ORDER);
+        kinds[4] = dirac_permutation_new(ORDER);
+        columns = dirac_permutation_columns_mut(kinds[4]);
+        for (ii = 0; ii < ORDER; ++ii) {
+            ((dirac_complex_t *)kinds[3])[ii] = CMPLX((double)ii, 1.0);
+            ((dirac_complex_t *)kinds[4])[ii] = ((ii % 3) == 0) ? -1.0 : (0.0 + 1.0i);
+            columns[ii] = (ii * 2) % ORDER;
+        }
+
+        for (ii = 0; ii < (sizeof(kinds) / sizeof(kinds[0])); ++ii) {
+            ASSERT(kinds[ii] != (dirac_matrix_t *)0);
+            if ((ii == 1) || (ii == 2)) {
+                equivalent = dirac_packed_to_dense(kinds[ii]);
+            } else if (ii == 0) {
+                equivalent = dirac_sparse_to_dense(kinds[ii]);
+            } else {
+                equivalent = dirac_structured_to_dense(kinds[ii]);
+            }
+            ASSERT(equivalent != (dirac_matrix_t *)0);
+
+            trace = 0;
+            for (jj = 0; jj < ORDER; ++jj) {
+                trace += ((const dirac_complex_t *)equivalent)[(jj * ORDER) + jj];
+            }
+            value = dirac_matrix_trace(kinds[ii]);
+            ASSERT(cabs(value - trace) < 1e-12);
+            ASSERT(cabs(value - dirac_matrix_trace(equivalent)) < 1e-12);
+
+            norm = dirac_matrix_norm(kinds[ii]);
+            ASSERT(fabs(norm - dirac_matrix_norm(equivalent)) < 1e-12);
+            ASSERT(fabs((norm * norm) - creal(dirac_matrix_inner(equivalent, equivalent))) < 1e-10);
+
+            value = dirac_matrix_expectation(kinds[ii], vector);
+            ASSERT(cabs(value - expected(equivalent, vector)) < 1e-11);
+            ASSERT(cabs(value - dirac_matrix_expectation(equivalent, vector)) < 1e-11);
+            if (ii == 1) {
+                ASSERT(cimag(value) == 0.0);
+            }
+
+            dirac_delete(equivalent);
+            dirac_delete(kinds[ii]);
+        }
+
+        dirac_delete(vector);
+        dirac_delete(dense);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* A million tenths sum accurately and identically on any threads. */
+        static const size_t COUNT = 1000000;
+        dirac_matrix_t * vector = dirac_new_base(COUNT, 1);
+        dirac_complex_t * vv = (dirac_complex_t *)vector;
+        dirac_complex_t one;
+        dirac_complex_t four;
+        double naive;
+        double exact;
+        size_t prior;
+        size_t ii;
+
+        for (ii = 0; ii < COUNT; ++ii) {
+            vv[ii] = CMPLX(0.1, -0.1);
+        }
+        exact = 0.02 * COUNT;
+        naive = 0.0;
+        for (ii = 0; ii < COUNT; ++ii) {
+            naive += 0.02;
+        }
+
+        prior = dirac_threads_set(1);
+        one = dirac_matrix_inner(vector, vector);
+        dirac_threads_set(4);
+        four = dirac_matrix_inner(vector, vector);
+        dirac_threads_set(prior);
+
+        ASSERT(one == four);
+        ASSERT(cimag(one) == 0.0);
+        ASSERT(fabs(creal(one) - exact) < (1e-13 * exact));
+        ASSERT(fabs(creal(one) - exact) < fabs(naive - exact));
+        ASSERT(fabs(dirac_matrix_norm(vector) - sqrt(exact)) < (1e-13 * sqrt(exact)));
+
+        dirac_delete(vector);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Either half of a Bell pair is maximally mixed. */
+        DIRAC_OBJECT_CONST(4, 4) bell =
+            DIRAC_OBJECT_INIT_BEGIN(4, 4)
+                { 0.5+0.0i, 0.0+0.0i, 0.0+0.0i, 0.5+0.0i, },
+                { 0.0+0.0i, 0.0+0.0i, 0.0+0.0i, 0.0+0.0i, },
+                { 0.0+0.0i, 0.0+0.0i, 0.0+0.0i, 0.0+0.0i, },
+                { 0.5+0.0i, 0.0+0.0i, 0.0+0.0i, 0.5+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        static const size_t QUBITS[] = { 2, 2, };
+        dirac_matrix_t * reduced;
+        const dirac_complex_t * rr;
+        uint64_t keep;
+
+        for (keep = 1; keep <= 2; ++keep) {
+            reduced = dirac_matrix_ptrace(DIRAC_MATRIX_GET(bell), QUBITS, 2, keep);
+            ASSERT(reduced != (dirac_matrix_t *)0);
+            ASSERT(dirac_rows_get(reduced) == 2);
+            ASSERT(dirac_cols_get(reduced) == 2);
+            rr = (const dirac_complex_t *)reduced;
+            ASSERT(rr[0] == 0.5);
+            ASSERT(rr[1] == 0.0);
+            ASSERT(rr[2] == 0.0);
+            ASSERT(rr[3] == 0.5);
+            dirac_delete(reduced);
+        }
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Tracing out part of A x B x C scales the rest by its trace. */
+        static const size_t DIMS[] = { 2, 3, 2, };
+        dirac_matrix_t * parts[3];
+        dirac_matrix_t * temp;
+        dirac_matrix_t * whole;
+        dirac_matrix_t * packed;
+        dirac_matrix_t * reduced;
+        dirac_matrix_t * other;
+        dirac_matrix_t * expected;
+        dirac_complex_t traces[3];
+        dirac_complex_t scale;
+        const dirac_complex_t * aa;
+        const dirac_complex_t * bb;
+        uint64_t keep;
+        size_t ii;
+        size_t jj;
+
+        for (ii = 0; ii < 3; ++ii) {
+            parts[ii] = hermitian(DIMS[ii]);
+            for (jj = 0; jj < DIMS[ii]; ++jj) {
+                ((dirac_complex_t *)parts[ii])[(jj * DIMS[ii]) + jj] += ii + 1.0;
+            }
+            traces[ii] = dirac_matrix_trace(parts[ii]);
+            ASSERT(traces[ii] != 0.0);
+        }
+        temp = dirac_matrix_kro(parts[0], parts[1]);
+        whole = dirac_matrix_kro(temp, parts[2]);
+        dirac_delete(temp);
+        ASSERT(dirac_rows_get(whole) == 12);
+        packed = dirac_packed_from_dense(whole, DIRAC_KIND_HERMITIAN);
+        ASSERT(packed != (dirac_matrix_t *)0);
+
+        for (keep = 0; keep < 8; ++keep) {
+            expected = (dirac_matrix_t *)0;
+            scale = 1.0;
+            for (ii = 0; ii < 3; ++ii) {
+                if ((keep & (1 << ii)) == 0) {
+                    scale *= traces[ii];
+                } else if (expected == (dirac_matrix_t *)0) {
+                    expected = dirac_matrix_dup(parts[ii]);
+                } else {
+                    temp = dirac_matrix_kro(expected, parts[ii]);
+                    dirac_delete(expected);
+                    expected = temp;
+                }
+            }
+            reduced = dirac_matrix_ptrace(whole, DIMS, 3, keep);
+            ASSERT(reduced != (dirac_matrix_t *)0);
+            other = dirac_matrix_ptrace(packed, DIMS, 3, keep);
+            ASSERT(other != (dirac_matrix_t *)0);
+            aa = (const dirac_complex_t *)reduced;
+            bb = (const dirac_complex_t *)other;
+            if (expected == (dirac_matrix_t *)0) {
+                ASSERT(dirac_rows_get(reduced) == 1);
+                ASSERT(dirac_cols_get(reduced) == 1);
+                ASSERT(cabs(aa[0] - scale) < 1e-12);
+                ASSERT(cabs(aa[0] - dirac_matrix_trace(whole)) < 1e-12);
+            } else {
+                ASSERT(dirac_rows_get(reduced) == dirac_rows_get(expected));
+                ASSERT(dirac_cols_get(reduced) == dirac_cols_get(expected));
+                for (jj = 0; jj < (dirac_rows_get(expected) * dirac_cols_get(expected)); ++jj) {
+                    ASSERT(cabs(aa[jj] - (scale * ((const dirac_complex_t *)expected)[jj])) < 1e-12);
+                }
+                dirac_delete(expected);
+            }
+            for (jj = 0; jj < (dirac_rows_get(reduced) * dirac_cols_get(reduced)); ++jj) {
+                ASSERT(cabs(aa[jj] - bb[jj]) < 1e-12);
+            }
+            dirac_delete(other);
+            dirac_delete(reduced);
+        }
+
+        errno = 0;
+        ASSERT(dirac_matrix_ptrace(whole, DIMS, 2, 1) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_matrix_ptrace(whole, DIMS, 3, 8) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_matrix_ptrace(whole, (const size_t *)0, 3, 1) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+
+        dirac_delete(packed);
+        dirac_delete(whole);
+        for (ii = 0; ii < 3; ++ii) {
+            dirac_delete(parts[ii]);
+        }
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_matrix_t * wide = dirac_new_base(2, 3);
+        dirac_matrix_t * square = dirac_new_base(3, 3);
+        dirac_matrix_t * vector = dirac_new_base(3, 1);
+        dirac_matrix_t * diagonal = dirac_diagonal_new(3);
+
+        errno = 0;
+        ASSERT(isnan(creal(dirac_matrix_trace(wide))));
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(isnan(dirac_matrix_norm((dirac_matrix_t *)0)));
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(isnan(creal(dirac_matrix_inner(square, vector))));
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(isnan(creal(dirac_matrix_inner(diagonal, square))));
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(isnan(creal(dirac_matrix_expectation(wide, vector))));
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(isnan(creal(dirac_matrix_expectation(square, square))));
+        ASSERT(errno == EINVAL);
+
+        dirac_delete(diagonal);
+        dirac_delete(vector);
+        dirac_delete(square);
+        dirac_delete(wide);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
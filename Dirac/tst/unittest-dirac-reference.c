@@ -0,0 +1,184 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac reference counting functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac reference counting functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+
+static const size_t ORDER = 64;
+
+static const int ROUNDS = 20000;
+
+static void * hold(void * arg)
+{
+    dirac_matrix_t * shared = (dirac_matrix_t *)arg;
+    dirac_matrix_t * mine;
+    dirac_complex_t * mm;
+    dirac_complex_t sum = 0;
+    int ii;
+    for (ii = 0; ii < ROUNDS; ++ii) {
+        mine = dirac_matrix_cow(shared);
+        if (mine != shared) { return (void *)1; }
+        sum += ((const dirac_complex_t *)mine)[ii % (ORDER * ORDER)];
+        if ((ii % 100) == 0) {
+            /* Writing needs a private copy while the others hold it. */
+            mine = dirac_matrix_own(mine);
+            if ((mine == (dirac_matrix_t *)0) || (mine == shared)) { return (void *)1; }
+            mm = (dirac_complex_t *)mine;
+            mm[0] = sum;
+        }
+        dirac_delete(mine);
+    }
+    return (void *)0;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        dirac_matrix_t * original = dirac_new_base(3, 3);
+        dirac_complex_t * oo = (dirac_complex_t *)original;
+        dirac_matrix_t * copy;
+        dirac_matrix_t * other;
+        size_t ii;
+
+        for (ii = 0; ii < 9; ++ii) {
+            oo[ii] = CMPLX((double)ii, -(double)ii);
+        }
+        ASSERT(dirac_references_get(original) == 1);
+
+        /* A copy-on-write duplicate is the same matrix held twice. */
+        copy = dirac_matrix_cow(original);
+        ASSERT(copy == original);
+        ASSERT(dirac_references_get(original) == 2);
+        other = dirac_matrix_cow(copy);
+        ASSERT(other == original);
+        ASSERT(dirac_references_get(original) == 3);
+
+        /* Owning it while it is shared makes a private copy. */
+        other = dirac_matrix_own(other);
+        ASSERT(other != (dirac_matrix_t *)0);
+        ASSERT(other != original);
+        ASSERT(dirac_references_get(original) == 2);
+        ASSERT(dirac_references_get(other) == 1);
+        ASSERT(memcmp(other, original, 9 * sizeof(dirac_complex_t)) == 0);
+        ((dirac_complex_t *)other)[4] = 42.0;
+        ASSERT(oo[4] == CMPLX(4.0, -4.0));
+
+        /* Owning it when no one else holds it is free. */
+        ASSERT(dirac_matrix_own(other) == other);
+
+        dirac_delete(copy);
+        ASSERT(dirac_references_get(original) == 1);
+        ASSERT(dirac_matrix_own(original) == original);
+        dirac_delete(other);
+        dirac_delete(original);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* A view is counted on its own, like any matrix from the cache. */
+        dirac_matrix_t * matrix = dirac_new_base(4, 4);
+        dirac_matrix_t * block = dirac_view_block(matrix, 1, 1, 2, 2);
+        dirac_matrix_t * copy;
+
+        ASSERT(dirac_references_get(block) == 1);
+        ASSERT(dirac_matrix_cow(block) == block);
+        ASSERT(dirac_references_get(block) == 2);
+        ASSERT(dirac_references_get(matrix) == 1);
+        copy = dirac_matrix_own(block);
+        ASSERT(copy != block);
+        ASSERT(dirac_kind_get(copy) == DIRAC_KIND_DENSE);
+        ASSERT(dirac_references_get(block) == 1);
+
+        dirac_delete(copy);
+        dirac_delete(block);
+        dirac_delete(matrix);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* One large operator held by many threads at once. */
+        static const int THREADS = 8;
+        dirac_matrix_t * shared = dirac_new_base(ORDER, ORDER);
+        pthread_t threads[THREADS];
+        void * result;
+        int ii;
+
+        for (ii = 0; ii < THREADS; ++ii) {
+            ASSERT(pthread_create(&(threads[ii]), (pthread_attr_t *)0, hold, shared) == 0);
+        }
+        for (ii = 0; ii < THREADS; ++ii) {
+            ASSERT(pthread_join(threads[ii], &result) == 0);
+            ASSERT(result == (void *)0);
+        }
+        ASSERT(dirac_references_get(shared) == 1);
+        ASSERT(((dirac_complex_t *)shared)[0] == 0.0);
+
+        dirac_delete(shared);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        DIRAC_OBJECT_CONST(2, 2) fixed = DIRAC_OBJECT_INIT(2, 2);
+
+        ASSERT(dirac_references_get(DIRAC_MATRIX_GET(fixed)) == 0);
+        errno = 0;
+        ASSERT(dirac_matrix_cow(DIRAC_MATRIX_GET(fixed)) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_matrix_cow((dirac_matrix_t *)0) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_matrix_own((dirac_matrix_t *)0) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
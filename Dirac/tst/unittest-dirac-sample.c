@@ -0,0 +1,259 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac measurement sampling functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac measurement sampling functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        /* Measuring |+>|0> gives |00> or |10> evenly and nothing else. */
+        DIRAC_OBJECT_CONST(4, 1) state =
+            DIRAC_OBJECT_INIT_BEGIN(4, 1)
+                { 0.70710678118654752+0.0i, },
+                { 0.0+0.0i, },
+                { 0.0+0.70710678118654752i, },
+                { 0.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        static const size_t COUNT = 100000;
+        uint64_t * shots = (uint64_t *)malloc(COUNT * sizeof(uint64_t));
+        dirac_sampler_t * sampler;
+        size_t counts[4] = { 0, };
+        size_t ii;
+
+        sampler = dirac_sampler_new(DIRAC_MATRIX_GET(state), DIRAC_SAMPLE_ALL);
+        ASSERT(sampler != (dirac_sampler_t *)0);
+        ASSERT(dirac_sampler_outcomes_get(sampler) == 4);
+        ASSERT(dirac_sampler_draw(sampler, 1, shots, COUNT) == COUNT);
+        for (ii = 0; ii < COUNT; ++ii) {
+            ASSERT(shots[ii] < 4);
+            counts[shots[ii]] += 1;
+        }
+        ASSERT(counts[1] == 0);
+        ASSERT(counts[3] == 0);
+        ASSERT(fabs(((double)counts[0] / COUNT) - 0.5) < 0.01);
+        dirac_sampler_delete(sampler);
+
+        /* The first qubit alone is evenly zero or one, the second zero. */
+        sampler = dirac_sampler_new(DIRAC_MATRIX_GET(state), 0x1);
+        ASSERT(sampler != (dirac_sampler_t *)0);
+        ASSERT(dirac_sampler_outcomes_get(sampler) == 2);
+        ASSERT(dirac_sampler_draw(sampler, 2, shots, COUNT) == COUNT);
+        counts[0] = counts[1] = 0;
+        for (ii = 0; ii < COUNT; ++ii) {
+            ASSERT(shots[ii] < 2);
+            counts[shots[ii]] += 1;
+        }
+        ASSERT(fabs(((double)counts[0] / COUNT) - 0.5) < 0.01);
+        dirac_sampler_delete(sampler);
+
+        sampler = dirac_sampler_new(DIRAC_MATRIX_GET(state), 0x2);
+        ASSERT(sampler != (dirac_sampler_t *)0);
+        ASSERT(dirac_sampler_draw(sampler, 3, shots, COUNT) == COUNT);
+        for (ii = 0; ii < COUNT; ++ii) {
+            ASSERT(shots[ii] == 0);
+        }
+        dirac_sampler_delete(sampler);
+
+        free(shots);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* An uneven distribution over many outcomes is followed closely. */
+        static const size_t ORDER = 1000;
+        static const size_t COUNT = 2000000;
+        dirac_matrix_t * vector = dirac_new_base(ORDER, 1);
+        dirac_complex_t * vv = (dirac_complex_t *)vector;
+        uint64_t * shots = (uint64_t *)malloc(COUNT * sizeof(uint64_t));
+        size_t * counts = (size_t *)calloc(ORDER, sizeof(size_t));
+        dirac_sampler_t * sampler;
+        double total = 0.0;
+        double expected;
+        double deviation;
+        size_t ii;
+
+        /* Weights 0, 1, 2, ..., with every seventh outcome impossible. */
+        for (ii = 0; ii < ORDER; ++ii) {
+            vv[ii] = ((ii % 7) == 0) ? 0.0 : CMPLX(sqrt((double)ii) * 0.6, sqrt((double)ii) * 0.8);
+            total += (double)(((ii % 7) == 0) ? 0 : ii);
+        }
+
+        sampler = dirac_sampler_new(vector, DIRAC_SAMPLE_ALL);
+        ASSERT(sampler != (dirac_sampler_t *)0);
+        ASSERT(dirac_sampler_outcomes_get(sampler) == ORDER);
+        ASSERT(dirac_sampler_draw(sampler, 0x5eed, shots, COUNT) == COUNT);
+        for (ii = 0; ii < COUNT; ++ii) {
+            ASSERT(shots[ii] < ORDER);
+            counts[shots[ii]] += 1;
+        }
+        for (ii = 0; ii < ORDER; ++ii) {
+            if ((ii % 7) == 0) {
+                ASSERT(counts[ii] == 0);
+            } else {
+                expected = (COUNT * (double)ii) / total;
+                deviation = sqrt(expected);
+                ASSERT(fabs(counts[ii] - expected) < (6.0 * deviation));
+            }
+        }
+        dirac_sampler_delete(sampler);
+
+        free(counts);
+        free(shots);
+        dirac_delete(vector);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* A seed gives the same shots on any number of threads. */
+        static const size_t QUBITS = 10;
+        static const size_t COUNT = 100003;
+        dirac_matrix_t * vector = dirac_new_base(1 << QUBITS, 1);
+        dirac_complex_t * vv = (dirac_complex_t *)vector;
+        uint64_t * one = (uint64_t *)malloc(COUNT * sizeof(uint64_t));
+        uint64_t * four = (uint64_t *)malloc(COUNT * sizeof(uint64_t));
+        dirac_sampler_t * sampler;
+        double weights[32];
+        size_t counts[32];
+        double total = 0.0;
+        double expected;
+        size_t outcome;
+        size_t prior;
+        size_t qq;
+        size_t ii;
+
+        for (ii = 0; ii < (1 << QUBITS); ++ii) {
+            vv[ii] = CMPLX(cos((double)ii), sin((double)(ii * ii)));
+        }
+
+        sampler = dirac_sampler_new(vector, 0x2a5);
+        ASSERT(sampler != (dirac_sampler_t *)0);
+        ASSERT(dirac_sampler_outcomes_get(sampler) == 32);
+
+        prior = dirac_threads_set(1);
+        ASSERT(dirac_sampler_draw(sampler, 42, one, COUNT) == COUNT);
+        dirac_threads_set(4);
+        ASSERT(dirac_sampler_draw(sampler, 42, four, COUNT) == COUNT);
+        ASSERT(memcmp(one, four, COUNT * sizeof(uint64_t)) == 0);
+        ASSERT(dirac_sampler_draw(sampler, 43, four, COUNT) == COUNT);
+        ASSERT(memcmp(one, four, COUNT * sizeof(uint64_t)) != 0);
+        dirac_threads_set(prior);
+
+        /* Qubit Q is bit QUBITS-1-Q of an index; kept qubits pack in order. */
+        memset(weights, 0, sizeof(weights));
+        memset(counts, 0, sizeof(counts));
+        for (ii = 0; ii < (1 << QUBITS); ++ii) {
+            outcome = 0;
+            for (qq = 0; qq < QUBITS; ++qq) {
+                if ((0x2a5 & (1 << qq)) != 0) {
+                    outcome = (outcome << 1) | ((ii >> (QUBITS - 1 - qq)) & 1);
+                }
+            }
+            weights[outcome] += creal(vv[ii] * conj(vv[ii]));
+            total += creal(vv[ii] * conj(vv[ii]));
+        }
+        for (ii = 0; ii < COUNT; ++ii) {
+            ASSERT(one[ii] < 32);
+            counts[one[ii]] += 1;
+        }
+        for (ii = 0; ii < 32; ++ii) {
+            expected = (COUNT * weights[ii]) / total;
+            ASSERT(fabs(counts[ii] - expected) < (6.0 * sqrt(expected) + 1.0));
+        }
+
+        dirac_sampler_delete(sampler);
+        free(four);
+        free(one);
+        dirac_delete(vector);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_matrix_t * zero = dirac_new_base(8, 1);
+        dirac_matrix_t * odd = dirac_new_base(6, 1);
+        dirac_matrix_t * square = dirac_new_base(2, 2);
+        uint64_t shot;
+
+        ((dirac_complex_t *)odd)[5] = 1.0;
+
+        errno = 0;
+        ASSERT(dirac_sampler_new(zero, DIRAC_SAMPLE_ALL) == (dirac_sampler_t *)0);
+        ASSERT(errno == EDOM);
+        errno = 0;
+        ASSERT(dirac_sampler_new(odd, 0x1) == (dirac_sampler_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_sampler_new(zero, 0x8) == (dirac_sampler_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_sampler_new(square, DIRAC_SAMPLE_ALL) == (dirac_sampler_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_sampler_draw((dirac_sampler_t *)0, 0, &shot, 1) == -1);
+        ASSERT(errno == EINVAL);
+
+        /* Any length will do for the whole vector. */
+        dirac_sampler_t * sampler = dirac_sampler_new(odd, DIRAC_SAMPLE_ALL);
+        ASSERT(sampler != (dirac_sampler_t *)0);
+        ASSERT(dirac_sampler_draw(sampler, 0, &shot, 1) == 1);
+        ASSERT(shot == 5);
+        ASSERT(dirac_sampler_draw(sampler, 0, (uint64_t *)0, 0) == 0);
+        dirac_sampler_delete(sampler);
+        dirac_sampler_delete((dirac_sampler_t *)0);
+
+        dirac_delete(square);
+        dirac_delete(odd);
+        dirac_delete(zero);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
@@ -0,0 +1,222 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac shared memory functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac shared memory functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include "unittest-dirac-primes.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+static const size_t ROWS = 17;
+
+static const size_t COLS = 9;
+
+static const int VERSIONS = 5;
+
+static void fill(dirac_matrix_t * them, int version)
+{
+    dirac_complex_t * body = (dirac_complex_t *)them;
+    size_t ii;
+    for (ii = 0; ii < (ROWS * COLS); ++ii) {
+        body[ii] = CMPLX(PRIMES[(ii + version) % 100], -version);
+    }
+}
+
+static int check(const dirac_matrix_t * them, int version)
+{
+    const dirac_complex_t * body = (const dirac_complex_t *)them;
+    size_t ii;
+    for (ii = 0; ii < (ROWS * COLS); ++ii) {
+        if (body[ii] != CMPLX(PRIMES[(ii + version) % 100], -version)) { return 0; }
+    }
+    return !0;
+}
+
+/*
+ * The consumer sees every version in order because the producer waits
+ * for it to say so (through the pipe) before publishing the next.
+ */
+static int consumer(const char * name, int ready)
+{
+    const dirac_matrix_t * them;
+    int64_t generation = 0;
+    int version;
+    int failures = 0;
+    char token = '.';
+    them = dirac_shared_attach(name);
+    if (them == (const dirac_matrix_t *)0) { return 1; }
+    if (dirac_rows_get(them) != ROWS) { ++failures; }
+    if (dirac_cols_get(them) != COLS) { ++failures; }
+    for (version = 1; version <= VERSIONS; ++version) {
+        generation = dirac_shared_wait(them, generation, 10000);
+        if (generation != (2 * version)) { ++failures; }
+        if (!check(them, version)) { ++failures; }
+        if (!dirac_shared_valid(them, generation)) { ++failures; }
+        if (write(ready, &token, 1) != 1) { ++failures; }
+    }
+    dirac_delete((dirac_matrix_t *)them);
+    return (failures == 0) ? 0 : 1;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    char name[64];
+    snprintf(name, sizeof(name), "/unittest-dirac-shared-%d", (int)getpid());
+
+    {
+        TEST();
+
+        dirac_matrix_t * them = dirac_shared_new(name, ROWS, COLS);
+        ASSERT(them != (dirac_matrix_t *)0);
+        ASSERT(dirac_rows_get(them) == ROWS);
+        ASSERT(dirac_cols_get(them) == COLS);
+        ASSERT(dirac_kind_get(them) == DIRAC_KIND_DENSE);
+        ASSERT(((dirac_complex_t *)them)[0] == 0.0);
+        ASSERT(dirac_shared_generation_get(them) == 0);
+
+        /* The name is taken until it is unlinked. */
+        ASSERT(dirac_shared_new(name, ROWS, COLS) == (dirac_matrix_t *)0);
+        ASSERT(errno == EEXIST);
+
+        /* Nothing published, so a wait times out. */
+        ASSERT(dirac_shared_wait(them, 0, 10) < 0);
+        ASSERT(errno == ETIMEDOUT);
+
+        /* Changes are visible to an attached view without copying. */
+        const dirac_matrix_t * view = dirac_shared_attach(name);
+        ASSERT(view != (const dirac_matrix_t *)0);
+        ASSERT(view != them);
+        ASSERT(dirac_shared_begin(them) == 0);
+        ASSERT(dirac_shared_generation_get(view) == 1);
+        ASSERT(dirac_shared_wait(view, 0, 0) < 0);
+        fill(them, 1);
+        ASSERT(dirac_shared_publish(them) == 2);
+        ASSERT(dirac_shared_wait(view, 0, 0) == 2);
+        ASSERT(check(view, 1));
+        ASSERT(dirac_shared_valid(view, 2));
+        ASSERT(dirac_shared_begin(them) == 0);
+        ASSERT(!dirac_shared_valid(view, 2));
+
+        /* Publishing without beginning still moves to the next even value. */
+        ASSERT(dirac_shared_publish(them) == 4);
+        ASSERT(dirac_shared_publish(them) == 6);
+
+        /* An attached view works as an operand. */
+        dirac_matrix_t * sum = dirac_matrix_add(view, view);
+        ASSERT(sum != (dirac_matrix_t *)0);
+        ASSERT(((dirac_complex_t *)sum)[0] == (2.0 * ((const dirac_complex_t *)view)[0]));
+        dirac_delete(sum);
+
+        dirac_delete((dirac_matrix_t *)view);
+        dirac_delete(them);
+        ASSERT(dirac_shared_unlink(name) == 0);
+        ASSERT(dirac_shared_attach(name) == (const dirac_matrix_t *)0);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_matrix_t * them = dirac_shared_new(name, ROWS, COLS);
+        ASSERT(them != (dirac_matrix_t *)0);
+
+        int ready[2];
+        ASSERT(pipe(ready) == 0);
+
+        pid_t pid = fork();
+        ASSERT(pid >= 0);
+        if (pid == 0) {
+            close(ready[0]);
+            _exit(consumer(name, ready[1]));
+        }
+        close(ready[1]);
+
+        int version;
+        char token;
+        for (version = 1; version <= VERSIONS; ++version) {
+            ASSERT(dirac_shared_begin(them) == 0);
+            fill(them, version);
+            ASSERT(dirac_shared_publish(them) == (2 * version));
+            ASSERT(read(ready[0], &token, 1) == 1);
+        }
+        close(ready[0]);
+
+        int status = -1;
+        ASSERT(waitpid(pid, &status, 0) == pid);
+        ASSERT(WIFEXITED(status));
+        ASSERT(WEXITSTATUS(status) == 0);
+
+        dirac_delete(them);
+        ASSERT(dirac_shared_unlink(name) == 0);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Only shared segments have generations. */
+        dirac_matrix_t * them = dirac_new_base(2, 2);
+        ASSERT(dirac_shared_begin(them) < 0);
+        ASSERT(dirac_shared_publish(them) < 0);
+        ASSERT(dirac_shared_generation_get(them) < 0);
+        ASSERT(dirac_shared_wait(them, 0, 0) < 0);
+        ASSERT(!dirac_shared_valid(them, 0));
+
+        char path[] = "/tmp/unittest-dirac-shared-XXXXXX";
+        close(mkstemp(path));
+        ASSERT(dirac_store(path, them) > 0);
+        const dirac_matrix_t * view = dirac_load(path);
+        ASSERT(view != (const dirac_matrix_t *)0);
+        ASSERT(dirac_shared_generation_get(view) < 0);
+        dirac_unload(view);
+        unlink(path);
+
+        dirac_delete(them);
+
+        ASSERT(dirac_shared_new(name, 0, COLS) == (dirac_matrix_t *)0);
+        ASSERT(dirac_shared_attach("/unittest-dirac-shared-nonexistent") == (const dirac_matrix_t *)0);
+        ASSERT(dirac_shared_unlink("/unittest-dirac-shared-nonexistent") < 0);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
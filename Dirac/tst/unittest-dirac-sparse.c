@@ -0,0 +1,338 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac sparse functions and related.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac sparse functions and related.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include "unittest-dirac-fixtures.h"
+#include "unittest-dirac-primes.h"
+#include <math.h>
+#include <pthread.h>
+
+static dirac_matrix_t * banded(size_t rows, size_t cols, size_t band)
+{
+    dirac_matrix_t * them = dirac_new_base(rows, cols);
+    dirac_complex_t * body = (dirac_complex_t *)them;
+    size_t rr;
+    size_t cc;
+    for (rr = 0; rr < rows; ++rr) {
+        for (cc = 0; cc < cols; ++cc) {
+            if ((rr > (cc + band)) || (cc > (rr + band))) { continue; }
+            body[(rr * cols) + cc] = CMPLX(PRIMES[(rr + cc) % 100] % 11, (PRIMES[(rr * cc) % 100] % 7) - 3.0);
+        }
+    }
+    return them;
+}
+
+static void * toggle(void * arg)
+{
+    int * donep = (int *)arg;
+    size_t count = 1;
+    while (!__atomic_load_n(donep, __ATOMIC_RELAXED)) {
+        (void)dirac_threads_set(count);
+        count = (count % 4) + 1;
+    }
+    return (void *)0;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        size_t prior = dirac_threads_set(3);
+        ASSERT(dirac_threads_get() == 3);
+        ASSERT(dirac_threads_set(0) == 3);
+        ASSERT(dirac_threads_get() >= 1);
+        dirac_threads_set(prior);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        DIRAC_OBJECT_CONST(4, 4) those = 
+            DIRAC_OBJECT_INIT_BEGIN(4, 4)
+                { 1.0+0.0i, 0.0+0.0i, 0.0+0.0i, 0.0+0.0i, },
+                { 0.0+0.0i, 1.0+0.0i, 0.0+0.0i, 0.0+0.0i, },
+                { 0.0+0.0i, 0.0+0.0i, 0.0+0.0i, 1.0+0.0i, },
+                { 0.0+0.0i, 0.0+0.0i, 1.0+0.0i, 0.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        const dirac_complex_t (*them)[4][4] = DIRAC_MATRIX_GET(those);
+
+        ASSERT(dirac_kind_get(them) == DIRAC_KIND_DENSE);
+        ASSERT(dirac_sparse_columns_get(them) == (const size_t *)0);
+
+        dirac_matrix_t * that = dirac_sparse_from_dense(them);
+        ASSERT(that != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(that) == DIRAC_KIND_SPARSE);
+        ASSERT(dirac_rows_get(that) == 4);
+        ASSERT(dirac_cols_get(that) == 4);
+        ASSERT(dirac_sparse_count_get(that) == 4);
+
+        dirac_print(stdout, that);
+
+        static const size_t COLUMNS[] = { 0, 1, 3, 2, };
+        static const size_t OFFSETS[] = { 0, 1, 2, 3, 4, };
+        const size_t * columns = dirac_sparse_columns_get(that);
+        const size_t * offsets = dirac_sparse_offsets_get(that);
+        int ii;
+        for (ii = 0; ii < 4; ++ii) {
+            ASSERT(columns[ii] == COLUMNS[ii]);
+            ASSERT(((const dirac_complex_t *)that)[ii] == 1.0);
+        }
+        for (ii = 0; ii < 5; ++ii) {
+            ASSERT(offsets[ii] == OFFSETS[ii]);
+        }
+
+        dirac_matrix_t * dup = dirac_matrix_dup(that);
+        ASSERT(dup != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(dup) == DIRAC_KIND_SPARSE);
+        ASSERT(dirac_sparse_count_get(dup) == 4);
+
+        dirac_matrix_t * dense = dirac_sparse_to_dense(dup);
+        ASSERT(dense != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(dense) == DIRAC_KIND_DENSE);
+        ASSERT(equivalent(dense, them));
+
+        ASSERT(dirac_matrix_add(that, them) == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_had(them, that) == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_trn(that) == (dirac_matrix_t *)0);
+        ASSERT(dirac_sparse_from_dense(that) == (dirac_matrix_t *)0);
+        ASSERT(dirac_sparse_to_dense(them) == (dirac_matrix_t *)0);
+
+        dirac_delete(dense);
+        dirac_delete(dup);
+        dirac_delete(that);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_matrix_t * that = dirac_sparse_new(2, 3, 2);
+        ASSERT(that != (dirac_matrix_t *)0);
+        ASSERT(dirac_sparse_count_get(that) == 2);
+
+        dirac_complex_t * values = (dirac_complex_t *)that;
+        size_t * columns = dirac_sparse_columns_mut(that);
+        size_t * offsets = dirac_sparse_offsets_mut(that);
+        values[0] = 2.0+1.0i;
+        columns[0] = 2;
+        values[1] = -1.0;
+        columns[1] = 0;
+        offsets[0] = 0;
+        offsets[1] = 1;
+        offsets[2] = 2;
+
+        dirac_complex_t (*dense)[2][3] = dirac_sparse_to_dense(that);
+        ASSERT(dense != (dirac_complex_t (*)[2][3])0);
+        ASSERT((*dense)[0][0] == 0);
+        ASSERT((*dense)[0][2] == (2.0+1.0i));
+        ASSERT((*dense)[1][0] == -1.0);
+        ASSERT((*dense)[1][2] == 0);
+
+        dirac_delete(dense);
+        dirac_delete(that);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        static const size_t ROWS = 96;
+        static const size_t MULS = 80;
+        static const size_t COLS = 48;
+
+        size_t prior = dirac_threads_set(4);
+
+        dirac_matrix_t * densea = banded(ROWS, MULS, 2);
+        dirac_matrix_t * denseb = banded(MULS, COLS, 1);
+        dirac_matrix_t * densev = banded(MULS, 1, MULS);
+        dirac_matrix_t * sparsea = dirac_sparse_from_dense(densea);
+        dirac_matrix_t * sparseb = dirac_sparse_from_dense(denseb);
+        ASSERT(sparsea != (dirac_matrix_t *)0);
+        ASSERT(sparseb != (dirac_matrix_t *)0);
+        ASSERT(dirac_sparse_count_get(sparsea) < (ROWS * 5));
+
+        dirac_matrix_t * expected = dirac_matrix_mul(densea, denseb);
+        ASSERT(expected != (dirac_matrix_t *)0);
+
+        dirac_matrix_t * that;
+
+        that = dirac_matrix_mul(sparsea, denseb);
+        ASSERT(that != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(that) == DIRAC_KIND_DENSE);
+        ASSERT(equivalent(that, expected));
+        dirac_delete(that);
+
+        that = dirac_matrix_mul(densea, sparseb);
+        ASSERT(that != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(that) == DIRAC_KIND_DENSE);
+        ASSERT(equivalent(that, expected));
+        dirac_delete(that);
+
+        dirac_matrix_t * product = dirac_matrix_mul(sparsea, sparseb);
+        ASSERT(product != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(product) == DIRAC_KIND_SPARSE);
+        that = dirac_sparse_to_dense(product);
+        ASSERT(that != (dirac_matrix_t *)0);
+        ASSERT(equivalent(that, expected));
+        dirac_delete(that);
+        dirac_delete(product);
+
+        dirac_delete(expected);
+
+        expected = dirac_matrix_mul(densea, densev);
+        ASSERT(expected != (dirac_matrix_t *)0);
+        that = dirac_matrix_mul(sparsea, densev);
+        ASSERT(that != (dirac_matrix_t *)0);
+        ASSERT(dirac_rows_get(that) == ROWS);
+        ASSERT(dirac_cols_get(that) == 1);
+        ASSERT(equivalent(that, expected));
+        dirac_delete(that);
+        dirac_delete(expected);
+
+        ASSERT(dirac_matrix_mul(sparseb, sparsea) == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_mul(sparsea, densea) == (dirac_matrix_t *)0);
+
+        dirac_delete(sparseb);
+        dirac_delete(sparsea);
+        dirac_delete(densev);
+        dirac_delete(denseb);
+        dirac_delete(densea);
+
+        dirac_threads_set(prior);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* The thread count may change while another thread is multiplying. */
+        dirac_matrix_t * densea = banded(64, 64, 3);
+        dirac_matrix_t * denseb = banded(64, 64, 2);
+        dirac_matrix_t * sparsea = dirac_sparse_from_dense(densea);
+        dirac_matrix_t * expected = dirac_matrix_mul(densea, denseb);
+        dirac_matrix_t * that;
+        int done = 0;
+        pthread_t thread;
+        size_t ii;
+
+        ASSERT(sparsea != (dirac_matrix_t *)0);
+        ASSERT(expected != (dirac_matrix_t *)0);
+        ASSERT(pthread_create(&thread, (pthread_attr_t *)0, toggle, (void *)&done) == 0);
+        for (ii = 0; ii < 200; ++ii) {
+            that = dirac_matrix_mul(sparsea, denseb);
+            ASSERT(that != (dirac_matrix_t *)0);
+            ASSERT(equivalent(that, expected));
+            dirac_delete(that);
+        }
+        __atomic_store_n(&done, !0, __ATOMIC_RELAXED);
+        ASSERT(pthread_join(thread, (void **)0) == 0);
+        dirac_threads_set(0);
+
+        dirac_delete(expected);
+        dirac_delete(sparsea);
+        dirac_delete(denseb);
+        dirac_delete(densea);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        DIRAC_OBJECT_CONST(2, 2) pauliz = 
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { 1.0+0.0i, 0.0+0.0i, },
+                { 0.0+0.0i, -1.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        const dirac_complex_t (*z)[2][2] = DIRAC_MATRIX_GET(pauliz);
+
+        DIRAC_OBJECT_CONST(2, 3) other = 
+            DIRAC_OBJECT_INIT_BEGIN(2, 3)
+                { 0.0+1.0i, 0.0+0.0i, 2.0+0.0i, },
+                { 0.0+0.0i, 3.0-1.0i, 0.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        const dirac_complex_t (*o)[2][3] = DIRAC_MATRIX_GET(other);
+
+        dirac_matrix_t * sparsez = dirac_sparse_from_dense(z);
+        dirac_matrix_t * sparseo = dirac_sparse_from_dense(o);
+        dirac_matrix_t * expected = dirac_matrix_kro(z, o);
+        ASSERT(expected != (dirac_matrix_t *)0);
+        ASSERT(dirac_rows_get(expected) == 4);
+        ASSERT(dirac_cols_get(expected) == 6);
+
+        dirac_matrix_t * that;
+        dirac_matrix_t * dense;
+
+        that = dirac_matrix_kro(sparsez, sparseo);
+        ASSERT(that != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(that) == DIRAC_KIND_SPARSE);
+        ASSERT(dirac_sparse_count_get(that) == 6);
+        dirac_print(stdout, that);
+        dense = dirac_sparse_to_dense(that);
+        ASSERT(equivalent(dense, expected));
+        dirac_delete(dense);
+        dirac_delete(that);
+
+        that = dirac_matrix_kro(z, sparseo);
+        ASSERT(that != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(that) == DIRAC_KIND_SPARSE);
+        dense = dirac_sparse_to_dense(that);
+        ASSERT(equivalent(dense, expected));
+        dirac_delete(dense);
+        dirac_delete(that);
+
+        that = dirac_matrix_kro(sparsez, o);
+        ASSERT(that != (dirac_matrix_t *)0);
+        dense = dirac_sparse_to_dense(that);
+        ASSERT(equivalent(dense, expected));
+        dirac_delete(dense);
+        dirac_delete(that);
+
+        dirac_delete(expected);
+        dirac_delete(sparseo);
+        dirac_delete(sparsez);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
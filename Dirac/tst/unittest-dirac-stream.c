@@ -0,0 +1,198 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac streaming functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac streaming functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include "unittest-dirac-fixtures.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <errno.h>
+
+static int matches(const char * path, const dirac_matrix_t * them)
+{
+    int rc = 0;
+    const dirac_matrix_t * view = dirac_load(path);
+    if (view == (const dirac_matrix_t *)0) {
+        /* Do nothing. */
+    } else if (dirac_rows_get(view) != dirac_rows_get(them)) {
+        /* Do nothing. */
+    } else if (dirac_cols_get(view) != dirac_cols_get(them)) {
+        /* Do nothing. */
+    } else {
+        rc = (memcmp(view, them, dirac_rows_get(them) * dirac_cols_get(them) * sizeof(dirac_complex_t)) == 0);
+    }
+    dirac_unload(view);
+    return rc;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    char patha[] = "/tmp/unittest-dirac-stream-a-XXXXXX";
+    char pathb[] = "/tmp/unittest-dirac-stream-b-XXXXXX";
+    char pathc[] = "/tmp/unittest-dirac-stream-c-XXXXXX";
+    close(mkstemp(patha));
+    close(mkstemp(pathb));
+    close(mkstemp(pathc));
+
+    {
+        TEST();
+
+        dirac_matrix_t * them = filled(10, 3, 1);
+        ASSERT(dirac_store(patha, them) > 0);
+
+        dirac_stream_t * reader = dirac_stream_reader(patha, 4);
+        ASSERT(reader != (dirac_stream_t *)0);
+        ASSERT(dirac_stream_rows_get(reader) == 10);
+        ASSERT(dirac_stream_cols_get(reader) == 3);
+        ASSERT(dirac_stream_block_get(reader) == 4);
+
+        dirac_stream_t * writer = dirac_stream_writer(pathc, 10, 3, 4);
+        ASSERT(writer != (dirac_stream_t *)0);
+
+        /* Copy block by block: 4, 4 and then the 2 rows that are left. */
+        static const size_t ROWS[] = { 4, 4, 2, };
+        const dirac_matrix_t * block;
+        dirac_matrix_t * target;
+        size_t blocks = 0;
+        while ((block = dirac_stream_read(reader)) != (const dirac_matrix_t *)0) {
+            ASSERT(blocks < (sizeof(ROWS) / sizeof(ROWS[0])));
+            ASSERT(dirac_rows_get(block) == ROWS[blocks]);
+            ASSERT(dirac_stream_row_get(reader) == (blocks * 4));
+            ASSERT(memcmp(block, &(((dirac_complex_t *)them)[blocks * 4 * 3]), ROWS[blocks] * 3 * sizeof(dirac_complex_t)) == 0);
+            target = dirac_stream_block(writer);
+            ASSERT(target != (dirac_matrix_t *)0);
+            ASSERT(dirac_rows_get(target) == ROWS[blocks]);
+            memcpy(target, block, ROWS[blocks] * 3 * sizeof(dirac_complex_t));
+            ASSERT(dirac_stream_write(writer) == 0);
+            ++blocks;
+        }
+        ASSERT(errno == 0);
+        ASSERT(blocks == 3);
+        ASSERT(dirac_stream_block(writer) == (dirac_matrix_t *)0);
+
+        ASSERT(dirac_stream_close(writer) == 0);
+        ASSERT(dirac_stream_close(reader) == 0);
+        ASSERT(matches(pathc, them));
+
+        /* A writer that is not given every row fails on close. */
+        writer = dirac_stream_writer(pathc, 10, 3, 4);
+        ASSERT(writer != (dirac_stream_t *)0);
+        ASSERT(dirac_stream_write(writer) < 0);
+        ASSERT(dirac_stream_block(writer) != (dirac_matrix_t *)0);
+        ASSERT(dirac_stream_write(writer) == 0);
+        ASSERT(dirac_stream_close(writer) < 0);
+
+        dirac_delete(them);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_matrix_t * thema = filled(23, 7, 2);
+        dirac_matrix_t * themb = filled(23, 7, 3);
+        ASSERT(dirac_store(patha, thema) > 0);
+        ASSERT(dirac_store(pathb, themb) > 0);
+
+        dirac_matrix_t * sum = dirac_matrix_add(thema, themb);
+        ASSERT(dirac_stream_add(pathc, patha, pathb, 5) == 23);
+        ASSERT(matches(pathc, sum));
+        ASSERT(dirac_stream_add(pathc, patha, pathb, 0) == 23);
+        ASSERT(matches(pathc, sum));
+        dirac_delete(sum);
+
+        dirac_matrix_t * product = dirac_matrix_had(thema, themb);
+        ASSERT(dirac_stream_had(pathc, patha, pathb, 1) == 23);
+        ASSERT(matches(pathc, product));
+        dirac_delete(product);
+
+        dirac_matrix_t * other = filled(7, 23, 4);
+        ASSERT(dirac_store(pathb, other) > 0);
+        ASSERT(dirac_stream_add(pathc, patha, pathb, 5) < 0);
+        dirac_delete(other);
+
+        dirac_delete(themb);
+        dirac_delete(thema);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_matrix_t * thema = filled(31, 8, 5);
+        dirac_matrix_t * vector = filled(8, 1, 6);
+        dirac_matrix_t * wide = filled(8, 3, 7);
+        dirac_matrix_t * product;
+        ASSERT(dirac_store(patha, thema) > 0);
+
+        product = dirac_matrix_mul(thema, vector);
+        ASSERT(dirac_stream_mul(pathc, patha, vector, 8) == 31);
+        ASSERT(matches(pathc, product));
+        dirac_delete(product);
+
+        product = dirac_matrix_mul(thema, wide);
+        ASSERT(dirac_stream_mul(pathc, patha, wide, 3) == 31);
+        ASSERT(matches(pathc, product));
+        dirac_delete(product);
+
+        ASSERT(dirac_stream_mul(pathc, patha, thema, 3) < 0);
+
+        errno = 0;
+        ASSERT(dirac_stream_mul(pathc, patha, (dirac_matrix_t *)0, 3) < 0);
+        ASSERT(errno == EINVAL);
+
+        /* Only dense files can be streamed. */
+        dirac_matrix_t * diagonal = dirac_diagonal_new(8);
+        ASSERT(dirac_store(pathb, diagonal) > 0);
+        ASSERT(dirac_stream_reader(pathb, 0) == (dirac_stream_t *)0);
+        dirac_delete(diagonal);
+
+        dirac_delete(wide);
+        dirac_delete(vector);
+        dirac_delete(thema);
+
+        STATUS();
+    }
+
+    unlink(pathc);
+    unlink(pathb);
+    unlink(patha);
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
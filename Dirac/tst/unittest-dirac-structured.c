@@ -0,0 +1,277 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac diagonal and permutation functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac diagonal and permutation functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include "unittest-dirac-fixtures.h"
+#include <math.h>
+
+/*
+ * Compares a matrix of any kind against a dense one and deletes it.
+ */
+static int consume(dirac_matrix_t * them, const dirac_matrix_t * expected, dirac_kind_t kind)
+{
+    dirac_matrix_t * dense = (dirac_matrix_t *)0;
+    int result = 0;
+    if (them == (dirac_matrix_t *)0) {
+        /* Do nothing. */
+    } else if (dirac_kind_get(them) != kind) {
+        /* Do nothing. */
+    } else if (kind == DIRAC_KIND_DENSE) {
+        result = equivalent(them, expected);
+    } else if (kind == DIRAC_KIND_SPARSE) {
+        dense = dirac_sparse_to_dense(them);
+        result = equivalent(dense, expected);
+    } else {
+        dense = dirac_structured_to_dense(them);
+        result = equivalent(dense, expected);
+    }
+    if (dense != (dirac_matrix_t *)0) { dirac_delete(dense); }
+    if (them != (dirac_matrix_t *)0) { dirac_delete(them); }
+    return result;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        dirac_matrix_t * diagonal = dirac_diagonal_new(4);
+        ASSERT(diagonal != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(diagonal) == DIRAC_KIND_DIAGONAL);
+        ASSERT(dirac_rows_get(diagonal) == 4);
+        ASSERT(dirac_cols_get(diagonal) == 4);
+        ASSERT(dirac_permutation_columns_get(diagonal) == (const size_t *)0);
+
+        dirac_complex_t * values = (dirac_complex_t *)diagonal;
+        int ii;
+        for (ii = 0; ii < 4; ++ii) {
+            ASSERT(values[ii] == 0);
+            values[ii] = cexp(I * M_PI * ii / 4.0);
+        }
+
+        dirac_print(stdout, diagonal);
+
+        dirac_complex_t (*dense)[4][4] = dirac_structured_to_dense(diagonal);
+        ASSERT(dense != (dirac_complex_t (*)[4][4])0);
+        int rr;
+        int cc;
+        for (rr = 0; rr < 4; ++rr) {
+            for (cc = 0; cc < 4; ++cc) {
+                ASSERT((*dense)[rr][cc] == ((rr == cc) ? values[rr] : 0));
+            }
+        }
+
+        dirac_matrix_t * other = filled(4, 3, 0);
+        dirac_matrix_t * expected = dirac_matrix_mul(dense, other);
+        ASSERT(consume(dirac_matrix_mul(diagonal, other), expected, DIRAC_KIND_DENSE));
+        dirac_delete(expected);
+        dirac_delete(other);
+
+        other = filled(5, 4, 0);
+        expected = dirac_matrix_mul(other, dense);
+        ASSERT(consume(dirac_matrix_mul(other, diagonal), expected, DIRAC_KIND_DENSE));
+        dirac_delete(expected);
+        dirac_delete(other);
+
+        expected = dirac_matrix_mul(dense, dense);
+        ASSERT(consume(dirac_matrix_mul(diagonal, diagonal), expected, DIRAC_KIND_DIAGONAL));
+        dirac_delete(expected);
+
+        ASSERT(consume(dirac_matrix_trn(diagonal), dense, DIRAC_KIND_DIAGONAL));
+        ASSERT(consume(dirac_matrix_dup(diagonal), dense, DIRAC_KIND_DIAGONAL));
+
+        other = filled(3, 3, 0);
+        ASSERT(dirac_matrix_mul(diagonal, other) == (dirac_matrix_t *)0);
+        ASSERT(dirac_matrix_add(diagonal, dense) == (dirac_matrix_t *)0);
+        ASSERT(dirac_structured_to_dense(other) == (dirac_matrix_t *)0);
+        dirac_delete(other);
+
+        dirac_delete(dense);
+        dirac_delete(diagonal);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        DIRAC_OBJECT_CONST(4, 4) cnot = 
+            DIRAC_OBJECT_INIT_BEGIN(4, 4)
+                { 1.0+0.0i, 0.0+0.0i, 0.0+0.0i, 0.0+0.0i, },
+                { 0.0+0.0i, 1.0+0.0i, 0.0+0.0i, 0.0+0.0i, },
+                { 0.0+0.0i, 0.0+0.0i, 0.0+0.0i, 1.0+0.0i, },
+                { 0.0+0.0i, 0.0+0.0i, 1.0+0.0i, 0.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        const dirac_complex_t (*densecnot)[4][4] = DIRAC_MATRIX_GET(cnot);
+
+        DIRAC_OBJECT_CONST(2, 2) pauliy = 
+            DIRAC_OBJECT_INIT_BEGIN(2, 2)
+                { 0.0+0.0i, 0.0-1.0i, },
+                { 0.0+1.0i, 0.0+0.0i, },
+            DIRAC_OBJECT_INIT_END;
+        const dirac_complex_t (*densey)[2][2] = DIRAC_MATRIX_GET(pauliy);
+
+        dirac_matrix_t * permcnot = dirac_permutation_new(4);
+        ASSERT(permcnot != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(permcnot) == DIRAC_KIND_PERMUTATION);
+        size_t * columns = dirac_permutation_columns_mut(permcnot);
+        ASSERT(columns != (size_t *)0);
+        ASSERT(columns[3] == 3);
+        ASSERT(((dirac_complex_t *)permcnot)[3] == 1);
+        columns[2] = 3;
+        columns[3] = 2;
+
+        dirac_matrix_t * permy = dirac_permutation_new(2);
+        ASSERT(permy != (dirac_matrix_t *)0);
+        columns = dirac_permutation_columns_mut(permy);
+        columns[0] = 1;
+        columns[1] = 0;
+        ((dirac_complex_t *)permy)[0] = -1.0i;
+        ((dirac_complex_t *)permy)[1] = 1.0i;
+
+        dirac_print(stdout, permy);
+
+        ASSERT(consume(dirac_matrix_dup(permcnot), densecnot, DIRAC_KIND_PERMUTATION));
+        ASSERT(consume(dirac_matrix_dup(permy), densey, DIRAC_KIND_PERMUTATION));
+
+        dirac_matrix_t * expected;
+        dirac_matrix_t * other;
+
+        expected = dirac_matrix_trn(densey);
+        ASSERT(consume(dirac_matrix_trn(permy), expected, DIRAC_KIND_PERMUTATION));
+        dirac_delete(expected);
+
+        other = filled(4, 6, 0);
+        expected = dirac_matrix_mul(densecnot, other);
+        ASSERT(consume(dirac_matrix_mul(permcnot, other), expected, DIRAC_KIND_DENSE));
+        dirac_delete(expected);
+        dirac_delete(other);
+
+        other = filled(3, 2, 0);
+        expected = dirac_matrix_mul(other, densey);
+        ASSERT(consume(dirac_matrix_mul(other, permy), expected, DIRAC_KIND_DENSE));
+        dirac_delete(expected);
+        dirac_delete(other);
+
+        expected = dirac_matrix_mul(densey, densey);
+        ASSERT(consume(dirac_matrix_mul(permy, permy), expected, DIRAC_KIND_PERMUTATION));
+        dirac_delete(expected);
+
+        dirac_matrix_t * diagonal = dirac_diagonal_new(2);
+        ((dirac_complex_t *)diagonal)[0] = 2.0;
+        ((dirac_complex_t *)diagonal)[1] = 3.0i;
+        dirac_matrix_t * densediagonal = dirac_structured_to_dense(diagonal);
+
+        expected = dirac_matrix_mul(densediagonal, densey);
+        ASSERT(consume(dirac_matrix_mul(diagonal, permy), expected, DIRAC_KIND_PERMUTATION));
+        dirac_delete(expected);
+
+        expected = dirac_matrix_mul(densey, densediagonal);
+        ASSERT(consume(dirac_matrix_mul(permy, diagonal), expected, DIRAC_KIND_PERMUTATION));
+        dirac_delete(expected);
+
+        expected = dirac_matrix_kro(densecnot, densey);
+        ASSERT(consume(dirac_matrix_kro(permcnot, permy), expected, DIRAC_KIND_PERMUTATION));
+        dirac_delete(expected);
+
+        expected = dirac_matrix_kro(densediagonal, densediagonal);
+        ASSERT(consume(dirac_matrix_kro(diagonal, diagonal), expected, DIRAC_KIND_DIAGONAL));
+        dirac_delete(expected);
+
+        expected = dirac_matrix_kro(densediagonal, densecnot);
+        ASSERT(consume(dirac_matrix_kro(diagonal, permcnot), expected, DIRAC_KIND_PERMUTATION));
+        dirac_delete(expected);
+
+        other = filled(2, 3, 0);
+        expected = dirac_matrix_kro(densey, other);
+        ASSERT(consume(dirac_matrix_kro(permy, other), expected, DIRAC_KIND_SPARSE));
+        dirac_delete(expected);
+
+        dirac_matrix_t * sparse = dirac_sparse_from_dense(other);
+        expected = dirac_matrix_mul(densey, other);
+        ASSERT(consume(dirac_matrix_mul(permy, sparse), expected, DIRAC_KIND_SPARSE));
+        dirac_delete(expected);
+        dirac_delete(sparse);
+        dirac_delete(other);
+
+        dirac_delete(densediagonal);
+        dirac_delete(diagonal);
+        dirac_delete(permy);
+        dirac_delete(permcnot);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        static const size_t ORDER = 512;
+        static const size_t COLS = 256;
+
+        size_t prior = dirac_threads_set(4);
+
+        dirac_matrix_t * perm = dirac_permutation_new(ORDER);
+        size_t * columns = dirac_permutation_columns_mut(perm);
+        dirac_complex_t * phases = (dirac_complex_t *)perm;
+        size_t rr;
+        for (rr = 0; rr < ORDER; ++rr) {
+            columns[rr] = (rr * 7) % ORDER;
+            phases[rr] = cexp(I * (double)rr);
+        }
+
+        dirac_matrix_t * dense = dirac_structured_to_dense(perm);
+        dirac_matrix_t * other = filled(ORDER, COLS, 0);
+        dirac_matrix_t * expected = dirac_matrix_mul(dense, other);
+        ASSERT(consume(dirac_matrix_mul(perm, other), expected, DIRAC_KIND_DENSE));
+        dirac_delete(expected);
+        dirac_delete(other);
+
+        other = filled(COLS, ORDER, 0);
+        expected = dirac_matrix_mul(other, dense);
+        ASSERT(consume(dirac_matrix_mul(other, perm), expected, DIRAC_KIND_DENSE));
+        dirac_delete(expected);
+        dirac_delete(other);
+
+        dirac_delete(dense);
+        dirac_delete(perm);
+
+        dirac_threads_set(prior);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
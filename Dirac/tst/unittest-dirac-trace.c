@@ -0,0 +1,312 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac tracing functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac tracing functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int ROUNDS = 1000;
+
+static void * work(void * arg)
+{
+    dirac_matrix_t * aa = dirac_new_base(4, 4);
+    dirac_matrix_t * bb = dirac_new_base(4, 4);
+    dirac_matrix_t * cc;
+    int ii;
+    for (ii = 0; ii < ROUNDS; ++ii) {
+        cc = dirac_matrix_add(aa, bb);
+        dirac_delete(cc);
+    }
+    dirac_delete(bb);
+    dirac_delete(aa);
+    return (void *)0;
+}
+
+static uint64_t histogram(const dirac_trace_statistics_t * sp)
+{
+    uint64_t total = 0;
+    size_t ii;
+    for (ii = 0; ii < DIRAC_TRACE_BUCKETS; ++ii) {
+        total += sp->histogram[ii];
+    }
+    return total;
+}
+
+static uint64_t calls(void)
+{
+    dirac_trace_statistics_t statistics[DIRAC_TRACE_OPERATIONS];
+    uint64_t total = 0;
+    size_t ii;
+    if (dirac_trace_snapshot(statistics) == 0) {
+        for (ii = 0; ii < DIRAC_TRACE_OPERATIONS; ++ii) {
+            total += statistics[ii].calls;
+        }
+    }
+    return total;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        ASSERT(strcmp(dirac_trace_name(DIRAC_TRACE_MUL), "dirac_matrix_mul") == 0);
+        ASSERT(strcmp(dirac_trace_name(DIRAC_TRACE_EXPM_MULTIPLY), "dirac_matrix_expm_multiply") == 0);
+        ASSERT(dirac_trace_name(DIRAC_TRACE_OPERATIONS) == (const char *)0);
+
+        errno = 0;
+        ASSERT(dirac_trace_snapshot((dirac_trace_statistics_t *)0) < 0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_trace_export((FILE *)0) < 0);
+        ASSERT(errno == EINVAL);
+
+        STATUS();
+    }
+
+    /* The rest needs the tracing built into the library. */
+    errno = 0;
+    if ((dirac_trace_set(DIRAC_TRACE_OFF) < 0) && (errno == ENOSYS)) {
+        fprintf(stderr, "tracing is not built in\n");
+        EXIT();
+    }
+
+    {
+        TEST();
+
+        /* Off by default: nothing is counted. */
+        dirac_matrix_t * aa = dirac_new_base(2, 2);
+        dirac_matrix_t * cc;
+
+        ASSERT(dirac_trace_get() == DIRAC_TRACE_OFF);
+        cc = dirac_matrix_mul(aa, aa);
+        dirac_delete(cc);
+        ASSERT(calls() == 0);
+
+        dirac_delete(aa);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_trace_statistics_t statistics[DIRAC_TRACE_OPERATIONS];
+        dirac_matrix_t * aa = dirac_new_base(8, 8);
+        dirac_matrix_t * bb = dirac_new_base(2, 2);
+        dirac_matrix_t * cc;
+        int ii;
+
+        ASSERT(dirac_trace_set(DIRAC_TRACE_COUNT) == DIRAC_TRACE_OFF);
+        ASSERT(dirac_trace_get() == DIRAC_TRACE_COUNT);
+
+        for (ii = 0; ii < 3; ++ii) {
+            cc = dirac_matrix_mul(aa, aa);
+            dirac_delete(cc);
+        }
+        for (ii = 0; ii < 2; ++ii) {
+            cc = dirac_matrix_kro(aa, bb);
+            dirac_delete(cc);
+        }
+
+        ASSERT(dirac_trace_snapshot(statistics) == 0);
+        ASSERT(statistics[DIRAC_TRACE_MUL].calls == 3);
+        ASSERT(statistics[DIRAC_TRACE_KRO].calls == 2);
+        ASSERT(statistics[DIRAC_TRACE_ADD].calls == 0);
+        ASSERT(histogram(&(statistics[DIRAC_TRACE_MUL])) == 3);
+        ASSERT(histogram(&(statistics[DIRAC_TRACE_KRO])) == 2);
+        ASSERT(statistics[DIRAC_TRACE_MUL].cycles > 0);
+        ASSERT(statistics[DIRAC_TRACE_MUL].nanoseconds > 0);
+        /* Two 8x8 operands and an 8x8 result, each time. */
+        ASSERT(statistics[DIRAC_TRACE_MUL].bytes == (3 * 3 * 8 * 8 * sizeof(dirac_complex_t)));
+        /* An 8x8 and a 2x2 operand and a 16x16 result, each time. */
+        ASSERT(statistics[DIRAC_TRACE_KRO].bytes == (2 * ((8 * 8) + (2 * 2) + (16 * 16)) * sizeof(dirac_complex_t)));
+
+        /* A power is one call, whatever its products. */
+        cc = dirac_matrix_pow(aa, 4);
+        dirac_delete(cc);
+        ASSERT(dirac_trace_snapshot(statistics) == 0);
+        ASSERT(statistics[DIRAC_TRACE_POW].calls == 1);
+        ASSERT(statistics[DIRAC_TRACE_MUL].calls == 3);
+
+        /* The factorizations, eigensolvers and reductions are traced too. */
+        dirac_matrix_t * dd = dirac_new_base(4, 4);
+        dirac_matrix_t * vv = dirac_new_base(4, 1);
+        dirac_matrix_t * vectors = (dirac_matrix_t *)0;
+        int jj;
+        for (jj = 0; jj < 4; ++jj) {
+            ((dirac_complex_t *)dd)[(jj * 4) + jj] = 2.0;
+            ((dirac_complex_t *)vv)[jj] = 1.0;
+        }
+        cc = dirac_matrix_eigh(dd, &vectors);
+        dirac_delete(vectors);
+        dirac_delete(cc);
+        cc = dirac_matrix_eigh_range(dd, 0, 2, (dirac_matrix_t **)0);
+        dirac_delete(cc);
+        cc = dirac_matrix_solve(dd, vv);
+        dirac_delete(cc);
+        cc = dirac_matrix_inv(dd);
+        dirac_delete(cc);
+        (void)dirac_matrix_det(dd);
+        (void)dirac_matrix_trace(dd);
+        (void)dirac_matrix_norm(dd);
+        (void)dirac_matrix_inner(vv, vv);
+        (void)dirac_matrix_expectation(dd, vv);
+        {
+            static const size_t DIMS[] = { 2, 2, };
+            cc = dirac_matrix_ptrace(dd, DIMS, 2, 1);
+            dirac_delete(cc);
+        }
+        ASSERT(dirac_trace_snapshot(statistics) == 0);
+        for (jj = DIRAC_TRACE_EIGH; jj <= DIRAC_TRACE_EXPECTATION; ++jj) {
+            ASSERT(dirac_trace_name(jj) != (const char *)0);
+            ASSERT(statistics[jj].calls == 1);
+        }
+        /* An operand and a result. */
+        ASSERT(statistics[DIRAC_TRACE_INV].bytes == (2 * 4 * 4 * sizeof(dirac_complex_t)));
+        /* Two operands and no matrix result. */
+        ASSERT(statistics[DIRAC_TRACE_INNER].bytes == (2 * 4 * sizeof(dirac_complex_t)));
+        dirac_delete(vv);
+        dirac_delete(dd);
+
+        dirac_trace_reset();
+        ASSERT(calls() == 0);
+        cc = dirac_matrix_dup(aa);
+        dirac_delete(cc);
+        ASSERT(dirac_trace_snapshot(statistics) == 0);
+        ASSERT(statistics[DIRAC_TRACE_DUP].calls == 1);
+        ASSERT(calls() == 1);
+
+        /* Off again: the statistics stay as they were. */
+        ASSERT(dirac_trace_set(DIRAC_TRACE_OFF) == DIRAC_TRACE_COUNT);
+        cc = dirac_matrix_dup(aa);
+        dirac_delete(cc);
+        ASSERT(calls() == 1);
+
+        errno = 0;
+        ASSERT(dirac_trace_set(42) < 0);
+        ASSERT(errno == EINVAL);
+        ASSERT(dirac_trace_get() == DIRAC_TRACE_OFF);
+
+        dirac_trace_reset();
+        dirac_delete(bb);
+        dirac_delete(aa);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Each thread records into its own buffer; the snapshot sums them. */
+        dirac_trace_statistics_t statistics[DIRAC_TRACE_OPERATIONS];
+        pthread_t threads[4];
+        void * result;
+        size_t ii;
+
+        ASSERT(dirac_trace_set(DIRAC_TRACE_COUNT) == DIRAC_TRACE_OFF);
+
+        for (ii = 0; ii < (sizeof(threads) / sizeof(threads[0])); ++ii) {
+            ASSERT(pthread_create(&(threads[ii]), (pthread_attr_t *)0, work, (void *)0) == 0);
+        }
+        for (ii = 0; ii < (sizeof(threads) / sizeof(threads[0])); ++ii) {
+            ASSERT(pthread_join(threads[ii], &result) == 0);
+        }
+
+        ASSERT(dirac_trace_snapshot(statistics) == 0);
+        ASSERT(statistics[DIRAC_TRACE_ADD].calls == (4 * ROUNDS));
+        ASSERT(histogram(&(statistics[DIRAC_TRACE_ADD])) == (4 * ROUNDS));
+
+        /* The buffers of the threads that have gone are used again. */
+        ASSERT(pthread_create(&(threads[0]), (pthread_attr_t *)0, work, (void *)0) == 0);
+        ASSERT(pthread_join(threads[0], &result) == 0);
+        ASSERT(dirac_trace_snapshot(statistics) == 0);
+        ASSERT(statistics[DIRAC_TRACE_ADD].calls == (5 * ROUNDS));
+
+        ASSERT(dirac_trace_set(DIRAC_TRACE_OFF) == DIRAC_TRACE_COUNT);
+        dirac_trace_reset();
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Events are exported as complete events in a Chrome trace. */
+        dirac_matrix_t * aa = dirac_new_base(4, 4);
+        dirac_matrix_t * cc;
+        char * buffer = (char *)0;
+        size_t length = 0;
+        FILE * fp;
+        ssize_t count;
+
+        ASSERT(dirac_trace_set(DIRAC_TRACE_EVENTS) == DIRAC_TRACE_OFF);
+        cc = dirac_matrix_mul(aa, aa);
+        dirac_delete(cc);
+        cc = dirac_matrix_trn(aa);
+        dirac_delete(cc);
+        ASSERT(dirac_trace_set(DIRAC_TRACE_OFF) == DIRAC_TRACE_EVENTS);
+
+        ASSERT((fp = open_memstream(&buffer, &length)) != (FILE *)0);
+        count = dirac_trace_export(fp);
+        fclose(fp);
+        fputs(buffer, stderr);
+        ASSERT(count == 2);
+        ASSERT(strncmp(buffer, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 39) == 0);
+        ASSERT(strstr(buffer, "\"name\":\"dirac_matrix_mul\"") != (char *)0);
+        ASSERT(strstr(buffer, "\"name\":\"dirac_matrix_trn\"") != (char *)0);
+        ASSERT(strstr(buffer, "\"ph\":\"X\"") != (char *)0);
+        ASSERT(strcmp(&(buffer[length - 4]), "\n]}\n") == 0);
+        free(buffer);
+
+        /* A reset discards the events. */
+        dirac_trace_reset();
+        buffer = (char *)0;
+        ASSERT((fp = open_memstream(&buffer, &length)) != (FILE *)0);
+        ASSERT(dirac_trace_export(fp) == 0);
+        fclose(fp);
+        ASSERT(strcmp(buffer, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n]}\n") == 0);
+        free(buffer);
+
+        dirac_delete(aa);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}
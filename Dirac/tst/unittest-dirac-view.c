@@ -0,0 +1,556 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ * @copyright Copyright 2025 Digital Aggregates Corporation, Colorado, USA.
+ * @note Licensed under the terms in LICENSE.txt.
+ * @brief This is a unit test of the Dirac view functions.
+ * @author Chip Overclock <mailto:coverclock@diag.com>
+ * @see Diminuto <https://github.com/coverclock/com-diag-dirac>
+ * @details
+ * This is a unit test of the Dirac view functions.
+ */
+
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/dirac/dirac.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+
+/*
+ * Returns true if A and B, either of which may be a view, are the same
+ * shape and agree element by element.
+ */
+static int same(dirac_matrix_t * thema, dirac_matrix_t * themb)
+{
+    size_t rr;
+    size_t cc;
+    if ((dirac_rows_get(thema) != dirac_rows_get(themb)) || (dirac_cols_get(thema) != dirac_cols_get(themb))) {
+        return 0;
+    }
+    for (rr = 0; rr < dirac_rows_get(thema); ++rr) {
+        for (cc = 0; cc < dirac_cols_get(thema); ++cc) {
+            if (cabs(*dirac_view_point(thema, rr, cc) - *dirac_view_point(themb, rr, cc)) > 1e-9) {
+                return 0;
+            }
+        }
+    }
+    return !0;
+}
+
+/*
+ * Returns a new dense matrix whose element (R, C) is R + Ci/10.
+ */
+static dirac_matrix_t * known(size_t rows, size_t columns)
+{
+    dirac_matrix_t * them = dirac_new_base(rows, columns);
+    dirac_complex_t * tt = (dirac_complex_t *)them;
+    size_t rr;
+    size_t cc;
+    for (rr = 0; rr < rows; ++rr) {
+        for (cc = 0; cc < columns; ++cc) {
+            tt[(rr * columns) + cc] = CMPLX((double)rr, (double)cc / 10.0);
+        }
+    }
+    return them;
+}
+
+/*
+ * Returns a new dense matrix that is the adjoint of the dense matrix A.
+ */
+static dirac_matrix_t * adjoint(const dirac_matrix_t * thema)
+{
+    dirac_matrix_t * them = dirac_matrix_trn(thema);
+    dirac_complex_t * tt = (dirac_complex_t *)them;
+    size_t ii;
+    for (ii = 0; ii < (dirac_rows_get(them) * dirac_cols_get(them)); ++ii) {
+        tt[ii] = conj(tt[ii]);
+    }
+    return them;
+}
+
+int main(void)
+{
+    SETLOGMASK();
+
+    {
+        TEST();
+
+        /* Blocks, rows, columns and reshapes address the parent in place. */
+        dirac_matrix_t * matrix = known(6, 5);
+        dirac_complex_t * mm = (dirac_complex_t *)matrix;
+        dirac_matrix_t * block = dirac_view_block(matrix, 1, 2, 3, 2);
+        dirac_matrix_t * row = dirac_view_row(matrix, 4);
+        dirac_matrix_t * col = dirac_view_col(matrix, 3);
+        dirac_matrix_t * rows = dirac_view_block(matrix, 2, 0, 3, 5);
+        dirac_matrix_t * shape = dirac_view_reshape(matrix, 10, 3);
+        dirac_matrix_t * inner;
+        size_t rr;
+        size_t cc;
+
+        ASSERT(block != (dirac_matrix_t *)0);
+        ASSERT(row != (dirac_matrix_t *)0);
+        ASSERT(col != (dirac_matrix_t *)0);
+        ASSERT(rows != (dirac_matrix_t *)0);
+        ASSERT(shape != (dirac_matrix_t *)0);
+
+        ASSERT(dirac_kind_get(block) == DIRAC_KIND_STRIDED);
+        ASSERT(dirac_kind_get(col) == DIRAC_KIND_STRIDED);
+        ASSERT(dirac_kind_get(row) == DIRAC_KIND_DENSE);
+        ASSERT(dirac_kind_get(rows) == DIRAC_KIND_DENSE);
+        ASSERT(dirac_kind_get(shape) == DIRAC_KIND_DENSE);
+
+        /* Dense or not, a view is a view and its handle is not its elements. */
+        ASSERT(dirac_view_is(block));
+        ASSERT(dirac_view_is(col));
+        ASSERT(dirac_view_is(row));
+        ASSERT(dirac_view_is(rows));
+        ASSERT(dirac_view_is(shape));
+        ASSERT(!dirac_view_is(matrix));
+        ASSERT(!dirac_view_is((dirac_matrix_t *)0));
+
+        ASSERT((dirac_rows_get(block) == 3) && (dirac_cols_get(block) == 2));
+        ASSERT((dirac_rows_get(row) == 1) && (dirac_cols_get(row) == 5));
+        ASSERT((dirac_rows_get(col) == 6) && (dirac_cols_get(col) == 1));
+        ASSERT((dirac_rows_get(shape) == 10) && (dirac_cols_get(shape) == 3));
+
+        for (rr = 0; rr < 3; ++rr) {
+            for (cc = 0; cc < 2; ++cc) {
+                ASSERT(dirac_view_point(block, rr, cc) == &(mm[((rr + 1) * 5) + cc + 2]));
+            }
+        }
+        for (cc = 0; cc < 5; ++cc) {
+            ASSERT(*dirac_view_point(row, 0, cc) == CMPLX(4.0, cc / 10.0));
+        }
+        for (rr = 0; rr < 6; ++rr) {
+            ASSERT(*dirac_view_point(col, rr, 0) == CMPLX((double)rr, 0.3));
+        }
+        for (rr = 0; rr < 10; ++rr) {
+            for (cc = 0; cc < 3; ++cc) {
+                ASSERT(dirac_view_point(shape, rr, cc) == &(mm[(rr * 3) + cc]));
+            }
+        }
+
+        /* A contiguous view is its elements, like any dense matrix. */
+        ASSERT(dirac_view_point(rows, 2, 4) == &(mm[(4 * 5) + 4]));
+
+        /* Views of views compose. */
+        inner = dirac_view_block(block, 1, 1, 2, 1);
+        ASSERT(inner != (dirac_matrix_t *)0);
+        ASSERT(dirac_view_point(inner, 0, 0) == &(mm[(2 * 5) + 3]));
+        ASSERT(dirac_view_point(inner, 1, 0) == &(mm[(3 * 5) + 3]));
+        ASSERT(dirac_view_point(inner, 2, 0) == (dirac_complex_t *)0);
+        dirac_delete(inner);
+
+        /* Writes through a view land in the parent. */
+        *dirac_view_point(block, 2, 1) = CMPLX(-7.0, 7.0);
+        ASSERT(mm[(3 * 5) + 3] == CMPLX(-7.0, 7.0));
+        *dirac_view_point(col, 5, 0) = 42.0;
+        ASSERT(mm[(5 * 5) + 3] == 42.0);
+
+        /* General views step by any strides. */
+        inner = dirac_view_new(matrix, 1, 3, 2, 10, 2);
+        ASSERT(inner != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(inner) == DIRAC_KIND_STRIDED);
+        ASSERT(dirac_view_point(inner, 2, 1) == &(mm[1 + 20 + 2]));
+        dirac_delete(inner);
+
+        dirac_delete(shape);
+        dirac_delete(rows);
+        dirac_delete(col);
+        dirac_delete(row);
+        dirac_delete(block);
+        dirac_delete(matrix);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Every operation gives the same answer on a view as on a copy. */
+        dirac_matrix_t * matrix = known(8, 8);
+        dirac_complex_t * mm = (dirac_complex_t *)matrix;
+        dirac_matrix_t * left = dirac_view_block(matrix, 0, 1, 4, 4);
+        dirac_matrix_t * right = dirac_view_block(matrix, 3, 4, 4, 4);
+        dirac_matrix_t * col = dirac_view_col(matrix, 6);
+        dirac_matrix_t * copyl;
+        dirac_matrix_t * copyr;
+        dirac_matrix_t * copyc;
+        dirac_matrix_t * diagonal = dirac_diagonal_new(4);
+        dirac_matrix_t * sparse;
+        dirac_matrix_t * one;
+        dirac_matrix_t * two;
+        size_t ii;
+
+        /* Make the blocks well conditioned for solving and exponentiating. */
+        for (ii = 0; ii < 8; ++ii) {
+            mm[(ii * 8) + ii] += 10.0;
+            mm[(ii * 8) + ((ii + 1) % 8)] += CMPLX(0.0, 3.0);
+        }
+        copyl = dirac_matrix_dup(left);
+        copyr = dirac_matrix_dup(right);
+        copyc = dirac_matrix_dup(col);
+        ASSERT(dirac_kind_get(copyl) == DIRAC_KIND_DENSE);
+        ASSERT(same(left, copyl));
+        ASSERT(same(col, copyc));
+        for (ii = 0; ii < 4; ++ii) {
+            ((dirac_complex_t *)diagonal)[ii] = CMPLX(ii + 1.0, -1.0);
+        }
+        sparse = dirac_sparse_from_dense(right);
+        ASSERT(sparse != (dirac_matrix_t *)0);
+
+        one = dirac_matrix_mul(left, right); two = dirac_matrix_mul(copyl, copyr);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_mul(left, copyr); two = dirac_matrix_mul(copyl, right);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_add(left, right); two = dirac_matrix_add(copyl, copyr);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_sub(left, right); two = dirac_matrix_sub(copyl, copyr);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_had(left, right); two = dirac_matrix_had(copyl, copyr);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_trn(left); two = dirac_matrix_trn(copyl);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_kro(left, col); two = dirac_matrix_kro(copyl, copyc);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_pow(left, 3); two = dirac_matrix_pow(copyl, 3);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+
+        /* With the other kinds. */
+        one = dirac_matrix_mul(diagonal, left); two = dirac_matrix_mul(diagonal, copyl);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_mul(left, sparse); two = dirac_matrix_mul(copyl, copyr);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_mul(sparse, left); two = dirac_matrix_mul(copyr, copyl);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+
+        /* The reductions and the factorizations. */
+        ASSERT(cabs(dirac_matrix_trace(left) - dirac_matrix_trace(copyl)) < 1e-9);
+        ASSERT(fabs(dirac_matrix_norm(col) - dirac_matrix_norm(copyc)) < 1e-9);
+        ASSERT(cabs(dirac_matrix_inner(col, col) - dirac_matrix_inner(copyc, copyc)) < 1e-9);
+        ASSERT(cabs(dirac_matrix_det(left) - dirac_matrix_det(copyl)) < (1e-9 * cabs(dirac_matrix_det(copyl))));
+        one = dirac_matrix_expm(left, CMPLX(0.0, -0.01)); two = dirac_matrix_expm(copyl, CMPLX(0.0, -0.01));
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+
+        dirac_delete(sparse);
+        dirac_delete(diagonal);
+        dirac_delete(copyc);
+        dirac_delete(copyr);
+        dirac_delete(copyl);
+        dirac_delete(col);
+        dirac_delete(right);
+        dirac_delete(left);
+        dirac_delete(matrix);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Transposes and adjoints are views that read through flags. */
+        static const size_t ORDER = 6;
+        dirac_matrix_t * uu = dirac_new_base(ORDER, ORDER);
+        dirac_matrix_t * rho = dirac_new_base(ORDER, ORDER);
+        dirac_matrix_t * vector = dirac_new_base(ORDER, 1);
+        dirac_complex_t * pp = (dirac_complex_t *)uu;
+        dirac_complex_t * qq = (dirac_complex_t *)rho;
+        dirac_complex_t * vv = (dirac_complex_t *)vector;
+        dirac_matrix_t * trn = dirac_view_trn(uu);
+        dirac_matrix_t * adj = dirac_view_adj(uu);
+        dirac_matrix_t * copyt;
+        dirac_matrix_t * copya;
+        dirac_matrix_t * back;
+        dirac_matrix_t * row;
+        dirac_matrix_t * one;
+        dirac_matrix_t * two;
+        dirac_matrix_t * three;
+        size_t ii;
+
+        for (ii = 0; ii < (ORDER * ORDER); ++ii) {
+            pp[ii] = CMPLX(sin((double)ii), cos((double)(3 * ii)));
+            qq[ii] = CMPLX(cos((double)(ii * ii)), sin((double)(ii + 1)));
+        }
+        for (ii = 0; ii < ORDER; ++ii) {
+            vv[ii] = CMPLX((double)ii, 1.0 - ii);
+        }
+        ASSERT(dirac_view_is(trn));
+        ASSERT(dirac_view_is(adj));
+        ASSERT(!dirac_view_is(uu));
+
+        copyt = dirac_matrix_trn(uu);
+        copya = adjoint(uu);
+
+        ASSERT(trn != (dirac_matrix_t *)0);
+        ASSERT(adj != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(trn) == DIRAC_KIND_STRIDED);
+        ASSERT(dirac_kind_get(adj) == DIRAC_KIND_STRIDED);
+        ASSERT(dirac_view_point(trn, 1, 4) == &(pp[(4 * ORDER) + 1]));
+        ASSERT(same(trn, copyt));
+        one = dirac_matrix_dup(adj);
+        ASSERT(same(one, copya));
+        dirac_delete(one);
+
+        /* U * RHO * U^H with no copies against the same with them. */
+        two = dirac_matrix_mul(uu, rho);
+        one = dirac_matrix_mul(two, adj);
+        three = dirac_matrix_mul(two, copya);
+        ASSERT(same(one, three));
+        dirac_delete(three); dirac_delete(two); dirac_delete(one);
+
+        one = dirac_matrix_mul(adj, rho); two = dirac_matrix_mul(copya, rho);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_mul(adj, trn); two = dirac_matrix_mul(copya, copyt);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_mul(adj, vector); two = dirac_matrix_mul(copya, vector);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_pow_apply(adj, 3, vector); two = dirac_matrix_pow_apply(copya, 3, vector);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_add(adj, rho); two = dirac_matrix_add(copya, rho);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_had(rho, adj); two = dirac_matrix_had(rho, copya);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_kro(adj, vector); two = dirac_matrix_kro(copya, vector);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        one = dirac_matrix_trn(adj); two = dirac_matrix_trn(copya);
+        ASSERT(same(one, two)); dirac_delete(one); dirac_delete(two);
+        ASSERT(cabs(dirac_matrix_trace(adj) - conj(dirac_matrix_trace(uu))) < 1e-9);
+        ASSERT(cabs(dirac_matrix_expectation(adj, vector) - dirac_matrix_expectation(copya, vector)) < 1e-9);
+        ASSERT(fabs(dirac_matrix_norm(adj) - dirac_matrix_norm(uu)) < 1e-9);
+
+        /* Twice round is the matrix as stored, and a row turns dense. */
+        back = dirac_view_adj(adj);
+        ASSERT(back != (dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(back) == DIRAC_KIND_DENSE);
+        ASSERT(same(back, uu));
+        dirac_delete(back);
+        back = dirac_view_trn(adj);
+        ASSERT(dirac_kind_get(back) == DIRAC_KIND_STRIDED);
+        ASSERT(cabs(*dirac_view_point(back, 2, 3) - pp[(2 * ORDER) + 3]) < 1e-12);
+        dirac_delete(back);
+        row = dirac_view_trn(vector);
+        ASSERT(dirac_kind_get(row) == DIRAC_KIND_DENSE);
+        ASSERT((dirac_rows_get(row) == 1) && (dirac_cols_get(row) == ORDER));
+        back = dirac_view_adj(vector);
+        ASSERT(dirac_kind_get(back) == DIRAC_KIND_STRIDED);
+        one = dirac_matrix_mul(back, vector);
+        ASSERT(cabs(((dirac_complex_t *)one)[0] - dirac_matrix_inner(vector, vector)) < 1e-9);
+        dirac_delete(one);
+        dirac_delete(back);
+        dirac_delete(row);
+
+        /* Assigning through an adjoint stores the adjoint. */
+        ASSERT(dirac_view_assign(adj, rho) == adj);
+        two = adjoint(rho);
+        ASSERT(same(uu, two));
+        dirac_delete(two);
+
+        dirac_delete(copya);
+        dirac_delete(copyt);
+        dirac_delete(adj);
+        dirac_delete(trn);
+        dirac_delete(vector);
+        dirac_delete(rho);
+        dirac_delete(uu);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* A column of amplitudes samples as the vector it views. */
+        dirac_matrix_t * matrix = dirac_new_base(4, 3);
+        dirac_complex_t * mm = (dirac_complex_t *)matrix;
+        dirac_matrix_t * col = dirac_view_col(matrix, 1);
+        dirac_sampler_t * sampler;
+        uint64_t shots[1000];
+        size_t ii;
+
+        mm[(2 * 3) + 1] = 1.0;
+        mm[(3 * 3) + 0] = 1.0;
+        mm[(0 * 3) + 2] = 1.0;
+
+        sampler = dirac_sampler_new(col, DIRAC_SAMPLE_ALL);
+        ASSERT(sampler != (dirac_sampler_t *)0);
+        ASSERT(dirac_sampler_draw(sampler, 7, shots, 1000) == 1000);
+        for (ii = 0; ii < 1000; ++ii) {
+            ASSERT(shots[ii] == 2);
+        }
+        dirac_sampler_delete(sampler);
+
+        dirac_delete(col);
+        dirac_delete(matrix);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* Results are written into a block of a larger matrix. */
+        dirac_matrix_t * matrix = dirac_new_base(4, 4);
+        dirac_complex_t * mm = (dirac_complex_t *)matrix;
+        dirac_matrix_t * block = dirac_view_block(matrix, 1, 1, 2, 2);
+        dirac_matrix_t * corner = dirac_view_block(matrix, 0, 0, 2, 2);
+        dirac_matrix_t * diagonal = dirac_diagonal_new(2);
+        size_t rr;
+        size_t cc;
+
+        ((dirac_complex_t *)diagonal)[0] = 3.0;
+        ((dirac_complex_t *)diagonal)[1] = 4.0;
+
+        ASSERT(dirac_view_assign(block, diagonal) == block);
+        for (rr = 0; rr < 4; ++rr) {
+            for (cc = 0; cc < 4; ++cc) {
+                if ((rr == 1) && (cc == 1)) {
+                    ASSERT(mm[(rr * 4) + cc] == 3.0);
+                } else if ((rr == 2) && (cc == 2)) {
+                    ASSERT(mm[(rr * 4) + cc] == 4.0);
+                } else {
+                    ASSERT(mm[(rr * 4) + cc] == 0.0);
+                }
+            }
+        }
+
+        /* Overlapping source and target. */
+        ASSERT(dirac_view_assign(corner, block) == corner);
+        ASSERT(mm[0] == 3.0);
+        ASSERT(mm[1] == 0.0);
+        ASSERT(mm[4] == 0.0);
+        ASSERT(mm[5] == 4.0);
+        ASSERT(mm[10] == 4.0);
+
+        errno = 0;
+        ASSERT(dirac_view_assign(matrix, diagonal) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_view_assign(diagonal, block) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+
+        dirac_delete(diagonal);
+        dirac_delete(corner);
+        dirac_delete(block);
+        dirac_delete(matrix);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        /* A strided view is written out as the matrix it looks like. */
+        char path[] = "/tmp/unittest-dirac-view-XXXXXX";
+        dirac_matrix_t * matrix = known(5, 7);
+        dirac_matrix_t * block = dirac_view_block(matrix, 1, 2, 3, 4);
+        dirac_matrix_t * copy = dirac_matrix_dup(block);
+        const dirac_matrix_t * loaded;
+        char * one = (char *)0;
+        char * two = (char *)0;
+        size_t ones = 0;
+        size_t twos = 0;
+        FILE * fp;
+        int fd;
+
+        fp = open_memstream(&one, &ones);
+        ASSERT(dirac_market_write(fp, block) > 0);
+        fclose(fp);
+        fp = open_memstream(&two, &twos);
+        ASSERT(dirac_market_write(fp, copy) > 0);
+        fclose(fp);
+        ASSERT(ones == twos);
+        ASSERT(memcmp(one, two, ones) == 0);
+        free(two);
+        free(one);
+
+        fd = mkstemp(path);
+        ASSERT(fd >= 0);
+        close(fd);
+        ASSERT(dirac_store(path, block) > 0);
+        loaded = dirac_load(path);
+        ASSERT(loaded != (const dirac_matrix_t *)0);
+        ASSERT(dirac_kind_get(loaded) == DIRAC_KIND_DENSE);
+        ASSERT(memcmp(loaded, copy, 3 * 4 * sizeof(dirac_complex_t)) == 0);
+        dirac_unload(loaded);
+        unlink(path);
+
+        dirac_delete(copy);
+        dirac_delete(block);
+        dirac_delete(matrix);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_matrix_t * matrix = dirac_new_base(3, 4);
+        dirac_matrix_t * diagonal = dirac_diagonal_new(3);
+        dirac_matrix_t * col = dirac_view_col(matrix, 0);
+
+        errno = 0;
+        ASSERT(dirac_view_block(matrix, 2, 0, 2, 1) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_view_block(matrix, 0, 4, 1, 1) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_view_block(matrix, 0, 0, 0, 1) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_view_row(matrix, 3) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_view_col(diagonal, 0) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_view_reshape(matrix, 5, 2) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_view_reshape(col, 1, 3) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_view_new(matrix, 3, 3, 2, 4, 1) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_view_new(matrix, 12, 1, 1, 1, 1) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        errno = 0;
+        ASSERT(dirac_view_new(col, 0, 1, 1, 1, 1) == (dirac_matrix_t *)0);
+        ASSERT(errno == EINVAL);
+        ASSERT(dirac_view_point(matrix, 3, 0) == (dirac_complex_t *)0);
+        ASSERT(dirac_view_point(diagonal, 0, 0) == (dirac_complex_t *)0);
+        ASSERT(dirac_view_point((dirac_matrix_t *)0, 0, 0) == (dirac_complex_t *)0);
+
+        dirac_delete(col);
+        dirac_delete(diagonal);
+        dirac_delete(matrix);
+
+        STATUS();
+    }
+
+    {
+        TEST();
+
+        dirac_t * that = dirac_audit();
+        ASSERT(that == (dirac_t *)0);
+
+        ssize_t total;
+
+        total = dirac_dump(stderr);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total >= 0);
+
+        dirac_free();
+
+        total = dirac_dump((FILE *)0);
+        fprintf(stderr, "cache[%zd]\n", total);
+        ASSERT(total == 0);
+
+        STATUS();
+    }
+
+    EXIT();
+}